@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/renderer/sw/pixel_ops.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+// The per-pixel loops the kernels replaced, for comparison
+void scalar_swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dst[i] = (src[i] & 0xff00ff00) | ((src[i] >> 16) & 0xff) | ((src[i] & 0xff) << 16);
+}
+
+void scalar_fill(uint32_t* dst, size_t count, uint32_t value)
+{
+    for (uint32_t* i = dst; i < dst + count; i++)
+        *i = value;
+}
+
+void scalar_premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const a = src[i] >> 24;
+        dst[i] = (a << 24) |
+            ((((src[i] >> 16) & 0xff) * a / 255) << 16) |
+            ((((src[i] >> 8) & 0xff) * a / 255) << 8) |
+            ((src[i] & 0xff) * a / 255);
+    }
+}
+
+void time(std::string const& name, uint64_t iterations, uint64_t pixels, std::function<void()> const& operation)
+{
+    operation();    // Warm the caches
+
+    auto const start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i != iterations; ++i)
+        operation();
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::cout << name << ": " << ns / iterations << "ns per frame, "
+              << static_cast<double>(pixels * iterations) / ns << " pixels/ns" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <width> <height> <iterations>"<<std::endl;
+        exit(1);
+    }
+
+    size_t const width = std::atoi(argv[1]);
+    size_t const height = std::atoi(argv[2]);
+    uint64_t const iterations = std::atoll(argv[3]);
+    size_t const count = width * height;
+    geom::Stride const stride{width * sizeof(uint32_t)};
+
+    std::vector<uint32_t> src(count);
+    for (size_t i = 0; i != count; ++i)
+        src[i] = static_cast<uint32_t>(i * 2654435761u);
+    std::vector<uint32_t> dst(count);
+    std::vector<uint32_t> scaled(count * 4);
+
+    std::cout<<"Using "<<mrs::pixel_ops_implementation()<<" kernels on "<<width<<"x"<<height<<" pixels"<<std::endl;
+
+    time("swap_red_blue (scalar)", iterations, count,
+        [&]{ scalar_swap_red_blue(src.data(), dst.data(), count); });
+    time("swap_red_blue", iterations, count,
+        [&]{ mrs::swap_red_blue(src.data(), dst.data(), count); });
+
+    time("premultiply_alpha (scalar)", iterations, count,
+        [&]{ scalar_premultiply_alpha(src.data(), dst.data(), count); });
+    time("premultiply_alpha", iterations, count,
+        [&]{ mrs::premultiply_alpha(src.data(), dst.data(), count); });
+
+    time("fill (scalar)", iterations, count,
+        [&]{ scalar_fill(dst.data(), count, 0xff323232); });
+    time("fill_pixels", iterations, count,
+        [&]{ mrs::fill_pixels(dst.data(), count, 0xff323232); });
+
+    time("flip_rows", iterations, count,
+        [&]{ mrs::flip_rows(reinterpret_cast<unsigned char*>(dst.data()), stride, width, height, false); });
+    time("flip_rows (swapping red and blue)", iterations, count,
+        [&]{ mrs::flip_rows(reinterpret_cast<unsigned char*>(dst.data()), stride, width, height, true); });
+
+    time("scale_pixels (2x)", iterations, count * 4,
+        [&]
+        {
+            mrs::scale_pixels(
+                src.data(), geom::Size{width, height}, stride,
+                scaled.data(), geom::Size{width * 2, height * 2}, geom::Stride{stride.as_uint32_t() * 2});
+        });
+
+    exit(0);
+}
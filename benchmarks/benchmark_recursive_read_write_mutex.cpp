@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/recursive_read_write_mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// The previous implementation: every lock operation goes through one mutex
+class SingleMutexRecursiveReadWriteMutex
+{
+public:
+    void read_lock()
+    {
+        auto const my_id = std::this_thread::get_id();
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait(lock, [&]{ return !write_locking_thread.count || write_locking_thread.id == my_id; });
+
+        auto const my_count = std::find_if(
+            read_locking_threads.begin(),
+            read_locking_threads.end(),
+            [my_id](ThreadLockCount const& candidate) { return my_id == candidate.id; });
+
+        if (my_count == read_locking_threads.end())
+            read_locking_threads.push_back(ThreadLockCount{my_id, 1U});
+        else
+            ++(my_count->count);
+    }
+
+    void read_unlock()
+    {
+        auto const my_id = std::this_thread::get_id();
+
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        auto const my_count = std::find_if(
+            read_locking_threads.begin(),
+            read_locking_threads.end(),
+            [my_id](ThreadLockCount const& candidate) { return my_id == candidate.id; });
+
+        --(my_count->count);
+        cv.notify_all();
+    }
+
+    void write_lock()
+    {
+        auto const my_id = std::this_thread::get_id();
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait(lock, [&]
+            {
+                if (write_locking_thread.count && write_locking_thread.id != my_id) return false;
+                for (auto const& candidate : read_locking_threads)
+                {
+                    if (candidate.id != my_id && candidate.count != 0) return false;
+                }
+                return true;
+            });
+
+        ++write_locking_thread.count;
+        write_locking_thread.id = my_id;
+    }
+
+    void write_unlock()
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        --write_locking_thread.count;
+        cv.notify_all();
+    }
+
+private:
+    struct ThreadLockCount
+    {
+        std::thread::id id;
+        unsigned int count;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<ThreadLockCount> read_locking_threads;
+    ThreadLockCount write_locking_thread{{}, 0};
+};
+
+/// Runs readers (and a writer, if write_every isn't 0) for a while; returns read locks per microsecond
+template<typename Mutex>
+auto reads_per_us(unsigned threads, unsigned write_every, std::chrono::milliseconds duration) -> double
+{
+    Mutex mutex;
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> reads{0};
+    uint64_t guarded{0};
+
+    std::vector<std::thread> readers;
+    for (unsigned i = 0; i != threads; ++i)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                uint64_t my_reads = 0;
+                uint64_t seen = 0;
+                while (running)
+                {
+                    mutex.read_lock();
+                    seen += guarded;
+                    mutex.read_unlock();
+                    ++my_reads;
+
+                    if (write_every && my_reads % write_every == 0)
+                    {
+                        mutex.write_lock();
+                        ++guarded;
+                        mutex.write_unlock();
+                    }
+                }
+                reads += my_reads + (seen & 1);
+            });
+    }
+
+    std::this_thread::sleep_for(duration);
+    running = false;
+    for (auto& reader : readers)
+        reader.join();
+
+    return static_cast<double>(reads) / std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+void compare(unsigned threads, unsigned write_every, std::chrono::milliseconds duration)
+{
+    auto const before = reads_per_us<SingleMutexRecursiveReadWriteMutex>(threads, write_every, duration);
+    auto const after = reads_per_us<mir::RecursiveReadWriteMutex>(threads, write_every, duration);
+
+    std::cout << threads << " threads, "
+              << (write_every ? "writing every " + std::to_string(write_every) + " reads" : std::string{"read only"})
+              << ": single mutex " << before << " reads/us, RecursiveReadWriteMutex " << after << " reads/us"
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <max threads> <milliseconds per run>"<<std::endl;
+        exit(1);
+    }
+
+    unsigned const max_threads = std::atoi(argv[1]);
+    std::chrono::milliseconds const duration{std::atoi(argv[2])};
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        compare(threads, 0, duration);
+        compare(threads, 1000, duration);
+    }
+
+    exit(0);
+}
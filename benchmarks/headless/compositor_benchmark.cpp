@@ -0,0 +1,278 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headless_server.h"
+#include "synthetic_client.h"
+#include "statistics.h"
+
+#include "mir/compositor/display_buffer_compositor.h"
+#include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/compositor/scene_element.h"
+
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+namespace mb = mir_benchmark;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+using namespace std::chrono;
+
+namespace
+{
+/// How long each composite() pass takes, across all outputs
+class FrameTimes
+{
+public:
+    void record(nanoseconds duration)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        durations.push_back(duration);
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        durations.clear();
+    }
+
+    auto take() -> std::vector<nanoseconds>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return std::move(durations);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<nanoseconds> durations;
+};
+
+class TimedCompositor : public mc::DisplayBufferCompositor
+{
+public:
+    TimedCompositor(std::unique_ptr<mc::DisplayBufferCompositor> wrapped, std::shared_ptr<FrameTimes> const& times)
+        : wrapped{std::move(wrapped)},
+          times{times}
+    {
+    }
+
+    void composite(mc::SceneElementSequence&& scene_sequence) override
+    {
+        auto const start = steady_clock::now();
+        wrapped->composite(std::move(scene_sequence));
+        times->record(steady_clock::now() - start);
+    }
+
+private:
+    std::unique_ptr<mc::DisplayBufferCompositor> const wrapped;
+    std::shared_ptr<FrameTimes> const times;
+};
+
+class TimedCompositorFactory : public mc::DisplayBufferCompositorFactory
+{
+public:
+    TimedCompositorFactory(
+        std::shared_ptr<mc::DisplayBufferCompositorFactory> const& wrapped,
+        std::shared_ptr<FrameTimes> const& times)
+        : wrapped{wrapped},
+          times{times}
+    {
+    }
+
+    auto create_compositor_for(mg::DisplayBuffer& display_buffer)
+        -> std::unique_ptr<mc::DisplayBufferCompositor> override
+    {
+        return std::make_unique<TimedCompositor>(wrapped->create_compositor_for(display_buffer), times);
+    }
+
+private:
+    std::shared_ptr<mc::DisplayBufferCompositorFactory> const wrapped;
+    std::shared_ptr<FrameTimes> const times;
+};
+
+auto process_cpu_time() -> nanoseconds
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return seconds{usage.ru_utime.tv_sec + usage.ru_stime.tv_sec} +
+        microseconds{usage.ru_utime.tv_usec + usage.ru_stime.tv_usec};
+}
+
+auto parse_size(std::string const& text) -> geom::Size
+{
+    auto const x = text.find('x');
+    if (x == std::string::npos)
+        throw std::invalid_argument{"Expected a size as <width>x<height>, got: " + text};
+    return geom::Size{std::stoi(text.substr(0, x)), std::stoi(text.substr(x + 1))};
+}
+
+auto as_seconds(nanoseconds time) -> double
+{
+    return duration<double>{time}.count();
+}
+
+void usage(char const* name)
+{
+    std::cerr
+        << "Usage: " << name << " [options]\n"
+        << "Drives synthetic wl_shm clients against an in-process Mir server on the stub graphics platform\n"
+        << "and writes the results as JSON.\n\n"
+        << "  --clients <n>            number of clients [default: 4]\n"
+        << "  --size <w>x<h>           client buffer size [default: 640x480]\n"
+        << "  --rate <hz>              commits per second per client, 0 to follow frame callbacks [default: 0]\n"
+        << "  --damage full|band|none  what each client redraws per commit [default: full]\n"
+        << "  --output-size <w>x<h>    size of the (single) output [default: 1920x1080]\n"
+        << "  --warmup <s>             seconds to run before measuring [default: 1]\n"
+        << "  --duration <s>           seconds to measure [default: 10]\n"
+        << "  --output <file>          where to write the results [default: stdout]\n";
+}
+}
+
+int main(int argc, char* argv[])
+try
+{
+    std::map<std::string, std::string> options{
+        {"--clients", "4"},
+        {"--size", "640x480"},
+        {"--rate", "0"},
+        {"--damage", "full"},
+        {"--output-size", "1920x1080"},
+        {"--warmup", "1"},
+        {"--duration", "10"},
+        {"--output", ""}};
+
+    for (int i = 1; i != argc; ++i)
+    {
+        auto const option = options.find(argv[i]);
+        if (option == options.end() || i + 1 == argc)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        option->second = argv[++i];
+    }
+
+    auto const client_count = std::stoi(options["--clients"]);
+    mb::ClientParameters const parameters{
+        parse_size(options["--size"]),
+        std::stod(options["--rate"]),
+        mb::damage_pattern_from(options["--damage"])};
+    auto const output_size = parse_size(options["--output-size"]);
+    duration<double> const warmup{std::stod(options["--warmup"])};
+    duration<double> const measured{std::stod(options["--duration"])};
+
+    mb::HeadlessServer server{{geom::Rectangle{{0, 0}, output_size}}};
+
+    auto const frame_times = std::make_shared<FrameTimes>();
+    server.server.wrap_display_buffer_compositor_factory(
+        [frame_times](std::shared_ptr<mc::DisplayBufferCompositorFactory> const& wrapped)
+        {
+            return std::make_shared<TimedCompositorFactory>(wrapped, frame_times);
+        });
+
+    server.start_server();
+
+    std::vector<std::unique_ptr<mb::SyntheticClient>> clients;
+    for (int i = 0; i != client_count; ++i)
+        clients.push_back(std::make_unique<mb::SyntheticClient>(server.connect_wayland_client(), parameters));
+
+    for (auto const& client : clients)
+        client->start();
+
+    std::this_thread::sleep_for(warmup);
+
+    frame_times->reset();
+    for (auto const& client : clients)
+        client->reset();
+    auto const cpu_at_start = process_cpu_time();
+    auto const start = steady_clock::now();
+
+    std::this_thread::sleep_for(measured);
+
+    auto const elapsed = steady_clock::now() - start;
+    auto const process_cpu = process_cpu_time() - cpu_at_start;
+    auto const compositor_frames = frame_times->take();
+
+    std::vector<mb::ClientResults> results;
+    for (auto const& client : clients)
+        results.push_back(client->stop());
+
+    clients.clear();
+    server.stop_server();
+
+    nanoseconds client_cpu{0};
+    for (auto const& result : results)
+        client_cpu += result.cpu_time;
+    // The main thread only sleeps while measuring, so the rest is the server's
+    auto const server_cpu = process_cpu - client_cpu;
+
+    std::ofstream file;
+    if (!options["--output"].empty())
+        file.open(options["--output"]);
+    std::ostream& out = file.is_open() ? file : std::cout;
+
+    out << "{\n"
+        << "  \"parameters\": {"
+        << "\"clients\": " << client_count
+        << ", \"width\": " << parameters.size.width.as_int()
+        << ", \"height\": " << parameters.size.height.as_int()
+        << ", \"commit_rate\": " << parameters.commit_rate
+        << ", \"damage\": \"" << mb::to_string(parameters.damage) << "\""
+        << ", \"duration_s\": " << as_seconds(elapsed)
+        << "},\n";
+
+    out << "  \"compositor\": {"
+        << "\"frames_per_second\": " << compositor_frames.size() / as_seconds(elapsed)
+        << ", \"frame_time_us\": ";
+    mb::write_json(out, mb::summarise(mb::to_microseconds(compositor_frames)));
+    out << ", \"cpu_s\": " << as_seconds(server_cpu)
+        << ", \"cpu_s_per_client\": " << as_seconds(server_cpu) / std::max(1, client_count)
+        << "},\n";
+
+    out << "  \"clients\": [\n";
+    for (size_t i = 0; i != results.size(); ++i)
+    {
+        auto const& result = results[i];
+        out << "    {\"commits\": " << result.commits
+            << ", \"frames\": " << result.frames
+            << ", \"skipped\": " << result.skipped
+            << ", \"cpu_s\": " << as_seconds(result.cpu_time)
+            << ", \"commit_to_consume_us\": ";
+        mb::write_json(out, mb::summarise(mb::to_microseconds(result.commit_to_consume)));
+        out << "}" << (i + 1 != results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << boost::diagnostic_information(error) << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headless_server.h"
+
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/headless_display_buffer_compositor_factory.h"
+#include "mir_test_framework/stub_server_platform_factory.h"
+#include "mir/fd.h"
+#include "mir/input/input_device_hub.h"
+#include "mir/input/input_device_info.h"
+#include "mir/input/input_device_observer.h"
+#include "mir/input/device.h"
+
+#include <wayland-client-core.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace geom = mir::geometry;
+namespace mi = mir::input;
+namespace mtf = mir_test_framework;
+namespace mb = mir_benchmark;
+
+namespace
+{
+// As in HeadlessTest, keep the platform library loaded until the last stub buffer has gone
+std::shared_ptr<void> delay_unloading_graphics_platform;
+
+class DeviceWaiter : public mi::InputDeviceObserver
+{
+public:
+    explicit DeviceWaiter(std::string const& unique_id)
+        : unique_id{unique_id}
+    {
+    }
+
+    void device_added(std::shared_ptr<mi::Device> const& device) override
+    {
+        if (device->unique_id() == unique_id)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            added = true;
+        }
+    }
+
+    void device_changed(std::shared_ptr<mi::Device> const&) override {}
+    void device_removed(std::shared_ptr<mi::Device> const&) override {}
+
+    void changes_complete() override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (added)
+            cv.notify_all();
+    }
+
+    auto wait_for(std::chrono::seconds timeout) -> bool
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        return cv.wait_for(lock, timeout, [this] { return added; });
+    }
+
+private:
+    std::string const unique_id;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool added{false};
+};
+}
+
+mb::HeadlessServer::HeadlessServer(std::vector<geom::Rectangle> const& outputs)
+{
+    add_to_environment("MIR_SERVER_PLATFORM_GRAPHICS_LIB", mtf::server_platform("graphics-dummy.so").c_str());
+    add_to_environment("MIR_SERVER_PLATFORM_INPUT_LIB", mtf::server_platform("input-stub.so").c_str());
+    add_to_environment("MIR_SERVER_ENABLE_KEY_REPEAT", "false");
+    add_to_environment("MIR_SERVER_CONSOLE_PROVIDER", "none");
+    add_to_environment("MIR_SERVER_NO_FILE", "");
+
+    mtf::set_next_display_rects(std::make_unique<std::vector<geom::Rectangle>>(outputs));
+
+    server.override_the_display_buffer_compositor_factory([]
+        {
+            return std::make_shared<mtf::HeadlessDisplayBufferCompositorFactory>();
+        });
+
+    server.add_init_callback([server = &server]
+        { delay_unloading_graphics_platform = server->the_graphics_platform(); });
+}
+
+mb::HeadlessServer::~HeadlessServer()
+{
+    delay_unloading_graphics_platform.reset();
+}
+
+auto mb::HeadlessServer::connect_wayland_client() -> wl_display*
+{
+    auto const fd = server.open_wayland_client_socket();
+
+    // wl_display_connect_to_fd() takes ownership of the fd it is given
+    auto const display = wl_display_connect_to_fd(dup(fd));
+    if (!display)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to connect Wayland client to benchmark server"}));
+    }
+    return display;
+}
+
+auto mb::HeadlessServer::add_input_device(mi::InputDeviceInfo const& info)
+    -> mir::UniqueModulePtr<mtf::FakeInputDevice>
+{
+    auto const waiter = std::make_shared<DeviceWaiter>(info.unique_id);
+    auto const hub = server.the_input_device_hub();
+    hub->add_observer(waiter);
+
+    auto device = mtf::add_fake_input_device(info);
+    auto const added = waiter->wait_for(std::chrono::seconds{5});
+
+    hub->remove_observer(waiter);
+
+    if (!added)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Fake input device was not added: " + info.name}));
+    }
+    return device;
+}
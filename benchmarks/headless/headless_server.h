@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_HEADLESS_SERVER_H_
+#define MIR_BENCHMARK_HEADLESS_SERVER_H_
+
+#include "mir_test_framework/async_server_runner.h"
+#include "mir_test_framework/fake_input_device.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/module_deleter.h"
+
+#include <vector>
+
+struct wl_display;
+
+namespace mir
+{
+namespace input
+{
+struct InputDeviceInfo;
+}
+}
+
+namespace mir_benchmark
+{
+/// An in-process server on the stub graphics and input platforms, for benchmarks that need no hardware
+class HeadlessServer : public mir_test_framework::AsyncServerRunner
+{
+public:
+    /// \param outputs  the display layout, one rectangle per output
+    explicit HeadlessServer(std::vector<mir::geometry::Rectangle> const& outputs);
+    ~HeadlessServer();
+
+    /// \return a new Wayland client connection to the server (which the caller must disconnect)
+    auto connect_wayland_client() -> wl_display*;
+
+    /// Adds a fake input device to the running server, once the seat has picked it up
+    auto add_input_device(mir::input::InputDeviceInfo const& info)
+        -> mir::UniqueModulePtr<mir_test_framework::FakeInputDevice>;
+};
+}
+
+#endif // MIR_BENCHMARK_HEADLESS_SERVER_H_
@@ -0,0 +1,290 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_client.h"
+
+#include "mir/anonymous_shm_file.h"
+
+#include <wayland-client.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace mb = mir_benchmark;
+namespace geom = mir::geometry;
+
+namespace
+{
+void shell_surface_ping(void*, wl_shell_surface* shell_surface, uint32_t serial)
+{
+    wl_shell_surface_pong(shell_surface, serial);
+}
+
+void shell_surface_configure(void*, wl_shell_surface*, uint32_t, int32_t, int32_t) {}
+void shell_surface_popup_done(void*, wl_shell_surface*) {}
+
+wl_shell_surface_listener const shell_surface_listener{
+    &shell_surface_ping,
+    &shell_surface_configure,
+    &shell_surface_popup_done};
+
+void pointer_enter(void*, wl_pointer*, uint32_t, wl_surface*, wl_fixed_t, wl_fixed_t) {}
+void pointer_leave(void*, wl_pointer*, uint32_t, wl_surface*) {}
+void pointer_button(void*, wl_pointer*, uint32_t, uint32_t, uint32_t, uint32_t) {}
+void pointer_axis(void*, wl_pointer*, uint32_t, uint32_t, wl_fixed_t) {}
+void pointer_frame(void*, wl_pointer*) {}
+void pointer_axis_source(void*, wl_pointer*, uint32_t) {}
+void pointer_axis_stop(void*, wl_pointer*, uint32_t, uint32_t) {}
+void pointer_axis_discrete(void*, wl_pointer*, uint32_t, int32_t) {}
+
+void keyboard_keymap(void*, wl_keyboard*, uint32_t, int32_t fd, uint32_t)
+{
+    close(fd);
+}
+
+void keyboard_enter(void*, wl_keyboard*, uint32_t, wl_surface*, wl_array*) {}
+void keyboard_leave(void*, wl_keyboard*, uint32_t, wl_surface*) {}
+void keyboard_modifiers(void*, wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) {}
+void keyboard_repeat_info(void*, wl_keyboard*, int32_t, int32_t) {}
+
+void touch_down(void*, wl_touch*, uint32_t, uint32_t, wl_surface*, int32_t, wl_fixed_t, wl_fixed_t) {}
+void touch_up(void*, wl_touch*, uint32_t, uint32_t, int32_t) {}
+void touch_motion(void*, wl_touch*, uint32_t, int32_t, wl_fixed_t, wl_fixed_t) {}
+void touch_cancel(void*, wl_touch*) {}
+#ifdef WL_TOUCH_SHAPE_SINCE_VERSION
+void touch_shape(void*, wl_touch*, int32_t, wl_fixed_t, wl_fixed_t) {}
+#endif
+#ifdef WL_TOUCH_ORIENTATION_SINCE_VERSION
+void touch_orientation(void*, wl_touch*, int32_t, wl_fixed_t) {}
+#endif
+}
+
+mb::InputClient::InputClient(wl_display* display, geom::Size size)
+    : size{size},
+      display{display}
+{
+    static wl_registry_listener const registry_listener{&registry_global, &registry_global_remove};
+
+    registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registry_listener, this);
+    wl_display_roundtrip(display);
+
+    if (!compositor || !shm || !shell || !seat)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Server lacks wl_compositor, wl_shm, wl_shell or wl_seat"}));
+    }
+
+    surface = wl_compositor_create_surface(compositor);
+    shell_surface = wl_shell_get_shell_surface(shell, surface);
+    wl_shell_surface_add_listener(shell_surface, &shell_surface_listener, this);
+    wl_shell_surface_set_toplevel(shell_surface);
+
+    auto const stride = size.width.as_int() * 4;
+    auto const buffer_size = stride * size.height.as_int();
+    shm_file = std::make_unique<mir::AnonymousShmFile>(buffer_size);
+    std::fill_n(static_cast<uint32_t*>(shm_file->base_ptr()), buffer_size / 4, 0xff808080);
+
+    auto const pool = wl_shm_create_pool(shm, shm_file->fd(), buffer_size);
+    buffer = wl_shm_pool_create_buffer(
+        pool, 0, size.width.as_int(), size.height.as_int(), stride, WL_SHM_FORMAT_XRGB8888);
+    wl_shm_pool_destroy(pool);
+
+    // Input is only delivered to surfaces that are showing something
+    wl_surface_attach(surface, buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width.as_int(), size.height.as_int());
+    wl_surface_commit(surface);
+
+    // Seat capabilities, and the enter events that follow mapping
+    wl_display_roundtrip(display);
+    wl_display_roundtrip(display);
+}
+
+mb::InputClient::~InputClient()
+{
+    if (thread.joinable())
+        stop();
+
+    if (touch)
+        wl_touch_destroy(touch);
+    if (keyboard)
+        wl_keyboard_destroy(keyboard);
+    if (pointer)
+        wl_pointer_destroy(pointer);
+    wl_buffer_destroy(buffer);
+    wl_shell_surface_destroy(shell_surface);
+    wl_surface_destroy(surface);
+    wl_seat_destroy(seat);
+    wl_shell_destroy(shell);
+    wl_shm_destroy(shm);
+    wl_compositor_destroy(compositor);
+    wl_registry_destroy(registry);
+    wl_display_roundtrip(display);
+    wl_display_disconnect(display);
+}
+
+void mb::InputClient::start()
+{
+    running = true;
+    thread = std::thread{[this] { run(); }};
+}
+
+void mb::InputClient::stop()
+{
+    running = false;
+    thread.join();
+}
+
+auto mb::InputClient::received() const -> uint64_t
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return receipts;
+}
+
+auto mb::InputClient::wait_for_more_than(uint64_t count, std::chrono::milliseconds timeout)
+    -> mir::optional_value<std::chrono::steady_clock::time_point>
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    if (!receipt.wait_for(lock, timeout, [&] { return receipts > count; }))
+        return {};
+
+    return last_receipt;
+}
+
+void mb::InputClient::run()
+{
+    while (running)
+    {
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+        wl_display_flush(display);
+
+        // Input arrives unprompted, so block in poll() rather than spin; the timeout only bounds stop()
+        pollfd fd{wl_display_get_fd(display), POLLIN, 0};
+        if (poll(&fd, 1, 10) > 0)
+            wl_display_read_events(display);
+        else
+            wl_display_cancel_read(display);
+
+        wl_display_dispatch_pending(display);
+    }
+}
+
+void mb::InputClient::record_receipt()
+{
+    auto const now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        ++receipts;
+        last_receipt = now;
+    }
+    receipt.notify_all();
+}
+
+void mb::InputClient::update_capabilities(uint32_t capabilities)
+{
+    static wl_pointer_listener const pointer_listener{
+        &pointer_enter, &pointer_leave, &pointer_motion, &pointer_button, &pointer_axis,
+        &pointer_frame, &pointer_axis_source, &pointer_axis_stop, &pointer_axis_discrete};
+    static wl_keyboard_listener const keyboard_listener{
+        &keyboard_keymap, &keyboard_enter, &keyboard_leave, &keyboard_key, &keyboard_modifiers, &keyboard_repeat_info};
+    static wl_touch_listener const touch_listener{
+        &touch_down, &touch_up, &touch_motion, &touch_frame, &touch_cancel,
+#ifdef WL_TOUCH_SHAPE_SINCE_VERSION
+        &touch_shape,
+#endif
+#ifdef WL_TOUCH_ORIENTATION_SINCE_VERSION
+        &touch_orientation,
+#endif
+    };
+
+    if ((capabilities & WL_SEAT_CAPABILITY_POINTER) && !pointer)
+    {
+        pointer = wl_seat_get_pointer(seat);
+        wl_pointer_add_listener(pointer, &pointer_listener, this);
+    }
+    if ((capabilities & WL_SEAT_CAPABILITY_KEYBOARD) && !keyboard)
+    {
+        keyboard = wl_seat_get_keyboard(seat);
+        wl_keyboard_add_listener(keyboard, &keyboard_listener, this);
+    }
+    if ((capabilities & WL_SEAT_CAPABILITY_TOUCH) && !touch)
+    {
+        touch = wl_seat_get_touch(seat);
+        wl_touch_add_listener(touch, &touch_listener, this);
+    }
+}
+
+void mb::InputClient::registry_global(
+    void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t version)
+{
+    auto const self = static_cast<InputClient*>(data);
+
+    if (strcmp(interface, wl_compositor_interface.name) == 0)
+    {
+        self->compositor = static_cast<wl_compositor*>(
+            wl_registry_bind(registry, id, &wl_compositor_interface, std::min(version, 4u)));
+    }
+    else if (strcmp(interface, wl_shm_interface.name) == 0)
+    {
+        self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+    }
+    else if (strcmp(interface, wl_shell_interface.name) == 0)
+    {
+        self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+    }
+    else if (strcmp(interface, wl_seat_interface.name) == 0 && !self->seat)
+    {
+        static wl_seat_listener const seat_listener{&seat_capabilities, &seat_name};
+
+        // Before version 5 wl_pointer.frame doesn't exist, so each motion is a whole event
+        self->seat = static_cast<wl_seat*>(wl_registry_bind(registry, id, &wl_seat_interface, std::min(version, 4u)));
+        wl_seat_add_listener(self->seat, &seat_listener, self);
+    }
+}
+
+void mb::InputClient::registry_global_remove(void*, wl_registry*, uint32_t)
+{
+}
+
+void mb::InputClient::seat_capabilities(void* data, wl_seat*, uint32_t capabilities)
+{
+    static_cast<InputClient*>(data)->update_capabilities(capabilities);
+}
+
+void mb::InputClient::seat_name(void*, wl_seat*, char const*)
+{
+}
+
+void mb::InputClient::pointer_motion(void* data, wl_pointer*, uint32_t, int32_t, int32_t)
+{
+    static_cast<InputClient*>(data)->record_receipt();
+}
+
+void mb::InputClient::keyboard_key(void* data, wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t)
+{
+    static_cast<InputClient*>(data)->record_receipt();
+}
+
+void mb::InputClient::touch_frame(void* data, wl_touch*)
+{
+    static_cast<InputClient*>(data)->record_receipt();
+}
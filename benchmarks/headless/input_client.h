@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_INPUT_CLIENT_H_
+#define MIR_BENCHMARK_INPUT_CLIENT_H_
+
+#include "mir/geometry/size.h"
+#include "mir/optional_value.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct wl_display;
+struct wl_registry;
+struct wl_compositor;
+struct wl_shm;
+struct wl_shell;
+struct wl_seat;
+struct wl_pointer;
+struct wl_keyboard;
+struct wl_touch;
+struct wl_surface;
+struct wl_shell_surface;
+struct wl_buffer;
+
+namespace mir
+{
+class ShmFile;
+}
+
+namespace mir_benchmark
+{
+/// A client that maps one opaque toplevel and notes when each input event reaches it
+class InputClient
+{
+public:
+    /// Takes ownership of \p display
+    InputClient(wl_display* display, mir::geometry::Size size);
+    ~InputClient();
+
+    void start();
+    void stop();
+
+    /// The number of wl_keyboard.key, wl_pointer.motion and wl_touch.frame events received so far
+    auto received() const -> uint64_t;
+
+    /// Waits for received() to exceed \p count
+    /// \return when the last event was received, or nothing on timeout
+    auto wait_for_more_than(uint64_t count, std::chrono::milliseconds timeout)
+        -> mir::optional_value<std::chrono::steady_clock::time_point>;
+
+private:
+    void run();
+    void update_capabilities(uint32_t capabilities);
+    void record_receipt();
+
+    static void registry_global(
+        void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t version);
+    static void registry_global_remove(void* data, wl_registry* registry, uint32_t id);
+    static void seat_capabilities(void* data, wl_seat* seat, uint32_t capabilities);
+    static void seat_name(void* data, wl_seat* seat, char const* name);
+    static void pointer_motion(void* data, wl_pointer* pointer, uint32_t time, int32_t x, int32_t y);
+    static void keyboard_key(void* data, wl_keyboard* keyboard, uint32_t serial, uint32_t time, uint32_t key, uint32_t state);
+    static void touch_frame(void* data, wl_touch* touch);
+
+    mir::geometry::Size const size;
+
+    wl_display* const display;
+    wl_registry* registry{nullptr};
+    wl_compositor* compositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+    wl_seat* seat{nullptr};
+    wl_pointer* pointer{nullptr};
+    wl_keyboard* keyboard{nullptr};
+    wl_touch* touch{nullptr};
+    wl_surface* surface{nullptr};
+    wl_shell_surface* shell_surface{nullptr};
+    wl_buffer* buffer{nullptr};
+
+    std::unique_ptr<mir::ShmFile> shm_file;
+
+    std::mutex mutable mutex;
+    std::condition_variable receipt;
+    uint64_t receipts{0};
+    std::chrono::steady_clock::time_point last_receipt;
+
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+}
+
+#endif // MIR_BENCHMARK_INPUT_CLIENT_H_
@@ -0,0 +1,465 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headless_server.h"
+#include "input_client.h"
+#include "synthetic_client.h"
+#include "statistics.h"
+
+#include "mir_test_framework/fake_input_device.h"
+#include "mir/test/event_factory.h"
+#include "mir/input/composite_event_filter.h"
+#include "mir/input/event_filter.h"
+#include "mir/input/input_device_info.h"
+#include "mir/input/seat_observer.h"
+#include "mir/observer_registrar.h"
+#include "mir/executor.h"
+#include "mir/server.h"
+#include "mir_toolkit/events/event.h"
+
+#include <wayland-server-core.h>
+
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/input.h>
+
+namespace mb = mir_benchmark;
+namespace mi = mir::input;
+namespace mis = mir::input::synthesis;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace std::chrono;
+
+namespace
+{
+auto now_ns() -> int64_t
+{
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/// When the event in flight reached each stage inside the server, in ns on the steady clock
+struct StageTimes
+{
+    std::atomic<int64_t> device{0};
+    std::atomic<int64_t> seat{0};
+    std::atomic<int64_t> dispatcher{0};
+    std::atomic<int64_t> sent{0};
+
+    void reset()
+    {
+        device = 0;
+        seat = 0;
+        dispatcher = 0;
+        sent = 0;
+    }
+
+    /// Only the first event of a sample counts (a touch frame, say, is several Wayland events)
+    static void stamp(std::atomic<int64_t>& stage, int64_t time)
+    {
+        int64_t unset{0};
+        stage.compare_exchange_strong(unset, time);
+    }
+};
+
+/// Notes input events as the seat finishes with them, which is on the input reader thread
+class SeatStage : public mi::SeatObserver
+{
+public:
+    explicit SeatStage(std::shared_ptr<StageTimes> const& times) : times{times} {}
+
+    void seat_dispatch_event(std::shared_ptr<MirEvent const> const& event) override
+    {
+        if (mir_event_get_type(event.get()) != mir_event_type_input)
+            return;
+
+        auto const time = now_ns();
+        StageTimes::stamp(times->device, mir_input_event_get_event_time(mir_event_get_input_event(event.get())));
+        StageTimes::stamp(times->seat, time);
+    }
+
+    void seat_add_device(uint64_t) override {}
+    void seat_remove_device(uint64_t) override {}
+    void seat_set_key_state(uint64_t, std::vector<uint32_t> const&) override {}
+    void seat_set_pointer_state(uint64_t, unsigned) override {}
+    void seat_set_cursor_position(float, float) override {}
+    void seat_set_confinement_region_called(geom::Rectangles const&) override {}
+    void seat_reset_confinement_regions() override {}
+
+private:
+    std::shared_ptr<StageTimes> const times;
+};
+
+/// Notes input events as they reach the event filters, on the input delivery thread
+class DispatcherStage : public mi::EventFilter
+{
+public:
+    explicit DispatcherStage(std::shared_ptr<StageTimes> const& times) : times{times} {}
+
+    bool handle(MirEvent const& event) override
+    {
+        if (mir_event_get_type(&event) == mir_event_type_input)
+            StageTimes::stamp(times->dispatcher, now_ns());
+        return false;
+    }
+
+private:
+    std::shared_ptr<StageTimes> const times;
+};
+
+/// Notes the Wayland events the client counts as they are written, on the Wayland thread
+void log_sent_event(void* data, wl_protocol_logger_type type, wl_protocol_logger_message const* message)
+{
+    if (type != WL_PROTOCOL_LOGGER_EVENT)
+        return;
+
+    auto const interface = wl_resource_get_class(message->resource);
+    auto const name = message->message->name;
+
+    if ((strcmp(interface, "wl_pointer") == 0 && strcmp(name, "motion") == 0) ||
+        (strcmp(interface, "wl_keyboard") == 0 && strcmp(name, "key") == 0) ||
+        (strcmp(interface, "wl_touch") == 0 && strcmp(name, "frame") == 0))
+    {
+        StageTimes::stamp(static_cast<StageTimes*>(data)->sent, now_ns());
+    }
+}
+
+/// Runs observer callbacks on the notifying thread, so timestamps are taken where the event is
+struct ImmediateExecutor : mir::Executor
+{
+    void spawn(std::function<void()>&& work) override { work(); }
+};
+
+char const* const stage_names[] = {
+    "emit_to_device",       // The fake device's queue, standing in for the kernel
+    "device_to_seat",
+    "seat_to_dispatcher",   // The hand-off to the input delivery thread
+    "dispatcher_to_send",   // Window management, surface dispatch and the Wayland thread
+    "send_to_receive",      // The socket and the client's event loop
+    "total"};
+
+auto const stage_count = sizeof stage_names / sizeof stage_names[0];
+
+struct EventResults
+{
+    std::string kind;
+    unsigned lost{0};
+    std::vector<nanoseconds> stages[stage_count];
+};
+
+struct Parameters
+{
+    unsigned samples;
+    unsigned warmup;
+    double rate;
+    int touch_contacts;
+    geom::Size output_size;
+};
+
+/// Emits one sample's event of the given kind, alternating so that state never drifts
+auto emitter_for(std::string const& kind, mtf::FakeInputDevice& device, Parameters const& parameters)
+    -> std::function<void(unsigned sample)>
+{
+    if (kind == "key")
+    {
+        return [&device](unsigned sample)
+            {
+                device.emit_event(
+                    (sample % 2 ? mis::a_key_up_event() : mis::a_key_down_event()).of_scancode(KEY_A));
+            };
+    }
+
+    if (kind == "pointer")
+    {
+        return [&device](unsigned sample)
+            {
+                device.emit_event(mis::a_pointer_event().with_movement(sample % 2 ? -1 : 1, 0));
+            };
+    }
+
+    if (kind == "touch")
+    {
+        geom::Point const centre{
+            parameters.output_size.width.as_int() / 2,
+            parameters.output_size.height.as_int() / 2};
+        auto const contacts = parameters.touch_contacts;
+
+        return [&device, centre, contacts](unsigned sample)
+            {
+                auto const dy = geom::DeltaY{sample % 2};
+                auto event = mis::a_touch_event()
+                    .with_action(sample ? mis::TouchParameters::Action::Move : mis::TouchParameters::Action::Tap)
+                    .at_position(centre + dy);
+
+                for (int i = 1; i < contacts; ++i)
+                    event.with_additional_contact(centre + geom::DeltaX{50 * i} + dy);
+
+                device.emit_event(event);
+            };
+    }
+
+    BOOST_THROW_EXCEPTION((std::invalid_argument{"Unknown event kind: " + kind}));
+}
+
+auto device_info_for(std::string const& kind) -> mi::InputDeviceInfo
+{
+    if (kind == "key")
+        return {"latency-keyboard", "latency-keyboard-uid", mi::DeviceCapability::keyboard};
+    if (kind == "pointer")
+        return {"latency-pointer", "latency-pointer-uid", mi::DeviceCapability::pointer};
+    return {"latency-touch", "latency-touch-uid", mi::DeviceCapability::touchscreen | mi::DeviceCapability::multitouch};
+}
+
+auto measure(
+    std::string const& kind,
+    mb::HeadlessServer& server,
+    StageTimes& times,
+    Parameters const& parameters) -> EventResults
+{
+    EventResults results;
+    results.kind = kind;
+
+    auto const device = server.add_input_device(device_info_for(kind));
+
+    // Connected after the device, so the client is the top, focused surface and sees the capability up front
+    mb::InputClient client{server.connect_wayland_client(), parameters.output_size};
+    client.start();
+
+    auto const emit = emitter_for(kind, *device, parameters);
+    auto const period = duration_cast<steady_clock::duration>(duration<double>{1.0 / parameters.rate});
+    auto next = steady_clock::now();
+
+    for (unsigned sample = 0; sample != parameters.warmup + parameters.samples; ++sample)
+    {
+        times.reset();
+        auto const before = client.received();
+        auto const emitted = now_ns();
+
+        emit(sample);
+
+        auto const received = client.wait_for_more_than(before, seconds{1});
+        auto const device_time = times.device.load();
+        auto const dispatcher = times.dispatcher.load();
+        // The seat notifies observers after handing the event on, so delivery may already have begun
+        auto const seat = std::min(times.seat.load(), dispatcher);
+        auto const sent = times.sent.load();
+
+        if (!received.is_set() || !device_time || !seat || !sent)
+        {
+            // Either the event never arrived, or it wasn't the one the server stages saw
+            ++results.lost;
+        }
+        else if (sample >= parameters.warmup)
+        {
+            auto const receipt = duration_cast<nanoseconds>(received.value().time_since_epoch()).count();
+
+            int64_t const stamps[] = {emitted, device_time, seat, dispatcher, sent, receipt};
+            for (size_t stage = 0; stage != stage_count - 1; ++stage)
+                results.stages[stage].push_back(nanoseconds{stamps[stage + 1] - stamps[stage]});
+            results.stages[stage_count - 1].push_back(nanoseconds{receipt - emitted});
+        }
+
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    if (kind == "touch")
+    {
+        auto const before = client.received();
+        device->emit_event(mis::a_touch_event().with_action(mis::TouchParameters::Action::Release));
+        client.wait_for_more_than(before, seconds{1});
+    }
+
+    client.stop();
+    return results;
+}
+
+auto parse_size(std::string const& text) -> geom::Size
+{
+    auto const x = text.find('x');
+    if (x == std::string::npos)
+        throw std::invalid_argument{"Expected a size as <width>x<height>, got: " + text};
+    return geom::Size{std::stoi(text.substr(0, x)), std::stoi(text.substr(x + 1))};
+}
+
+auto split(std::string const& list) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    std::istringstream in{list};
+    for (std::string item; std::getline(in, item, ',');)
+        result.push_back(item);
+    return result;
+}
+
+void usage(char const* name)
+{
+    std::cerr
+        << "Usage: " << name << " [options]\n"
+        << "Measures the latency of fake input device events through an in-process Mir server to a\n"
+        << "Wayland client, stage by stage, and writes the results as JSON.\n\n"
+        << "  --events <kinds>              comma separated from key, pointer, touch [default: key,pointer,touch]\n"
+        << "  --samples <n>                 events measured per kind [default: 1000]\n"
+        << "  --warmup <n>                  events discarded first per kind [default: 50]\n"
+        << "  --rate <hz>                   events per second [default: 200]\n"
+        << "  --touch-contacts <n>          fingers in each touch event [default: 2]\n"
+        << "  --output-size <w>x<h>         size of the (single) output [default: 1920x1080]\n"
+        << "  --load-clients <n>            synthetic clients committing frames meanwhile [default: 0]\n"
+        << "  --load-size <w>x<h>           their buffer size [default: 640x480]\n"
+        << "  --load-rate <hz>              their commit rate, 0 to follow frame callbacks [default: 0]\n"
+        << "  --load-damage full|band|none  what they redraw per commit [default: full]\n"
+        << "  --output <file>               where to write the results [default: stdout]\n";
+}
+}
+
+int main(int argc, char* argv[])
+try
+{
+    std::map<std::string, std::string> options{
+        {"--events", "key,pointer,touch"},
+        {"--samples", "1000"},
+        {"--warmup", "50"},
+        {"--rate", "200"},
+        {"--touch-contacts", "2"},
+        {"--output-size", "1920x1080"},
+        {"--load-clients", "0"},
+        {"--load-size", "640x480"},
+        {"--load-rate", "0"},
+        {"--load-damage", "full"},
+        {"--output", ""}};
+
+    for (int i = 1; i != argc; ++i)
+    {
+        auto const option = options.find(argv[i]);
+        if (option == options.end() || i + 1 == argc)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        option->second = argv[++i];
+    }
+
+    auto const kinds = split(options["--events"]);
+    Parameters const parameters{
+        static_cast<unsigned>(std::stoul(options["--samples"])),
+        static_cast<unsigned>(std::stoul(options["--warmup"])),
+        std::stod(options["--rate"]),
+        std::max(1, std::stoi(options["--touch-contacts"])),
+        parse_size(options["--output-size"])};
+    auto const load_client_count = std::stoi(options["--load-clients"]);
+    mb::ClientParameters const load_parameters{
+        parse_size(options["--load-size"]),
+        std::stod(options["--load-rate"]),
+        mb::damage_pattern_from(options["--load-damage"])};
+
+    mb::HeadlessServer server{{geom::Rectangle{{0, 0}, parameters.output_size}}};
+    server.start_server();
+
+    auto const times = std::make_shared<StageTimes>();
+    ImmediateExecutor immediate;
+    auto const seat_stage = std::make_shared<SeatStage>(times);
+    auto const dispatcher_stage = std::make_shared<DispatcherStage>(times);
+    server.server.the_seat_observer_registrar()->register_interest(seat_stage, immediate);
+    server.server.the_composite_event_filter()->prepend(dispatcher_stage);
+
+    std::promise<wl_protocol_logger*> logger_added;
+    server.server.run_on_wayland_display([&](wl_display* display)
+        {
+            logger_added.set_value(wl_display_add_protocol_logger(display, &log_sent_event, times.get()));
+        });
+    auto const logger = logger_added.get_future().get();
+
+    std::vector<std::unique_ptr<mb::SyntheticClient>> load;
+    for (int i = 0; i != load_client_count; ++i)
+        load.push_back(std::make_unique<mb::SyntheticClient>(server.connect_wayland_client(), load_parameters));
+    for (auto const& client : load)
+        client->start();
+
+    std::vector<EventResults> results;
+    for (auto const& kind : kinds)
+        results.push_back(measure(kind, server, *times, parameters));
+
+    for (auto const& client : load)
+        client->stop();
+    load.clear();
+
+    std::promise<void> logger_removed;
+    server.server.run_on_wayland_display([&](wl_display*)
+        {
+            wl_protocol_logger_destroy(logger);
+            logger_removed.set_value();
+        });
+    logger_removed.get_future().wait();
+
+    server.server.the_seat_observer_registrar()->unregister_interest(*seat_stage);
+    server.stop_server();
+
+    std::ofstream file;
+    if (!options["--output"].empty())
+        file.open(options["--output"]);
+    std::ostream& out = file.is_open() ? file : std::cout;
+
+    out << "{\n"
+        << "  \"parameters\": {"
+        << "\"samples\": " << parameters.samples
+        << ", \"rate\": " << parameters.rate
+        << ", \"touch_contacts\": " << parameters.touch_contacts
+        << ", \"load_clients\": " << load_client_count
+        << ", \"load_width\": " << load_parameters.size.width.as_int()
+        << ", \"load_height\": " << load_parameters.size.height.as_int()
+        << ", \"load_rate\": " << load_parameters.commit_rate
+        << ", \"load_damage\": \"" << mb::to_string(load_parameters.damage) << "\""
+        << "},\n";
+
+    for (size_t i = 0; i != results.size(); ++i)
+    {
+        auto const& result = results[i];
+        out << "  \"" << result.kind << "\": {\n"
+            << "    \"lost\": " << result.lost << ",\n";
+
+        for (size_t stage = 0; stage != stage_count; ++stage)
+        {
+            auto const samples = mb::to_microseconds(result.stages[stage]);
+            out << "    \"" << stage_names[stage] << "_us\": {\"summary\": ";
+            mb::write_json(out, mb::summarise(samples));
+            out << ", \"histogram\": ";
+            mb::write_json(out, mb::histogram(samples));
+            out << "}" << (stage + 1 != stage_count ? "," : "") << "\n";
+        }
+
+        out << "  }" << (i + 1 != results.size() ? "," : "") << "\n";
+    }
+    out << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << boost::diagnostic_information(error) << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "statistics.h"
+
+#include <algorithm>
+#include <numeric>
+#include <ostream>
+
+namespace mb = mir_benchmark;
+
+namespace
+{
+auto percentile(std::vector<double> const& sorted, double fraction) -> double
+{
+    auto const index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+}
+
+auto mb::summarise(std::vector<double> samples) -> Summary
+{
+    if (samples.empty())
+        return Summary{0, 0, 0, 0, 0, 0, 0};
+
+    std::sort(samples.begin(), samples.end());
+
+    return Summary{
+        samples.size(),
+        std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size(),
+        samples.front(),
+        percentile(samples, 0.5),
+        percentile(samples, 0.95),
+        percentile(samples, 0.99),
+        samples.back()};
+}
+
+auto mb::histogram(std::vector<double> const& samples) -> Histogram
+{
+    Histogram result;
+    if (samples.empty())
+        return result;
+
+    auto const largest = *std::max_element(samples.begin(), samples.end());
+
+    result.upper_bounds.push_back(1);
+    while (result.upper_bounds.back() <= largest)
+        result.upper_bounds.push_back(result.upper_bounds.back() * 2);
+    result.counts.resize(result.upper_bounds.size());
+
+    for (auto const sample : samples)
+    {
+        auto const bucket = std::upper_bound(result.upper_bounds.begin(), result.upper_bounds.end(), sample);
+        ++result.counts[bucket - result.upper_bounds.begin()];
+    }
+
+    return result;
+}
+
+auto mb::to_microseconds(std::vector<std::chrono::nanoseconds> const& durations) -> std::vector<double>
+{
+    std::vector<double> result;
+    result.reserve(durations.size());
+    for (auto const& duration : durations)
+        result.push_back(std::chrono::duration<double, std::micro>{duration}.count());
+    return result;
+}
+
+void mb::write_json(std::ostream& out, Summary const& summary)
+{
+    out << "{\"count\": " << summary.count
+        << ", \"mean\": " << summary.mean
+        << ", \"min\": " << summary.min
+        << ", \"median\": " << summary.median
+        << ", \"p95\": " << summary.p95
+        << ", \"p99\": " << summary.p99
+        << ", \"max\": " << summary.max
+        << "}";
+}
+
+void mb::write_json(std::ostream& out, Histogram const& histogram)
+{
+    out << "[";
+    for (size_t i = 0; i != histogram.counts.size(); ++i)
+    {
+        out << (i ? ", " : "")
+            << "{\"lt\": " << histogram.upper_bounds[i]
+            << ", \"count\": " << histogram.counts[i] << "}";
+    }
+    out << "]";
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_STATISTICS_H_
+#define MIR_BENCHMARK_STATISTICS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+namespace mir_benchmark
+{
+/// Order statistics of a set of samples
+struct Summary
+{
+    size_t count;
+    double mean;
+    double min;
+    double median;
+    double p95;
+    double p99;
+    double max;
+};
+
+auto summarise(std::vector<double> samples) -> Summary;
+
+/// Sample counts in power-of-two buckets: [0, 1), [1, 2), [2, 4)... up to the one holding the largest sample
+struct Histogram
+{
+    std::vector<double> upper_bounds;
+    std::vector<size_t> counts;
+};
+
+auto histogram(std::vector<double> const& samples) -> Histogram;
+
+/// Converts durations to samples in microseconds
+auto to_microseconds(std::vector<std::chrono::nanoseconds> const& durations) -> std::vector<double>;
+
+/// Writes \p summary as a JSON object
+void write_json(std::ostream& out, Summary const& summary);
+
+/// Writes \p histogram as a JSON array of {"lt": <upper bound>, "count": <n>} objects
+void write_json(std::ostream& out, Histogram const& histogram);
+}
+
+#endif // MIR_BENCHMARK_STATISTICS_H_
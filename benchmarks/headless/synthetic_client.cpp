@@ -0,0 +1,367 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synthetic_client.h"
+
+#include "mir/anonymous_shm_file.h"
+
+#include <wayland-client.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+
+namespace mb = mir_benchmark;
+
+namespace
+{
+// Enough to always have one free while one is on screen and one is queued
+int const buffer_count = 3;
+
+auto to_nanoseconds(timespec const& time) -> std::chrono::nanoseconds
+{
+    return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+}
+
+void shell_surface_ping(void*, wl_shell_surface* shell_surface, uint32_t serial)
+{
+    wl_shell_surface_pong(shell_surface, serial);
+}
+
+void shell_surface_configure(void*, wl_shell_surface*, uint32_t, int32_t, int32_t)
+{
+}
+
+void shell_surface_popup_done(void*, wl_shell_surface*)
+{
+}
+
+wl_shell_surface_listener const shell_surface_listener{
+    &shell_surface_ping,
+    &shell_surface_configure,
+    &shell_surface_popup_done};
+}
+
+struct mb::SyntheticClient::Buffer
+{
+    SyntheticClient* client;
+    wl_buffer* buffer;
+    uint32_t* pixels;
+    bool busy;
+};
+
+struct mb::SyntheticClient::PendingFrame
+{
+    SyntheticClient* client;
+    std::chrono::steady_clock::time_point committed;
+};
+
+auto mb::damage_pattern_from(std::string const& name) -> DamagePattern
+{
+    if (name == "full")
+        return DamagePattern::full;
+    if (name == "band")
+        return DamagePattern::band;
+    if (name == "none")
+        return DamagePattern::none;
+
+    BOOST_THROW_EXCEPTION((std::invalid_argument{"Unknown damage pattern: " + name}));
+}
+
+auto mb::to_string(DamagePattern pattern) -> char const*
+{
+    switch (pattern)
+    {
+    case DamagePattern::full: return "full";
+    case DamagePattern::band: return "band";
+    case DamagePattern::none: return "none";
+    }
+    return "unknown";
+}
+
+mb::SyntheticClient::SyntheticClient(wl_display* display, ClientParameters const& parameters)
+    : parameters{parameters},
+      stride{parameters.size.width.as_int() * 4},
+      band_height{std::max(1, parameters.size.height.as_int() / 10)},
+      display{display}
+{
+    static wl_registry_listener const registry_listener{&registry_global, &registry_global_remove};
+
+    registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registry_listener, this);
+    wl_display_roundtrip(display);
+
+    if (!compositor || !shm || !shell)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Server lacks wl_compositor, wl_shm or wl_shell"}));
+    }
+
+    surface = wl_compositor_create_surface(compositor);
+    shell_surface = wl_shell_get_shell_surface(shell, surface);
+    wl_shell_surface_add_listener(shell_surface, &shell_surface_listener, this);
+    wl_shell_surface_set_toplevel(shell_surface);
+
+    auto const buffer_size = stride * parameters.size.height.as_int();
+    shm_file = std::make_unique<mir::AnonymousShmFile>(buffer_size * buffer_count);
+
+    static wl_buffer_listener const buffer_listener{&buffer_release};
+
+    auto const pool = wl_shm_create_pool(shm, shm_file->fd(), buffer_size * buffer_count);
+    buffers.reserve(buffer_count);
+    for (int i = 0; i != buffer_count; ++i)
+    {
+        auto const base = static_cast<char*>(shm_file->base_ptr()) + i * buffer_size;
+        buffers.push_back(Buffer{
+            this,
+            wl_shm_pool_create_buffer(
+                pool,
+                i * buffer_size,
+                parameters.size.width.as_int(),
+                parameters.size.height.as_int(),
+                stride,
+                WL_SHM_FORMAT_ARGB8888),
+            reinterpret_cast<uint32_t*>(base),
+            false});
+        wl_buffer_add_listener(buffers.back().buffer, &buffer_listener, &buffers.back());
+        std::fill_n(buffers.back().pixels, buffer_size / 4, 0xff000000);
+    }
+    wl_shm_pool_destroy(pool);
+
+    wl_display_roundtrip(display);
+}
+
+mb::SyntheticClient::~SyntheticClient()
+{
+    if (thread.joinable())
+        stop();
+
+    for (auto const& buffer : buffers)
+        wl_buffer_destroy(buffer.buffer);
+    wl_shell_surface_destroy(shell_surface);
+    wl_surface_destroy(surface);
+    wl_shell_destroy(shell);
+    wl_shm_destroy(shm);
+    wl_compositor_destroy(compositor);
+    wl_registry_destroy(registry);
+    wl_display_roundtrip(display);
+    wl_display_disconnect(display);
+}
+
+void mb::SyntheticClient::start()
+{
+    running = true;
+    thread = std::thread{[this] { run(); }};
+}
+
+void mb::SyntheticClient::reset()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    results = ClientResults{};
+    cpu_at_reset = thread_cpu_time();
+}
+
+auto mb::SyntheticClient::stop() -> ClientResults
+{
+    running = false;
+    thread.join();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    return results;
+}
+
+void mb::SyntheticClient::run()
+{
+    using namespace std::chrono;
+
+    auto const period = parameters.commit_rate > 0 ?
+        duration_cast<steady_clock::duration>(duration<double>{1.0 / parameters.commit_rate}) :
+        steady_clock::duration::zero();
+    auto next_commit = steady_clock::now();
+
+    while (running)
+    {
+        auto const now = steady_clock::now();
+
+        if (period == steady_clock::duration::zero())
+        {
+            if (!awaiting_frame)
+                commit();
+        }
+        else if (now >= next_commit)
+        {
+            commit();
+
+            next_commit += period;
+            // Don't try to catch up on commits that are already lost
+            if (next_commit < now)
+                next_commit = now + period;
+        }
+
+        auto const timeout = period == steady_clock::duration::zero() ?
+            milliseconds{10} :
+            std::min<milliseconds>(milliseconds{10}, ceil<milliseconds>(next_commit - steady_clock::now()));
+
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+        wl_display_flush(display);
+
+        pollfd fd{wl_display_get_fd(display), POLLIN, 0};
+        if (poll(&fd, 1, std::max(0, static_cast<int>(timeout.count()))) > 0)
+            wl_display_read_events(display);
+        else
+            wl_display_cancel_read(display);
+
+        wl_display_dispatch_pending(display);
+    }
+
+    timespec cpu;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    results.cpu_time = to_nanoseconds(cpu) - cpu_at_reset;
+}
+
+void mb::SyntheticClient::commit()
+{
+    auto const buffer = std::find_if(buffers.begin(), buffers.end(), [](Buffer const& b) { return !b.busy; });
+    if (buffer == buffers.end())
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        ++results.skipped;
+        return;
+    }
+
+    paint(*buffer);
+    buffer->busy = true;
+
+    wl_surface_attach(surface, buffer->buffer, 0, 0);
+
+    auto const width = parameters.size.width.as_int();
+    auto const height = parameters.size.height.as_int();
+    switch (parameters.damage)
+    {
+    case DamagePattern::full:
+        wl_surface_damage(surface, 0, 0, width, height);
+        break;
+
+    case DamagePattern::band:
+        wl_surface_damage(surface, 0, (frame_number * band_height) % height, width, band_height);
+        break;
+
+    case DamagePattern::none:
+        break;
+    }
+
+    static wl_callback_listener const frame_listener{&frame_done};
+    wl_callback_add_listener(
+        wl_surface_frame(surface),
+        &frame_listener,
+        new PendingFrame{this, std::chrono::steady_clock::now()});
+
+    wl_surface_commit(surface);
+
+    ++frame_number;
+    awaiting_frame = true;
+
+    std::lock_guard<std::mutex> lock{mutex};
+    ++results.commits;
+}
+
+void mb::SyntheticClient::paint(Buffer& buffer)
+{
+    uint32_t const colour = 0xff000000 | (frame_number * 0x010203 & 0x00ffffff);
+    auto const width = parameters.size.width.as_int();
+    auto const height = parameters.size.height.as_int();
+
+    switch (parameters.damage)
+    {
+    case DamagePattern::full:
+        std::fill_n(buffer.pixels, width * height, colour);
+        break;
+
+    case DamagePattern::band:
+    {
+        auto const top = (frame_number * band_height) % height;
+        auto const rows = std::min(band_height, static_cast<int>(height - top));
+        std::fill_n(buffer.pixels + top * width, rows * width, colour);
+        break;
+    }
+
+    case DamagePattern::none:
+        break;
+    }
+}
+
+auto mb::SyntheticClient::thread_cpu_time() const -> std::chrono::nanoseconds
+{
+    clockid_t clock;
+    timespec cpu;
+    if (!thread.joinable() ||
+        pthread_getcpuclockid(const_cast<std::thread&>(thread).native_handle(), &clock) != 0 ||
+        clock_gettime(clock, &cpu) != 0)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    return to_nanoseconds(cpu);
+}
+
+void mb::SyntheticClient::registry_global(
+    void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t version)
+{
+    auto const self = static_cast<SyntheticClient*>(data);
+
+    if (strcmp(interface, wl_compositor_interface.name) == 0)
+    {
+        self->compositor = static_cast<wl_compositor*>(
+            wl_registry_bind(registry, id, &wl_compositor_interface, std::min(version, 4u)));
+    }
+    else if (strcmp(interface, wl_shm_interface.name) == 0)
+    {
+        self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+    }
+    else if (strcmp(interface, wl_shell_interface.name) == 0)
+    {
+        self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+    }
+}
+
+void mb::SyntheticClient::registry_global_remove(void*, wl_registry*, uint32_t)
+{
+}
+
+void mb::SyntheticClient::buffer_release(void* data, wl_buffer*)
+{
+    static_cast<Buffer*>(data)->busy = false;
+}
+
+void mb::SyntheticClient::frame_done(void* data, wl_callback* callback, uint32_t)
+{
+    std::unique_ptr<PendingFrame> const frame{static_cast<PendingFrame*>(data)};
+    wl_callback_destroy(callback);
+
+    auto const latency = std::chrono::steady_clock::now() - frame->committed;
+    frame->client->awaiting_frame = false;
+
+    std::lock_guard<std::mutex> lock{frame->client->mutex};
+    ++frame->client->results.frames;
+    frame->client->results.commit_to_consume.push_back(latency);
+}
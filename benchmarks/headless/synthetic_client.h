@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_SYNTHETIC_CLIENT_H_
+#define MIR_BENCHMARK_SYNTHETIC_CLIENT_H_
+
+#include "mir/geometry/size.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct wl_display;
+struct wl_registry;
+struct wl_compositor;
+struct wl_shm;
+struct wl_shell;
+struct wl_surface;
+struct wl_shell_surface;
+struct wl_buffer;
+struct wl_callback;
+
+namespace mir
+{
+class ShmFile;
+}
+
+namespace mir_benchmark
+{
+/// Which part of the buffer a client redraws (and damages) for each commit
+enum class DamagePattern
+{
+    full,   ///< The whole buffer
+    band,   ///< A horizontal band a tenth of the height, moving down each frame
+    none    ///< Nothing: the same content is committed again
+};
+
+auto damage_pattern_from(std::string const& name) -> DamagePattern;
+auto to_string(DamagePattern pattern) -> char const*;
+
+struct ClientParameters
+{
+    mir::geometry::Size size;
+    /// Commits per second, or 0 to commit as soon as the previous frame callback arrives
+    double commit_rate;
+    DamagePattern damage;
+};
+
+struct ClientResults
+{
+    unsigned commits;
+    unsigned frames;
+    /// Commits due at the requested rate that found no buffer free
+    unsigned skipped;
+    /// From wl_surface.commit to the frame callback, which Mir sends when the compositor consumes the buffer
+    std::vector<std::chrono::nanoseconds> commit_to_consume;
+    std::chrono::nanoseconds cpu_time;
+};
+
+/// A wl_shm client that maps a toplevel and commits synthetic frames on its own thread
+class SyntheticClient
+{
+public:
+    /// Takes ownership of \p display
+    SyntheticClient(wl_display* display, ClientParameters const& parameters);
+    ~SyntheticClient();
+
+    void start();
+    /// Discard results gathered so far (for instance, during warm-up)
+    void reset();
+    auto stop() -> ClientResults;
+
+private:
+    struct Buffer;
+    struct PendingFrame;
+
+    void run();
+    void commit();
+    void paint(Buffer& buffer);
+    auto thread_cpu_time() const -> std::chrono::nanoseconds;
+
+    static void registry_global(
+        void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t version);
+    static void registry_global_remove(void* data, wl_registry* registry, uint32_t id);
+    static void buffer_release(void* data, wl_buffer* buffer);
+    static void frame_done(void* data, wl_callback* callback, uint32_t time);
+
+    ClientParameters const parameters;
+    int const stride;
+    int const band_height;
+
+    wl_display* const display;
+    wl_registry* registry{nullptr};
+    wl_compositor* compositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+    wl_surface* surface{nullptr};
+    wl_shell_surface* shell_surface{nullptr};
+
+    std::unique_ptr<mir::ShmFile> shm_file;
+    std::vector<Buffer> buffers;
+
+    // Only accessed on the client thread
+    unsigned frame_number{0};
+    bool awaiting_frame{false};
+
+    std::mutex mutable mutex;
+    ClientResults results{};
+    std::chrono::nanoseconds cpu_at_reset{0};
+
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+}
+
+#endif // MIR_BENCHMARK_SYNTHETIC_CLIENT_H_
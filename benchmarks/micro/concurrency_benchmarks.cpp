@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "mir/thread_safe_list.h"
+#include "mir/recursive_read_write_mutex.h"
+#include "src/server/frontend_wayland/wayland_executor.h"
+
+#include <wayland-server-core.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace mb = mir_benchmark;
+namespace mf = mir::frontend;
+
+namespace
+{
+struct Observer
+{
+    std::atomic<uint64_t> calls{0};
+};
+
+auto list_of(unsigned elements) -> std::shared_ptr<mir::ThreadSafeList<std::shared_ptr<Observer>>>
+{
+    auto const list = std::make_shared<mir::ThreadSafeList<std::shared_ptr<Observer>>>();
+    for (unsigned i = 0; i != elements; ++i)
+        list->add(std::make_shared<Observer>());
+    return list;
+}
+
+mb::Registration const for_each{{
+    "ThreadSafeList::for_each",
+    "elements",
+    {1, 10, 100, 1000},
+    [](unsigned elements) -> mb::Operation
+    {
+        auto const list = list_of(elements);
+
+        return [list](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    list->for_each([](auto const& observer) { observer->calls.fetch_add(1, std::memory_order_relaxed); });
+            };
+    }}};
+
+mb::Registration const concurrent_for_each{{
+    "ThreadSafeList::for_each (16 elements)",
+    "threads",
+    {1, 2, 4, 8},
+    [](unsigned threads) -> mb::Operation
+    {
+        auto const list = list_of(16);
+
+        return [list, threads](uint64_t iterations)
+            {
+                mb::run_on_threads(threads, iterations, [&](uint64_t my_iterations)
+                    {
+                        for (uint64_t i = 0; i != my_iterations; ++i)
+                        {
+                            list->for_each(
+                                [](auto const& observer) { observer->calls.fetch_add(1, std::memory_order_relaxed); });
+                        }
+                    });
+            };
+    }}};
+
+mb::Registration const read_lock{{
+    "RecursiveReadWriteMutex read (write every 1000)",
+    "threads",
+    {1, 2, 4, 8},
+    [](unsigned threads) -> mb::Operation
+    {
+        auto const mutex = std::make_shared<mir::RecursiveReadWriteMutex>();
+
+        return [mutex, threads](uint64_t iterations)
+            {
+                mb::run_on_threads(threads, iterations, [&](uint64_t my_iterations)
+                    {
+                        for (uint64_t i = 0; i != my_iterations; ++i)
+                        {
+                            if (i % 1000 == 999)
+                            {
+                                mir::RecursiveWriteLock lock{*mutex};
+                            }
+                            else
+                            {
+                                mir::RecursiveReadLock lock{*mutex};
+                            }
+                        }
+                    });
+            };
+    }}};
+
+/// A Wayland event loop with an executor feeding it
+class ExecutorLoop
+{
+public:
+    ExecutorLoop()
+        : loop{wl_event_loop_create()},
+          executor{std::make_unique<mf::WaylandExecutor>(loop)}
+    {
+    }
+
+    ~ExecutorLoop()
+    {
+        executor.reset();
+        wl_event_loop_destroy(loop);
+    }
+
+    wl_event_loop* const loop;
+    std::unique_ptr<mf::WaylandExecutor> executor;
+    uint64_t executed{0};   ///< Only touched on the thread dispatching the loop
+};
+
+mb::Registration const spawn{{
+    "WaylandExecutor::spawn",
+    "threads",
+    {1, 2, 4},
+    [](unsigned threads) -> mb::Operation
+    {
+        auto const state = std::make_shared<ExecutorLoop>();
+
+        return [state, threads](uint64_t iterations)
+            {
+                auto const total = (iterations / threads) * threads;
+                state->executed = 0;
+
+                std::thread producers{[&]
+                    {
+                        mb::run_on_threads(threads, iterations, [&](uint64_t my_iterations)
+                            {
+                                for (uint64_t i = 0; i != my_iterations; ++i)
+                                    state->executor->spawn([state = state.get()] { ++state->executed; });
+                            });
+                    }};
+
+                // This thread plays the part of the Wayland thread
+                while (state->executed != total)
+                    wl_event_loop_dispatch(state->loop, 10);
+
+                producers.join();
+            };
+    }}};
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "mir/events/event_builders.h"
+#include "mir/events/event.h"
+
+namespace mb = mir_benchmark;
+namespace mev = mir::events;
+
+namespace
+{
+auto touch_event(unsigned contacts) -> mir::EventUPtr
+{
+    auto event = mev::make_event(
+        MirInputDeviceId{0}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{}, mir_input_event_modifier_none);
+
+    for (unsigned i = 0; i != contacts; ++i)
+    {
+        mev::add_touch(
+            *event, i, mir_touch_action_change, mir_touch_tooltype_finger,
+            100.0f + i, 200.0f + i, 1.0f, 10.0f, 10.0f, 10.0f);
+    }
+    return event;
+}
+
+mb::Registration const create{{
+    "MirEvent create (touch)",
+    "contacts",
+    {1, 5, 10},
+    [](unsigned contacts) -> mb::Operation
+    {
+        return [contacts](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    touch_event(contacts);
+            };
+    }}};
+
+mb::Registration const clone{{
+    "MirEvent clone (touch)",
+    "contacts",
+    {1, 5, 10},
+    [](unsigned contacts) -> mb::Operation
+    {
+        std::shared_ptr<MirEvent const> const event{touch_event(contacts)};
+
+        return [event](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    mev::clone_event(*event);
+            };
+    }}};
+
+mb::Registration const serialize{{
+    "MirEvent serialize (touch)",
+    "contacts",
+    {1, 5, 10},
+    [](unsigned contacts) -> mb::Operation
+    {
+        std::shared_ptr<MirEvent const> const event{touch_event(contacts)};
+
+        return [event](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    MirEvent::serialize(event.get());
+            };
+    }}};
+
+mb::Registration const deserialize{{
+    "MirEvent deserialize (touch)",
+    "contacts",
+    {1, 5, 10},
+    [](unsigned contacts) -> mb::Operation
+    {
+        auto const bytes = MirEvent::serialize(touch_event(contacts).get());
+
+        return [bytes](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    MirEvent::deserialize(bytes);
+            };
+    }}};
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mb = mir_benchmark;
+
+using namespace std::chrono;
+
+namespace
+{
+struct Result
+{
+    std::string name;
+    std::string scale_name;
+    unsigned scale;
+    uint64_t iterations;
+    double min_ns;
+    double median_ns;
+};
+
+auto time(mb::Operation const& operation, uint64_t iterations) -> duration<double>
+{
+    auto const start = steady_clock::now();
+    operation(iterations);
+    return steady_clock::now() - start;
+}
+
+auto measure(mb::MicroBenchmark const& benchmark, unsigned scale, duration<double> min_time, unsigned repetitions)
+    -> Result
+{
+    auto const operation = benchmark.setup(scale);
+
+    // Find an iteration count that takes about min_time
+    uint64_t iterations = 1;
+    auto elapsed = time(operation, iterations);
+    while (elapsed < min_time / 10 && iterations < (uint64_t{1} << 40))
+    {
+        iterations *= 10;
+        elapsed = time(operation, iterations);
+    }
+    iterations = std::max<uint64_t>(1, static_cast<uint64_t>(iterations * (min_time / elapsed)));
+
+    std::vector<double> ns_per_op;
+    for (unsigned i = 0; i != repetitions; ++i)
+        ns_per_op.push_back(duration<double, std::nano>{time(operation, iterations)}.count() / iterations);
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+
+    return Result{
+        benchmark.name,
+        benchmark.scale_name,
+        scale,
+        iterations,
+        ns_per_op.front(),
+        ns_per_op[ns_per_op.size() / 2]};
+}
+
+void usage(char const* name)
+{
+    std::cerr
+        << "Usage: " << name << " [options]\n"
+        << "  --filter <text>       only run benchmarks whose name contains <text>\n"
+        << "  --min-time <s>        target duration of each measurement [default: 0.5]\n"
+        << "  --repetitions <n>     measurements per benchmark and scale [default: 3]\n"
+        << "  --json                write results as JSON instead of a table\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    duration<double> min_time{0.5};
+    unsigned repetitions{3};
+    bool json{false};
+
+    for (int i = 1; i != argc; ++i)
+    {
+        std::string const option{argv[i]};
+        if (option == "--json")
+        {
+            json = true;
+        }
+        else if (i + 1 != argc && option == "--filter")
+        {
+            filter = argv[++i];
+        }
+        else if (i + 1 != argc && option == "--min-time")
+        {
+            min_time = duration<double>{std::atof(argv[++i])};
+        }
+        else if (i + 1 != argc && option == "--repetitions")
+        {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Result> results;
+    for (auto const& benchmark : mb::registered_benchmarks())
+    {
+        if (benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        for (auto const scale : benchmark.scales)
+        {
+            results.push_back(measure(benchmark, scale, min_time, repetitions));
+
+            if (!json)
+            {
+                auto const& result = results.back();
+                std::cout << std::left << std::setw(48) << result.name
+                          << std::setw(16) << (result.scale_name + "=" + std::to_string(result.scale))
+                          << std::right << std::fixed << std::setprecision(1)
+                          << std::setw(12) << result.min_ns << " ns/op (min)"
+                          << std::setw(12) << result.median_ns << " ns/op (median)"
+                          << std::endl;
+            }
+        }
+    }
+
+    if (json)
+    {
+        std::cout << "{\"benchmarks\": [\n";
+        for (size_t i = 0; i != results.size(); ++i)
+        {
+            auto const& result = results[i];
+            std::cout << "  {\"name\": \"" << result.name << "\""
+                      << ", \"scale_name\": \"" << result.scale_name << "\""
+                      << ", \"scale\": " << result.scale
+                      << ", \"iterations\": " << result.iterations
+                      << ", \"ns_per_op_min\": " << result.min_ns
+                      << ", \"ns_per_op_median\": " << result.median_ns
+                      << "}" << (i + 1 != results.size() ? "," : "") << "\n";
+        }
+        std::cout << "]}" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include <atomic>
+#include <thread>
+
+namespace mb = mir_benchmark;
+
+mb::Registration::Registration(MicroBenchmark const& benchmark)
+{
+    registered_benchmarks().push_back(benchmark);
+}
+
+auto mb::registered_benchmarks() -> std::vector<MicroBenchmark>&
+{
+    static std::vector<MicroBenchmark> benchmarks;
+    return benchmarks;
+}
+
+void mb::run_on_threads(unsigned threads, uint64_t iterations, std::function<void(uint64_t)> const& per_thread)
+{
+    std::atomic<unsigned> waiting{threads};
+    std::vector<std::thread> workers;
+
+    for (unsigned i = 0; i != threads; ++i)
+    {
+        workers.emplace_back(
+            [&]
+            {
+                // Start together, so that the threads really contend
+                --waiting;
+                while (waiting)
+                    std::this_thread::yield();
+
+                per_thread(iterations / threads);
+            });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARK_MICRO_BENCHMARK_H_
+#define MIR_BENCHMARK_MICRO_BENCHMARK_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mir_benchmark
+{
+/// Performs a benchmark's operation \p iterations times, spread over threads as the benchmark chooses
+using Operation = std::function<void(uint64_t iterations)>;
+
+/// Prepares a benchmark at the given scale, so that the setup is excluded from its timings
+using Setup = std::function<Operation(unsigned scale)>;
+
+struct MicroBenchmark
+{
+    std::string name;
+    std::string scale_name;     ///< What the scale counts: surfaces, threads, ...
+    std::vector<unsigned> scales;
+    Setup setup;
+};
+
+/// Adds a benchmark to those run by mir_micro_benchmarks; intended for namespace scope
+class Registration
+{
+public:
+    Registration(MicroBenchmark const& benchmark);
+};
+
+auto registered_benchmarks() -> std::vector<MicroBenchmark>&;
+
+/// Runs \p per_thread(iterations / threads) on each of \p threads threads at once
+void run_on_threads(unsigned threads, uint64_t iterations, std::function<void(uint64_t)> const& per_thread);
+}
+
+#endif // MIR_BENCHMARK_MICRO_BENCHMARK_H_
@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "src/server/compositor/occlusion.h"
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/input/surface_input_dispatcher.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/events/event_builders.h"
+#include "mir/input/input_reception_mode.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+#include "mir/test/doubles/stub_scene_element.h"
+
+#include <random>
+
+namespace mb = mir_benchmark;
+namespace mc = mir::compositor;
+namespace ms = mir::scene;
+namespace mi = mir::input;
+namespace mev = mir::events;
+namespace mr = mir::report;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+geom::Rectangle const screen{{0, 0}, {1920, 1080}};
+
+/// Window-like rectangles scattered over (and a little beyond) the screen; the same for each run
+auto windows(unsigned count) -> std::vector<geom::Rectangle>
+{
+    std::mt19937 random{count};
+    std::uniform_int_distribution<int> x{-100, 1800};
+    std::uniform_int_distribution<int> y{-100, 1000};
+    std::uniform_int_distribution<int> size{100, 800};
+
+    std::vector<geom::Rectangle> result;
+    for (unsigned i = 0; i != count; ++i)
+        result.push_back({{x(random), y(random)}, {size(random), size(random)}});
+    return result;
+}
+
+auto points(unsigned count) -> std::vector<geom::Point>
+{
+    std::mt19937 random{count};
+    std::uniform_int_distribution<int> x{0, screen.size.width.as_int() - 1};
+    std::uniform_int_distribution<int> y{0, screen.size.height.as_int() - 1};
+
+    std::vector<geom::Point> result;
+    for (unsigned i = 0; i != count; ++i)
+        result.push_back({x(random), y(random)});
+    return result;
+}
+
+auto surface_stack_of(unsigned surfaces) -> std::shared_ptr<ms::SurfaceStack>
+{
+    auto const report = mr::null_scene_report();
+    auto const stack = std::make_shared<ms::SurfaceStack>(report);
+
+    for (auto const& rect : windows(surfaces))
+    {
+        auto const surface = std::make_shared<ms::BasicSurface>(
+            nullptr /* session */,
+            std::string("benchmark"),
+            rect,
+            mir_pointer_unconfined,
+            std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, {}}},
+            std::shared_ptr<mir::graphics::CursorImage>(),
+            report);
+        stack->add_surface(surface, mi::InputReceptionMode::normal);
+    }
+
+    return stack;
+}
+
+unsigned const point_count = 256;
+
+mb::Registration const occlusion{{
+    "filter_occlusions_from",
+    "elements",
+    {10, 100, 1000},
+    [](unsigned elements) -> mb::Operation
+    {
+        mc::SceneElementSequence sequence;
+        for (auto const& rect : windows(elements))
+        {
+            sequence.push_back(std::make_shared<mtd::StubSceneElement>(std::make_shared<mtd::FakeRenderable>(rect)));
+        }
+
+        return [sequence](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                {
+                    // filter_occlusions_from() removes the occluded elements, so work on a copy
+                    auto elements = sequence;
+                    mc::filter_occlusions_from(elements, screen);
+                }
+            };
+    }}};
+
+mb::Registration const scene_elements_for{{
+    "SurfaceStack::scene_elements_for",
+    "surfaces",
+    {10, 100, 1000},
+    [](unsigned surfaces) -> mb::Operation
+    {
+        auto const stack = surface_stack_of(surfaces);
+
+        return [stack](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    stack->scene_elements_for(stack.get());
+            };
+    }}};
+
+mb::Registration const surface_at{{
+    "SurfaceStack::surface_at",
+    "surfaces",
+    {10, 100, 1000},
+    [](unsigned surfaces) -> mb::Operation
+    {
+        auto const stack = surface_stack_of(surfaces);
+        auto const targets = points(point_count);
+
+        return [stack, targets](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    stack->surface_at(targets[i % targets.size()]);
+            };
+    }}};
+
+mb::Registration const dispatch{{
+    "SurfaceInputDispatcher::dispatch (pointer motion)",
+    "surfaces",
+    {10, 100, 1000},
+    [](unsigned surfaces) -> mb::Operation
+    {
+        auto const stack = surface_stack_of(surfaces);
+        auto const dispatcher = std::make_shared<mi::SurfaceInputDispatcher>(stack);
+        dispatcher->start();
+
+        std::vector<std::shared_ptr<MirEvent const>> events;
+        for (auto const& point : points(point_count))
+        {
+            events.push_back(mev::make_event(
+                MirInputDeviceId{0}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{},
+                mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+                point.x.as_int(), point.y.as_int(), 0, 0, 0, 0));
+        }
+
+        // Keep the stack alive for as long as the dispatcher observes it
+        return [stack, dispatcher, events](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i != iterations; ++i)
+                    dispatcher->dispatch(events[i % events.size()]);
+            };
+    }}};
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "src/server/compositor/stream.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <array>
+
+namespace mb = mir_benchmark;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+mb::Registration const submit_and_lock{{
+    "Stream::submit_buffer + lock_compositor_buffer",
+    "compositors",
+    {1, 2, 4},
+    [](unsigned compositors) -> mb::Operation
+    {
+        geom::Size const size{64, 64};
+        auto const stream = std::make_shared<mc::Stream>(size, mir_pixel_format_argb_8888);
+
+        std::array<std::shared_ptr<mg::Buffer>, 3> const buffers{{
+            std::make_shared<mtd::StubBuffer>(size),
+            std::make_shared<mtd::StubBuffer>(size),
+            std::make_shared<mtd::StubBuffer>(size)}};
+
+        return [stream, buffers, compositors](uint64_t iterations)
+            {
+                // Each compositor holds on to its buffer until it next locks one, as they do when compositing
+                std::vector<int> compositor_ids(compositors);
+                std::vector<std::shared_ptr<mg::Buffer>> locked(compositors);
+
+                for (uint64_t i = 0; i != iterations; ++i)
+                {
+                    stream->submit_buffer(buffers[i % buffers.size()]);
+                    for (unsigned c = 0; c != compositors; ++c)
+                        locked[c] = stream->lock_compositor_buffer(&compositor_ids[c]);
+                }
+            };
+    }}};
+}
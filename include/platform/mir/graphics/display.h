@@ -24,6 +24,7 @@
 #include <memory>
 #include <functional>
 #include <chrono>
+#include <vector>
 
 namespace mir
 {
@@ -40,6 +41,9 @@ class VirtualOutput;
 typedef std::function<bool()> DisplayPauseHandler;
 typedef std::function<bool()> DisplayResumeHandler;
 typedef std::function<void()> DisplayConfigurationChangeHandler;
+class DisplaySyncGroup;
+typedef std::function<void(std::vector<DisplaySyncGroup*> const&)> DisplaySyncGroupReleaseHandler;
+typedef std::function<void(Frame const&)> PresentationHandler;
 
 /**
  * DisplaySyncGroup represents a group of displays that need to be output
@@ -78,6 +82,19 @@ public:
      */
     virtual std::chrono::milliseconds recommended_sleep() const = 0;
 
+    /**
+     * Requests notification of when the content of the next post() reaches the screen.
+     *
+     * If the platform can time presentation it calls \p handler once with the Frame
+     * in which that content first became visible; Frame::msc is zero if the timestamp
+     * was not taken from the display hardware. The handler may be called from within
+     * post() and must not call back into the DisplaySyncGroup.
+     *
+     * \return \c false if the platform does not support presentation timing, in which
+     *          case \p handler will never be called.
+     */
+    virtual bool notify_next_presentation(PresentationHandler const& /*handler*/) { return false; }
+
     virtual ~DisplaySyncGroup() = default;
 protected:
     DisplaySyncGroup() = default;
@@ -124,6 +141,31 @@ public:
      */
     virtual void configure(DisplayConfiguration const& conf) = 0;
 
+    /**
+     * Sets a new output configuration, disturbing only the DisplaySyncGroups it affects.
+     *
+     * Before touching any DisplaySyncGroup it is about to destroy or change, the Display calls
+     * \p release with those groups; once \p release returns they must no longer be used.
+     * Every other DisplaySyncGroup (and its DisplayBuffers) remains valid and may continue to
+     * be composited throughout. Groups created by the new configuration are visible through
+     * for_each_display_sync_group() once this function returns.
+     *
+     * \p release is called with the Display's configuration state locked, so must not call
+     * back into the Display.
+     *
+     * \param conf    [in] Configuration to apply.
+     * \param release [in] Called (at most once) with the groups about to be invalidated.
+     * \return        \c true if \p conf has been applied; \c false if this Display does not
+     *                support incremental configuration, in which case nothing has been
+     *                applied or released and configure() should be used instead.
+     */
+    virtual bool configure_incrementally(
+        DisplayConfiguration const& /*conf*/,
+        DisplaySyncGroupReleaseHandler const& /*release*/)
+    {
+        return false;
+    }
+
     /**
      * Registers a handler for display configuration changes.
      *
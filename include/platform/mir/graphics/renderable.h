@@ -50,6 +50,13 @@ public:
     virtual std::shared_ptr<Buffer> buffer() const = 0;
 
     virtual geometry::Rectangle screen_position() const = 0;
+
+    /**
+     * The region of buffer() to draw, in buffer pixels, scaled to fill
+     * screen_position(). If unset the whole buffer is drawn.
+     */
+    virtual std::experimental::optional<geometry::Rectangle> source_rect() const { return {}; }
+
     virtual std::experimental::optional<geometry::Rectangle> clip_area() const = 0;
 
     // These are from the old CompositingCriteria. There is a little bit
@@ -48,12 +48,18 @@ extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const renderer_opt;
+extern char const* const compositor_threads_opt;
 extern char const* const enable_key_repeat_opt;
+extern char const* const resample_input_opt;
 extern char const* const x11_display_opt;
 extern char const* const wayland_extensions_opt;
 extern char const* const add_wayland_extensions_opt;
 extern char const* const drop_wayland_extensions_opt;
 extern char const* const enable_mirclient_opt;
+extern char const* const client_surface_quota_opt;
+extern char const* const client_buffer_memory_quota_opt;
+extern char const* const client_frame_callback_quota_opt;
 
 extern char const* const offscreen_opt;
 
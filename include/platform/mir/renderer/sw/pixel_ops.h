@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_PIXEL_OPS_H_
+#define MIR_RENDERER_SW_PIXEL_OPS_H_
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/**
+ * \name CPU pixel operations
+ *
+ * Kernels for software buffer paths, operating on 32bpp pixels in native
+ * byte order. Each uses the best of AVX2, SSE2 or NEON that the CPU supports
+ * (chosen at runtime), falling back to portable code.
+ *
+ * Unless noted, source and destination may be the same buffer but must not
+ * otherwise overlap.
+ * @{
+ */
+
+/// Swaps the red and blue channels (ARGB8888 <-> ABGR8888)
+void swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count);
+
+/// Converts straight alpha to premultiplied alpha, with alpha in the top byte
+void premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count);
+
+/**
+ * Composites premultiplied-alpha src over dst (Porter-Duff "over")
+ *
+ * src (including its alpha) is first scaled by opacity. If source_is_opaque
+ * the alpha channel of src is ignored and taken to be fully opaque.
+ */
+void blend_over(
+    uint32_t const* src, uint32_t* dst, size_t count,
+    uint8_t opacity, bool source_is_opaque);
+
+/// Sets count pixels to value
+void fill_pixels(uint32_t* dst, size_t count, uint32_t value);
+
+/// Copies rows of row_bytes bytes between buffers of (possibly) different strides
+void copy_rows(
+    unsigned char const* src, geometry::Stride src_stride,
+    unsigned char* dst, geometry::Stride dst_stride,
+    size_t row_bytes, size_t rows);
+
+/**
+ * Flips an image vertically in place, optionally swapping the red and blue
+ * channels at the same time (as needed for pixels read back from GL).
+ */
+void flip_rows(
+    unsigned char* pixels, geometry::Stride stride,
+    size_t width, size_t height, bool swap_red_and_blue);
+
+/// Copies src into dst, scaling to dst_size with nearest-neighbour sampling
+void scale_pixels(
+    uint32_t const* src, geometry::Size src_size, geometry::Stride src_stride,
+    uint32_t* dst, geometry::Size dst_size, geometry::Stride dst_stride);
+
+/// The name of the instruction set in use: "avx2", "sse2", "neon" or "generic"
+auto pixel_ops_implementation() -> char const*;
+/** @} */
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_PIXEL_OPS_H_ */
@@ -0,0 +1,80 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/geometry/rectangle.h"
+
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * A display buffer that can be composited into by the CPU
+ *
+ * Display buffers offer this through graphics::DisplayBuffer::native_display_buffer()
+ * in the same way as renderer::gl::RenderTarget.
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /**
+     * Map the framebuffer that the next frame should be drawn into.
+     *
+     * The mapping is of mir_pixel_format_argb_8888 or mir_pixel_format_xrgb_8888
+     * pixels and holds whatever was last drawn into that framebuffer (see
+     * framebuffer_age()). It must be released before present() is called.
+     */
+    virtual auto map_framebuffer() -> std::unique_ptr<Mapping<unsigned char>> = 0;
+
+    /**
+     * The number of frames since the framebuffer last returned by map_framebuffer()
+     * was drawn into, or 0 if its content is undefined.
+     *
+     * A target with a single persistent framebuffer always has an age of 1
+     * once a frame has been presented.
+     */
+    virtual auto framebuffer_age() const -> unsigned = 0;
+
+    /**
+     * Display the frame drawn into the framebuffer.
+     *
+     * \param [in] damage   The areas of the framebuffer (in framebuffer pixels)
+     *                      that differ from the previous frame.
+     */
+    virtual void present(std::vector<geometry::Rectangle> const& damage) = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDER_TARGET_H_ */
@@ -23,6 +23,7 @@
 
 #include <experimental/optional>
 #include <chrono>
+#include <vector>
 
 namespace mir
 {
@@ -101,11 +102,14 @@ public:
     TouchParameters& at_position(geometry::Point abs_pos);
     TouchParameters& with_action(Action touch_action);
     TouchParameters& with_event_time(std::chrono::nanoseconds time);
+    /// Another finger, at \p abs_pos, taking the same action in the same event
+    TouchParameters& with_additional_contact(geometry::Point abs_pos);
 
     int device_id;
     int abs_x;
     int abs_y;
     Action action;
+    std::vector<geometry::Point> additional_contacts;
     std::experimental::optional<std::chrono::nanoseconds> event_time;
 };
 TouchParameters a_touch_event();
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_WAYLAND_PROTOCOL_STATISTICS_H_
+#define MIR_WAYLAND_PROTOCOL_STATISTICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct wl_interface;
+
+namespace mir
+{
+namespace wayland
+{
+/// Statistics for a single request or event of a Wayland interface
+struct MessageStatistics
+{
+    std::string interface;
+    std::string message;
+    bool is_request;
+    uint64_t count;
+    /// Total time spent in the request handler; always zero for events
+    std::chrono::nanoseconds handler_time;
+};
+
+/**
+ * Request and event counters for one Wayland interface
+ *
+ * Wrappers generated with the "instrumented" option hold one of these per
+ * interface, registered for as long as the wrapper's library is loaded.
+ * Recording only touches atomics, so is safe to do from the Wayland thread
+ * while statistics are being read elsewhere.
+ */
+class InterfaceStatistics
+{
+public:
+    /**
+     * \param interface     The interface description; message names are read
+     *                      from it only when taking a snapshot
+     * \param request_count The number of requests in \a interface
+     * \param event_count   The number of events in \a interface
+     */
+    InterfaceStatistics(wl_interface const* interface, int request_count, int event_count);
+    ~InterfaceStatistics();
+
+    InterfaceStatistics(InterfaceStatistics const&) = delete;
+    InterfaceStatistics& operator=(InterfaceStatistics const&) = delete;
+
+    void record_request(uint32_t opcode, std::chrono::steady_clock::duration handler_time);
+    void record_event(uint32_t opcode);
+
+    /// Append statistics for every message seen at least once
+    void snapshot(std::vector<MessageStatistics>& into) const;
+
+private:
+    struct Counter
+    {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> nanoseconds{0};
+    };
+
+    wl_interface const* const interface;
+    int const request_count;
+    int const event_count;
+    std::unique_ptr<Counter[]> const requests;
+    std::unique_ptr<Counter[]> const events;
+};
+
+/**
+ * Statistics for every message of every instrumented interface currently loaded
+ *
+ * This is empty unless Mir was built with MIR_INSTRUMENT_WAYLAND_WRAPPERS.
+ */
+auto protocol_statistics() -> std::vector<MessageStatistics>;
+}
+}
+
+#endif // MIR_WAYLAND_PROTOCOL_STATISTICS_H_
@@ -19,69 +19,125 @@
 #include "mir/recursive_read_write_mutex.h"
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
-void mir::RecursiveReadWriteMutex::read_lock()
+namespace
 {
-    auto const my_id = std::this_thread::get_id();
+/// The read locks held by this thread, as (mutex, recursion count)
+thread_local std::vector<std::pair<mir::RecursiveReadWriteMutex const*, unsigned>> read_locks_held;
 
-    std::unique_lock<decltype(mutex)> lock{mutex};
-    cv.wait(lock, [&]{
-        return !write_locking_thread.count ||
-            write_locking_thread.id == my_id; });
+auto read_locks_held_on(mir::RecursiveReadWriteMutex const* mutex)
+    -> std::vector<std::pair<mir::RecursiveReadWriteMutex const*, unsigned>>::iterator
+{
+    return std::find_if(
+        read_locks_held.begin(),
+        read_locks_held.end(),
+        [mutex](auto const& held) { return held.first == mutex; });
+}
+
+auto this_threads_reader_slot(unsigned slots) -> unsigned
+{
+    static std::atomic<unsigned> next_slot{0};
+    thread_local unsigned const slot{next_slot++};
+    return slot % slots;
+}
+}
 
-    auto const my_count = std::find_if(
-        read_locking_threads.begin(),
-        read_locking_threads.end(),
-        [my_id](ThreadLockCount const& candidate) { return my_id == candidate.id; });
+mir::RecursiveReadWriteMutex::~RecursiveReadWriteMutex()
+{
+    // Forget any read locks this thread leaked, in case another mutex takes our address
+    auto const held = read_locks_held_on(this);
+    if (held != read_locks_held.end())
+        read_locks_held.erase(held);
+}
+
+auto mir::RecursiveReadWriteMutex::readers() const -> unsigned
+{
+    unsigned total = 0;
+    for (auto const& slot : reader_slot)
+        total += slot.count.load();
+    return total;
+}
 
-    if (my_count == read_locking_threads.end())
+void mir::RecursiveReadWriteMutex::read_lock()
+{
+    auto const held = read_locks_held_on(this);
+    if (held != read_locks_held.end())
     {
-        read_locking_threads.push_back(ThreadLockCount(my_id, 1U));
+        ++held->second;
+        return;
     }
-    else
+
+    auto const my_id = std::this_thread::get_id();
+    auto& my_slot = reader_slot[this_threads_reader_slot(reader_slots)];
+
+    /*
+     * Announce ourselves, then check for a writer. A writer does the reverse, and
+     * with sequentially consistent operations at least one of us sees the other.
+     */
+    for (;;)
     {
-        ++(my_count->count);
+        my_slot.count.fetch_add(1);
+        if (!write_locked.load() || write_locking_thread.load() == my_id)
+            break;
+
+        my_slot.count.fetch_sub(1);
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.notify_all();    // The writer may be waiting on our slot
+        cv.wait(lock, [&]{ return !write_locked.load(); });
     }
+
+    read_locks_held.emplace_back(this, 1U);
 }
 
 void mir::RecursiveReadWriteMutex::read_unlock()
 {
-    auto const my_id = std::this_thread::get_id();
+    auto const held = read_locks_held_on(this);
+    if (--held->second)
+        return;
 
-    std::lock_guard<decltype(mutex)> lock{mutex};
-    auto const my_count = std::find_if(
-        read_locking_threads.begin(),
-        read_locking_threads.end(),
-        [my_id](ThreadLockCount const& candidate) { return my_id == candidate.id; });
-
-    --(my_count->count);
+    read_locks_held.erase(held);
+    reader_slot[this_threads_reader_slot(reader_slots)].count.fetch_sub(1);
 
-    cv.notify_all();
+    if (write_locked.load())
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        cv.notify_all();
+    }
 }
 
 void mir::RecursiveReadWriteMutex::write_lock()
 {
     auto const my_id = std::this_thread::get_id();
 
+    if (write_locking_thread.load() == my_id)
+    {
+        ++write_lock_count;
+        return;
+    }
+
+    // A read lock of our own doesn't stop us writing
+    unsigned const my_read_locks = (read_locks_held_on(this) != read_locks_held.end()) ? 1 : 0;
+
     std::unique_lock<decltype(mutex)> lock{mutex};
-    cv.wait(lock, [&]
-        {
-            if (write_locking_thread.count &&
-                write_locking_thread.id != my_id) return false;
-            for (auto const& candidate : read_locking_threads)
-            {
-                if (candidate.id != my_id && candidate.count != 0) return false;
-            }
-            return true;
-        });
-
-    ++write_locking_thread.count;
-    write_locking_thread.id = my_id;
+    cv.wait(lock, [&]{ return !write_locked.load(); });
+
+    write_locked = true;
+    write_locking_thread = my_id;
+    cv.wait(lock, [&]{ return readers() == my_read_locks; });
+
+    write_lock_count = 1;
 }
 
 void mir::RecursiveReadWriteMutex::write_unlock()
 {
+    if (--write_lock_count)
+        return;
+
     std::lock_guard<decltype(mutex)> lock{mutex};
-    --write_locking_thread.count;
+    write_locking_thread = std::thread::id{};
+    write_locked = false;
     cv.notify_all();
 }
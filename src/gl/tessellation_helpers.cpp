@@ -36,13 +36,30 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mgl::Primitive rectangle;
     rectangle.type = GL_TRIANGLE_STRIP;
 
-    GLfloat const tex_right = 1.0f;
-    GLfloat const tex_bottom = 1.0f;
+    GLfloat tex_left = 0.0f;
+    GLfloat tex_right = 1.0f;
+    GLfloat tex_top = 0.0f;
+    GLfloat tex_bottom = 1.0f;
+
+    if (auto const source = renderable.source_rect())
+    {
+        auto const buffer = renderable.buffer();
+        auto const buffer_size = buffer ? buffer->size() : geom::Size{};
+        if (buffer_size.width.as_int() > 0 && buffer_size.height.as_int() > 0)
+        {
+            GLfloat const width = buffer_size.width.as_int();
+            GLfloat const height = buffer_size.height.as_int();
+            tex_left = source->left().as_int() / width;
+            tex_right = source->right().as_int() / width;
+            tex_top = source->top().as_int() / height;
+            tex_bottom = source->bottom().as_int() / height;
+        }
+    }
 
     auto& vertices = rectangle.vertices;
-    vertices[0] = {{left,  top,    0.0f}, {0.0f,      0.0f}};
-    vertices[1] = {{left,  bottom, 0.0f}, {0.0f,      tex_bottom}};
-    vertices[2] = {{right, top,    0.0f}, {tex_right, 0.0f}};
+    vertices[0] = {{left,  top,    0.0f}, {tex_left,  tex_top}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex_left,  tex_bottom}};
+    vertices[2] = {{right, top,    0.0f}, {tex_right, tex_top}};
     vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
     return rectangle;
 }
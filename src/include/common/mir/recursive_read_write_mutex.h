@@ -19,18 +19,27 @@
 #ifndef MIR_RECURSIVE_READ_WRITE_MUTEX_H_
 #define MIR_RECURSIVE_READ_WRITE_MUTEX_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <mutex>
 #include <thread>
-#include <vector>
 
 namespace mir
 {
 /** a recursive read-write mutex.
  * Note that a write lock can be acquired if no other threads have a read lock.
+ *
+ * Readers only touch one of a handful of per-thread counters (and a thread's
+ * recursive read locks are counted thread-locally), so concurrent readers do
+ * not contend. Writers are preferred: once a writer is waiting, threads not
+ * already holding a read lock wait for it.
  */
 class RecursiveReadWriteMutex
 {
 public:
+    RecursiveReadWriteMutex() = default;
+    ~RecursiveReadWriteMutex();
+
     void read_lock();
 
     void read_unlock();
@@ -40,17 +49,27 @@ public:
     void write_unlock();
 
 private:
-    std::mutex mutex;
-    std::condition_variable cv;
-    struct ThreadLockCount
+    RecursiveReadWriteMutex(RecursiveReadWriteMutex const&) = delete;
+    RecursiveReadWriteMutex& operator=(RecursiveReadWriteMutex const&) = delete;
+
+    auto readers() const -> unsigned;
+
+    static unsigned constexpr reader_slots = 8;
+
+    /// Threads are spread over the slots; each slot on its own cache line
+    struct alignas(64) ReaderSlot
     {
-        ThreadLockCount() : id(), count(0) {}
-        ThreadLockCount(std::thread::id id, unsigned int count) : id(id), count(count) {}
-        std::thread::id id;
-        unsigned int count;
+        std::atomic<unsigned> count{0};
     };
-    std::vector<ThreadLockCount> read_locking_threads;
-    ThreadLockCount write_locking_thread;
+    ReaderSlot reader_slot[reader_slots];
+
+    std::atomic<bool> write_locked{false};
+    std::atomic<std::thread::id> write_locking_thread{};
+    unsigned write_lock_count{0};   ///< Only touched by write_locking_thread
+
+    /* Readers and writers only wait on these when a writer is involved */
+    std::mutex mutex;
+    std::condition_variable cv;
 };
 
 class RecursiveReadLock
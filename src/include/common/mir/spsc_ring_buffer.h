@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SPSC_RING_BUFFER_H_
+#define MIR_SPSC_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/throw_exception.hpp>
+
+namespace mir
+{
+/*
+ * A bounded, wait-free queue for exactly one producer thread and exactly one
+ * consumer thread.
+ *
+ * try_push() must only ever be called from the producer and try_pop() only
+ * from the consumer. Neither blocks nor allocates; a full (or empty) buffer
+ * is reported by returning false.
+ *
+ * Requirements for type 'Element'
+ *  - default-constructible
+ *  - move-assignable
+ */
+template<typename Element>
+class SpscRingBuffer
+{
+public:
+    /// \param capacity must be a non-zero power of two
+    explicit SpscRingBuffer(size_t capacity)
+        : mask{capacity - 1},
+          slots(capacity)
+    {
+        if (capacity == 0 || (capacity & mask) != 0)
+            BOOST_THROW_EXCEPTION(std::invalid_argument("SpscRingBuffer capacity must be a power of two"));
+    }
+
+    SpscRingBuffer(SpscRingBuffer const&) = delete;
+    SpscRingBuffer& operator=(SpscRingBuffer const&) = delete;
+
+    bool try_push(Element&& element)
+    {
+        auto const tail = write_index.load(std::memory_order_relaxed);
+
+        if (tail - read_index.load(std::memory_order_acquire) > mask)
+            return false;
+
+        slots[tail & mask] = std::move(element);
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(Element& element)
+    {
+        auto const head = read_index.load(std::memory_order_relaxed);
+
+        if (head == write_index.load(std::memory_order_acquire))
+            return false;
+
+        // Leave a default-constructed element behind so that we don't keep
+        // resources alive until the slot is next overwritten
+        element = std::move(slots[head & mask]);
+        slots[head & mask] = Element{};
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    size_t const mask;
+    std::vector<Element> slots;
+
+    // Keep the indices on separate cache lines so producer and consumer
+    // don't contend for the same line
+    alignas(64) std::atomic<size_t> write_index{0};
+    alignas(64) std::atomic<size_t> read_index{0};
+};
+}
+
+#endif // MIR_SPSC_RING_BUFFER_H_
@@ -20,29 +20,28 @@
 #ifndef MIR_THREAD_SAFE_LIST_H_
 #define MIR_THREAD_SAFE_LIST_H_
 
-#include "mir/recursive_read_write_mutex.h"
-
+#include <algorithm>
 #include <atomic>
-#include <functional>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace mir
 {
 
 /*
  * Requirements for type 'Element'
- *  - for_each():
- *    - copy-assignable
  *  - add():
- *    - copy-assignable
+ *    - copy-constructible
  *    - conversion to bool: indicates whether this is a valid element
  *  - remove(), remove_all():
- *    - copy-assignable
- *    - Element{}: default construction should create an invalid element
  *    - bool operator==: equality of elements
- *    - bool operator!=: inequality of elements
- *  - clear():
- *    - copy-assignable
- *    - Element{}: value initialization should create an invalid element
+ *
+ * for_each() walks an immutable snapshot of the list without taking any lock;
+ * add() and remove() replace the snapshot. An element removed (on any thread)
+ * after for_each() has started is not visited, and once remove() returns no
+ * other thread is still calling back on the removed element.
  */
 
 template<class Element>
@@ -53,133 +52,165 @@ public:
     void remove(Element const& element);
     unsigned int remove_all(Element const& element);
     void clear();
-    void for_each(std::function<void(Element const& element)> const& f);
+
+    template<typename Function>
+    void for_each(Function const& f);
 
 private:
-    struct ListItem
+    struct Entry
+    {
+        explicit Entry(Element const& element) : element{element} {}
+
+        Element const element;
+        std::atomic<bool> removed{false};
+        std::atomic<unsigned> in_use{0};    ///< Calls to for_each() callbacks in progress
+    };
+    using Snapshot = std::vector<std::shared_ptr<Entry>>;
+
+    /// The entries this thread is calling back on, outermost first
+    static auto entries_in_use_by_this_thread() -> std::vector<Entry const*>&
     {
-        ListItem() {}
-        RecursiveReadWriteMutex mutex;
-        Element element{};
-        std::atomic<ListItem*> next{nullptr};
+        static thread_local std::vector<Entry const*> entries;
+        return entries;
+    }
+
+    /// Remove the entries matching predicate, then wait for other threads to finish with them
+    template<typename Predicate>
+    auto remove_if(Predicate const& predicate) -> unsigned int;
 
-        ~ListItem() { delete next.load(); }
-    } head;
+    std::mutex mutex;   ///< Serialises changes to the snapshot
+    std::condition_variable entry_released;
+    std::shared_ptr<Snapshot const> snapshot;   ///< Only accessed through std::atomic_load/atomic_store
 };
 
 template<class Element>
-void ThreadSafeList<Element>::for_each(
-    std::function<void(Element const& element)> const& f)
+template<typename Function>
+void ThreadSafeList<Element>::for_each(Function const& f)
 {
-    ListItem* current_item = &head;
+    auto const current = std::atomic_load(&snapshot);
+    if (!current)
+        return;
+
+    auto& in_use_by_this_thread = entries_in_use_by_this_thread();
 
-    while (current_item)
+    for (auto const& entry : *current)
     {
-        RecursiveReadLock lock{current_item->mutex};
+        if (entry->removed)
+            continue;
 
-        // We need to take a copy in case we recursively remove during call
-        if (auto const copy_of_element = current_item->element) f(copy_of_element);
+        /*
+         * Announce we're using the entry, then check it wasn't removed: remove()
+         * does the reverse, so at least one of us sees the other.
+         */
+        in_use_by_this_thread.push_back(entry.get());
+        entry->in_use.fetch_add(1);
 
-        current_item = current_item->next;
+        struct Release
+        {
+            ~Release()
+            {
+                in_use_by_this_thread.pop_back();
+                entry.in_use.fetch_sub(1);
+                if (entry.removed)
+                {
+                    std::lock_guard<std::mutex> lock{list.mutex};
+                    list.entry_released.notify_all();
+                }
+            }
+
+            ThreadSafeList& list;
+            Entry& entry;
+            std::vector<Entry const*>& in_use_by_this_thread;
+        } const release{*this, *entry, in_use_by_this_thread};
+
+        if (!entry->removed)
+            f(entry->element);
     }
 }
 
 template<class Element>
 void ThreadSafeList<Element>::add(Element const& element)
 {
-    ListItem* current_item = &head;
+    if (!element)
+        return;
 
-    do
-    {
-        // Note: we release the read lock to avoid two threads calling add at
-        // the same time mutually blocking the other's upgrade to write lock.
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element) continue;
-        }
-
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (!current_item->element)
-        {
-            current_item->element = element;
-            return;
-        }
-    }
-    while (current_item->next && (current_item = current_item->next));
+    std::lock_guard<std::mutex> lock{mutex};
 
-    // No empty Items so append a new one
-    auto new_item = new ListItem;
-    new_item->element = element;
-
-    for (ListItem* expected{nullptr};
-        !current_item->next.compare_exchange_weak(expected, new_item);
-        expected = nullptr)
+    auto updated = std::make_shared<Snapshot>();
+    if (auto const current = std::atomic_load(&snapshot))
     {
-        if (expected) current_item = expected;
+        updated->reserve(current->size() + 1);
+        *updated = *current;
     }
+    updated->push_back(std::make_shared<Entry>(element));
+
+    std::atomic_store(&snapshot, std::shared_ptr<Snapshot const>{std::move(updated)});
 }
 
 template<class Element>
-void ThreadSafeList<Element>::remove(Element const& element)
+template<typename Predicate>
+auto ThreadSafeList<Element>::remove_if(Predicate const& predicate) -> unsigned int
 {
-    ListItem* current_item = &head;
+    std::unique_lock<std::mutex> lock{mutex};
 
-    do
+    auto const current = std::atomic_load(&snapshot);
+    if (!current)
+        return 0;
+
+    Snapshot removed;
+    auto updated = std::make_shared<Snapshot>();
+    for (auto const& entry : *current)
     {
+        if (predicate(entry->element))
         {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
+            entry->removed = true;
+            removed.push_back(entry);
         }
-
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (current_item->element == element)
+        else
         {
-            current_item->element = Element{};
-            return;
+            updated->push_back(entry);
         }
     }
-    while ((current_item = current_item->next));
-}
 
-template<class Element>
-unsigned int ThreadSafeList<Element>::remove_all(Element const& element)
-{
-    ListItem* current_item = &head;
-    auto removed = 0u;
+    if (removed.empty())
+        return 0;
+
+    std::atomic_store(&snapshot, std::shared_ptr<Snapshot const>{std::move(updated)});
 
-    do
+    // A callback on this thread may be removing its own element; don't wait for ourself
+    auto const& in_use_by_this_thread = entries_in_use_by_this_thread();
+    for (auto const& entry : removed)
     {
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
-        }
+        auto const uses_by_this_thread = static_cast<unsigned>(
+            std::count(in_use_by_this_thread.begin(), in_use_by_this_thread.end(), entry.get()));
+
+        entry_released.wait(lock, [&]{ return entry->in_use.load() == uses_by_this_thread; });
+    }
 
-        RecursiveWriteLock lock{current_item->mutex};
+    return removed.size();
+}
 
-        if (current_item->element == element)
+template<class Element>
+void ThreadSafeList<Element>::remove(Element const& element)
+{
+    bool found = false;
+    remove_if(
+        [&](Element const& candidate)
         {
-            current_item->element = Element{};
-            ++removed;
-        }
-    }
-    while ((current_item = current_item->next));
+            return !found && (found = (candidate == element));
+        });
+}
 
-    return removed;
+template<class Element>
+unsigned int ThreadSafeList<Element>::remove_all(Element const& element)
+{
+    return remove_if([&](Element const& candidate) { return candidate == element; });
 }
 
 template<class Element>
 void ThreadSafeList<Element>::clear()
 {
-    ListItem* current_item = &head;
-
-    do
-    {
-        RecursiveWriteLock lock{current_item->mutex};
-        current_item->element = Element{};
-    }
-    while ((current_item = current_item->next));
+    remove_if([](Element const&) { return true; });
 }
 
 }
@@ -19,8 +19,11 @@
 #ifndef MIR_COMPOSITOR_COMPOSITOR_H_
 #define MIR_COMPOSITOR_COMPOSITOR_H_
 
+#include <vector>
+
 namespace mir
 {
+namespace graphics { class DisplaySyncGroup; }
 namespace compositor
 {
 
@@ -32,6 +35,18 @@ public:
     virtual void start() = 0;
     virtual void stop() = 0;
 
+    /**
+     * Stops compositing the given groups (if started), leaving the rest running.
+     * On return the groups are no longer referenced and may be destroyed.
+     */
+    virtual void stop_compositing(std::vector<graphics::DisplaySyncGroup*> const& groups) = 0;
+
+    /**
+     * Starts compositing any of the display's sync groups that are not already
+     * being composited (if started).
+     */
+    virtual void start_compositing_new_groups() = 0;
+
 protected:
     Compositor() = default;
     Compositor(Compositor const&) = delete;
@@ -21,6 +21,9 @@
 #define MIR_COMPOSITOR_DISPLAY_BUFFER_COMPOSITOR_H_
 
 #include "mir/compositor/scene.h"
+#include "mir/graphics/buffer_id.h"
+
+#include <vector>
 
 namespace mir
 {
@@ -34,6 +37,16 @@ public:
 
     virtual void composite(SceneElementSequence&& scene_sequence) = 0;
 
+    /// What the most recent composite() put on screen
+    struct Composition
+    {
+        std::vector<graphics::BufferID> buffers; ///< Buffers of the visible renderables
+        bool zero_copy = false;                  ///< Whether they were scanned out directly
+    };
+
+    /// Describes the last composite(); compositors that don't track this report nothing
+    virtual Composition last_composition() const { return {}; }
+
 protected:
     DisplayBufferCompositor() = default;
     DisplayBufferCompositor& operator=(DisplayBufferCompositor const&) = delete;
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_PRESENTATION_OBSERVER_H_
+#define MIR_COMPOSITOR_PRESENTATION_OBSERVER_H_
+
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+/// Notified once the content of a composited frame has reached the screen
+class PresentationObserver
+{
+public:
+    /// How precisely a presentation was timed (mirrors wp_presentation_feedback.kind)
+    enum Flags : uint32_t
+    {
+        vsync = 0x1,        ///< Presentation was synchronised to vertical retrace
+        hw_clock = 0x2,     ///< The timestamp came from the display hardware
+        hw_completion = 0x4,///< The display hardware signalled completion
+        zero_copy = 0x8     ///< The buffers were scanned out without being composited
+    };
+
+    virtual ~PresentationObserver() = default;
+
+    /**
+     * The \p buffers were shown in \p frame.
+     *
+     * \param refresh   the predicted time until the next frame, or zero if unknown
+     * \param flags     a combination of Flags
+     */
+    virtual void frame_presented(
+        std::vector<graphics::BufferID> const& buffers,
+        graphics::Frame const& frame,
+        std::chrono::nanoseconds refresh,
+        uint32_t flags) = 0;
+
+protected:
+    PresentationObserver() = default;
+    PresentationObserver(PresentationObserver const&) = delete;
+    PresentationObserver& operator=(PresentationObserver const&) = delete;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_PRESENTATION_OBSERVER_H_ */
@@ -79,6 +79,8 @@ public:
     void unregister_fd_handler(void const* owner) override;
 
     void enqueue(void const* owner, ServerAction const& action) override;
+    void enqueue_with_priority(
+        void const* owner, ServerActionPriority priority, ServerAction const& action) override;
     void enqueue_with_guaranteed_execution(ServerAction const& action) override;
 
     void pause_processing_for(void const* owner) override;
@@ -159,7 +161,6 @@ public:
 private:
     void execute_with_context_as_thread_default(std::function<void()> code);
 
-    bool should_process_actions_for(void const* owner);
     void handle_exception(std::exception_ptr const& e);
 
     std::shared_ptr<time::Clock> const clock;
@@ -167,8 +168,8 @@ private:
     std::atomic<bool> running_;
     detail::FdSources fd_sources;
     detail::SignalSources signal_sources;
-    std::mutex do_not_process_mutex;
-    std::vector<void const*> do_not_process;
+    detail::ServerActionSource server_actions;
+    detail::AlarmSource alarm_source;
     std::mutex run_on_halt_mutex;
     std::deque<ServerAction> run_on_halt_queue;
     std::function<void()> before_iteration_hook;
@@ -20,6 +20,7 @@
 #define MIR_GLIB_MAIN_LOOP_SOURCES_H_
 
 #include "mir/time/clock.h"
+#include "mir/server_action_queue.h"
 #include "mir/thread_safe_list.h"
 #include "mir/fd.h"
 
@@ -67,18 +68,80 @@ private:
 void add_idle_gsource(
     GMainContext* main_context, int priority, std::function<void()> const& callback);
 
-void add_server_action_gsource(
-    GMainContext* main_context,
-    void const* owner,
-    std::function<void()> const& action,
-    std::function<bool(void const*)> const& should_dispatch);
-
-GSourceHandle add_timer_gsource(
-    GMainContext* main_context,
-    std::shared_ptr<time::Clock> const& clock,
-    std::shared_ptr<LockableCallback> const& handler,
-    std::function<void()> const& exception_handler,
-    time::Timestamp target_time);
+/**
+ * A single GSource dispatching all ServerActions enqueued on a main loop
+ *
+ * Actions are queued (from any thread) by priority and drained in batches;
+ * each dispatch runs at most the actions that were pending when it started,
+ * so that actions enqueueing further actions cannot starve other sources.
+ * Actions belonging to a paused owner are set aside until the owner is
+ * resumed, so they cost nothing while other actions are drained.
+ */
+class ServerActionSource
+{
+public:
+    ServerActionSource(GMainContext* main_context);
+    ~ServerActionSource();
+
+    void enqueue(void const* owner, ServerActionPriority priority, std::function<void()>&& action);
+    void pause_processing_for(void const* owner);
+    void resume_processing_for(void const* owner);
+
+private:
+    ServerActionSource(ServerActionSource const&) = delete;
+    ServerActionSource& operator=(ServerActionSource const&) = delete;
+
+    struct ActionGSource;
+
+    ActionGSource* const gsource;
+};
+
+/**
+ * A single GSource dispatching every Alarm created by a main loop
+ *
+ * Alarm deadlines are kept in a time::TimerWheel and the source's poll timeout
+ * follows the wheel's next event, so arming, rescheduling and cancelling
+ * alarms doesn't create or destroy GSources and nearby deadlines are handled
+ * in a single wakeup.
+ */
+class AlarmSource
+{
+public:
+    class Alarm
+    {
+    public:
+        virtual ~Alarm() = default;
+
+        /// Arms the alarm for target_time, superseding any previous schedule
+        virtual void schedule(time::Timestamp target_time) = 0;
+
+        /// Disarms the alarm; once this returns the handler is neither running nor will it run
+        virtual void cancel() = 0;
+
+    protected:
+        Alarm() = default;
+        Alarm(Alarm const&) = delete;
+        Alarm& operator=(Alarm const&) = delete;
+    };
+
+    AlarmSource(GMainContext* main_context, std::shared_ptr<time::Clock> const& clock);
+    ~AlarmSource();
+
+    std::shared_ptr<Alarm> create_alarm(
+        std::shared_ptr<LockableCallback> const& handler,
+        std::function<void()> const& exception_handler);
+
+private:
+    AlarmSource(AlarmSource const&) = delete;
+    AlarmSource& operator=(AlarmSource const&) = delete;
+
+    struct Wheel;
+    class WheelAlarm;
+    struct AlarmGSource;
+
+    std::shared_ptr<Wheel> const wheel;
+    AlarmGSource* const gsource;
+};
 
 class FdSources
 {
@@ -41,6 +41,7 @@ struct StreamInfo
     std::shared_ptr<compositor::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    optional_value<geometry::Rectangle> source{};  ///< The part of the buffer shown, in buffer pixels
 };
 
 class SurfaceObserver;
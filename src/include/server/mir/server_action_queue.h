@@ -26,12 +26,37 @@ namespace mir
 
 typedef std::function<void()> ServerAction;
 
+/// Relative urgency of a ServerAction
+enum class ServerActionPriority
+{
+    high,   ///< Latency sensitive work, such as input and display configuration
+    normal, ///< Everything else
+    low     ///< Housekeeping that may wait for all other pending actions
+};
+
 class ServerActionQueue
 {
 public:
     virtual ~ServerActionQueue() = default;
 
     virtual void enqueue(void const* owner, ServerAction const& action) = 0;
+    /**
+     * Enqueue an action to be run ahead of any pending actions of lower priority.
+     *
+     * Actions of the same priority are run in the order they were enqueued.
+     * Implementations that do not support priorities run the action as if it
+     * had been enqueue()d.
+     *
+     * \param [in]  owner     Owner of the action, for pause_processing_for()
+     * \param [in]  priority  Priority of the action
+     * \param [in]  action    Functor to invoke.
+     */
+    virtual void enqueue_with_priority(
+        void const* owner, ServerActionPriority priority, ServerAction const& action)
+    {
+        (void)priority;
+        enqueue(owner, action);
+    }
     /**
      * Enqueue an action to be run, guaranteeing that it *will* be run.
      *
@@ -50,6 +50,7 @@ struct StreamSpecification
     std::weak_ptr<frontend::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    optional_value<geometry::Rectangle> source{};  ///< The part of the buffer shown, in buffer pixels
 };
 auto operator==(StreamSpecification const& lhs, StreamSpecification const& rhs) -> bool;
 
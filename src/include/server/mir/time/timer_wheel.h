@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TIME_TIMER_WHEEL_H_
+#define MIR_TIME_TIMER_WHEEL_H_
+
+#include "mir/time/types.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+namespace mir
+{
+namespace time
+{
+
+/**
+ * A hierarchical timing wheel
+ *
+ * Deadlines are rounded up to a whole number of ticks of the wheel's
+ * granularity, so timers due within the same tick expire together and never
+ * before their deadline. Scheduling and cancelling are O(1); timers far in the
+ * future are cascaded towards the innermost wheel as their deadline nears.
+ *
+ * \note TimerWheel is not threadsafe; callers must provide synchronisation.
+ */
+class TimerWheel
+{
+    struct Slot;
+
+public:
+    /// A timer's storage in the wheel; it must be cancelled before it is destroyed
+    class Timer
+    {
+    public:
+        Timer() = default;
+
+        bool scheduled() const { return slot != nullptr; }
+        Timestamp deadline() const { return deadline_; }
+
+    private:
+        friend class TimerWheel;
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+
+        Slot* slot{nullptr};
+        Timer* prev{nullptr};
+        Timer* next{nullptr};
+        uint64_t tick{0};
+        Timestamp deadline_;
+    };
+
+    TimerWheel(Timestamp origin, Duration granularity);
+    ~TimerWheel();
+
+    /// Schedules (or reschedules) timer to expire at deadline
+    void schedule(Timer& timer, Timestamp deadline);
+
+    /// Removes timer from the wheel; has no effect if it is not scheduled
+    void cancel(Timer& timer);
+
+    bool empty() const { return count == 0; }
+
+    /**
+     * The earliest time at which advance() has work to do
+     *
+     * This is either the expiry of a timer or the point at which timers need
+     * cascading to an inner wheel.
+     * \pre !empty()
+     */
+    Timestamp next_event() const;
+
+    /**
+     * Advances the wheel to now, invoking expired for each timer whose deadline
+     * has been reached. Expired timers are unscheduled before expired is called.
+     * \note expired must not schedule or cancel timers on this wheel
+     */
+    void advance(Timestamp now, std::function<void(Timer&)> const& expired);
+
+private:
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+
+    static int const bits_per_level = 6;
+    static int const slots_per_level = 1 << bits_per_level;
+    static int const levels = 4;
+
+    struct Slot
+    {
+        Timer* head;
+        int level;      ///< -1 for timers that are already due
+        int index;
+    };
+
+    struct Level
+    {
+        std::array<Slot, slots_per_level> slots;
+        uint64_t occupied;  ///< Bit n is set iff slots[n] is non-empty
+    };
+
+    uint64_t tick_for(Timestamp t, bool round_up) const;
+    uint64_t next_event_tick() const;
+    void insert(Timer& timer);
+    void unlink(Timer& timer);
+    void process_tick(std::function<void(Timer&)> const& expired);
+
+    Timestamp const origin;
+    Duration const granularity;
+    uint64_t current{0};
+    size_t count{0};
+    std::array<Level, levels> wheel;
+    Slot due;
+};
+
+}
+}
+
+#endif /* MIR_TIME_TIMER_WHEEL_H_ */
@@ -17,6 +17,7 @@
  */
 
 #include "mir/renderer/sw/pixel_source.h"
+#include "mir/renderer/sw/pixel_ops.h"
 
 #include <algorithm>
 #include <boost/throw_exception.hpp>
@@ -277,23 +278,12 @@ auto mrs::alloc_buffer_with_content(
     auto const buffer = allocator.alloc_software_buffer(size, src_format);
 
     auto mapping = as_write_mappable_buffer(buffer)->map_writeable();
-    if (mapping->stride() == src_stride)
-    {
-        // Happy case: Buffer is packed, like the cursor_image; we can just blit.
-        ::memcpy(mapping->data(), content, mapping->len());
-    }
-    else
-    {
-        // Less happy path: the buffer has a different stride; we need to copy row-by-row
-        auto const dest_stride = mapping->stride().as_uint32_t();
-        for (auto y = 0u; y < size.height.as_uint32_t(); ++y)
-        {
-            ::memcpy(
-                mapping->data() + (dest_stride * y),
-                content + (src_stride.as_uint32_t() * y),
-                src_stride.as_uint32_t());
-        }
-    }
+    // A packed buffer (like the cursor_image) is copied in one go; otherwise row-by-row
+    mrs::copy_rows(
+        content, src_stride,
+        mapping->data(), mapping->stride(),
+        std::min(src_stride.as_uint32_t(), mapping->stride().as_uint32_t()),
+        size.height.as_uint32_t());
     return buffer;
 }
 
@@ -0,0 +1,648 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/renderer/sw/pixel_ops.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIR_PIXEL_OPS_X86
+#elif defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define MIR_PIXEL_OPS_NEON
+#endif
+
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+/*
+ * Each instruction set provides the same small set of kernels; the vector
+ * kernels handle whole vectors and leave any remainder to the generic ones.
+ */
+struct Kernels
+{
+    char const* name;
+    void (*swap_red_blue)(uint32_t const* src, uint32_t* dst, size_t count);
+    void (*premultiply_alpha)(uint32_t const* src, uint32_t* dst, size_t count);
+    void (*blend_over)(uint32_t const* src, uint32_t* dst, size_t count, uint32_t opacity, uint32_t alpha_mask);
+    void (*fill)(uint32_t* dst, size_t count, uint32_t value);
+    /// Exchanges the contents of a and b, swapping red and blue on request
+    void (*exchange)(uint32_t* a, uint32_t* b, size_t count, bool swap_red_and_blue);
+};
+
+inline auto swizzle(uint32_t pixel) -> uint32_t
+{
+    return (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+}
+
+// Rounds c*a/255 correctly for all 8-bit inputs
+inline auto multiply_channel(uint32_t c, uint32_t a) -> uint32_t
+{
+    auto const t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+void generic_swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dst[i] = swizzle(src[i]);
+}
+
+void generic_premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const pixel = src[i];
+        auto const alpha = pixel >> 24;
+        dst[i] = (alpha << 24) |
+            (multiply_channel((pixel >> 16) & 0xff, alpha) << 16) |
+            (multiply_channel((pixel >> 8) & 0xff, alpha) << 8) |
+            multiply_channel(pixel & 0xff, alpha);
+    }
+}
+
+/*
+ * The blend kernels OR alpha_mask into each source pixel, which is how an
+ * opaque source has its alpha channel ignored.
+ */
+void generic_blend_over(uint32_t const* src, uint32_t* dst, size_t count, uint32_t opacity, uint32_t alpha_mask)
+{
+    if (opacity == 255 && alpha_mask)
+    {
+        // Nothing shows through, so this is just a copy
+        for (size_t i = 0; i != count; ++i)
+            dst[i] = src[i] | alpha_mask;
+        return;
+    }
+
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const source = src[i] | alpha_mask;
+        auto const destination = dst[i];
+        auto const source_alpha = multiply_channel(source >> 24, opacity);
+
+        uint32_t result = 0;
+        for (int shift = 0; shift != 32; shift += 8)
+        {
+            auto const channel =
+                multiply_channel((source >> shift) & 0xff, opacity) +
+                multiply_channel((destination >> shift) & 0xff, 255 - source_alpha);
+            result |= std::min(channel, 255u) << shift;
+        }
+        dst[i] = result;
+    }
+}
+
+void generic_fill(uint32_t* dst, size_t count, uint32_t value)
+{
+    std::fill_n(dst, count, value);
+}
+
+void generic_exchange(uint32_t* a, uint32_t* b, size_t count, bool swap_red_and_blue)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const from_a = a[i];
+        auto const from_b = b[i];
+        a[i] = swap_red_and_blue ? swizzle(from_b) : from_b;
+        b[i] = swap_red_and_blue ? swizzle(from_a) : from_a;
+    }
+}
+
+Kernels const generic_kernels{
+    "generic",
+    &generic_swap_red_blue,
+    &generic_premultiply_alpha,
+    &generic_blend_over,
+    &generic_fill,
+    &generic_exchange};
+
+#if defined(MIR_PIXEL_OPS_X86) && defined(__SSE2__)
+inline auto sse2_swizzle(__m128i pixels) -> __m128i
+{
+    auto const green_alpha = _mm_set1_epi32(0xff00ff00);
+    auto const blue = _mm_set1_epi32(0x000000ff);
+    return _mm_or_si128(
+        _mm_and_si128(pixels, green_alpha),
+        _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(pixels, 16), blue),
+            _mm_slli_epi32(_mm_and_si128(pixels, blue), 16)));
+}
+
+// Divides each 16-bit t = x*y by 255, rounding as multiply_channel() does
+inline auto sse2_divide_by_255(__m128i t) -> __m128i
+{
+    t = _mm_add_epi16(t, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// Blends eight 16-bit channels (two pixels) of source over destination
+inline auto sse2_blend_pair(__m128i source, __m128i destination, __m128i opacity) -> __m128i
+{
+    source = sse2_divide_by_255(_mm_mullo_epi16(source, opacity));
+    auto const source_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xff), 0xff);
+    auto const remaining = _mm_sub_epi16(_mm_set1_epi16(255), source_alpha);
+    return _mm_add_epi16(source, sse2_divide_by_255(_mm_mullo_epi16(destination, remaining)));
+}
+
+// Multiplies eight 16-bit channels (two pixels) by their pixel's alpha
+inline auto sse2_premultiply_pair(__m128i channels) -> __m128i
+{
+    auto const alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, 0xff), 0xff);
+    // Leave alpha itself unchanged by multiplying it by 255
+    alpha = _mm_or_si128(
+        _mm_andnot_si128(alpha_lanes, alpha),
+        _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+
+    return sse2_divide_by_255(_mm_mullo_epi16(channels, alpha));
+}
+
+void sse2_swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), sse2_swizzle(pixels));
+    }
+    generic_swap_red_blue(src + i, dst + i, count - i);
+}
+
+void sse2_premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    auto const zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        auto const low = sse2_premultiply_pair(_mm_unpacklo_epi8(pixels, zero));
+        auto const high = sse2_premultiply_pair(_mm_unpackhi_epi8(pixels, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+    generic_premultiply_alpha(src + i, dst + i, count - i);
+}
+
+void sse2_blend_over(uint32_t const* src, uint32_t* dst, size_t count, uint32_t opacity, uint32_t alpha_mask)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const opacities = _mm_set1_epi16(opacity);
+    auto const mask = _mm_set1_epi32(alpha_mask);
+    size_t i = 0;
+    if (opacity == 255 && alpha_mask)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            auto const source = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(source, mask));
+        }
+    }
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const source = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)), mask);
+        auto const destination = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        auto const low = sse2_blend_pair(
+            _mm_unpacklo_epi8(source, zero), _mm_unpacklo_epi8(destination, zero), opacities);
+        auto const high = sse2_blend_pair(
+            _mm_unpackhi_epi8(source, zero), _mm_unpackhi_epi8(destination, zero), opacities);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+    generic_blend_over(src + i, dst + i, count - i, opacity, alpha_mask);
+}
+
+void sse2_fill(uint32_t* dst, size_t count, uint32_t value)
+{
+    auto const pixels = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), pixels);
+    generic_fill(dst + i, count - i, value);
+}
+
+void sse2_exchange(uint32_t* a, uint32_t* b, size_t count, bool swap_red_and_blue)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto from_a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+        auto from_b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+        if (swap_red_and_blue)
+        {
+            from_a = sse2_swizzle(from_a);
+            from_b = sse2_swizzle(from_b);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), from_b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b + i), from_a);
+    }
+    generic_exchange(a + i, b + i, count - i, swap_red_and_blue);
+}
+
+Kernels const sse2_kernels{
+    "sse2",
+    &sse2_swap_red_blue,
+    &sse2_premultiply_alpha,
+    &sse2_blend_over,
+    &sse2_fill,
+    &sse2_exchange};
+#endif
+
+#if defined(MIR_PIXEL_OPS_X86)
+#define MIR_AVX2 __attribute__((target("avx2")))
+
+MIR_AVX2 inline auto avx2_swizzle(__m256i pixels) -> __m256i
+{
+    auto const order = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    return _mm256_shuffle_epi8(pixels, order);
+}
+
+MIR_AVX2 inline auto avx2_divide_by_255(__m256i t) -> __m256i
+{
+    t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+MIR_AVX2 inline auto avx2_blend_pairs(__m256i source, __m256i destination, __m256i opacity) -> __m256i
+{
+    source = avx2_divide_by_255(_mm256_mullo_epi16(source, opacity));
+    auto const source_alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source, 0xff), 0xff);
+    auto const remaining = _mm256_sub_epi16(_mm256_set1_epi16(255), source_alpha);
+    return _mm256_add_epi16(source, avx2_divide_by_255(_mm256_mullo_epi16(destination, remaining)));
+}
+
+MIR_AVX2 inline auto avx2_premultiply_pairs(__m256i channels) -> __m256i
+{
+    auto const alpha_lanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    auto alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(channels, 0xff), 0xff);
+    alpha = _mm256_blendv_epi8(alpha, _mm256_set1_epi16(255), alpha_lanes);
+
+    return avx2_divide_by_255(_mm256_mullo_epi16(channels, alpha));
+}
+
+MIR_AVX2 void avx2_swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), avx2_swizzle(pixels));
+    }
+    generic_swap_red_blue(src + i, dst + i, count - i);
+}
+
+MIR_AVX2 void avx2_premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    auto const zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // Unpacking and packing both work within 128-bit lanes, so pixel order is preserved
+        auto const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        auto const low = avx2_premultiply_pairs(_mm256_unpacklo_epi8(pixels, zero));
+        auto const high = avx2_premultiply_pairs(_mm256_unpackhi_epi8(pixels, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+    }
+    generic_premultiply_alpha(src + i, dst + i, count - i);
+}
+
+MIR_AVX2 void avx2_blend_over(
+    uint32_t const* src, uint32_t* dst, size_t count, uint32_t opacity, uint32_t alpha_mask)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const opacities = _mm256_set1_epi16(opacity);
+    auto const mask = _mm256_set1_epi32(alpha_mask);
+    size_t i = 0;
+    if (opacity == 255 && alpha_mask)
+    {
+        for (; i + 8 <= count; i += 8)
+        {
+            auto const source = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(source, mask));
+        }
+    }
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const source = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i)), mask);
+        auto const destination = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        auto const low = avx2_blend_pairs(
+            _mm256_unpacklo_epi8(source, zero), _mm256_unpacklo_epi8(destination, zero), opacities);
+        auto const high = avx2_blend_pairs(
+            _mm256_unpackhi_epi8(source, zero), _mm256_unpackhi_epi8(destination, zero), opacities);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+    }
+    generic_blend_over(src + i, dst + i, count - i, opacity, alpha_mask);
+}
+
+MIR_AVX2 void avx2_fill(uint32_t* dst, size_t count, uint32_t value)
+{
+    auto const pixels = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), pixels);
+    generic_fill(dst + i, count - i, value);
+}
+
+MIR_AVX2 void avx2_exchange(uint32_t* a, uint32_t* b, size_t count, bool swap_red_and_blue)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto from_a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        auto from_b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        if (swap_red_and_blue)
+        {
+            from_a = avx2_swizzle(from_a);
+            from_b = avx2_swizzle(from_b);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), from_b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i), from_a);
+    }
+    generic_exchange(a + i, b + i, count - i, swap_red_and_blue);
+}
+
+#undef MIR_AVX2
+
+Kernels const avx2_kernels{
+    "avx2",
+    &avx2_swap_red_blue,
+    &avx2_premultiply_alpha,
+    &avx2_blend_over,
+    &avx2_fill,
+    &avx2_exchange};
+#endif
+
+#if defined(MIR_PIXEL_OPS_NEON)
+void neon_swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        auto pixels = vld4q_u8(reinterpret_cast<uint8_t const*>(src + i));
+        std::swap(pixels.val[0], pixels.val[2]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i), pixels);
+    }
+    generic_swap_red_blue(src + i, dst + i, count - i);
+}
+
+inline auto neon_multiply_channel(uint8x16_t c, uint8x16_t a) -> uint8x16_t
+{
+    auto const rounding = vdupq_n_u16(128);
+    auto const low = vaddq_u16(vmull_u8(vget_low_u8(c), vget_low_u8(a)), rounding);
+    auto const high = vaddq_u16(vmull_u8(vget_high_u8(c), vget_high_u8(a)), rounding);
+    return vcombine_u8(
+        vaddhn_u16(low, vshrq_n_u16(low, 8)),
+        vaddhn_u16(high, vshrq_n_u16(high, 8)));
+}
+
+void neon_premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        auto pixels = vld4q_u8(reinterpret_cast<uint8_t const*>(src + i));
+        for (int channel = 0; channel != 3; ++channel)
+            pixels.val[channel] = neon_multiply_channel(pixels.val[channel], pixels.val[3]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i), pixels);
+    }
+    generic_premultiply_alpha(src + i, dst + i, count - i);
+}
+
+void neon_blend_over(uint32_t const* src, uint32_t* dst, size_t count, uint32_t opacity, uint32_t alpha_mask)
+{
+    auto const opacities = vdupq_n_u8(opacity);
+    auto const forced_alpha = vdupq_n_u8(alpha_mask >> 24);
+    size_t i = 0;
+    if (opacity == 255 && alpha_mask)
+    {
+        auto const mask = vdupq_n_u32(alpha_mask);
+        for (; i + 4 <= count; i += 4)
+            vst1q_u32(dst + i, vorrq_u32(vld1q_u32(src + i), mask));
+    }
+    for (; i + 16 <= count; i += 16)
+    {
+        auto source = vld4q_u8(reinterpret_cast<uint8_t const*>(src + i));
+        auto destination = vld4q_u8(reinterpret_cast<uint8_t const*>(dst + i));
+        source.val[3] = vorrq_u8(source.val[3], forced_alpha);
+
+        auto const source_alpha = neon_multiply_channel(source.val[3], opacities);
+        auto const remaining = vmvnq_u8(source_alpha);
+        for (int channel = 0; channel != 4; ++channel)
+        {
+            destination.val[channel] = vqaddq_u8(
+                neon_multiply_channel(source.val[channel], opacities),
+                neon_multiply_channel(destination.val[channel], remaining));
+        }
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i), destination);
+    }
+    generic_blend_over(src + i, dst + i, count - i, opacity, alpha_mask);
+}
+
+void neon_fill(uint32_t* dst, size_t count, uint32_t value)
+{
+    auto const pixels = vdupq_n_u32(value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(dst + i, pixels);
+    generic_fill(dst + i, count - i, value);
+}
+
+void neon_exchange(uint32_t* a, uint32_t* b, size_t count, bool swap_red_and_blue)
+{
+    if (!swap_red_and_blue)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto const from_a = vld1q_u32(a + i);
+            auto const from_b = vld1q_u32(b + i);
+            vst1q_u32(a + i, from_b);
+            vst1q_u32(b + i, from_a);
+        }
+        generic_exchange(a + i, b + i, count - i, false);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        auto from_a = vld4q_u8(reinterpret_cast<uint8_t const*>(a + i));
+        auto from_b = vld4q_u8(reinterpret_cast<uint8_t const*>(b + i));
+        std::swap(from_a.val[0], from_a.val[2]);
+        std::swap(from_b.val[0], from_b.val[2]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(a + i), from_b);
+        vst4q_u8(reinterpret_cast<uint8_t*>(b + i), from_a);
+    }
+    generic_exchange(a + i, b + i, count - i, true);
+}
+
+Kernels const neon_kernels{
+    "neon",
+    &neon_swap_red_blue,
+    &neon_premultiply_alpha,
+    &neon_blend_over,
+    &neon_fill,
+    &neon_exchange};
+#endif
+
+auto select_kernels() -> Kernels const&
+{
+#if defined(MIR_PIXEL_OPS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return avx2_kernels;
+#endif
+#if defined(MIR_PIXEL_OPS_X86) && defined(__SSE2__)
+    return sse2_kernels;
+#elif defined(MIR_PIXEL_OPS_NEON)
+    return neon_kernels;
+#else
+    return generic_kernels;
+#endif
+}
+
+auto kernels() -> Kernels const&
+{
+    static Kernels const& selected = select_kernels();
+    return selected;
+}
+}
+
+void mrs::swap_red_blue(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    kernels().swap_red_blue(src, dst, count);
+}
+
+void mrs::premultiply_alpha(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    kernels().premultiply_alpha(src, dst, count);
+}
+
+void mrs::blend_over(
+    uint32_t const* src, uint32_t* dst, size_t count,
+    uint8_t opacity, bool source_is_opaque)
+{
+    kernels().blend_over(src, dst, count, opacity, source_is_opaque ? 0xff000000 : 0);
+}
+
+void mrs::fill_pixels(uint32_t* dst, size_t count, uint32_t value)
+{
+    kernels().fill(dst, count, value);
+}
+
+void mrs::copy_rows(
+    unsigned char const* src, geom::Stride src_stride,
+    unsigned char* dst, geom::Stride dst_stride,
+    size_t row_bytes, size_t rows)
+{
+    // memcpy() is already vectorised; the win here is avoiding per-row calls where possible
+    if (src_stride == dst_stride && src_stride.as_uint32_t() == row_bytes)
+    {
+        ::memcpy(dst, src, row_bytes * rows);
+        return;
+    }
+
+    for (size_t y = 0; y != rows; ++y)
+    {
+        ::memcpy(dst, src, row_bytes);
+        src += src_stride.as_uint32_t();
+        dst += dst_stride.as_uint32_t();
+    }
+}
+
+void mrs::flip_rows(
+    unsigned char* pixels, geom::Stride stride,
+    size_t width, size_t height, bool swap_red_and_blue)
+{
+    auto const& selected = kernels();
+    auto row = [pixels, stride](size_t y)
+        {
+            return reinterpret_cast<uint32_t*>(pixels + y * stride.as_uint32_t());
+        };
+
+    for (size_t top = 0, bottom = height; top + 1 < bottom; ++top)
+    {
+        --bottom;
+        selected.exchange(row(top), row(bottom), width, swap_red_and_blue);
+    }
+
+    if (swap_red_and_blue && height % 2)
+    {
+        auto const middle = row(height / 2);
+        selected.swap_red_blue(middle, middle, width);
+    }
+}
+
+void mrs::scale_pixels(
+    uint32_t const* src, geom::Size src_size, geom::Stride src_stride,
+    uint32_t* dst, geom::Size dst_size, geom::Stride dst_stride)
+{
+    auto const src_width = src_size.width.as_uint32_t();
+    auto const src_height = src_size.height.as_uint32_t();
+    auto const dst_width = dst_size.width.as_uint32_t();
+    auto const dst_height = dst_size.height.as_uint32_t();
+
+    if (!src_width || !src_height || !dst_width || !dst_height)
+        return;
+
+    auto const src_row = [src, src_stride](size_t y)
+        {
+            return reinterpret_cast<uint32_t const*>(
+                reinterpret_cast<unsigned char const*>(src) + y * src_stride.as_uint32_t());
+        };
+    auto const dst_row = [dst, dst_stride](size_t y)
+        {
+            return reinterpret_cast<uint32_t*>(
+                reinterpret_cast<unsigned char*>(dst) + y * dst_stride.as_uint32_t());
+        };
+
+    // Sample at pixel centres, so that scaling by an integer factor replicates pixels exactly
+    std::vector<uint32_t> columns(dst_width);
+    for (uint32_t x = 0; x != dst_width; ++x)
+        columns[x] = (uint64_t{2} * x + 1) * src_width / (uint64_t{2} * dst_width);
+
+    uint32_t previous_source_row = src_height;
+    for (uint32_t y = 0; y != dst_height; ++y)
+    {
+        auto const source_row = static_cast<uint32_t>(
+            (uint64_t{2} * y + 1) * src_height / (uint64_t{2} * dst_height));
+
+        if (source_row == previous_source_row)
+        {
+            // Upscaling repeats rows; copying the row we just produced is cheaper than resampling
+            ::memcpy(dst_row(y), dst_row(y - 1), dst_width * sizeof(uint32_t));
+            continue;
+        }
+
+        auto const in = src_row(source_row);
+        auto const out = dst_row(y);
+        for (uint32_t x = 0; x != dst_width; ++x)
+            out[x] = in[columns[x]];
+
+        previous_source_row = source_row;
+    }
+}
+
+auto mrs::pixel_ops_implementation() -> char const*
+{
+    return kernels().name;
+}
@@ -48,12 +48,18 @@ char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::renderer_opt                = "renderer";
+char const* const mo::compositor_threads_opt      = "compositor-threads";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
+char const* const mo::resample_input_opt          = "resample-input";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
 char const* const mo::add_wayland_extensions_opt  = "add-wayland-extensions";
 char const* const mo::drop_wayland_extensions_opt = "drop-wayland-extensions";
 char const* const mo::enable_mirclient_opt        = "enable-mirclient";
+char const* const mo::client_surface_quota_opt    = "client-surface-quota";
+char const* const mo::client_buffer_memory_quota_opt = "client-buffer-memory-quota";
+char const* const mo::client_frame_callback_quota_opt = "client-frame-callback-quota";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
@@ -184,6 +190,15 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (renderer_opt, po::value<std::string>()->default_value("gl"),
+            "Renderer to composite with [{gl,software}]. The software renderer "
+            "is used on outputs that only support it regardless of this option.")
+        (compositor_threads_opt, po::value<int>()->default_value(-1),
+            "Number of additional threads each output may use to render parts "
+            "of a frame in parallel, where the renderer supports it (currently "
+            "the software renderer). 0 renders each output on its compositor "
+            "thread alone. Default: A negative value means one fewer than the "
+            "number of CPU cores.")
         (offscreen_opt,
             "Render to offscreen buffers instead of the real outputs.")
         (touchspots_opt,
@@ -193,6 +208,20 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Cursor (mouse pointer) to use [{auto,null,software}]")
         (enable_key_repeat_opt, po::value<bool>()->default_value(true),
              "Enable server generated key repeat")
+        (resample_input_opt, po::value<bool>()->default_value(false),
+             "Deliver pointer and touch motion once per display frame, "
+             "resampled to a common point in time, instead of as it arrives "
+             "from the device")
+        (client_surface_quota_opt, po::value<std::string>(),
+            "Limit on the number of surfaces each client may hold, as SOFT[:HARD]. "
+            "Exceeding the soft limit is logged, and exceeding the hard limit disconnects "
+            "the client. 0 or unset means no limit.")
+        (client_buffer_memory_quota_opt, po::value<std::string>(),
+            "Limit on the memory, in MiB, of the buffers each client has committed to its "
+            "surfaces, as SOFT[:HARD]. See --client-surface-quota.")
+        (client_frame_callback_quota_opt, po::value<std::string>(),
+            "Limit on the number of frame callbacks each client may have waiting, "
+            "as SOFT[:HARD]. See --client-surface-quota.")
         (fatal_except_opt, "On \"fatal error\" conditions [e.g. drivers behaving "
             "in unexpected ways] throw an exception (instead of a core dump)")
         (debug_opt, "Enable extra development debugging. "
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpu_copy_bypass.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <algorithm>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+auto mgc::cpu_copy_bypass_candidate(
+    RenderableList const& renderables,
+    geom::Rectangle const& view_area,
+    glm::mat2 const& output_transform,
+    geom::Size const& output_size) -> std::shared_ptr<Buffer>
+{
+    if (output_transform != glm::mat2(1))
+        return nullptr;
+
+    auto const top = std::find_if(renderables.rbegin(), renderables.rend(), [&](auto const& renderable)
+        { return view_area.overlaps(renderable->screen_position()); });
+
+    if (top == renderables.rend())
+        return nullptr;
+
+    auto const& renderable = *top;
+    auto const buffer = renderable->buffer();
+    if (!buffer)
+        return nullptr;
+
+    glm::mat4 const identity(1);
+    auto const source = renderable->source_rect();
+    auto const clip = renderable->clip_area();
+
+    // The same conditions as for bypass on KMS, plus being readable by the CPU
+    if (renderable->alpha() != 1.0f || renderable->shaped() ||
+        renderable->screen_position() != view_area ||
+        renderable->transformation() != identity ||
+        (source && *source != geom::Rectangle{{0, 0}, buffer->size()}) ||
+        (clip && !clip->contains(view_area)) ||
+        buffer->size() != output_size ||
+        buffer->pixel_format() != mir_pixel_format_xrgb_8888 ||
+        !dynamic_cast<mrs::ReadMappableBuffer*>(buffer->native_buffer_base()))
+    {
+        return nullptr;
+    }
+
+    return buffer;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_CPU_COPY_BYPASS_H_
+#define MIR_GRAPHICS_COMMON_CPU_COPY_BYPASS_H_
+
+#include "mir/graphics/renderable.h"
+#include "mir/geometry/rectangle.h"
+
+#include <glm/glm.hpp>
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+
+namespace common
+{
+/**
+ * The client buffer a hosted output can show without compositing, if there is one
+ *
+ * That is the topmost renderable, if it exactly covers an untransformed output with an
+ * opaque, untransformed XRGB8888 buffer the CPU can read. Platforms that draw into a
+ * host window (X11, Wayland) still copy its pixels to the host: what bypass saves them
+ * is the GL composite, the texture upload and the swap.
+ */
+auto cpu_copy_bypass_candidate(
+    RenderableList const& renderables,
+    geometry::Rectangle const& view_area,
+    glm::mat2 const& output_transform,
+    geometry::Size const& output_size) -> std::shared_ptr<Buffer>;
+}
+}
+}
+
+#endif // MIR_GRAPHICS_COMMON_CPU_COPY_BYPASS_H_
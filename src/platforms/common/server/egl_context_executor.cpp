@@ -19,58 +19,143 @@
 #include "egl_context_executor.h"
 #include "mir/renderer/gl/context.h"
 
+#define MIR_LOG_COMPONENT "gfx-common"
+#include "mir/log.h"
+
+#include <vector>
+
 namespace mgc = mir::graphics::common;
 
+namespace
+{
+template<typename T>
+void raise_to(std::atomic<T>& maximum, T value)
+{
+    auto current = maximum.load();
+    while (value > current && !maximum.compare_exchange_weak(current, value))
+    {
+    }
+}
+}
+
+class mgc::EGLContextExecutor::Worker
+{
+public:
+    Worker(EGLContextExecutor* executor, std::unique_ptr<mir::renderer::gl::Context> context)
+        : executor{executor},
+          ctx{std::move(context)},
+          egl_thread{[this] { process_loop(); }}
+    {
+    }
+
+    ~Worker() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            shutdown_requested = true;
+        }
+        new_work.notify_one();
+        egl_thread.join();
+    }
+
+    void enqueue(Work&& work)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            work_queue.push_back(std::move(work));
+        }
+        new_work.notify_one();
+    }
+
+private:
+    void process_loop()
+    {
+        ctx->make_current();
+
+        std::vector<Work> batch;
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!shutdown_requested || !work_queue.empty())
+        {
+            new_work.wait(lock, [this] { return shutdown_requested || !work_queue.empty(); });
+
+            // Take the whole queue, so spawn() can carry on while this batch runs
+            batch.swap(work_queue);
+            lock.unlock();
+
+            for (auto& work : batch)
+                executor->run(work);
+            // …and ensure any functor cleanup happens with the EGL context current, too.
+            batch.clear();
+
+            lock.lock();
+        }
+
+        ctx->release_current();
+    }
+
+    EGLContextExecutor* const executor;
+    std::unique_ptr<mir::renderer::gl::Context> const ctx;
+
+    std::mutex mutex;
+    std::condition_variable new_work;
+    std::vector<Work> work_queue;
+    bool shutdown_requested{false};
+
+    std::thread egl_thread;
+};
+
 mgc::EGLContextExecutor::EGLContextExecutor(
     std::unique_ptr<mir::renderer::gl::Context> context)
-    : ctx{std::move(context)},
-      egl_thread(std::thread{process_loop, this})
+    : worker{std::make_unique<Worker>(this, std::move(context))}
 {
 }
 
 mgc::EGLContextExecutor::~EGLContextExecutor() noexcept
 {
+    // The worker drains its queue before its thread exits
+    worker.reset();
+
+    auto const summary = statistics();
+    if (summary.completed)
     {
-        std::lock_guard<std::mutex> lock{mutex};
-        shutdown_requested = true;
+        using ms = std::chrono::duration<double, std::milli>;
+        mir::log_debug(
+            "Ran %llu GL jobs, at most %zu queued; they waited %.3fms on average, at most %.3fms",
+            static_cast<unsigned long long>(summary.completed),
+            summary.max_queue_depth,
+            ms{summary.mean_latency}.count(),
+            ms{summary.max_latency}.count());
     }
-    new_work.notify_all();
-    egl_thread.join();
 }
 
 void mgc::EGLContextExecutor::spawn(
     std::function<void()>&& functor)
 {
-    {
-        std::lock_guard<std::mutex> lock{mutex};
-        work_queue.emplace_back(std::move(functor));
-    }
-    new_work.notify_all();
+    raise_to(max_queue_depth, ++queue_depth);
+    worker->enqueue(Work{std::move(functor), std::chrono::steady_clock::now()});
 }
 
-void mgc::EGLContextExecutor::process_loop(mgc::EGLContextExecutor* const me)
+auto mgc::EGLContextExecutor::statistics() const -> Statistics
 {
-    me->ctx->make_current();
+    auto const count = completed.load();
+    return Statistics{
+        queue_depth.load(),
+        max_queue_depth.load(),
+        count,
+        std::chrono::nanoseconds{count ? total_latency_ns.load() / static_cast<int64_t>(count) : 0},
+        std::chrono::nanoseconds{max_latency_ns.load()}};
+}
 
-    std::unique_lock<std::mutex> lock{me->mutex};
-    while (!me->shutdown_requested)
-    {
-        for (auto& work : me->work_queue)
-        {
-            work();
-        }
-        me->work_queue.clear();
+void mgc::EGLContextExecutor::run(Work& work)
+{
+    auto const latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - work.spawned).count();
 
-        me->new_work.wait(lock);
-    }
+    total_latency_ns += latency;
+    raise_to(max_latency_ns, static_cast<int64_t>(latency));
 
-    // Drain the work-queue
-    for (auto& work : me->work_queue)
-    {
-        work();
-    }
-    // …and ensure any functor cleanup happens with the EGL context current, too.
-    me->work_queue.clear();
+    work.functor();
 
-    me->ctx->release_current();
+    ++completed;
+    --queue_depth;
 }
@@ -21,12 +21,12 @@
 
 #include "mir/executor.h"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
-#include <future>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
-#include <vector>
 
 namespace mir
 {
@@ -42,6 +42,13 @@ namespace graphics
 {
 namespace common
 {
+/**
+ * Runs functors on a thread with a current EGL context
+ *
+ * Queued work is swapped out and run without holding the queue lock, so
+ * spawn() never waits for GL work. A summary of the statistics() is logged
+ * when the executor is destroyed.
+ */
 class EGLContextExecutor : public Executor
 {
 public:
@@ -52,16 +59,36 @@ public:
      * Run a run a function on a thread with a current EGL context
      */
     void spawn(std::function<void()>&& functor) override;
+
+    struct Statistics
+    {
+        size_t queue_depth;                     ///< Work spawned but not yet finished
+        size_t max_queue_depth;
+        uint64_t completed;
+        std::chrono::nanoseconds mean_latency;  ///< From spawn() to the work starting
+        std::chrono::nanoseconds max_latency;
+    };
+
+    auto statistics() const -> Statistics;
+
 private:
-    static void process_loop(EGLContextExecutor* const me);
+    struct Work
+    {
+        std::function<void()> functor;
+        std::chrono::steady_clock::time_point spawned;
+    };
+
+    class Worker;
+
+    void run(Work& work);
 
-    std::unique_ptr<renderer::gl::Context> const ctx;
-    std::mutex mutex;
-    std::condition_variable new_work;
-    std::vector<std::function<void()>> work_queue;
-    bool shutdown_requested{false};
+    std::atomic<size_t> queue_depth{0};
+    std::atomic<size_t> max_queue_depth{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<int64_t> total_latency_ns{0};
+    std::atomic<int64_t> max_latency_ns{0};
 
-    std::thread egl_thread;
+    std::unique_ptr<Worker> worker;
 };
 
 }
@@ -113,6 +113,11 @@ size_t mgk::DRMModeResources::num_connectors() const
     return resources->count_connectors;
 }
 
+std::vector<uint32_t> mgk::DRMModeResources::connector_ids() const
+{
+    return {resources->connectors, resources->connectors + resources->count_connectors};
+}
+
 size_t mgk::DRMModeResources::num_encoders() const
 {
     return resources->count_encoders;
@@ -156,6 +161,24 @@ mgk::DRMModeConnectorUPtr mgk::get_connector(int drm_fd, uint32_t id)
     return connector;
 }
 
+mgk::DRMModeConnectorUPtr mgk::get_connector_current(int drm_fd, uint32_t id)
+{
+    errno = 0;
+    DRMModeConnectorUPtr connector{drmModeGetConnectorCurrent(drm_fd, id), &drmModeFreeConnector};
+
+    if (!connector)
+    {
+        if (errno == 0)
+        {
+            // drmModeGetConnectorCurrent either sets errno, or has failed in malloc()
+            errno = ENOMEM;
+        }
+        BOOST_THROW_EXCEPTION((
+            std::system_error{errno, std::system_category(), "Failed to get DRM connector"}));
+    }
+    return connector;
+}
+
 mgk::DRMModeEncoderUPtr mgk::get_encoder(int drm_fd, uint32_t id)
 {
     errno = 0;
@@ -26,6 +26,7 @@
 #include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace mir
 {
@@ -44,6 +45,8 @@ typedef std::unique_ptr<drmModeObjectProperties,void(*)(drmModeObjectProperties*
 typedef std::unique_ptr<drmModePropertyRes,void(*)(drmModePropertyPtr)> DRMModePropertyUPtr;
 
 DRMModeConnectorUPtr get_connector(int drm_fd, uint32_t id);
+/// Like get_connector(), but returns what the kernel already knows instead of probing the connector again
+DRMModeConnectorUPtr get_connector_current(int drm_fd, uint32_t id);
 DRMModeEncoderUPtr get_encoder(int drm_fd, uint32_t id);
 DRMModeCrtcUPtr get_crtc(int drm_fd, uint32_t id);
 DRMModePlaneUPtr get_plane(int drm_fd, uint32_t id);
@@ -143,6 +146,7 @@ public:
     void for_each_crtc(std::function<void(DRMModeCrtcUPtr)> const& f) const;
 
     size_t num_connectors() const;
+    std::vector<uint32_t> connector_ids() const;
 
     size_t num_encoders() const;
 
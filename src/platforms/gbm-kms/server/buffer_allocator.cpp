@@ -306,6 +306,8 @@ void mgg::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    device,
+                    bypass_option == mgg::BypassOption::allowed,
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dmabuf_feedback.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/memfd.h>
+
+namespace mgg = mir::graphics::gbm;
+
+namespace
+{
+/**
+ * A read-only file holding \a size bytes of \a data, which is safe to share with every client
+ *
+ * The file is sealed, so that no client can modify or resize it even by reopening it
+ * through /proc.
+ */
+auto create_sealed_file(void const* data, size_t size) -> mir::Fd
+{
+    mir::Fd const file{static_cast<int>(
+        syscall(SYS_memfd_create, "mir-dmabuf-format-table", MFD_CLOEXEC | MFD_ALLOW_SEALING))};
+    if (file < 0)
+    {
+        BOOST_THROW_EXCEPTION((
+            std::system_error{errno, std::system_category(), "Failed to create format table"}));
+    }
+
+    for (size_t written = 0; written < size;)
+    {
+        auto const result = write(file, static_cast<char const*>(data) + written, size - written);
+        if (result < 0 && errno != EINTR)
+        {
+            BOOST_THROW_EXCEPTION((
+                std::system_error{errno, std::system_category(), "Failed to write format table"}));
+        }
+        written += std::max<ssize_t>(result, 0);
+    }
+
+    if (fcntl(file, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+    {
+        BOOST_THROW_EXCEPTION((
+            std::system_error{errno, std::system_category(), "Failed to seal format table"}));
+    }
+
+    // The seals already prevent writes, but clients have no business with a writable fd
+    auto const proc_path = "/proc/self/fd/" + std::to_string(static_cast<int>(file));
+    mir::Fd read_only{open(proc_path.c_str(), O_RDONLY | O_CLOEXEC)};
+    return read_only < 0 ? file : read_only;
+}
+}
+
+mgg::DmaBufFeedbackParameters::DmaBufFeedbackParameters(std::vector<DmaBufFormat> formats, dev_t main_device)
+    : formats{std::move(formats)},
+      main_device{main_device}
+{
+    // Table indices are only 16 bits wide
+    auto const max_entries = std::numeric_limits<uint16_t>::max() + 1u;
+
+    std::vector<FormatTableEntry> entries;
+    for (auto const& format : this->formats)
+    {
+        for (auto const modifier : format.modifiers)
+        {
+            if (entries.size() == max_entries)
+                break;
+
+            indices.push_back(static_cast<uint16_t>(entries.size()));
+            entries.push_back(FormatTableEntry{format.format, 0, modifier});
+        }
+    }
+
+    table_size = entries.size() * sizeof(FormatTableEntry);
+    table = create_sealed_file(entries.data(), table_size);
+}
+
+void mgg::DmaBufFeedbackParameters::send_formats(FormatSink& sink, uint32_t version) const
+{
+    // Version 4 replaces the format and modifier events with feedback objects
+    if (version >= 4)
+        return;
+
+    for (auto const& format : formats)
+    {
+        sink.format(format.format);
+
+        // Modifier events were introduced in version 3
+        if (version >= 3)
+        {
+            for (auto const modifier : format.modifiers)
+                sink.modifier(format.format, modifier);
+        }
+    }
+}
+
+void mgg::DmaBufFeedbackParameters::send_feedback(FeedbackSink& sink) const
+{
+    sink.format_table(table, table_size);
+    sink.main_device(main_device);
+    sink.tranche(main_device, 0, indices);
+    sink.done();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PLATFORM_GBM_KMS_DMABUF_FEEDBACK_H_
+#define MIR_PLATFORM_GBM_KMS_DMABUF_FEEDBACK_H_
+
+#include "mir/fd.h"
+
+#include <cstdint>
+#include <vector>
+#include <sys/types.h>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+/// A pixel format, and the modifiers we can import it with
+struct DmaBufFormat
+{
+    uint32_t format;
+    std::vector<uint64_t> modifiers;
+};
+
+/**
+ * What zwp_linux_dmabuf_v1 tells clients about the formats they can use
+ *
+ * Up to version 3 the formats are listed in format (and, from version 3, modifier)
+ * events. From version 4 they are sent to zwp_linux_dmabuf_feedback_v1 objects
+ * instead, which all share a single format table.
+ *
+ * There is a single tranche, of every format in the table. There is no scanout
+ * tranche: whether a surface's buffers can be scanned out depends on the scene, and
+ * there is nothing yet to tell the client when that changes.
+ */
+class DmaBufFeedbackParameters
+{
+public:
+    /// The format and modifier events of zwp_linux_dmabuf_v1
+    class FormatSink
+    {
+    public:
+        virtual ~FormatSink() = default;
+
+        virtual void format(uint32_t format) = 0;
+        virtual void modifier(uint32_t format, uint64_t modifier) = 0;
+    };
+
+    /// The events of zwp_linux_dmabuf_feedback_v1
+    class FeedbackSink
+    {
+    public:
+        virtual ~FeedbackSink() = default;
+
+        virtual void format_table(mir::Fd const& table, uint32_t size) = 0;
+        virtual void main_device(dev_t device) = 0;
+        virtual void tranche(dev_t target_device, uint32_t flags, std::vector<uint16_t> const& indices) = 0;
+        virtual void done() = 0;
+    };
+
+    /// An entry of the format table, as laid out by the protocol
+    struct FormatTableEntry
+    {
+        uint32_t format;
+        uint32_t padding;
+        uint64_t modifier;
+    };
+    static_assert(sizeof(FormatTableEntry) == 16, "zwp_linux_dmabuf_feedback_v1 table entries are 16 bytes");
+
+    /**
+     * \param formats       the formats we can import, in order of preference
+     * \param main_device   the device we import buffers with
+     */
+    DmaBufFeedbackParameters(std::vector<DmaBufFormat> formats, dev_t main_device);
+
+    /// Sends the formats to a zwp_linux_dmabuf_v1 of \a version, unless it uses feedback objects
+    void send_formats(FormatSink& sink, uint32_t version) const;
+    void send_feedback(FeedbackSink& sink) const;
+
+private:
+    std::vector<DmaBufFormat> const formats;
+    dev_t const main_device;
+    mir::Fd table;
+    uint32_t table_size;
+    std::vector<uint16_t> indices;
+};
+}
+}
+}
+
+#endif // MIR_PLATFORM_GBM_KMS_DMABUF_FEEDBACK_H_
@@ -18,6 +18,7 @@
 
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer.h"
 #include "bypass.h"
 
 using namespace mir;
@@ -43,6 +44,9 @@ bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
     auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
     auto const fits = (renderable->screen_position() == view_area);
     auto const is_orthogonal = (renderable->transformation() == identity);
-    bypass_is_feasible = (is_opaque && fits && is_orthogonal);
+    auto const source = renderable->source_rect();
+    auto const is_uncropped = !source ||
+        (*source == geometry::Rectangle{{0, 0}, renderable->buffer()->size()});
+    bypass_is_feasible = (is_opaque && fits && is_orthogonal && is_uncropped);
     return bypass_is_feasible;
 }
@@ -28,6 +28,8 @@
 
 #include <boost/exception/errinfo_errno.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <vector>
 
@@ -40,6 +42,10 @@ namespace
 const uint64_t fallback_cursor_size = 64;
 char const* const mir_drm_cursor_64x64 = "MIR_DRM_CURSOR_64x64";
 
+// Enough for the handful of cursors a session switches between (arrow, text beam, resize, ...)
+size_t const cached_images = 8;
+size_t const buffers_per_output = 4;
+
 // Transforms a relative position within the display bounds described by \a rect which is rotated with \a orientation
 geom::Displacement transform(geom::Rectangle const& rect, geom::Displacement const& vector, MirOrientation orientation)
 {
@@ -99,7 +105,7 @@ gbm_device* gbm_create_device_checked(int fd)
 }
 }
 
-mgg::Cursor::GBMBOWrapper::GBMBOWrapper(int fd, MirOrientation orientation) :
+mgg::Cursor::GBMBOWrapper::GBMBOWrapper(int fd) :
     device{gbm_create_device_checked(fd)},
     buffer{
         gbm_bo_create(
@@ -107,8 +113,7 @@ mgg::Cursor::GBMBOWrapper::GBMBOWrapper(int fd, MirOrientation orientation) :
             get_drm_cursor_width(fd),
             get_drm_cursor_height(fd),
             GBM_FORMAT_ARGB8888,
-            GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE)},
-    current_orientation{orientation}
+            GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE)}
 {
     if (!buffer) BOOST_THROW_EXCEPTION(std::runtime_error("failed to create gbm-kms buffer"));
 }
@@ -127,21 +132,26 @@ inline mgg::Cursor::GBMBOWrapper::~GBMBOWrapper()
 }
 
 mgg::Cursor::GBMBOWrapper::GBMBOWrapper(GBMBOWrapper&& from)
-    : device{from.device},
+    : last_used{from.last_used},
+      device{from.device},
       buffer{from.buffer},
-      current_orientation{from.current_orientation}
+      content_image{from.content_image},
+      content_orientation{from.content_orientation}
 {
     from.buffer = nullptr;
     from.device = nullptr;
 }
 
-auto mir::graphics::gbm::Cursor::GBMBOWrapper::change_orientation(MirOrientation new_orientation) -> bool
+void mgg::Cursor::GBMBOWrapper::set_content(uint64_t image, MirOrientation orientation)
 {
-    if (current_orientation == new_orientation)
-        return false;
+    content_image = image;
+    content_orientation = orientation;
+}
 
-    current_orientation = new_orientation;
-    return true;
+mgg::Cursor::OutputBuffers::OutputBuffers(int drm_fd) :
+    drm_fd{drm_fd}
+{
+    buffers.push_back(std::make_unique<GBMBOWrapper>(drm_fd));
 }
 
 mgg::Cursor::Cursor(
@@ -162,7 +172,7 @@ mgg::Cursor::Cursor(
                 [this, &kms_conf](auto const& output)
                 {
                     // I'm not sure why g++ needs the explicit "this->" but it does - alan_g
-                    this->buffer_for_output(*kms_conf.get_output_for(output.id));
+                    this->buffers_for_output(*kms_conf.get_output_for(output.id));
                 });
         });
 
@@ -192,9 +202,11 @@ void mgg::Cursor::write_buffer_data_locked(
 
 void mgg::Cursor::pad_and_write_image_data_locked(
     std::lock_guard<std::mutex> const& lg,
-    GBMBOWrapper& buffer)
+    GBMBOWrapper& buffer,
+    MirOrientation orientation)
 {
-    auto const orientation = buffer.orientation();
+    auto const& image = images.front();
+    auto const size = image.size;
     bool const sideways = orientation == mir_orientation_left || orientation == mir_orientation_right;
 
     auto const min_width  = sideways ? min_buffer_width : min_buffer_height;
@@ -212,7 +224,7 @@ void mgg::Cursor::pad_and_write_image_data_locked(
     size_t rhs_padding = buffer_stride - 4*image_width;
 
     auto const filler = 0; // 0x3f; is useful to make buffer visible for debugging
-    uint8_t const* src = argb8888.data();
+    uint8_t const* src = image.argb8888.data();
     uint8_t* dest = &padded[0];
 
     switch (orientation)
@@ -280,17 +292,27 @@ void mgg::Cursor::show(CursorImage const& cursor_image)
     std::lock_guard<std::mutex> lg(guard);
 
     size = cursor_image.size();
+    hotspot = cursor_image.hotspot();
 
-    argb8888.resize(size.width.as_uint32_t() * size.height.as_uint32_t() * 4);
-    memcpy(argb8888.data(), cursor_image.as_argb_8888(), argb8888.size());
+    // Showing an image we've shown recently is common (text beam <-> arrow <-> resize), so recognise it by
+    // its pixels and keep the buffers that already hold it padded and rotated
+    auto const pixels = static_cast<uint8_t const*>(cursor_image.as_argb_8888());
+    auto const bytes = size.width.as_uint32_t() * size.height.as_uint32_t() * 4;
+    auto const cached = std::find_if(begin(images), end(images), [&](CachedImage const& image)
+        {
+            return image.size == size && memcmp(image.argb8888.data(), pixels, bytes) == 0;
+        });
 
-    hotspot = cursor_image.hotspot();
+    if (cached != end(images))
     {
-        auto locked_buffers = buffers.lock();
-        for (auto& tuple : *locked_buffers)
-        {
-            pad_and_write_image_data_locked(lg, std::get<2>(tuple));
-        }
+        std::rotate(begin(images), cached, cached + 1);
+    }
+    else
+    {
+        if (images.size() == cached_images)
+            images.pop_back();
+
+        images.insert(begin(images), CachedImage{next_image_id++, size, {pixels, pixels + bytes}});
     }
 
     // Writing the data could throw an exception so lets
@@ -405,14 +427,13 @@ void mgg::Cursor::place_cursor_at_locked(
             // work on radeon and intel. There also seems to be precedent in weston for
             // implementing hotspot in this fashion.
             output.move_cursor(position_on_output - hotspot_displacement);
-            auto& buffer = buffer_for_output(output);
-
-            auto const changed_orientation = buffer.change_orientation(orientation);
+            auto& output_buffers = buffers_for_output(output);
+            auto& buffer = buffer_for_image_locked(lg, output_buffers, orientation);
 
-            if (changed_orientation)
-                pad_and_write_image_data_locked(lg, buffer);
+            auto const changed_buffer = output_buffers.shown != &buffer;
+            output_buffers.shown = &buffer;
 
-            if (force_state || !output.has_cursor() || changed_orientation)
+            if (force_state || !output.has_cursor() || changed_buffer)
             {
                 if (!output.set_cursor(buffer) || !output.has_cursor())
                     set_on_all_outputs = false;
@@ -430,7 +451,43 @@ void mgg::Cursor::place_cursor_at_locked(
     last_set_failed = !set_on_all_outputs;
 }
 
-mgg::Cursor::GBMBOWrapper& mgg::Cursor::buffer_for_output(KMSOutput const& output)
+auto mgg::Cursor::buffer_for_image_locked(
+    std::lock_guard<std::mutex> const& lg,
+    OutputBuffers& output_buffers,
+    MirOrientation orientation) -> GBMBOWrapper&
+{
+    auto const image = images.front().id;
+    auto& buffers = output_buffers.buffers;
+
+    auto found = std::find_if(begin(buffers), end(buffers), [&](auto const& buffer)
+        { return buffer->holds(image, orientation); });
+
+    if (found == end(buffers))
+    {
+        // Never write to the buffer on screen: reuse the least recently used of the others, or
+        // make another if they all hold images that might be wanted again
+        for (auto i = begin(buffers); i != end(buffers); ++i)
+        {
+            if (i->get() != output_buffers.shown && (found == end(buffers) || (*i)->last_used < (*found)->last_used))
+                found = i;
+        }
+
+        if (found == end(buffers) || ((*found)->has_content() && buffers.size() < buffers_per_output))
+        {
+            buffers.push_back(std::make_unique<GBMBOWrapper>(output_buffers.drm_fd));
+            found = end(buffers) - 1;
+        }
+
+        (*found)->forget_content();
+        pad_and_write_image_data_locked(lg, **found, orientation);
+        (*found)->set_content(image, orientation);
+    }
+
+    (*found)->last_used = ++buffer_use_count;
+    return **found;
+}
+
+mgg::Cursor::OutputBuffers& mgg::Cursor::buffers_for_output(KMSOutput const& output)
 {
     auto const drm_fd = output.drm_fd();
     auto const id = output.id();
@@ -443,17 +500,31 @@ mgg::Cursor::GBMBOWrapper& mgg::Cursor::buffer_for_output(KMSOutput const& outpu
             return std::get<2>(bo);
     }
 
-    locked_buffers->push_back(image_buffer{id, drm_fd, GBMBOWrapper{drm_fd, mir_orientation_normal}});
+    locked_buffers->push_back(image_buffer{id, drm_fd, OutputBuffers{drm_fd}});
 
-    GBMBOWrapper& bo = std::get<2>(locked_buffers->back());
+    auto& output_buffers = std::get<2>(locked_buffers->back());
+    GBMBOWrapper& bo = *output_buffers.buffers.front();
+    bool min_size_changed{false};
     if (gbm_bo_get_width(bo) < min_buffer_width)
     {
         min_buffer_width = gbm_bo_get_width(bo);
+        min_size_changed = true;
     }
     if (gbm_bo_get_height(bo) < min_buffer_height)
     {
         min_buffer_height = gbm_bo_get_height(bo);
+        min_size_changed = true;
+    }
+
+    if (min_size_changed)
+    {
+        // Images are padded to the smallest buffer, so what is already written is no longer right
+        for (auto& tuple : *locked_buffers)
+        {
+            for (auto& buffer : std::get<2>(tuple).buffers)
+                buffer->forget_content();
+        }
     }
 
-    return bo;
+    return output_buffers;
 }
@@ -86,6 +86,7 @@ public:
 private:
     enum ForceCursorState { UpdateState, ForceState };
     struct GBMBOWrapper;
+    struct OutputBuffers;
     void for_each_used_output(std::function<void(KMSOutput& output, DisplayConfigurationOutput const& conf)> const& f);
     void place_cursor_at(geometry::Point position, ForceCursorState force_state);
     void place_cursor_at_locked(std::lock_guard<std::mutex> const&, geometry::Point position, ForceCursorState force_state);
@@ -96,10 +97,15 @@ private:
         size_t count);
     void pad_and_write_image_data_locked(
         std::lock_guard<std::mutex> const&,
-        GBMBOWrapper& buffer);
+        GBMBOWrapper& buffer,
+        MirOrientation orientation);
+    auto buffer_for_image_locked(
+        std::lock_guard<std::mutex> const&,
+        OutputBuffers& output_buffers,
+        MirOrientation orientation) -> GBMBOWrapper&;
     void clear(std::lock_guard<std::mutex> const&);
 
-    GBMBOWrapper& buffer_for_output(KMSOutput const& output);
+    OutputBuffers& buffers_for_output(KMSOutput const& output);
     
     std::mutex guard;
 
@@ -107,32 +113,60 @@ private:
     geometry::Point current_position;
     geometry::Displacement hotspot;
     geometry::Size size;
-    std::vector<uint8_t> argb8888;
+
+    /// An image we have shown recently, so showing it again needn't touch the pixels
+    struct CachedImage
+    {
+        uint64_t id;
+        geometry::Size size;
+        std::vector<uint8_t> argb8888;
+    };
+    /// Most recently shown first: the front is the current image
+    std::vector<CachedImage> images;
+    uint64_t next_image_id{1};
 
     bool visible;
     bool last_set_failed;
 
     struct GBMBOWrapper
     {
-        GBMBOWrapper(int fd, MirOrientation orientation);
+        explicit GBMBOWrapper(int fd);
         operator gbm_bo*();
 
-        auto orientation() const -> MirOrientation { return current_orientation; }
-        auto change_orientation(MirOrientation new_orientation) -> bool;
+        /// Whether the buffer already holds \a image, padded and rotated for \a orientation
+        auto holds(uint64_t image, MirOrientation orientation) const -> bool
+            { return content_image == image && content_orientation == orientation; }
+        auto has_content() const -> bool { return content_image != 0; }
+        void set_content(uint64_t image, MirOrientation orientation);
+        void forget_content() { content_image = 0; }
 
         ~GBMBOWrapper();
 
         GBMBOWrapper(GBMBOWrapper&& from);
+
+        uint64_t last_used{0};
     private:
         gbm_device* device;
         gbm_bo* buffer;
-        MirOrientation current_orientation;
+        uint64_t content_image{0};
+        MirOrientation content_orientation{mir_orientation_normal};
         GBMBOWrapper(GBMBOWrapper const&) = delete;
         GBMBOWrapper& operator=(GBMBOWrapper const&) = delete;
     };
 
-    using image_buffer = std::tuple<uint32_t, int, GBMBOWrapper>;
+    /// The cursor buffers of one output: flipping between them is cheaper than rewriting one
+    struct OutputBuffers
+    {
+        explicit OutputBuffers(int drm_fd);
+
+        int const drm_fd;
+        std::vector<std::unique_ptr<GBMBOWrapper>> buffers;
+        GBMBOWrapper* shown{nullptr};
+    };
+
+    using image_buffer = std::tuple<uint32_t, int, OutputBuffers>;
     Mutex<std::vector<image_buffer>> buffers;
+    uint64_t buffer_use_count{0};
 
     uint32_t min_buffer_width;
     uint32_t min_buffer_height;
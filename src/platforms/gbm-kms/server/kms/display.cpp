@@ -43,9 +43,11 @@
 #include "kms-utils/drm_mode_resources.h"
 #include "kms-utils/kms_connector.h"
 
+#include <cstdlib>
 #include <stdexcept>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace mgg = mir::graphics::gbm;
 namespace mg = mir::graphics;
@@ -277,8 +279,16 @@ void mgg::Display::register_configuration_change_handler(
             [conf_change_handler, this](int)
             {
                 monitor.process_events([conf_change_handler, this]
-                                       (mir::udev::Monitor::EventType, mir::udev::Device const&)
+                                       (mir::udev::Monitor::EventType, mir::udev::Device const& device)
                                        {
+                                            {
+                                                std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+                                                // Newer kernels say which connector changed; otherwise probe them all
+                                                if (auto const connector = device.property("CONNECTOR"))
+                                                    output_container->connector_changed(std::strtoul(connector, nullptr, 10));
+                                                else
+                                                    output_container->all_connectors_changed();
+                                            }
                                             dirty_configuration = true;
                                             conf_change_handler();
                                        });
@@ -392,6 +402,25 @@ std::unique_ptr<mir::renderer::gl::Context> mgg::Display::create_gl_context() co
     return std::make_unique<GBMGLContext>(*gbm, *gl_config, shared_egl.context());
 }
 
+bool mgg::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    mg::DisplaySyncGroupReleaseHandler const& release)
+{
+    if (!conf.valid())
+    {
+        BOOST_THROW_EXCEPTION(
+            std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    {
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+        configure_incrementally_locked(dynamic_cast<RealKMSDisplayConfiguration const&>(conf), release, lock);
+    }
+
+    if (auto c = cursor.lock()) c->resume();
+    return true;
+}
+
 bool mgg::Display::apply_if_configuration_preserves_display_buffers(
     mg::DisplayConfiguration const& conf)
 {
@@ -525,40 +554,10 @@ void mgg::Display::configure_locked(
             }
             else
             {
-                uint32_t const width  = current_mode_resolution.width.as_uint32_t();
-                uint32_t const height = current_mode_resolution.height.as_uint32_t();
-
                 for (auto const& group : kms_output_groups)
                 {
-                    /*
-                     * In a hybrid setup a scanout surface needs to be allocated differently if it
-                     * needs to be able to be shared across GPUs. This likely reduces performance.
-                     *
-                     * As a first cut, assume every scanout buffer in a hybrid setup might need
-                     * to be shared.
-                     */
-                    auto surface = gbm->create_scanout_surface(width, height, drm.size() != 1);
-                    auto const raw_surface = surface.get();
-
-                    auto db = std::make_unique<DisplayBuffer>(
-                        bypass_option,
-                        listener,
-                        group,
-                        GBMOutputSurface{
-                            group.front()->drm_fd(),
-                            std::move(surface),
-                            width, height,
-                            helpers::EGLHelper{
-                                *gl_config,
-                                *gbm,
-                                raw_surface,
-                                shared_egl.context()
-                            }
-                        },
-                        bounding_rect,
-                        transformation);
-
-                    display_buffers_new.push_back(std::move(db));
+                    display_buffers_new.push_back(
+                        create_display_buffer(group, current_mode_resolution, bounding_rect, transformation));
                 }
             }
         });
@@ -573,3 +572,202 @@ void mgg::Display::configure_locked(
         /* Clear connected but unused outputs */
         clear_connected_unused_outputs();
 }
+
+void mgg::Display::configure_incrementally_locked(
+    mgg::RealKMSDisplayConfiguration const& kms_conf,
+    mg::DisplaySyncGroupReleaseHandler const& release,
+    std::lock_guard<std::mutex> const& lock)
+{
+    if (compatible(kms_conf, current_display_configuration))
+    {
+        configure_locked(kms_conf, lock);
+        return;
+    }
+
+    std::unordered_map<DisplayConfigurationOutputId, DisplayConfigurationOutput> current_outputs;
+    current_display_configuration.for_each_output(
+        [&](DisplayConfigurationOutput const& conf_output)
+        {
+            current_outputs.emplace(conf_output.id, conf_output);
+        });
+
+    /*
+     * A DisplayBuffer survives if it drives exactly the outputs (on its
+     * device) of a group in which nothing at all has changed. Everything
+     * else is released, reset and rebuilt as configure_locked() would.
+     */
+    OverlappingOutputGrouping grouping{kms_conf};
+    std::vector<std::vector<std::shared_ptr<KMSOutput>>> unchanged_output_groups;
+
+    grouping.for_each_group(
+        [&](OverlappingOutputGroup const& group)
+        {
+            bool unchanged{true};
+            std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
+
+            group.for_each_output(
+                [&](DisplayConfigurationOutput const& conf_output)
+                {
+                    auto const current = current_outputs.find(conf_output.id);
+                    unchanged = unchanged && current != current_outputs.end() && current->second == conf_output;
+                    add_to_drm_device_group(
+                        kms_output_groups, current_display_configuration.get_output_for(conf_output.id));
+                });
+
+            if (unchanged)
+            {
+                for (auto& outputs : kms_output_groups)
+                    unchanged_output_groups.push_back(std::move(outputs));
+            }
+        });
+
+    std::unordered_set<KMSOutput const*> preserved_outputs;
+    std::vector<DisplayBuffer*> released_buffers;
+
+    for (auto const& db : display_buffers)
+    {
+        auto const unchanged = std::find_if(
+            unchanged_output_groups.begin(), unchanged_output_groups.end(),
+            [&db](auto const& outputs) { return db->drives(outputs); });
+
+        if (unchanged != unchanged_output_groups.end())
+        {
+            for (auto const& output : *unchanged)
+                preserved_outputs.insert(output.get());
+        }
+        else
+        {
+            released_buffers.push_back(db.get());
+        }
+    }
+
+    release(std::vector<DisplaySyncGroup*>(released_buffers.begin(), released_buffers.end()));
+
+    for (auto const db : released_buffers)
+        db->wait_for_page_flip();
+
+    /* Reset the state of all outputs not driven by a surviving DisplayBuffer */
+    kms_conf.for_each_output(
+        [&](DisplayConfigurationOutput const& conf_output)
+        {
+            auto kms_output = current_display_configuration.get_output_for(conf_output.id);
+            if (!preserved_outputs.count(kms_output.get()))
+            {
+                kms_output->clear_cursor();
+                kms_output->reset();
+            }
+        });
+
+    /*
+     * Surviving DisplayBuffers stay in display_buffers until every new one has
+     * been built: if configuring an output or building a DisplayBuffer throws,
+     * display_buffers must still be intact for the caller's full reconfiguration.
+     * Each slot is either a surviving DisplayBuffer or a newly built one.
+     */
+    std::vector<std::pair<std::unique_ptr<DisplayBuffer>*, std::unique_ptr<DisplayBuffer>>> slots;
+
+    grouping.for_each_group(
+        [&](OverlappingOutputGroup const& group)
+        {
+            auto bounding_rect = group.bounding_rectangle();
+            std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
+            glm::mat2 transformation;
+            geom::Size current_mode_resolution;
+
+            group.for_each_output(
+                [&](DisplayConfigurationOutput const& conf_output)
+                {
+                    auto kms_output = current_display_configuration.get_output_for(conf_output.id);
+
+                    if (!preserved_outputs.count(kms_output.get()))
+                    {
+                        auto const mode_index = kms_conf.get_kms_mode_index(conf_output.id,
+                                                                            conf_output.current_mode_index);
+                        kms_output->configure(conf_output.top_left - bounding_rect.top_left, mode_index);
+                        kms_output->set_power_mode(conf_output.power_mode);
+                        kms_output->set_gamma(conf_output.gamma);
+                    }
+                    add_to_drm_device_group(kms_output_groups, std::move(kms_output));
+
+                    transformation = conf_output.transformation();
+                    if (conf_output.current_mode_index < conf_output.modes.size())
+                        current_mode_resolution = conf_output.modes[conf_output.current_mode_index].size;
+                });
+
+            for (auto const& outputs : kms_output_groups)
+            {
+                if (preserved_outputs.count(outputs.front().get()))
+                {
+                    auto const db = std::find_if(
+                        display_buffers.begin(), display_buffers.end(),
+                        [&outputs](auto const& db) { return db->drives(outputs); });
+
+                    if (db == display_buffers.end())
+                    {
+                        BOOST_THROW_EXCEPTION((std::logic_error{
+                            "No DisplayBuffer drives the outputs of an unchanged group"}));
+                    }
+
+                    slots.emplace_back(&*db, nullptr);
+                }
+                else
+                {
+                    slots.emplace_back(
+                        nullptr,
+                        create_display_buffer(outputs, current_mode_resolution, bounding_rect, transformation));
+                }
+            }
+        });
+
+    std::vector<std::unique_ptr<DisplayBuffer>> display_buffers_new;
+    display_buffers_new.reserve(slots.size());
+
+    for (auto& slot : slots)
+        display_buffers_new.push_back(slot.first ? std::move(*slot.first) : std::move(slot.second));
+
+    display_buffers = std::move(display_buffers_new);
+
+    /* Store applied configuration */
+    current_display_configuration = kms_conf;
+
+    /* Clear connected but unused outputs */
+    clear_connected_unused_outputs();
+}
+
+auto mgg::Display::create_display_buffer(
+    std::vector<std::shared_ptr<KMSOutput>> const& outputs,
+    geom::Size const& mode_resolution,
+    geom::Rectangle const& area,
+    glm::mat2 const& transformation) const -> std::unique_ptr<DisplayBuffer>
+{
+    uint32_t const width  = mode_resolution.width.as_uint32_t();
+    uint32_t const height = mode_resolution.height.as_uint32_t();
+
+    /*
+     * In a hybrid setup a scanout surface needs to be allocated differently if it
+     * needs to be able to be shared across GPUs. This likely reduces performance.
+     *
+     * As a first cut, assume every scanout buffer in a hybrid setup might need
+     * to be shared.
+     */
+    auto surface = gbm->create_scanout_surface(width, height, drm.size() != 1);
+    auto const raw_surface = surface.get();
+
+    return std::make_unique<DisplayBuffer>(
+        bypass_option,
+        listener,
+        outputs,
+        GBMOutputSurface{
+            outputs.front()->drm_fd(),
+            std::move(surface),
+            width, height,
+            helpers::EGLHelper{
+                *gl_config,
+                *gbm,
+                raw_surface,
+                shared_egl.context()
+            }
+        },
+        area,
+        transformation);
+}
@@ -27,6 +27,8 @@
 #include "egl_helper.h"
 #include "platform_common.h"
 
+#include <glm/glm.hpp>
+
 #include <atomic>
 #include <mutex>
 #include <vector>
@@ -37,6 +39,7 @@ class ConsoleServices;
 namespace geometry
 {
 struct Rectangle;
+struct Size;
 }
 namespace graphics
 {
@@ -79,6 +82,9 @@ public:
     std::unique_ptr<DisplayConfiguration> configuration() const override;
     bool apply_if_configuration_preserves_display_buffers(DisplayConfiguration const& conf) override;
     void configure(DisplayConfiguration const& conf) override;
+    bool configure_incrementally(
+        DisplayConfiguration const& conf,
+        DisplaySyncGroupReleaseHandler const& release) override;
 
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
@@ -110,13 +116,22 @@ private:
     mir::udev::Monitor monitor;
     helpers::EGLHelper shared_egl;
     std::vector<std::unique_ptr<DisplayBuffer>> display_buffers;
-    std::shared_ptr<KMSOutputContainer> const output_container;
+    std::shared_ptr<RealKMSOutputContainer> const output_container;
     mutable RealKMSDisplayConfiguration current_display_configuration;
     mutable std::atomic<bool> dirty_configuration;
 
     void configure_locked(
         RealKMSDisplayConfiguration const& conf,
         std::lock_guard<decltype(configuration_mutex)> const&);
+    void configure_incrementally_locked(
+        RealKMSDisplayConfiguration const& conf,
+        DisplaySyncGroupReleaseHandler const& release,
+        std::lock_guard<decltype(configuration_mutex)> const&);
+    std::unique_ptr<DisplayBuffer> create_display_buffer(
+        std::vector<std::shared_ptr<KMSOutput>> const& outputs,
+        geometry::Size const& mode_resolution,
+        geometry::Rectangle const& area,
+        glm::mat2 const& transformation) const;
 
     BypassOption bypass_option;
     std::weak_ptr<Cursor> cursor;
@@ -17,6 +17,8 @@
  */
 
 #include "display_buffer.h"
+#include "dumb_framebuffer.h"
+#include "fb_handle.h"
 #include "kms_output.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
@@ -47,6 +49,47 @@ namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
 namespace geom = mir::geometry;
 namespace mgmh = mir::graphics::gbm::helpers;
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+class DumbFramebufferMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    DumbFramebufferMapping(mgg::DumbFramebuffer const& framebuffer)
+        : framebuffer{framebuffer}
+    {
+    }
+
+    MirPixelFormat format() const override
+    {
+        return mir_pixel_format_xrgb_8888;
+    }
+
+    geom::Stride stride() const override
+    {
+        return framebuffer.stride();
+    }
+
+    geom::Size size() const override
+    {
+        return framebuffer.size();
+    }
+
+    unsigned char* data() override
+    {
+        return framebuffer.pixels();
+    }
+
+    size_t len() const override
+    {
+        return framebuffer.stride().as_uint32_t() * framebuffer.size().height.as_uint32_t();
+    }
+
+private:
+    mgg::DumbFramebuffer const& framebuffer;
+};
+}
 
 mgg::GBMOutputSurface::FrontBuffer::FrontBuffer()
     : surf{nullptr},
@@ -523,6 +566,12 @@ void mgg::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectan
     area = a;
 }
 
+bool mgg::DisplayBuffer::drives(std::vector<std::shared_ptr<KMSOutput>> const& other_outputs) const
+{
+    return outputs.size() == other_outputs.size() &&
+           std::is_permutation(outputs.begin(), outputs.end(), other_outputs.begin());
+}
+
 bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
 {
     glm::mat2 static const no_transformation(1);
@@ -595,11 +644,17 @@ void mgg::DisplayBuffer::post()
      */
     wait_for_page_flip();
 
-    mgg::FBHandle *bufobj;
+    mgg::FBHandle const* bufobj;
     if (bypass_buf)
     {
         bufobj = bypass_bufobj;
     }
+    else if (software_frame_pending)
+    {
+        bufobj = &dumb_framebuffers[next_dumb_framebuffer]->fb();
+        next_dumb_framebuffer = (next_dumb_framebuffer + 1) % dumb_framebuffers.size();
+        software_frame_pending = false;
+    }
     else
     {
         scheduled_composite_frame = get_front_buffer(surface.lock_front());
@@ -612,8 +667,21 @@ void mgg::DisplayBuffer::post()
      * Try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
      */
+    auto presentation = std::move(next_presentation);
+    next_presentation = nullptr;
+
     if (!needs_set_crtc && !schedule_page_flip(*bufobj))
         needs_set_crtc = true;
+    else if (page_flips_pending)
+    {
+        /*
+         * The wait above delivers any earlier handler, but if one is still
+         * held its flip has completed: report that rather than dropping it.
+         */
+        if (scheduled_presentation)
+            scheduled_presentation(outputs.front()->last_frame());
+        scheduled_presentation = std::move(presentation);
+    }
 
     /*
      * Fallback blitting: Not pretty, since it may tear. VirtualBox seems
@@ -623,6 +691,10 @@ void mgg::DisplayBuffer::post()
     {
         set_crtc(*bufobj);
         needs_set_crtc = false;
+
+        // Not synchronised with the hardware, so the best we can do is "now"
+        if (presentation)
+            presentation(Frame{0, Frame::Timestamp::now(CLOCK_MONOTONIC)});
     }
 
     using namespace std;  // For operator""ms()
@@ -654,8 +726,12 @@ void mgg::DisplayBuffer::post()
          * Not in clone mode? We can afford to wait for the page flip then,
          * making us double-buffered (noticeably less laggy than the triple
          * buffering that clone mode requires).
+         *
+         * In clone mode we still wait if someone is waiting to hear when this
+         * frame is presented: nothing else reads the flip events, so an idle
+         * scene would otherwise never report its last frame.
          */
-        if (outputs.size() == 1)
+        if (outputs.size() == 1 || scheduled_presentation)
             wait_for_page_flip();
 
         /*
@@ -686,6 +762,12 @@ std::chrono::milliseconds mgg::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
+bool mgg::DisplayBuffer::notify_next_presentation(PresentationHandler const& handler)
+{
+    next_presentation = handler;
+    return true;
+}
+
 bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
 {
     /*
@@ -709,6 +791,14 @@ void mgg::DisplayBuffer::wait_for_page_flip()
             output->wait_for_page_flip();
 
         page_flips_pending = false;
+
+        if (scheduled_presentation)
+        {
+            // The first output is the one the clone group is timed against
+            auto const presentation = std::move(scheduled_presentation);
+            scheduled_presentation = nullptr;
+            presentation(outputs.front()->last_frame());
+        }
     }
 
     if (scheduled_bypass_frame || scheduled_composite_frame)
@@ -739,6 +829,39 @@ void mgg::DisplayBuffer::release_current()
     surface.release_current();
 }
 
+auto mgg::DisplayBuffer::map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    if (dumb_framebuffers.empty())
+    {
+        /*
+         * Double buffered, like the GBM surface; clone groups don't wait for
+         * the page flip after post() so need a third buffer to draw into.
+         */
+        auto const count = outputs.size() == 1 ? 2 : 3;
+        for (auto i = 0; i != count; ++i)
+            dumb_framebuffers.push_back(std::make_unique<DumbFramebuffer>(surface.device_fd(), surface.size()));
+        dumb_framebuffer_frame.resize(count, 0);
+    }
+
+    return std::make_unique<DumbFramebufferMapping>(*dumb_framebuffers[next_dumb_framebuffer]);
+}
+
+auto mgg::DisplayBuffer::framebuffer_age() const -> unsigned
+{
+    if (dumb_framebuffers.empty())
+        return 0;
+
+    auto const last_drawn = dumb_framebuffer_frame[next_dumb_framebuffer];
+    return last_drawn ? software_frames + 1 - last_drawn : 0;
+}
+
+void mgg::DisplayBuffer::present(std::vector<geom::Rectangle> const& /*damage*/)
+{
+    // Page flips replace the whole framebuffer, so the damage is only useful for drawing
+    dumb_framebuffer_frame[next_dumb_framebuffer] = ++software_frames;
+    software_frame_pending = true;
+}
+
 void mgg::DisplayBuffer::schedule_set_crtc()
 {
     needs_set_crtc = true;
@@ -22,6 +22,7 @@
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/display.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 #include "display_helpers.h"
 #include "egl_helper.h"
 #include "platform_common.h"
@@ -43,6 +44,7 @@ namespace gbm
 
 class Platform;
 class FBHandle;
+class DumbFramebuffer;
 class KMSOutput;
 class NativeBuffer;
 
@@ -86,6 +88,7 @@ public:
     FrontBuffer lock_front();
     void report_egl_configuration(std::function<void(EGLDisplay, EGLConfig)> const& to);
     geometry::Size size() const { return {width, height}; }
+    int device_fd() const { return drm_fd; }
 private:
     int const drm_fd;
     uint32_t width, height;
@@ -96,7 +99,8 @@ private:
 class DisplayBuffer : public graphics::DisplayBuffer,
                       public graphics::DisplaySyncGroup,
                       public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+                      public renderer::gl::RenderTarget,
+                      public renderer::software::RenderTarget
 {
 public:
     DisplayBuffer(BypassOption bypass_options,
@@ -114,10 +118,16 @@ public:
     bool overlay(RenderableList const& renderlist) override;
     void bind() override;
 
+    // software::RenderTarget
+    auto map_framebuffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    auto framebuffer_age() const -> unsigned override;
+    void present(std::vector<geometry::Rectangle> const& damage) override;
+
     void for_each_display_buffer(
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    bool notify_next_presentation(PresentationHandler const& handler) override;
 
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
@@ -126,6 +136,9 @@ public:
     void schedule_set_crtc();
     void wait_for_page_flip();
 
+    /// Whether this drives exactly \p other_outputs (in any order)
+    bool drives(std::vector<std::shared_ptr<KMSOutput>> const& other_outputs) const;
+
 private:
     bool schedule_page_flip(FBHandle const& bufobj);
     void set_crtc(FBHandle const&);
@@ -150,11 +163,22 @@ private:
     GBMOutputSurface::FrontBuffer visible_composite_frame;
     GBMOutputSurface::FrontBuffer scheduled_composite_frame;
 
+    /// Framebuffers for software rendering, created when first mapped
+    std::vector<std::unique_ptr<DumbFramebuffer>> dumb_framebuffers;
+    /// The software frame each dumb framebuffer last presented, or 0 if none
+    std::vector<unsigned long> dumb_framebuffer_frame;
+    size_t next_dumb_framebuffer{0};
+    unsigned long software_frames{0};
+    bool software_frame_pending{false};
+
     geometry::Rectangle area;
     glm::mat2 transform;
     std::atomic<bool> needs_set_crtc;
     std::chrono::milliseconds recommend_sleep{0};
     bool page_flips_pending;
+
+    PresentationHandler next_presentation;      ///< For the next post()
+    PresentationHandler scheduled_presentation; ///< For the pending page flip
 };
 
 }
@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dumb_framebuffer.h"
+#include "fb_handle.h"
+
+#include <boost/throw_exception.hpp>
+#include <drm_fourcc.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <sys/mman.h>
+#include <system_error>
+
+namespace mgg = mir::graphics::gbm;
+namespace geom = mir::geometry;
+
+namespace
+{
+void destroy_dumb_buffer(int drm_fd, uint32_t gem_handle)
+{
+    struct drm_mode_destroy_dumb params = {};
+    params.handle = gem_handle;
+    drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &params);
+}
+}
+
+mgg::DumbFramebuffer::DumbFramebuffer(int drm_fd, geom::Size size)
+    : drm_fd{drm_fd},
+      size_{size}
+{
+    struct drm_mode_create_dumb create = {};
+    create.width = size.width.as_uint32_t();
+    create.height = size.height.as_uint32_t();
+    create.bpp = 32;
+
+    if (drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to create dumb buffer"}));
+    }
+
+    gem_handle = create.handle;
+    pitch = create.pitch;
+    mapped_size = create.size;
+
+    try
+    {
+        uint32_t fb_id{0};
+        uint32_t const handles[4] = {gem_handle, 0, 0, 0};
+        uint32_t const pitches[4] = {pitch, 0, 0, 0};
+        uint32_t const offsets[4] = {0, 0, 0, 0};
+
+        if (auto const error = drmModeAddFB2(
+                drm_fd, create.width, create.height, DRM_FORMAT_XRGB8888, handles, pitches, offsets, &fb_id, 0))
+        {
+            BOOST_THROW_EXCEPTION((std::system_error{-error, std::system_category(), "Failed to add dumb buffer framebuffer"}));
+        }
+        fb_ = std::make_unique<FBHandle>(drm_fd, fb_id);
+
+        struct drm_mode_map_dumb map = {};
+        map.handle = gem_handle;
+
+        if (drmIoctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0)
+        {
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to prepare dumb buffer for mapping"}));
+        }
+
+        mapping = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, map.offset);
+        if (mapping == MAP_FAILED)
+        {
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to map dumb buffer"}));
+        }
+    }
+    catch (...)
+    {
+        fb_.reset();
+        destroy_dumb_buffer(drm_fd, gem_handle);
+        throw;
+    }
+}
+
+mgg::DumbFramebuffer::~DumbFramebuffer()
+{
+    munmap(mapping, mapped_size);
+    fb_.reset();
+    destroy_dumb_buffer(drm_fd, gem_handle);
+}
+
+auto mgg::DumbFramebuffer::fb() const -> FBHandle const&
+{
+    return *fb_;
+}
+
+auto mgg::DumbFramebuffer::pixels() const -> unsigned char*
+{
+    return static_cast<unsigned char*>(mapping);
+}
+
+auto mgg::DumbFramebuffer::stride() const -> geom::Stride
+{
+    return geom::Stride{pitch};
+}
+
+auto mgg::DumbFramebuffer::size() const -> geom::Size
+{
+    return size_;
+}
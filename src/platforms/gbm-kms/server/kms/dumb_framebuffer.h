@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_DUMB_FRAMEBUFFER_H_
+#define MIR_GRAPHICS_GBM_DUMB_FRAMEBUFFER_H_
+
+#include "mir/geometry/dimensions.h"
+#include "mir/geometry/size.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+class FBHandle;
+
+/**
+ * An XRGB8888 KMS dumb buffer, mapped for the CPU to draw into and able to be scanned out
+ *
+ * Dumb buffers need no GPU or EGL, so these let outputs be composited in software.
+ */
+class DumbFramebuffer
+{
+public:
+    DumbFramebuffer(int drm_fd, geometry::Size size);
+    ~DumbFramebuffer();
+
+    DumbFramebuffer(DumbFramebuffer const&) = delete;
+    DumbFramebuffer& operator=(DumbFramebuffer const&) = delete;
+
+    auto fb() const -> FBHandle const&;
+    auto pixels() const -> unsigned char*;
+    auto stride() const -> geometry::Stride;
+    auto size() const -> geometry::Size;
+
+private:
+    int const drm_fd;
+    geometry::Size const size_;
+    uint32_t gem_handle;
+    uint32_t pitch;
+    size_t mapped_size;
+    void* mapping;
+    std::unique_ptr<FBHandle> fb_;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_GBM_DUMB_FRAMEBUFFER_H_
@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_FB_HANDLE_H_
+#define MIR_GRAPHICS_GBM_FB_HANDLE_H_
+
+#include <xf86drmMode.h>
+
+#include <cstdint>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+/// A KMS framebuffer, removed when the handle is destroyed
+class FBHandle
+{
+public:
+    FBHandle(int drm_fd, uint32_t drm_fb_id)
+        : drm_fd{drm_fd}, drm_fb_id{drm_fb_id}
+    {
+    }
+
+    ~FBHandle()
+    {
+        if (drm_fb_id)
+        {
+            drmModeRmFB(drm_fd, drm_fb_id);
+        }
+    }
+
+    FBHandle(FBHandle const&) = delete;
+    FBHandle& operator=(FBHandle const&) = delete;
+
+    uint32_t get_drm_fb_id() const
+    {
+        return drm_fb_id;
+    }
+
+private:
+    int const drm_fd;
+    uint32_t const drm_fb_id;
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_GBM_FB_HANDLE_H_
@@ -17,6 +17,7 @@
  */
 
 #include "real_kms_output.h"
+#include "fb_handle.h"
 #include "mir/graphics/display_configuration.h"
 #include "page_flipper.h"
 #include "kms-utils/kms_connector.h"
@@ -34,33 +35,6 @@ namespace mgg = mg::gbm;
 namespace mgk = mg::kms;
 namespace geom = mir::geometry;
 
-class mgg::FBHandle
-{
-public:
-    FBHandle(gbm_bo* bo, uint32_t drm_fb_id)
-        : bo{bo}, drm_fb_id{drm_fb_id}
-    {
-    }
-
-    ~FBHandle()
-    {
-        if (drm_fb_id)
-        {
-            int drm_fd = gbm_device_get_fd(gbm_bo_get_device(bo));
-            drmModeRmFB(drm_fd, drm_fb_id);
-        }
-    }
-
-    uint32_t get_drm_fb_id() const
-    {
-        return drm_fb_id;
-    }
-
-private:
-    gbm_bo *bo;
-    uint32_t drm_fb_id;
-};
-
 namespace
 {
 void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
@@ -83,9 +57,11 @@ mgg::RealKMSOutput::RealKMSOutput(
       saved_crtc(),
       using_saved_crtc{true},
       has_cursor_{false},
-      power_mode(mir_power_mode_on)
+      power_mode(mir_power_mode_on),
+      edid_blob_id{0}
 {
     reset();
+    update_edid();
 
     kms::DRMModeResources resources{drm_fd_};
 
@@ -111,12 +87,14 @@ uint32_t mgg::RealKMSOutput::id() const
 
 void mgg::RealKMSOutput::reset()
 {
-    kms::DRMModeResources resources{drm_fd_};
-
-    /* Update the connector to ensure we have the latest information */
+    /*
+     * Update the connector to ensure we have the latest information. This is called on
+     * every configuration change, so take what the kernel knows rather than probing
+     * the connector (and reading its EDID) again.
+     */
     try
     {
-        connector = resources.connector(connector->connector_id);
+        connector = kms::get_connector_current(drm_fd_, connector->connector_id);
     }
     catch (std::exception const& e)
     {
@@ -400,8 +378,14 @@ void mgg::RealKMSOutput::set_gamma(mg::GammaCurves const& gamma)
 
 void mgg::RealKMSOutput::refresh_hardware_state()
 {
-    connector = kms::get_connector(drm_fd_, connector->connector_id);
+    refresh_hardware_state(kms::get_connector(drm_fd_, connector->connector_id));
+}
+
+void mgg::RealKMSOutput::refresh_hardware_state(kms::DRMModeConnectorUPtr&& new_connector)
+{
+    connector = std::move(new_connector);
     current_crtc = nullptr;
+    update_edid();
 
     if (connector->encoder_id)
     {
@@ -473,13 +457,21 @@ MirSubpixelArrangement kms_subpixel_to_mir_subpixel(uint32_t subpixel)
     }
 }
 
-std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
+/*
+ * Reads the connector's EDID into \a edid, unless \a blob_id shows it already holds it.
+ * The kernel keeps the same blob for as long as the monitor's EDID is unchanged.
+ */
+void update_edid_for_connector(int drm_fd, uint32_t connector_id, uint64_t& blob_id, std::vector<uint8_t>& edid)
 {
-    std::vector<uint8_t> edid;
-
     mgk::ObjectProperties connector_props{
         drm_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR};
 
+    if (blob_id != 0 && connector_props.has_property("EDID") && connector_props["EDID"] == blob_id)
+        return;
+
+    edid.clear();
+    blob_id = 0;
+
     if (connector_props.has_property("EDID"))
     {
         /*
@@ -498,7 +490,7 @@ std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
                 connector_id,
                 errno,
                 ::strerror(errno));
-            return edid;
+            return;
         }
 
         if (!drm_property_type_is(property.get(), DRM_MODE_PROP_BLOB))
@@ -507,7 +499,7 @@ std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
                 "EDID property on connector %u has unexpected type %u",
                 connector_id,
                 property->flags);
-            return edid;
+            return;
         }
 
         // A property ID of 0 means invalid.
@@ -518,7 +510,7 @@ std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
              * don't provide an EDID, which is not as unusual as you might think...
              */
             mir::log_debug("No EDID data available on connector %u", connector_id);
-            return edid;
+            return;
         }
 
         auto blob = drmModeGetPropertyBlob(drm_fd, connector_props["EDID"]);
@@ -531,7 +523,7 @@ std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
                 errno,
                 ::strerror(errno));
 
-            return edid;
+            return;
         }
 
         edid.reserve(blob->length);
@@ -542,12 +534,25 @@ std::vector<uint8_t> edid_for_connector(int drm_fd, uint32_t connector_id)
         drmModeFreePropertyBlob(blob);
 
         edid.shrink_to_fit();
+        blob_id = connector_props["EDID"];
     }
-
-    return edid;
 }
 }
 
+void mgg::RealKMSOutput::update_edid()
+{
+    if (connector->connection == DRM_MODE_CONNECTED)
+    {
+        update_edid_for_connector(drm_fd_, connector->connector_id, edid_blob_id, edid);
+    }
+    else
+    {
+        /* There's obviously no monitor EDID when there is no monitor connected! */
+        edid.clear();
+        edid_blob_id = 0;
+    }
+}
+
 void mgg::RealKMSOutput::update_from_hardware_state(
     DisplayConfigurationOutput& output) const
 {
@@ -562,14 +567,6 @@ void mgg::RealKMSOutput::update_from_hardware_state(
     std::vector<MirPixelFormat> formats{mir_pixel_format_argb_8888,
                                         mir_pixel_format_xrgb_8888};
 
-    std::vector<uint8_t> edid;
-    if (connected) {
-        /* Only ask for the EDID on connected outputs. There's obviously no monitor EDID
-         * when there is no monitor connected!
-         */
-        edid = edid_for_connector(drm_fd_, connector->connector_id);
-    }
-
     drmModeModeInfo current_mode_info = drmModeModeInfo();
     GammaCurves gamma;
 
@@ -663,7 +660,7 @@ mgg::FBHandle* mgg::RealKMSOutput::fb_for(gbm_bo* bo) const
         return nullptr;
 
     /* Create a FBHandle and associate it with the gbm_bo */
-    bufobj = new FBHandle{bo, fb_id};
+    bufobj = new FBHandle{drm_fd_, fb_id};
     gbm_bo_set_user_data(bo, bufobj, bo_user_data_destroy);
 
     return bufobj;
@@ -25,6 +25,7 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace mir
 {
@@ -67,6 +68,8 @@ public:
     Frame last_frame() const override;
 
     void refresh_hardware_state() override;
+    /// As refresh_hardware_state(), but with a \a connector the caller has already queried
+    void refresh_hardware_state(kms::DRMModeConnectorUPtr&& connector);
     void update_from_hardware_state(DisplayConfigurationOutput& output) const override;
 
     FBHandle* fb_for(gbm_bo* bo) const override;
@@ -76,6 +79,7 @@ public:
 private:
     bool ensure_crtc();
     void restore_saved_crtc();
+    void update_edid();
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
@@ -91,6 +95,9 @@ private:
     MirPowerMode power_mode;
     int dpms_enum_id;
 
+    std::vector<uint8_t> edid;
+    uint64_t edid_blob_id;
+
     std::mutex power_mutex;
 
     AtomicFrame last_frame_;
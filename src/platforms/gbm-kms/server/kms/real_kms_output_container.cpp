@@ -57,20 +57,27 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
             continue;
         }
 
-        for (auto &&connector : resources->connectors())
+        for (auto const connector_id : resources->connector_ids())
         {
             // Caution: O(n²) here, but n is the number of outputs, so should
             // conservatively be << 100.
             auto existing_output = std::find_if(
                 outputs.begin(),
                 outputs.end(),
-                [&connector, drm_fd](auto const &candidate)
+                [connector_id, drm_fd](auto const &candidate)
                 {
                     return
-                        connector->connector_id == candidate->id() &&
+                        connector_id == candidate->id() &&
                         drm_fd == candidate->drm_fd();
                 });
 
+            bool const needs_probe =
+                all_changed || existing_output == outputs.end() || changed_connectors.count(connector_id);
+
+            auto connector = needs_probe ?
+                kms::get_connector(drm_fd, connector_id) :
+                kms::get_connector_current(drm_fd, connector_id);
+
             if (existing_output != outputs.end())
             {
                 // We could drop this down to O(n) by being smarter about moving out
@@ -78,7 +85,7 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
                 //
                 // That's a bit of a faff, so just do the simple thing for now.
                 new_outputs.push_back(*existing_output);
-                new_outputs.back()->refresh_hardware_state();
+                new_outputs.back()->refresh_hardware_state(std::move(connector));
             }
             else
             {
@@ -96,4 +103,16 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
     }
 
     outputs = new_outputs;
+    changed_connectors.clear();
+    all_changed = false;
+}
+
+void mgg::RealKMSOutputContainer::connector_changed(uint32_t connector_id)
+{
+    changed_connectors.insert(connector_id);
+}
+
+void mgg::RealKMSOutputContainer::all_connectors_changed()
+{
+    all_changed = true;
 }
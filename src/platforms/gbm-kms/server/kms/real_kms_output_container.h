@@ -20,6 +20,8 @@
 #define MIR_GRAPHICS_GBM_REAL_KMS_OUTPUT_CONTAINER_H_
 
 #include "kms_output_container.h"
+
+#include <unordered_set>
 #include <vector>
 
 namespace mir
@@ -30,6 +32,7 @@ namespace gbm
 {
 
 class PageFlipper;
+class RealKMSOutput;
 
 class RealKMSOutputContainer : public KMSOutputContainer
 {
@@ -41,9 +44,23 @@ public:
     void for_each_output(std::function<void(std::shared_ptr<KMSOutput> const&)> functor) const override;
 
     void update_from_hardware_state() override;
+
+    /**
+     * Note a hotplug event for a connector.
+     *
+     * Probing a connector can take tens of milliseconds (it may read the EDID over DDC), so
+     * the next update only probes the connectors that have changed, and takes the kernel's
+     * current state for the rest.
+     */
+    void connector_changed(uint32_t connector_id);
+    /// Note a hotplug event that doesn't say which connector changed
+    void all_connectors_changed();
+
 private:
     std::vector<int> const drm_fds;
-    std::vector<std::shared_ptr<KMSOutput>> outputs;
+    std::vector<std::shared_ptr<RealKMSOutput>> outputs;
+    std::unordered_set<uint32_t> changed_connectors;
+    bool all_changed{true};
     std::function<std::shared_ptr<PageFlipper>(int drm_fd)> const construct_page_flipper;
 };
 
@@ -18,6 +18,8 @@
 
 
 #include "linux_dmabuf.h"
+#include "dmabuf_feedback.h"
+#include "native_buffer.h"
 
 #include "wayland_wrapper.h"
 #include "mir/graphics/egl_extensions.h"
@@ -28,6 +30,7 @@
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/buffer_basic.h"
 #include "mir/executor.h"
+#include "mir/fd.h"
 
 #define MIR_LOG_COMPONENT "linux-dmabuf-import"
 #include "mir/log.h"
@@ -37,9 +40,11 @@
 #include <EGL/eglext.h>
 
 #include <boost/range/combine.hpp>
+#include <cstring>
 #include <mutex>
 #include <vector>
 #include <drm_fourcc.h>
+#include <sys/stat.h>
 #include <wayland-server.h>
 
 namespace mg = mir::graphics;
@@ -56,6 +61,17 @@ struct PlaneInfo
     uint32_t stride;
 };
 
+/**
+ * Can a buffer with this modifier be scanned out by RealKMSOutput::fb_for()?
+ *
+ * fb_for() creates framebuffers without explicit modifiers, so anything other
+ * than linear or implicit layouts would be misinterpreted by the display.
+ */
+bool modifier_can_be_scanned_out(uint64_t modifier)
+{
+    return modifier == DRM_FORMAT_MOD_LINEAR || modifier == DRM_FORMAT_MOD_INVALID;
+}
+
 /**
  * Holds on to all imported dmabuf buffers, and allows looking up by wl_buffer
  *
@@ -67,6 +83,7 @@ public:
     DmaBufBuffer(
         EGLDisplay dpy,
         std::shared_ptr<mg::EGLExtensions> egl_extensions,
+        gbm_device* scanout_device,
         wl_resource* wl_buffer,
         int32_t width,
         int32_t height,
@@ -77,6 +94,7 @@ public:
             : Buffer(wl_buffer, Version<1>{}),
               dpy{dpy},
               egl_extensions{std::move(egl_extensions)},
+              scanout_device{scanout_device},
               width{width},
               height{height},
               format_{format},
@@ -184,6 +202,54 @@ public:
         return image;
     }
 
+    /**
+     * Import the dmabuf into GBM so the display can scan out of it directly
+     *
+     * The import is only attempted once per wl_buffer; subsequent calls return
+     * the same gbm_bo, so the display's framebuffer for it is reused too.
+     *
+     * \return The imported buffer, or nullptr if this buffer can't be scanned out.
+     */
+    auto scanout_bo() -> std::shared_ptr<gbm_bo>
+    {
+        if (!bo && !scanout_import_attempted)
+        {
+            scanout_import_attempted = true;
+
+            if (!scanout_device ||
+                planes.size() != 1 ||
+                planes[0].offset != 0 ||
+                !modifier_can_be_scanned_out(modifier))
+            {
+                return nullptr;
+            }
+
+            gbm_import_fd_modifier_data import_data{};
+            import_data.width = width;
+            import_data.height = height;
+            import_data.format = format_;
+            import_data.num_fds = 1;
+            import_data.fds[0] = planes[0].fd;
+            import_data.strides[0] = planes[0].stride;
+            import_data.offsets[0] = planes[0].offset;
+            import_data.modifier = modifier;
+
+            if (auto const imported = gbm_bo_import(
+                scanout_device,
+                GBM_BO_IMPORT_FD_MODIFIER,
+                &import_data,
+                GBM_BO_USE_SCANOUT))
+            {
+                bo = std::shared_ptr<gbm_bo>{imported, &gbm_bo_destroy};
+            }
+            else
+            {
+                mir::log_debug("Client dmabuf cannot be imported for scanout: %s", strerror(errno));
+            }
+        }
+        return bo;
+    }
+
 private:
     void destroy() override
     {
@@ -192,12 +258,15 @@ private:
 
     EGLDisplay const dpy;
     std::shared_ptr<mg::EGLExtensions> const egl_extensions;
+    gbm_device* const scanout_device;
     int32_t const width, height;
     uint32_t const format_;
     uint32_t const flags;
     uint64_t const modifier;
     std::vector<PlaneInfo> const planes;
     EGLImageKHR image;
+    std::shared_ptr<gbm_bo> bo;
+    bool scanout_import_attempted{false};
 
     struct EGLPlaneAttribs
     {
@@ -245,11 +314,13 @@ public:
     LinuxDmaBufParams(
         wl_resource* new_resource,
         EGLDisplay dpy,
-        std::shared_ptr<mg::EGLExtensions> egl_extensions)
-        : mir::wayland::LinuxBufferParamsV1(new_resource, Version<3>{}),
+        std::shared_ptr<mg::EGLExtensions> egl_extensions,
+        gbm_device* scanout_device)
+        : mir::wayland::LinuxBufferParamsV1(new_resource, Version<4>{}),
           consumed{false},
           dpy{dpy},
-          egl_extensions{std::move(egl_extensions)}
+          egl_extensions{std::move(egl_extensions)},
+          scanout_device{scanout_device}
     {
     }
 
@@ -262,6 +333,7 @@ private:
     bool consumed;
     EGLDisplay dpy;
     std::shared_ptr<mg::EGLExtensions> egl_extensions;
+    gbm_device* const scanout_device;
 
     void destroy() override
     {
@@ -409,6 +481,7 @@ private:
             new DmaBufBuffer{
                 dpy,
                 egl_extensions,
+                scanout_device,
                 buffer_resource,
                 width,
                 height,
@@ -448,6 +521,7 @@ private:
             new DmaBufBuffer{
                 dpy,
                 egl_extensions,
+                scanout_device,
                 buffer_id,
                 width,
                 height,
@@ -512,6 +586,38 @@ bool drm_format_has_alpha(uint32_t format)
     }
 }
 
+/**
+ * The scanout handle of a client dmabuf, keeping its gbm_bo alive while the
+ * display might still be showing it.
+ */
+struct DmaBufNativeBuffer : mgg::NativeBuffer
+{
+    explicit DmaBufNativeBuffer(std::shared_ptr<gbm_bo> imported)
+        : mgg::NativeBuffer(),
+          imported{std::move(imported)}
+    {
+        bo = this->imported.get();
+        is_gbm_buffer = true;
+        native_format = gbm_bo_get_format(bo);
+        native_flags = GBM_BO_USE_SCANOUT;
+        flags = mir_buffer_flag_can_scanout;
+        width = gbm_bo_get_width(bo);
+        height = gbm_bo_get_height(bo);
+        stride = gbm_bo_get_stride(bo);
+    }
+
+    std::shared_ptr<gbm_bo> const imported;
+};
+
+auto scanout_handle_for(DmaBufBuffer& source) -> std::shared_ptr<mg::NativeBuffer>
+{
+    if (auto const bo = source.scanout_bo())
+    {
+        return std::make_shared<DmaBufNativeBuffer>(bo);
+    }
+    return nullptr;
+}
+
 class WaylandDmabufTexBuffer :
     public mg::BufferBasic,
     public mg::NativeBufferBase,
@@ -533,6 +639,7 @@ public:
           size_{source.size()},
           layout_{source.layout()},
           has_alpha{drm_format_has_alpha(source.format())},
+          native{scanout_handle_for(source)},
           wayland_executor{std::move(wayland_executor)}
     {
         eglBindAPI(EGL_OPENGL_ES_API);
@@ -565,7 +672,7 @@ public:
 
     std::shared_ptr<mir::graphics::NativeBuffer> native_buffer_handle() const override
     {
-        return {nullptr};
+        return native;
     }
 
     mir::geometry::Size size() const override
@@ -632,11 +739,19 @@ private:
     geom::Size const size_;
     Layout const layout_;
     bool const has_alpha;
+    std::shared_ptr<mir::graphics::NativeBuffer> const native;
 
     std::shared_ptr<mir::Executor> const wayland_executor;
 };
 
-
+/**
+ * View existing data as a wl_array, for the duration of a send_*_event() call
+ */
+template<typename T>
+auto as_wl_array(T const* data, size_t count) -> wl_array
+{
+    return wl_array{count * sizeof(T), count * sizeof(T), const_cast<T*>(data)};
+}
 }
 
 bool format_is_simple_enough_for_us(uint32_t format)
@@ -828,43 +943,107 @@ private:
     std::vector<std::vector<EGLBoolean>> external_only_for_format;
 };
 
-class mgg::LinuxDmaBufUnstable::Instance : public mir::wayland::LinuxDmabufV1
+namespace
+{
+/// The formats we can import, of those EGL lists
+auto importable_formats(mgg::DmaBufFormatDescriptors const& descriptors) -> std::vector<mgg::DmaBufFormat>
+{
+    std::vector<mgg::DmaBufFormat> formats;
+    for (auto i = 0u; i < descriptors.num_formats(); ++i)
+    {
+        auto [format, modifiers, external_only] = descriptors[i];
+
+        if (!format_is_simple_enough_for_us(format))
+        {
+            continue;
+        }
+
+        mgg::DmaBufFormat importable{static_cast<uint32_t>(format), {}};
+        for (auto j = 0u; j < modifiers.size(); ++j)
+        {
+            // We can't (currently) handle external images
+            if (external_only[j] == EGL_FALSE)
+            {
+                importable.modifiers.push_back(modifiers[j]);
+            }
+        }
+        formats.push_back(std::move(importable));
+    }
+    return formats;
+}
+
+auto device_number(gbm_device* device) -> dev_t
+{
+    struct stat device_stat;
+    if (fstat(gbm_device_get_fd(device), &device_stat) != 0)
+    {
+        BOOST_THROW_EXCEPTION((
+            std::system_error{errno, std::system_category(), "Failed to stat DRM device"}));
+    }
+    return device_stat.st_rdev;
+}
+}
+
+class mgg::LinuxDmaBufUnstable::Feedback : public mir::wayland::LinuxDmabufFeedbackV1,
+                                           DmaBufFeedbackParameters::FeedbackSink
+{
+public:
+    Feedback(wl_resource* new_resource, DmaBufFeedbackParameters const& parameters)
+        : mir::wayland::LinuxDmabufFeedbackV1(new_resource, Version<4>{})
+    {
+        parameters.send_feedback(*this);
+    }
+
+private:
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    void format_table(mir::Fd const& table, uint32_t size) override
+    {
+        send_format_table_event(table, size);
+    }
+
+    void main_device(dev_t device) override
+    {
+        auto device_array = as_wl_array(&device, 1);
+        send_main_device_event(&device_array);
+    }
+
+    void tranche(dev_t target_device, uint32_t flags, std::vector<uint16_t> const& indices) override
+    {
+        auto device_array = as_wl_array(&target_device, 1);
+        auto indices_array = as_wl_array(indices.data(), indices.size());
+        send_tranche_target_device_event(&device_array);
+        send_tranche_flags_event(flags);
+        send_tranche_formats_event(&indices_array);
+        send_tranche_done_event();
+    }
+
+    void done() override
+    {
+        send_done_event();
+    }
+};
+
+class mgg::LinuxDmaBufUnstable::Instance : public mir::wayland::LinuxDmabufV1,
+                                           DmaBufFeedbackParameters::FormatSink
 {
 public:
     Instance(
         wl_resource* new_resource,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        DmaBufFormatDescriptors const& formats)
-        : mir::wayland::LinuxDmabufV1(new_resource, Version<3>{}),
+        gbm_device* scanout_device,
+        std::shared_ptr<DmaBufFeedbackParameters> feedback)
+        : mir::wayland::LinuxDmabufV1(new_resource, Version<4>{}),
           dpy{dpy},
-          egl_extensions{std::move(egl_extensions)}
+          egl_extensions{std::move(egl_extensions)},
+          scanout_device{scanout_device},
+          feedback{std::move(feedback)}
     {
-        for (auto i = 0u; i < formats.num_formats(); ++i)
-        {
-            auto [format, modifiers, external_only] = formats[i];
-
-            if (format_is_simple_enough_for_us(format))
-            {
-                send_format_event(format);
-                if (version_supports_modifier())
-                {
-                    for (auto j = 0u; j < modifiers.size(); ++j)
-                    {
-                        auto const modifier = modifiers[j];
-                        auto const external = external_only[j];
-                        if (external == EGL_FALSE)
-                        {
-                            // We can't (currently) handle external images
-                            send_modifier_event(
-                                format,
-                                modifier >> 32,
-                                modifier & 0xFFFFFFFF);
-                        }
-                    }
-                }
-            }
-        }
+        this->feedback->send_formats(*this, wl_resource_get_version(resource));
     }
 private:
     void destroy() override
@@ -874,22 +1053,49 @@ private:
 
     void create_params(struct wl_resource* params_id) override
     {
-        new LinuxDmaBufParams{params_id, dpy, egl_extensions};
+        new LinuxDmaBufParams{params_id, dpy, egl_extensions, scanout_device};
+    }
+
+    void format(uint32_t format) override
+    {
+        send_format_event(format);
+    }
+
+    void modifier(uint32_t format, uint64_t modifier) override
+    {
+        send_modifier_event(format, modifier >> 32, modifier & 0xFFFFFFFF);
+    }
+
+    void get_default_feedback(struct wl_resource* id) override
+    {
+        new Feedback{id, *feedback};
+    }
+
+    void get_surface_feedback(struct wl_resource* id, struct wl_resource* /*surface*/) override
+    {
+        new Feedback{id, *feedback};
     }
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
+    gbm_device* const scanout_device;
+    std::shared_ptr<DmaBufFeedbackParameters> const feedback;
 };
 
 mgg::LinuxDmaBufUnstable::LinuxDmaBufUnstable(
     wl_display* display,
     EGLDisplay dpy,
     std::shared_ptr<EGLExtensions> egl_extensions,
-    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext)
-    : mir::wayland::LinuxDmabufV1::Global(display, Version<3>{}),
+    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+    gbm_device* device,
+    bool scanout_allowed)
+    : mir::wayland::LinuxDmabufV1::Global(display, Version<4>{}),
       dpy{dpy},
       egl_extensions{std::move(egl_extensions)},
-      formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)}
+      scanout_device{scanout_allowed ? device : nullptr},
+      feedback{std::make_shared<DmaBufFeedbackParameters>(
+          importable_formats(DmaBufFormatDescriptors{dpy, dmabuf_ext}),
+          device_number(device))}
 {
 }
 
@@ -916,5 +1122,10 @@ auto mgg::LinuxDmaBufUnstable::buffer_from_resource(
 
 void mgg::LinuxDmaBufUnstable::bind(wl_resource* new_resource)
 {
-    new LinuxDmaBufUnstable::Instance{new_resource, dpy, egl_extensions, *formats};
+    new LinuxDmaBufUnstable::Instance{
+        new_resource,
+        dpy,
+        egl_extensions,
+        scanout_device,
+        feedback};
 }
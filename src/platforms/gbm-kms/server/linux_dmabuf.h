@@ -22,6 +22,7 @@
 #include "linux-dmabuf-unstable-v1_wrapper.h"
 
 #include <EGL/egl.h>
+#include <gbm.h>
 
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/egl_extensions.h"
@@ -45,6 +46,7 @@ namespace graphics
 namespace gbm
 {
 class DmaBufFormatDescriptors;
+class DmaBufFeedbackParameters;
 
 class LinuxDmaBufUnstable : public wayland::LinuxDmabufV1::Global
 {
@@ -53,7 +55,9 @@ public:
         wl_display* display,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext);
+        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+        gbm_device* device,
+        bool scanout_allowed);
 
     std::shared_ptr<Buffer> buffer_from_resource(
         wl_resource* buffer,
@@ -64,11 +68,14 @@ public:
 
 private:
     class Instance;
+    class Feedback;
     void bind(wl_resource* new_resource) override;
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
-    std::shared_ptr<DmaBufFormatDescriptors> const formats;
+    /// Non-null only if client dmabufs may be scanned out directly (see DisplayBuffer::overlay())
+    gbm_device* const scanout_device;
+    std::shared_ptr<DmaBufFeedbackParameters> const feedback;
 };
 
 }
@@ -0,0 +1,47 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositing_bypass.h"
+
+#include <algorithm>
+
+namespace mgw = mir::graphics::wayland;
+namespace geom = mir::geometry;
+
+mgw::HostBufferPool::HostBufferPool(BufferFactory create_buffer) :
+    create_buffer{std::move(create_buffer)}
+{
+}
+
+auto mgw::HostBufferPool::acquire(geom::Size size) -> HostBuffer&
+{
+    buffers.erase(
+        std::remove_if(begin(buffers), end(buffers), [&](auto const& buffer)
+            { return !buffer->busy && buffer->size != size; }),
+        end(buffers));
+
+    auto idle = std::find_if(begin(buffers), end(buffers), [&](auto const& buffer)
+        { return !buffer->busy && buffer->size == size; });
+
+    if (idle == end(buffers))
+    {
+        buffers.push_back(create_buffer(size));
+        idle = end(buffers) - 1;
+    }
+
+    (*idle)->busy = true;
+    return **idle;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PLATFORMS_WAYLAND_COMPOSITING_BYPASS_H_
+#define MIR_PLATFORMS_WAYLAND_COMPOSITING_BYPASS_H_
+
+#include <mir/geometry/size.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace wayland
+{
+/// A buffer on the host, busy from when it is handed out until the host releases it
+class HostBuffer
+{
+public:
+    explicit HostBuffer(geometry::Size size) : size{size} {}
+    virtual ~HostBuffer() = default;
+
+    HostBuffer(HostBuffer const&) = delete;
+    HostBuffer& operator=(HostBuffer const&) = delete;
+
+    geometry::Size const size;
+    std::atomic<bool> busy{false};
+};
+
+/**
+ * The host buffers that bypassed frames are copied into, reused once the host releases them
+ *
+ * \see common::cpu_copy_bypass_candidate()
+ */
+class HostBufferPool
+{
+public:
+    using BufferFactory = std::function<std::unique_ptr<HostBuffer>(geometry::Size size)>;
+
+    explicit HostBufferPool(BufferFactory create_buffer);
+
+    /**
+     * An idle buffer of \a size, which is marked busy
+     *
+     * One is created if none is idle. Idle buffers of any other size (left over from
+     * a different mode) are freed.
+     */
+    auto acquire(geometry::Size size) -> HostBuffer&;
+
+private:
+    BufferFactory const create_buffer;
+    std::vector<std::unique_ptr<HostBuffer>> buffers;
+};
+}
+}
+}
+
+#endif // MIR_PLATFORMS_WAYLAND_COMPOSITING_BYPASS_H_
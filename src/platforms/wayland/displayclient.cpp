@@ -16,8 +16,13 @@
  */
 
 #include "displayclient.h"
+#include "compositing_bypass.h"
+#include "cpu_copy_bypass.h"
 #include "mir/graphics/egl_error.h"
 #include <mir/graphics/pixel_format_utils.h>
+#include <mir/graphics/buffer.h>
+#include <mir/renderer/sw/pixel_source.h>
+#include <mir/anonymous_shm_file.h>
 
 #include <wayland-client.h>
 #include <wayland-egl.h>
@@ -31,10 +36,14 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstring>
+#include <limits>
 #include <stdlib.h>
 #include <system_error>
 
+namespace mgc = mir::graphics::common;
 namespace mgw = mir::graphics::wayland;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
 
 class mgw::DisplayClient::Output  :
     public DisplaySyncGroup,
@@ -111,6 +120,45 @@ public:
     void release_current() override;
     void swap_buffers() override;
     void bind() override;
+
+private:
+    class ShmHostBuffer;
+
+    /// The client buffer overlay() chose to copy straight to the host this frame, if any
+    std::shared_ptr<Buffer> bypass_buffer;
+    HostBufferPool host_buffers;
+
+    void post_bypass();
+};
+
+/// A wl_shm buffer on the host that bypassed frames are copied into
+class mgw::DisplayClient::Output::ShmHostBuffer : public HostBuffer
+{
+public:
+    ShmHostBuffer(wl_shm* shm, geom::Size size) :
+        HostBuffer{size},
+        stride{4 * size.width.as_int()},
+        shm_file{static_cast<size_t>(stride * size.height.as_int())}
+    {
+        auto const pool = wl_shm_create_pool(shm, shm_file.fd(), stride * size.height.as_int());
+        buffer = wl_shm_pool_create_buffer(
+            pool, 0, size.width.as_int(), size.height.as_int(), stride, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+
+        static wl_buffer_listener const buffer_listener{
+            [](void* data, wl_buffer*) { static_cast<ShmHostBuffer*>(data)->busy = false; }
+        };
+        wl_buffer_add_listener(buffer, &buffer_listener, this);
+    }
+
+    ~ShmHostBuffer()
+    {
+        wl_buffer_destroy(buffer);
+    }
+
+    int const stride;
+    AnonymousShmFile const shm_file;
+    wl_buffer* buffer;
 };
 
 namespace
@@ -120,6 +168,46 @@ static EGLint const ctxattribs[] =
         EGL_CONTEXT_CLIENT_VERSION, 2,
         EGL_NONE
     };
+
+// Waits for the host to tell us a commit has been presented
+struct FrameSync
+{
+    explicit FrameSync(wl_surface* surface) :
+        callback{wl_surface_frame(surface)}
+    {
+        static struct wl_callback_listener const frame_listener =
+            {
+                [](void* data, auto... args)
+                    { static_cast<FrameSync*>(data)->frame_done(args...); },
+            };
+
+        wl_callback_add_listener(callback, &frame_listener, this);
+    }
+
+    ~FrameSync()
+    {
+        wl_callback_destroy(callback);
+    }
+
+    void frame_done(wl_callback*, uint32_t)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        posted = true;
+        cv.notify_all();
+    }
+
+    void wait_for_done()
+    {
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait(lock, [this]{ return posted; });
+    }
+
+    std::mutex mutex;
+    bool posted = false;
+    std::condition_variable cv;
+
+    wl_callback* const callback;
+};
 }
 
 void mgw::DisplayClient::Output::geometry(
@@ -239,7 +327,8 @@ mgw::DisplayClient::Output::Output(
     owner{owner},
     surface{wl_compositor_create_surface(owner->compositor)},
     on_done{[this, on_constructed = std::move(on_constructed), on_change=std::move(on_change)]
-        (Output const& o) mutable { on_constructed(o), on_done = std::move(on_change); }}
+        (Output const& o) mutable { on_constructed(o), on_done = std::move(on_change); }},
+    host_buffers{[owner](geom::Size size) { return std::make_unique<ShmHostBuffer>(owner->shm, size); }}
 {
     wl_output_add_listener(output, &output_listener, this);
 
@@ -316,6 +405,35 @@ void mgw::DisplayClient::Output::for_each_display_buffer(std::function<void(Disp
 
 void mgw::DisplayClient::Output::post()
 {
+    if (bypass_buffer)
+    {
+        post_bypass();
+        bypass_buffer.reset();
+    }
+}
+
+void mgw::DisplayClient::Output::post_bypass()
+{
+    auto const mapping = dynamic_cast<mrs::ReadMappableBuffer*>(bypass_buffer->native_buffer_base())->map_readable();
+    auto const size = mapping->size();
+    auto const target = static_cast<ShmHostBuffer*>(&host_buffers.acquire(size));
+
+    // The host can't read the client's buffer, so it is copied into one of ours
+    auto const row_length = 4 * size.width.as_int();
+    auto const source_stride = mapping->stride().as_int();
+    auto const source = mapping->data();
+    auto const destination = static_cast<unsigned char*>(target->shm_file.base_ptr());
+    for (auto row = 0; row != size.height.as_int(); ++row)
+        memcpy(destination + row * target->stride, source + row * source_stride, row_length);
+
+    FrameSync frame_sync{surface};
+
+    wl_surface_attach(surface, target->buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max());
+    wl_surface_commit(surface);
+    wl_display_flush(owner->display);
+
+    frame_sync.wait_for_done();
 }
 
 auto mgw::DisplayClient::Output::recommended_sleep() const -> std::chrono::milliseconds
@@ -328,9 +446,14 @@ auto mgw::DisplayClient::Output::view_area() const -> geometry::Rectangle
     return dcout.extents();
 }
 
-bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const&)
+bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const& renderlist)
 {
-    return false;
+    bypass_buffer = window ?
+        mgc::cpu_copy_bypass_candidate(
+            renderlist, view_area(), transformation(), dcout.modes[dcout.current_mode_index].size) :
+        nullptr;
+
+    return bypass_buffer != nullptr;
 }
 
 auto mgw::DisplayClient::Output::transformation() const -> glm::mat2
@@ -359,44 +482,7 @@ void mgw::DisplayClient::Output::release_current()
 
 void mgw::DisplayClient::Output::swap_buffers()
 {
-    struct FrameSync
-    {
-        explicit FrameSync(wl_surface* surface) :
-            callback{wl_surface_frame(surface)}
-        {
-            static struct wl_callback_listener const frame_listener =
-                {
-                    [](void* data, auto... args)
-                        { static_cast<FrameSync*>(data)->frame_done(args...); },
-                };
-
-            wl_callback_add_listener(callback, &frame_listener, this);
-        }
-
-        ~FrameSync()
-        {
-            wl_callback_destroy(callback);
-        }
-
-        void frame_done(wl_callback*, uint32_t)
-        {
-            std::lock_guard<decltype(mutex)> lock{mutex};
-            posted = true;
-            cv.notify_all();
-        }
-
-        void wait_for_done()
-        {
-            std::unique_lock<decltype(mutex)> lock{mutex};
-            cv.wait(lock, [this]{ return posted; });
-        }
-
-        std::mutex mutex;
-        bool posted = false;
-        std::condition_variable cv;
-
-        wl_callback* const callback;
-    } frame_sync{surface};
+    FrameSync frame_sync{surface};
 
     // Avoid throttling compositing by blocking in eglSwapBuffers().
     // Instead we use the frame "done" notification.
@@ -272,6 +272,7 @@ mgx::Display::Display(::Display* x_dpy,
             configuration->id,
             *window,
             configuration->extents(),
+            configuration->modes[configuration->current_mode_index].vrefresh_hz,
             shared_egl.context(),
             last_frame,
             report,
@@ -318,6 +319,7 @@ void mgx::Display::configure(mg::DisplayConfiguration const& new_configuration)
             std::logic_error("Invalid or inconsistent display configuration"));
     }
 
+    // Compositing is stopped for a full reconfiguration, so every output can be updated
     new_configuration.for_each_output([&](DisplayConfigurationOutput const& conf_output)
     {
         bool found_info = false;
@@ -326,9 +328,7 @@ void mgx::Display::configure(mg::DisplayConfiguration const& new_configuration)
         {
             if (output->configuration->id == conf_output.id)
             {
-                *output->configuration = conf_output;
-                output->display_buffer->set_view_area(output->configuration->extents());
-                output->display_buffer->set_transformation(output->configuration->transformation());
+                output->configure(conf_output);
                 found_info = true;
                 break;
             }
@@ -377,6 +377,49 @@ std::unique_ptr<mir::renderer::gl::Context> mgx::Display::create_gl_context() co
     return std::make_unique<XGLContext>(x_dpy, gl_config, shared_egl.context());
 }
 
+bool mgx::Display::configure_incrementally(
+    mg::DisplayConfiguration const& new_configuration,
+    mg::DisplaySyncGroupReleaseHandler const& release)
+{
+    if (!new_configuration.valid())
+    {
+        BOOST_THROW_EXCEPTION(
+            std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    // Each output has its own window, so only those whose configuration changes need releasing
+    std::vector<std::pair<OutputInfo*, DisplayConfigurationOutput>> changed;
+    new_configuration.for_each_output([&](DisplayConfigurationOutput const& conf_output)
+    {
+        bool found_info = false;
+
+        for (auto const& output : outputs)
+        {
+            if (output->configuration->id == conf_output.id)
+            {
+                if (*output->configuration != conf_output)
+                    changed.emplace_back(output.get(), conf_output);
+                found_info = true;
+                break;
+            }
+        }
+
+        if (!found_info)
+            mir::log_error("Could not find info for output %d", conf_output.id.as_value());
+    });
+
+    std::vector<mg::DisplaySyncGroup*> released;
+    for (auto const& change : changed)
+        released.push_back(change.first->display_buffer.get());
+    release(released);
+
+    // The other outputs are still being composited, so they must not be touched
+    for (auto const& change : changed)
+        change.first->configure(change.second);
+
+    return true;
+}
+
 bool mgx::Display::apply_if_configuration_preserves_display_buffers(
     mg::DisplayConfiguration const& /*conf*/)
 {
@@ -403,3 +446,10 @@ mgx::Display::OutputInfo::~OutputInfo()
 {
     mx::X11Resources::instance.clear_output_config_for_win(*this->window);
 }
+
+void mgx::Display::OutputInfo::configure(DisplayConfigurationOutput const& conf)
+{
+    *configuration = conf;
+    display_buffer->set_view_area(configuration->extents());
+    display_buffer->set_transformation(configuration->transformation());
+}
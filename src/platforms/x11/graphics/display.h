@@ -84,6 +84,10 @@ public:
 
     void configure(graphics::DisplayConfiguration const&) override;
 
+    bool configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        DisplaySyncGroupReleaseHandler const& release) override;
+
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
         DisplayConfigurationChangeHandler const& conf_change_handler) override;
@@ -112,6 +116,9 @@ private:
             std::shared_ptr<DisplayConfigurationOutput> configuration);
         ~OutputInfo();
 
+        /// Only safe while this output's display buffer is not being composited
+        void configure(DisplayConfigurationOutput const& conf);
+
         std::unique_ptr<X11Window> window;
         std::unique_ptr<DisplayBuffer> display_buffer;
         std::shared_ptr<DisplayConfigurationOutput> configuration;
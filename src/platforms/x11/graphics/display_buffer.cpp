@@ -21,18 +21,175 @@
 #include "mir/fatal.h"
 #include "display_buffer.h"
 #include "display_configuration.h"
+#include "cpu_copy_bypass.h"
+#include "mir/graphics/buffer.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
+#include "mir/renderer/sw/pixel_ops.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#define MIR_LOG_COMPONENT "x11-display"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
 #include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
 
 namespace mg=mir::graphics;
+namespace mgc=mg::common;
 namespace mgx=mg::X;
+namespace mrs=mir::renderer::software;
 namespace geom=mir::geometry;
 
+namespace
+{
+class FramebufferMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    FramebufferMapping(uint32_t* pixels, geom::Size size)
+        : pixels{pixels},
+          size_{size}
+    {
+    }
+
+    MirPixelFormat format() const override
+    {
+        return mir_pixel_format_xrgb_8888;
+    }
+
+    geom::Stride stride() const override
+    {
+        return geom::Stride{size_.width.as_uint32_t() * sizeof(uint32_t)};
+    }
+
+    geom::Size size() const override
+    {
+        return size_;
+    }
+
+    unsigned char* data() override
+    {
+        return reinterpret_cast<unsigned char*>(pixels);
+    }
+
+    size_t len() const override
+    {
+        return stride().as_uint32_t() * size_.height.as_uint32_t();
+    }
+
+private:
+    uint32_t* const pixels;
+    geom::Size const size_;
+};
+
+/*
+ * Xlib reports errors through a single process-wide handler, so while we wait to hear
+ * whether the X server could attach a segment we swap in one that notes that failure
+ * and passes everything else on.
+ */
+std::mutex shm_attach_mutex;
+int const shm_attach_request{1}; // X_ShmAttach, from <X11/extensions/shmproto.h>
+int shm_opcode{0};
+bool shm_attach_failed{false};
+XErrorHandler previous_error_handler{nullptr};
+
+int note_shm_attach_error(::Display* dpy, XErrorEvent* event)
+{
+    if (event->request_code == shm_opcode && event->minor_code == shm_attach_request)
+    {
+        shm_attach_failed = true;
+        return 0;
+    }
+
+    return previous_error_handler ? previous_error_handler(dpy, event) : 0;
+}
+
+/// Attaches \a segment to the X server, returning false if it can't (a remote server can't)
+auto attach_shm_segment(::Display* x_dpy, XShmSegmentInfo* segment) -> bool
+{
+    std::lock_guard<std::mutex> lock{shm_attach_mutex};
+
+    int first_event, first_error;
+    if (!XQueryExtension(x_dpy, "MIT-SHM", &shm_opcode, &first_event, &first_error))
+        return false;
+
+    // Errors from earlier requests are none of our business
+    XSync(x_dpy, False);
+
+    shm_attach_failed = false;
+    previous_error_handler = XSetErrorHandler(&note_shm_attach_error);
+    XShmAttach(x_dpy, segment);
+    XSync(x_dpy, False);
+    XSetErrorHandler(previous_error_handler);
+
+    return !shm_attach_failed;
+}
+}
+
+/// An XImage in a MIT-SHM segment, so the X server reads the pixels without them crossing the socket
+class mgx::DisplayBuffer::ShmImage
+{
+public:
+    ShmImage(::Display* x_dpy, Visual* visual, int depth, geom::Size size) :
+        x_dpy{x_dpy},
+        size{size}
+    {
+        image = XShmCreateImage(
+            x_dpy, visual, depth, ZPixmap, nullptr, &segment, size.width.as_uint32_t(), size.height.as_uint32_t());
+        if (!image)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Failed to create X11 shared memory image"));
+
+        segment.shmid = shmget(IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+        if (segment.shmid < 0)
+        {
+            XDestroyImage(image);
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to allocate shared memory"}));
+        }
+
+        segment.shmaddr = image->data = static_cast<char*>(shmat(segment.shmid, nullptr, 0));
+        segment.readOnly = False;
+        auto const attached = attach_shm_segment(x_dpy, &segment);
+
+        // Both ends are attached (or never will be), so the segment can be marked for removal
+        shmctl(segment.shmid, IPC_RMID, nullptr);
+
+        if (!attached)
+        {
+            shmdt(segment.shmaddr);
+            XDestroyImage(image);
+            BOOST_THROW_EXCEPTION(std::runtime_error("X server failed to attach shared memory"));
+        }
+    }
+
+    ~ShmImage()
+    {
+        XShmDetach(x_dpy, &segment);
+        XSync(x_dpy, False);
+        XDestroyImage(image);
+        shmdt(segment.shmaddr);
+    }
+
+    ShmImage(ShmImage const&) = delete;
+    ShmImage& operator=(ShmImage const&) = delete;
+
+    ::Display* const x_dpy;
+    geom::Size const size;
+    XShmSegmentInfo segment;
+    XImage* image;
+};
+
 mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
                                   DisplayConfigurationOutputId output_id,
                                   Window const win,
                                   geometry::Rectangle const& view_area,
+                                  double refresh_rate,
                                   EGLContext const shared_context,
                                   std::shared_ptr<AtomicFrame> const& f,
                                   std::shared_ptr<DisplayReport> const& r,
@@ -43,7 +200,11 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
                                     egl{gl_config},
                                     last_frame{f},
                                     output_id{output_id},
-                                    eglGetSyncValues{nullptr}
+                                    min_frame_interval{std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        std::chrono::milliseconds{1000} / refresh_rate)},
+                                    eglGetSyncValues{nullptr},
+                                    x_dpy{x_dpy},
+                                    win{win}
 {
     egl.setup(x_dpy, win, shared_context);
     egl.report_egl_configuration(
@@ -83,6 +244,13 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
     }
 }
 
+mgx::DisplayBuffer::~DisplayBuffer()
+{
+    shm_image.reset();
+    if (gc)
+        XFreeGC(x_dpy, gc);
+}
+
 geom::Rectangle mgx::DisplayBuffer::view_area() const
 {
     return area;
@@ -99,9 +267,13 @@ void mgx::DisplayBuffer::release_current()
     egl.release_current();
 }
 
-bool mgx::DisplayBuffer::overlay(RenderableList const& /*renderlist*/)
+bool mgx::DisplayBuffer::overlay(RenderableList const& renderlist)
 {
-    return false;
+    if (!visual)
+        query_window_attributes();
+
+    passthrough = mgc::cpu_copy_bypass_candidate(renderlist, area, transform, framebuffer_size);
+    return passthrough != nullptr;
 }
 
 void mgx::DisplayBuffer::swap_buffers()
@@ -174,9 +346,176 @@ void mgx::DisplayBuffer::for_each_display_buffer(
 
 void mgx::DisplayBuffer::post()
 {
+    using namespace std::chrono_literals;
+
+    // Predicted worst case render time for the next frame, as on gbm-kms...
+    auto predicted_render_time = 50ms;
+
+    if (passthrough)
+    {
+        post_passthrough();
+        passthrough.reset();
+
+        // ...but the next frame is very likely passed through as well, which is only a copy
+        predicted_render_time = 5ms;
+    }
+
+    recommend_sleep = 0ms;
+    if (predicted_render_time < min_frame_interval)
+        recommend_sleep = min_frame_interval - predicted_render_time;
+}
+
+void mgx::DisplayBuffer::post_passthrough()
+{
+    auto const mapping = dynamic_cast<mrs::ReadMappableBuffer*>(passthrough->native_buffer_base())->map_readable();
+    auto const size = mapping->size();
+    auto const width = size.width.as_uint32_t();
+    auto const source_stride = mapping->stride().as_uint32_t();
+    auto const source = mapping->data();
+
+    if (has_shm && (!shm_image || shm_image->size != size))
+    {
+        shm_image.reset();
+        try
+        {
+            shm_image = std::make_unique<ShmImage>(x_dpy, visual, depth, size);
+        }
+        catch (std::exception const& error)
+        {
+            mir::log_info("Not using MIT-SHM for X11 output: %s", error.what());
+            has_shm = false;
+        }
+    }
+
+    if (!has_shm)
+    {
+        // Without MIT-SHM this is the software rendering path, minus the rendering
+        framebuffer.resize(width * size.height.as_uint32_t());
+        for (auto row = 0u; row != size.height.as_uint32_t(); ++row)
+        {
+            memcpy(framebuffer.data() + row * width, source + row * source_stride, width * sizeof(uint32_t));
+        }
+        present({geom::Rectangle{{0, 0}, size}});
+        return;
+    }
+
+    auto const image = shm_image->image;
+    for (auto row = 0u; row != size.height.as_uint32_t(); ++row)
+    {
+        auto const from = reinterpret_cast<uint32_t const*>(source + row * source_stride);
+        auto const to = reinterpret_cast<uint32_t*>(image->data + row * image->bytes_per_line);
+        if (swap_red_and_blue)
+            mrs::swap_red_blue(from, to, width);
+        else
+            memcpy(to, from, width * sizeof(uint32_t));
+    }
+
+    if (!gc)
+        gc = XCreateGC(x_dpy, win, 0, nullptr);
+
+    XShmPutImage(x_dpy, win, gc, image, 0, 0, 0, 0, width, size.height.as_uint32_t(), False);
+
+    /*
+     * Waiting for the server to process the request means it has finished reading the segment
+     * before we write the next frame into it, and keeps us from queuing frames faster than the
+     * host can show them.
+     */
+    XSync(x_dpy, False);
+
+    // The window no longer shows what is in the software framebuffer
+    presented = false;
+    last_frame->increment_now();
+    report->report_vsync(output_id.as_value(), last_frame->load());
 }
 
 std::chrono::milliseconds mgx::DisplayBuffer::recommended_sleep() const
 {
-    return std::chrono::milliseconds::zero();
+    return recommend_sleep;
+}
+
+void mgx::DisplayBuffer::query_window_attributes()
+{
+    XWindowAttributes attributes;
+    if (!XGetWindowAttributes(x_dpy, win, &attributes))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to get X11 window attributes"));
+
+    visual = attributes.visual;
+    depth = attributes.depth;
+    swap_red_and_blue = visual->red_mask != 0xff0000;
+    has_shm = XShmQueryExtension(x_dpy);
+    framebuffer_size = geom::Size{attributes.width, attributes.height};
+}
+
+auto mgx::DisplayBuffer::map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    // Only software rendering and passthrough need these, so don't make a round trip unless they're used
+    if (!visual)
+        query_window_attributes();
+
+    framebuffer.resize(framebuffer_size.width.as_uint32_t() * framebuffer_size.height.as_uint32_t());
+    return std::make_unique<FramebufferMapping>(framebuffer.data(), framebuffer_size);
+}
+
+auto mgx::DisplayBuffer::framebuffer_age() const -> unsigned
+{
+    // There is only the one framebuffer, and it keeps what was drawn into it
+    return presented ? 1 : 0;
+}
+
+void mgx::DisplayBuffer::present(std::vector<geom::Rectangle> const& damage)
+{
+    auto const width = framebuffer_size.width.as_int();
+    auto const height = framebuffer_size.height.as_int();
+    auto pixels = framebuffer.data();
+
+    if (swap_red_and_blue)
+    {
+        swapped_framebuffer.resize(framebuffer.size());
+        for (auto const& rect : damage)
+        {
+            for (auto y = rect.top().as_int(); y != rect.bottom().as_int(); ++y)
+            {
+                auto const offset = y * width + rect.left().as_int();
+                mrs::swap_red_blue(
+                    framebuffer.data() + offset,
+                    swapped_framebuffer.data() + offset,
+                    rect.size.width.as_uint32_t());
+            }
+        }
+        pixels = swapped_framebuffer.data();
+    }
+
+    if (!gc)
+        gc = XCreateGC(x_dpy, win, 0, nullptr);
+
+    auto const image = XCreateImage(
+        x_dpy, visual, depth, ZPixmap, 0, reinterpret_cast<char*>(pixels),
+        width, height, 32, width * sizeof(uint32_t));
+    if (!image)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to create X11 image"));
+
+    // The pixels are native-endian 32-bit values; Xlib converts if the server differs
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    image->byte_order = LSBFirst;
+#else
+    image->byte_order = MSBFirst;
+#endif
+
+    for (auto const& rect : damage)
+    {
+        XPutImage(
+            x_dpy, win, gc, image,
+            rect.left().as_int(), rect.top().as_int(),
+            rect.left().as_int(), rect.top().as_int(),
+            rect.size.width.as_uint32_t(), rect.size.height.as_uint32_t());
+    }
+
+    // The pixels are ours, not the image's
+    image->data = nullptr;
+    XDestroyImage(image);
+    XFlush(x_dpy);
+
+    presented = true;
+    last_frame->increment_now();
+    report->report_vsync(output_id.as_value(), last_frame->load());
 }
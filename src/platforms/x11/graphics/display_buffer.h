@@ -24,10 +24,13 @@
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/display.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 #include "egl_helper.h"
 
 #include <EGL/egl.h>
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -35,6 +38,7 @@ namespace graphics
 {
 
 class AtomicFrame;
+class Buffer;
 class GLConfig;
 class DisplayReport;
 
@@ -44,7 +48,8 @@ namespace X
 class DisplayBuffer : public graphics::DisplayBuffer,
                       public graphics::DisplaySyncGroup,
                       public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+                      public renderer::gl::RenderTarget,
+                      public renderer::software::RenderTarget
 {
 public:
     DisplayBuffer(
@@ -52,10 +57,12 @@ public:
             DisplayConfigurationOutputId output_id,
             Window const win,
             geometry::Rectangle const& view_area,
+            double refresh_rate,
             EGLContext const shared_context,
             std::shared_ptr<AtomicFrame> const& f,
             std::shared_ptr<DisplayReport> const& r,
             GLConfig const& gl_config);
+    ~DisplayBuffer();
 
     geometry::Rectangle view_area() const override;
     void make_current() override;
@@ -74,18 +81,46 @@ public:
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
+    auto map_framebuffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    auto framebuffer_age() const -> unsigned override;
+    void present(std::vector<geometry::Rectangle> const& damage) override;
+
 private:
+    class ShmImage;
+
+    void query_window_attributes();
+    void post_passthrough();
+
     std::shared_ptr<DisplayReport> const report;
     geometry::Rectangle area;
     glm::mat2 transform;
     helpers::EGLHelper egl;
     std::shared_ptr<AtomicFrame> const last_frame;
     DisplayConfigurationOutputId output_id;
+    std::chrono::milliseconds const min_frame_interval;
+    std::chrono::milliseconds recommend_sleep{0};
 
     typedef EGLBoolean (EGLAPIENTRY EglGetSyncValuesCHROMIUM)
         (EGLDisplay dpy, EGLSurface surface, int64_t *ust,
          int64_t *msc, int64_t *sbc);
     EglGetSyncValuesCHROMIUM* eglGetSyncValues;
+
+    /* For software rendering: a framebuffer in CPU memory, copied to the window on present() */
+    ::Display* const x_dpy;
+    Window const win;
+    Visual* visual{nullptr};
+    int depth{0};
+    bool swap_red_and_blue{false};
+    bool has_shm{false};
+    geometry::Size framebuffer_size;
+    std::vector<uint32_t> framebuffer;
+    std::vector<uint32_t> swapped_framebuffer;
+    GC gc{nullptr};
+    bool presented{false};
+
+    /* For passthrough: a client buffer overlay() chose to show without compositing */
+    std::shared_ptr<Buffer> passthrough;
+    std::unique_ptr<ShmImage> shm_image;
 };
 
 }
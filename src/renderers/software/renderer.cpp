@@ -0,0 +1,625 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/sw/pixel_ops.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/thread/basic_thread_pool.h"
+#include "mir/report_exception.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <future>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+struct mrs::Renderer::Canvas
+{
+    uint32_t* pixels;
+    size_t stride;      ///< In pixels
+    geom::Size size;
+
+    auto row(int y) const -> uint32_t*
+    {
+        return pixels + y * stride;
+    }
+
+    auto area() const -> geom::Rectangle
+    {
+        return {{0, 0}, size};
+    }
+};
+
+/// What was drawn for a renderable; if this is unchanged, so are the pixels
+struct mrs::Renderer::LayerState
+{
+    mg::Renderable::ID id;
+    mg::BufferID buffer_id;
+    geom::Rectangle area;   ///< The visible area in canvas pixels
+    geom::Rectangle source; ///< The part of the buffer drawn, in buffer pixels
+    float alpha;
+    bool shaped;
+
+    bool operator==(LayerState const& other) const
+    {
+        return id == other.id &&
+            buffer_id == other.buffer_id &&
+            area == other.area &&
+            source == other.source &&
+            alpha == other.alpha &&
+            shaped == other.shaped;
+    }
+};
+
+struct mrs::Renderer::Layer
+{
+    LayerState state;
+    std::shared_ptr<mg::Buffer> buffer;
+    geom::Rectangle destination;    ///< Where state.source is drawn, in canvas pixels
+    uint8_t opacity;
+    bool source_is_opaque;
+    bool swap_red_blue;
+
+    /* Set once the buffer is mapped; if pixels is null the layer isn't drawn */
+    uint32_t const* pixels{nullptr};
+    size_t stride{0};               ///< In pixels
+
+    /// When scaling, the source column for each column of state.area
+    std::vector<uint32_t> columns;
+
+    bool scaled() const
+    {
+        return state.source.size != destination.size;
+    }
+
+    auto source_row(int y) const -> uint32_t const*
+    {
+        auto const height = destination.size.height.as_uint32_t();
+        auto const offset = static_cast<uint32_t>(y - destination.top().as_int());
+        auto const row = state.source.top().as_uint32_t() +
+            (uint64_t{2} * offset + 1) * state.source.size.height.as_uint32_t() / (uint64_t{2} * height);
+        return pixels + row * stride + state.source.left().as_int();
+    }
+
+    /// Whether nothing beneath this layer shows through area
+    bool hides(geom::Rectangle const& area) const
+    {
+        return pixels && opacity == 255 && source_is_opaque && state.area.contains(area);
+    }
+};
+
+namespace
+{
+bool empty(geom::Rectangle const& rect)
+{
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+/// An output transformation as a rotation/reflection matrix of integers
+struct IntegerTransform
+{
+    int xx, xy, yx, yy;
+
+    bool swaps_axes() const { return xx == 0; }
+};
+
+auto as_integer_transform(glm::mat2 const& transform) -> IntegerTransform
+{
+    return {
+        static_cast<int>(transform[0][0]), static_cast<int>(transform[0][1]),
+        static_cast<int>(transform[1][0]), static_cast<int>(transform[1][1])};
+}
+
+bool is_rotation_or_reflection(glm::mat2 const& transform)
+{
+    for (auto column = 0; column != 2; ++column)
+    {
+        for (auto row = 0; row != 2; ++row)
+        {
+            auto const value = transform[column][row];
+            if (value != 0.0f && value != 1.0f && value != -1.0f)
+                return false;
+        }
+    }
+
+    auto const t = as_integer_transform(transform);
+    return t.xx * t.xx + t.xy * t.xy == 1 &&
+        t.yx * t.yx + t.yy * t.yy == 1 &&
+        t.xx * t.yx + t.xy * t.yy == 0;
+}
+
+/// The number of frames of damage kept, and so the oldest framebuffer we can repaint incrementally
+unsigned const max_buffer_age = 4;
+
+/**
+ * Copies canvas into framebuffer, applying the output transformation
+ *
+ * This follows the GL renderer, in which the transform maps from the canvas to
+ * the framebuffer in GL clip space (y up). Being a rotation or reflection it
+ * is its own transpose's inverse, so each framebuffer pixel is found in the
+ * canvas at transpose(transform) * pixel.
+ */
+void transform_copy(
+    IntegerTransform const& t,
+    uint32_t const* canvas, geom::Size canvas_size,
+    uint32_t* framebuffer, size_t framebuffer_stride, geom::Size framebuffer_size)
+{
+    int const canvas_width = canvas_size.width.as_int();
+    int const canvas_height = canvas_size.height.as_int();
+    int const width = framebuffer_size.width.as_int();
+    int const height = framebuffer_size.height.as_int();
+
+    for (int y = 0; y != height; ++y)
+    {
+        // Pixel centres relative to the middle of the framebuffer, doubled to keep them integral
+        int const u = 1 - width;
+        int const v = height - 1 - 2 * y;
+        int x_in_canvas = (t.xx * u + t.xy * v + canvas_width - 1) / 2;
+        int y_in_canvas = (canvas_height - 1 - (t.yx * u + t.yy * v)) / 2;
+
+        auto const out = framebuffer + y * framebuffer_stride;
+        for (int x = 0; x != width; ++x)
+        {
+            out[x] = canvas[y_in_canvas * canvas_width + x_in_canvas];
+            x_in_canvas += t.xx;
+            y_in_canvas -= t.yx;
+        }
+    }
+}
+}
+
+mrs::Renderer::Renderer(
+    graphics::DisplayBuffer& display_buffer,
+    std::shared_ptr<thread::BasicThreadPool> const& thread_pool,
+    unsigned worker_threads)
+    : render_target{dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer())},
+      thread_pool{thread_pool},
+      worker_threads{worker_threads},
+      viewport{display_buffer.view_area()},
+      requested_transform{1},
+      output_transform{1}
+{
+    if (!render_target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+}
+
+mrs::Renderer::~Renderer() = default;
+
+void mrs::Renderer::set_viewport(geometry::Rectangle const& rect)
+{
+    if (rect != viewport)
+    {
+        viewport = rect;
+        full_damage = true;
+    }
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& transform)
+{
+    if (transform == requested_transform)
+        return;
+
+    requested_transform = transform;
+    if (is_rotation_or_reflection(transform))
+    {
+        output_transform = transform;
+    }
+    else
+    {
+        mir::log_warning("Output transformation is not a rotation or reflection; ignoring it");
+        output_transform = glm::mat2{1};
+    }
+    full_damage = true;
+}
+
+void mrs::Renderer::suspend()
+{
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    auto mapping = render_target->map_framebuffer();
+
+    if (mapping->format() != mir_pixel_format_argb_8888 && mapping->format() != mir_pixel_format_xrgb_8888)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Software rendering requires an ARGB or XRGB framebuffer"));
+
+    auto const framebuffer_size = mapping->size();
+    auto const framebuffer_stride = mapping->stride().as_uint32_t() / sizeof(uint32_t);
+    auto const framebuffer = reinterpret_cast<uint32_t*>(mapping->data());
+
+    auto const transform = as_integer_transform(output_transform);
+    bool const transformed = transform.xx != 1 || transform.yy != 1;
+
+    /* A transformed output is drawn into a canvas of our own, then copied */
+    Canvas canvas{framebuffer, framebuffer_stride, framebuffer_size};
+    unsigned age = render_target->framebuffer_age();
+    if (transformed)
+    {
+        canvas.size = transform.swaps_axes() ?
+            geom::Size{framebuffer_size.height.as_int(), framebuffer_size.width.as_int()} :
+            framebuffer_size;
+        canvas.stride = canvas.size.width.as_uint32_t();
+
+        auto const canvas_pixels = canvas.stride * canvas.size.height.as_uint32_t();
+        age = (rotated_canvas.size() == canvas_pixels) ? 1 : 0;
+        rotated_canvas.resize(canvas_pixels);
+        canvas.pixels = rotated_canvas.data();
+    }
+
+    if (canvas.size != last_canvas_size)
+    {
+        last_canvas_size = canvas.size;
+        damage_history.clear();
+        full_damage = true;
+    }
+
+    auto layers = layers_for(renderables, canvas);
+
+    /*
+     * Repaint what has changed since the framebuffer was last drawn into:
+     * the damage of each frame since then.
+     */
+    damage_history.push_front(damage_since_last_frame(layers, canvas));
+    while (damage_history.size() > max_buffer_age)
+        damage_history.pop_back();
+
+    TileMask repaint(damage_history.front().size(), age == 0 || age > damage_history.size());
+    for (unsigned i = 0; i < age && i < damage_history.size(); ++i)
+    {
+        std::transform(
+            repaint.begin(), repaint.end(), damage_history[i].begin(),
+            repaint.begin(), std::logical_or<bool>{});
+    }
+
+    with_pixels_of(layers, 0, [&]{ paint(layers, canvas, repaint); });
+
+    int const tiles_across = (canvas.size.width.as_int() + tile_size - 1) / tile_size;
+    std::vector<geom::Rectangle> damage;
+    if (transformed)
+    {
+        if (std::find(repaint.begin(), repaint.end(), true) != repaint.end() ||
+            render_target->framebuffer_age() != 1)
+        {
+            transform_copy(
+                transform, canvas.pixels, canvas.size,
+                framebuffer, framebuffer_stride, framebuffer_size);
+            damage.push_back({{0, 0}, framebuffer_size});
+        }
+    }
+    else
+    {
+        // Report runs of repainted tiles within each row of tiles
+        for (size_t tile = 0; tile < repaint.size(); ++tile)
+        {
+            if (!repaint[tile])
+                continue;
+
+            auto run_end = tile;
+            while (run_end + 1 < repaint.size() && repaint[run_end + 1] && (run_end + 1) % tiles_across)
+                ++run_end;
+
+            geom::Rectangle const run{
+                {static_cast<int>(tile % tiles_across) * tile_size, static_cast<int>(tile / tiles_across) * tile_size},
+                {static_cast<int>(run_end - tile + 1) * tile_size, tile_size}};
+            damage.push_back(run.intersection_with(canvas.area()));
+            tile = run_end;
+        }
+    }
+
+    mapping.reset();
+    render_target->present(damage);
+}
+
+auto mrs::Renderer::layers_for(mg::RenderableList const& renderables, Canvas const& canvas) const
+    -> std::vector<Layer>
+{
+    double const x_scale = canvas.size.width.as_int() / double(viewport.size.width.as_int());
+    double const y_scale = canvas.size.height.as_int() / double(viewport.size.height.as_int());
+    auto const to_canvas = [&](geom::Rectangle const& rect)
+        {
+            int const left = std::lround((rect.left().as_int() - viewport.left().as_int()) * x_scale);
+            int const top = std::lround((rect.top().as_int() - viewport.top().as_int()) * y_scale);
+            int const right = std::lround((rect.right().as_int() - viewport.left().as_int()) * x_scale);
+            int const bottom = std::lround((rect.bottom().as_int() - viewport.top().as_int()) * y_scale);
+            return geom::Rectangle{{left, top}, {right - left, bottom - top}};
+        };
+
+    std::vector<Layer> layers;
+    for (auto const& renderable : renderables)
+    {
+        auto const buffer = renderable->buffer();
+        if (!buffer)
+            continue;
+
+        bool has_alpha, swap_red_blue;
+        switch (buffer->pixel_format())
+        {
+        case mir_pixel_format_argb_8888: has_alpha = true;  swap_red_blue = false; break;
+        case mir_pixel_format_xrgb_8888: has_alpha = false; swap_red_blue = false; break;
+        case mir_pixel_format_abgr_8888: has_alpha = true;  swap_red_blue = true;  break;
+        case mir_pixel_format_xbgr_8888: has_alpha = false; swap_red_blue = true;  break;
+        default:
+            if (reported_formats.insert(buffer->pixel_format()).second)
+                mir::log_warning("Cannot render buffers of pixel format %d in software", buffer->pixel_format());
+            continue;
+        }
+
+        auto const destination = to_canvas(renderable->screen_position());
+        auto area = destination.intersection_with(canvas.area());
+        if (auto const clip = renderable->clip_area())
+            area = area.intersection_with(to_canvas(clip.value()));
+        geom::Rectangle source{{0, 0}, buffer->size()};
+        if (auto const crop = renderable->source_rect())
+            source = source.intersection_with(crop.value());
+        if (empty(area) || empty(source))
+            continue;
+
+        Layer layer{
+            {renderable->id(), buffer->id(), area, source, renderable->alpha(), renderable->shaped()},
+            buffer,
+            destination,
+            static_cast<uint8_t>(std::lround(std::min(std::max(renderable->alpha(), 0.0f), 1.0f) * 255)),
+            !renderable->shaped() || !has_alpha,
+            swap_red_blue,
+            nullptr,
+            0,
+            {}};
+
+        if (layer.scaled())
+        {
+            auto const width = destination.size.width.as_uint32_t();
+            auto const source_width = source.size.width.as_uint32_t();
+            for (auto x = area.left().as_int(); x != area.right().as_int(); ++x)
+            {
+                auto const offset = static_cast<uint32_t>(x - destination.left().as_int());
+                layer.columns.push_back((uint64_t{2} * offset + 1) * source_width / (uint64_t{2} * width));
+            }
+        }
+
+        layers.push_back(std::move(layer));
+    }
+
+    return layers;
+}
+
+auto mrs::Renderer::damage_since_last_frame(std::vector<Layer> const& layers, Canvas const& canvas) const
+    -> TileMask
+{
+    int const tiles_across = (canvas.size.width.as_int() + tile_size - 1) / tile_size;
+    int const tiles_down = (canvas.size.height.as_int() + tile_size - 1) / tile_size;
+    TileMask damage(tiles_across * tiles_down, full_damage);
+
+    auto const add_damage = [&](geom::Rectangle const& area)
+        {
+            auto const left = area.left().as_int() / tile_size;
+            auto const right = (area.right().as_int() + tile_size - 1) / tile_size;
+            auto const top = area.top().as_int() / tile_size;
+            auto const bottom = (area.bottom().as_int() + tile_size - 1) / tile_size;
+            for (auto y = top; y < bottom; ++y)
+                std::fill(damage.begin() + y * tiles_across + left, damage.begin() + y * tiles_across + right, true);
+        };
+
+    std::unordered_map<mg::Renderable::ID, size_t> last_index;
+    for (size_t i = 0; i != last_layers.size(); ++i)
+        last_index[last_layers[i].id] = i;
+
+    size_t highest_match = 0;
+    for (auto const& layer : layers)
+    {
+        auto const last = last_index.find(layer.state.id);
+        if (last == last_index.end())
+        {
+            add_damage(layer.state.area);
+            continue;
+        }
+
+        // Anything restacked could change what is visible anywhere, so give up
+        if (last->second < highest_match)
+            std::fill(damage.begin(), damage.end(), true);
+        highest_match = std::max(highest_match, last->second);
+
+        auto const& last_state = last_layers[last->second];
+        if (!(last_state == layer.state))
+        {
+            add_damage(last_state.area);
+            add_damage(layer.state.area);
+        }
+        last_index.erase(last);
+    }
+
+    // Whatever remains has gone away
+    for (auto const& gone : last_index)
+        add_damage(last_layers[gone.second].area);
+
+    last_layers.clear();
+    for (auto const& layer : layers)
+        last_layers.push_back(layer.state);
+    full_damage = false;
+
+    return damage;
+}
+
+void mrs::Renderer::paint(std::vector<Layer>& layers, Canvas const& canvas, TileMask const& tiles) const
+{
+    int const tiles_across = (canvas.size.width.as_int() + tile_size - 1) / tile_size;
+
+    std::vector<size_t> dirty;
+    for (size_t tile = 0; tile != tiles.size(); ++tile)
+    {
+        if (tiles[tile])
+            dirty.push_back(tile);
+    }
+
+    std::atomic<size_t> next{0};
+    auto const work = [&]
+        {
+            std::vector<uint32_t> scratch(canvas.size.width.as_uint32_t());
+            for (size_t i; (i = next++) < dirty.size();)
+            {
+                geom::Rectangle const tile{
+                    {static_cast<int>(dirty[i] % tiles_across) * tile_size,
+                     static_cast<int>(dirty[i] / tiles_across) * tile_size},
+                    {tile_size, tile_size}};
+                paint_tile(layers, canvas, tile.intersection_with(canvas.area()), scratch);
+            }
+        };
+
+    // Splitting a handful of tiles between threads costs more than it saves
+    size_t const min_tiles_per_thread = 4;
+    auto const helpers = std::min<size_t>(worker_threads, dirty.size() / min_tiles_per_thread);
+
+    std::vector<std::future<void>> helping;
+    for (size_t i = 0; i != helpers; ++i)
+        helping.push_back(thread_pool->run(work));
+
+    try
+    {
+        work();
+    }
+    catch (...)
+    {
+        // The helpers are using our stack; they must finish before it unwinds
+        for (auto& helper : helping)
+            helper.wait();
+        throw;
+    }
+
+    // As above: every helper must finish before a failure in one unwinds our stack
+    for (auto& helper : helping)
+        helper.wait();
+    for (auto& helper : helping)
+        helper.get();
+}
+
+void mrs::Renderer::paint_tile(
+    std::vector<Layer> const& layers,
+    Canvas const& canvas,
+    geom::Rectangle const& tile,
+    std::vector<uint32_t>& scratch) const
+{
+    auto const width = tile.size.width.as_uint32_t();
+
+    // Start from the topmost layer that hides everything beneath it
+    auto first = layers.rend();
+    for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer)
+    {
+        if (layer->hides(tile))
+        {
+            first = layer;
+            break;
+        }
+    }
+
+    if (first == layers.rend())
+    {
+        for (auto y = tile.top().as_int(); y != tile.bottom().as_int(); ++y)
+            fill_pixels(canvas.row(y) + tile.left().as_int(), width, 0);
+    }
+
+    auto const start = (first == layers.rend()) ? layers.begin() : std::prev(first.base());
+    for (auto layer = start; layer != layers.end(); ++layer)
+    {
+        auto const area = layer->state.area.intersection_with(tile);
+        if (!layer->pixels || empty(area))
+            continue;
+
+        auto const left = area.left().as_int();
+        auto const count = area.size.width.as_uint32_t();
+        auto const skipped_columns = left - layer->state.area.left().as_int();
+
+        for (auto y = area.top().as_int(); y != area.bottom().as_int(); ++y)
+        {
+            auto source = layer->source_row(y);
+            if (layer->scaled())
+            {
+                auto const columns = layer->columns.data() + skipped_columns;
+                for (uint32_t x = 0; x != count; ++x)
+                    scratch[x] = source[columns[x]];
+                source = scratch.data();
+            }
+            else
+            {
+                source += left - layer->destination.left().as_int();
+            }
+
+            if (layer->swap_red_blue)
+            {
+                swap_red_blue(source, scratch.data(), count);
+                source = scratch.data();
+            }
+
+            blend_over(source, canvas.row(y) + left, count, layer->opacity, layer->source_is_opaque);
+        }
+    }
+}
+
+void mrs::Renderer::with_pixels_of(
+    std::vector<Layer>& layers,
+    size_t index,
+    std::function<void()> const& then)
+{
+    if (index == layers.size())
+    {
+        then();
+        return;
+    }
+
+    auto& layer = layers[index];
+    auto const native = layer.buffer->native_buffer_base();
+
+    /* Pixel sources (such as wl_shm buffers) can be read in place */
+    if (auto const pixel_source = dynamic_cast<mrs::PixelSource*>(native))
+    {
+        pixel_source->read(
+            [&](unsigned char const* pixels)
+            {
+                layer.pixels = reinterpret_cast<uint32_t const*>(pixels);
+                layer.stride = pixel_source->stride().as_uint32_t() / sizeof(uint32_t);
+                with_pixels_of(layers, index + 1, then);
+            });
+        return;
+    }
+
+    std::unique_ptr<mrs::Mapping<unsigned char const>> mapping;
+    try
+    {
+        mapping = mrs::as_read_mappable_buffer(layer.buffer)->map_readable();
+        layer.pixels = reinterpret_cast<uint32_t const*>(mapping->data());
+        layer.stride = mapping->stride().as_uint32_t() / sizeof(uint32_t);
+    }
+    catch (std::exception const&)
+    {
+        // As with the GL renderer, a buffer we can't draw is skipped rather than fatal
+        mir::report_exception();
+    }
+
+    with_pixels_of(layers, index + 1, then);
+}
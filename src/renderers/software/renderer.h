@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_RENDERER_H_
+#define MIR_RENDERER_SOFTWARE_RENDERER_H_
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/graphics/renderable.h>
+#include <mir_toolkit/common.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace thread { class BasicThreadPool; }
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+
+/**
+ * Composites renderables on the CPU into a software::RenderTarget
+ *
+ * The output is divided into tiles and only tiles affected by changes since
+ * the framebuffer was last drawn are repainted. Repainting is shared between
+ * the calling thread and up to worker_threads threads from thread_pool.
+ *
+ * Renderable transformations are not supported; such renderables are drawn
+ * untransformed. Output transformations are limited to rotations by multiples
+ * of 90° and reflections.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(
+        graphics::DisplayBuffer& display_buffer,
+        std::shared_ptr<thread::BasicThreadPool> const& thread_pool,
+        unsigned worker_threads);
+    ~Renderer();
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+    /// The width and height of the tiles damage is tracked in
+    static int constexpr tile_size = 64;
+
+private:
+    struct Canvas;
+    struct Layer;
+    struct LayerState;
+    using TileMask = std::vector<bool>;
+
+    auto layers_for(graphics::RenderableList const& renderables, Canvas const& canvas) const -> std::vector<Layer>;
+    auto damage_since_last_frame(std::vector<Layer> const& layers, Canvas const& canvas) const -> TileMask;
+    void paint(std::vector<Layer>& layers, Canvas const& canvas, TileMask const& tiles) const;
+    void paint_tile(std::vector<Layer> const& layers, Canvas const& canvas, geometry::Rectangle const& tile,
+                    std::vector<uint32_t>& scratch) const;
+
+    /// Calls then() with the pixels of each layer available (or the layer skipped if they can't be)
+    static void with_pixels_of(std::vector<Layer>& layers, size_t index, std::function<void()> const& then);
+
+    RenderTarget* const render_target;
+    std::shared_ptr<thread::BasicThreadPool> const thread_pool;
+    unsigned const worker_threads;
+
+    geometry::Rectangle viewport;
+    glm::mat2 requested_transform;
+    glm::mat2 output_transform;     ///< The requested transform, if we support it
+
+    /* State carried between frames */
+    mutable bool full_damage{true};
+    mutable geometry::Size last_canvas_size;
+    mutable std::vector<LayerState> last_layers;
+    mutable std::deque<TileMask> damage_history;    ///< Most recent frame first
+    mutable std::vector<uint32_t> rotated_canvas;   ///< Drawn into when the output is transformed
+    mutable std::set<MirPixelFormat> reported_formats;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_RENDERER_H_
@@ -0,0 +1,314 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffer_mailbox.h"
+#include "mir/graphics/buffer.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace mg = mir::graphics;
+namespace mc = mir::compositor;
+
+/*
+ * Frames are numbered from 1 as they are published; slot frame % capacity
+ * holds frame "frame" until it is discarded.
+ *
+ * A slot is only read with its reader count raised and only discarded once
+ * that count drops to zero, so the buffer itself never needs an atomic
+ * shared_ptr. Discarding is keyed on the frame number, which makes it safe
+ * for the producer and any compositor to race to discard the same frame.
+ *
+ * Apart from the ring being full, a frame is only discarded once a newer one
+ * has been published, so a compositor that finds its frame gone can always
+ * move on to a later one.
+ */
+namespace
+{
+std::uint64_t const no_frame = 0;
+std::uint64_t const discarding = std::numeric_limits<std::uint64_t>::max();
+}
+
+mc::BufferMailbox::BufferMailbox() = default;
+
+mc::BufferMailbox::~BufferMailbox() = default;
+
+std::shared_ptr<mg::Buffer> mc::BufferMailbox::compositor_acquire(CompositorID id)
+{
+    auto& consumer = consumer_for(id);
+
+    for (;;)
+    {
+        auto const frame = current.load();
+
+        // If there is no current frame or this compositor has already shown it,
+        // move the stream on (unless some other compositor just did)
+        if (frame == no_frame || consumer.consumed.load() >= frame)
+        {
+            if (advance_from(frame))
+                continue;
+
+            if (frame == no_frame)
+                BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to compositor"));
+        }
+
+        if (auto const buffer = read(frame))
+        {
+            consumer.consumed.store(frame);
+            return buffer;
+        }
+
+        if (!advance_from(frame))
+            std::this_thread::yield();
+    }
+}
+
+std::shared_ptr<mg::Buffer> mc::BufferMailbox::snapshot_acquire()
+{
+    for (;;)
+    {
+        auto const frame = current.load();
+
+        if (frame == no_frame)
+        {
+            if (advance_from(frame))
+                continue;
+
+            BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to snapshotter"));
+        }
+
+        if (auto const buffer = read(frame))
+            return buffer;
+
+        if (!advance_from(frame))
+            std::this_thread::yield();
+    }
+}
+
+bool mc::BufferMailbox::buffer_ready_for(CompositorID id) const
+{
+    auto const frame = current.load();
+
+    // If there are queued frames then there is one ready for any compositor;
+    // otherwise it's ready if the compositor hasn't yet shown the current one
+    return published.load() > frame || (frame != no_frame && consumed_by(id) < frame);
+}
+
+void mc::BufferMailbox::submit(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    std::lock_guard<decltype(producer_mutex)> lock{producer_mutex};
+
+    auto const previous = published.load();
+    auto const frame = previous + 1;
+    auto& slot = slot_for(frame);
+
+    for (;;)
+    {
+        auto const occupant = slot.frame.load();
+
+        if (occupant == no_frame)
+            break;
+
+        if (occupant == discarding)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // The compositors are a whole ring behind: drop frames rather than grow the queue
+        auto const latched = current.load();
+        if (occupant < latched)
+            clear(occupant);
+        else
+            advance_from(latched);
+    }
+
+    slot.buffer = buffer;
+    slot.frame.store(frame);
+    published.store(frame);
+
+    if (dropping_.load())
+    {
+        if (previous != current.load())
+            clear(previous);
+    }
+    else
+    {
+        // A buffer is only queued once: resubmitting it moves it to the back of the queue
+        auto const oldest = std::max(current.load() + 1, frame > capacity ? frame - capacity + 1 : 1);
+        for (auto queued = oldest; queued < frame; ++queued)
+        {
+            if (read(queued) == buffer)
+                clear(queued);
+        }
+    }
+}
+
+void mc::BufferMailbox::set_dropping(bool dropping)
+{
+    std::lock_guard<decltype(producer_mutex)> lock{producer_mutex};
+
+    if (dropping_.exchange(dropping) == dropping)
+        return;
+
+    if (dropping)
+        discard_queued_frames();
+}
+
+bool mc::BufferMailbox::dropping() const
+{
+    return dropping_.load();
+}
+
+void mc::BufferMailbox::drop_old_buffers()
+{
+    std::lock_guard<decltype(producer_mutex)> lock{producer_mutex};
+
+    discard_queued_frames();
+
+    auto const newest = published.load();
+    auto latched = current.load();
+    while (latched < newest)
+    {
+        if (current.compare_exchange_weak(latched, newest))
+        {
+            clear(latched);
+            break;
+        }
+    }
+}
+
+auto mc::BufferMailbox::slot_for(Frame frame) -> Slot&
+{
+    return slots[frame % capacity];
+}
+
+std::shared_ptr<mg::Buffer> mc::BufferMailbox::read(Frame frame) const
+{
+    auto& slot = slots[frame % capacity];
+    std::shared_ptr<mg::Buffer> buffer;
+
+    slot.readers.fetch_add(1);
+    if (slot.frame.load() == frame)
+        buffer = slot.buffer;
+    slot.readers.fetch_sub(1);
+
+    return buffer;
+}
+
+void mc::BufferMailbox::clear(Frame frame)
+{
+    if (frame == no_frame)
+        return;
+
+    auto& slot = slot_for(frame);
+    if (!slot.frame.compare_exchange_strong(frame, discarding))
+        return;
+
+    while (slot.readers.load())
+        std::this_thread::yield();
+
+    // Release the buffer after the slot is reusable: this can call back into the client
+    auto const buffer = std::move(slot.buffer);
+    slot.frame.store(no_frame);
+}
+
+bool mc::BufferMailbox::advance_from(Frame frame)
+{
+    auto const newest = published.load();
+    if (newest <= frame)
+        return false;
+
+    auto const next = dropping_.load() ? newest : frame + 1;
+    if (current.compare_exchange_strong(frame, next))
+        clear(frame);
+
+    return true;
+}
+
+void mc::BufferMailbox::discard_queued_frames()
+{
+    auto const newest = published.load();
+    auto const oldest = std::max(current.load() + 1, newest > capacity ? newest - capacity + 1 : 1);
+
+    for (auto queued = oldest; queued < newest; ++queued)
+        clear(queued);
+}
+
+auto mc::BufferMailbox::consumer_for(CompositorID id) -> Consumer&
+{
+    for (auto& consumer : consumers)
+    {
+        if (consumer.id.load() == id)
+            return consumer;
+    }
+
+    for (;;)
+    {
+        for (auto& consumer : consumers)
+        {
+            CompositorID unused{nullptr};
+            if (take_over(consumer, unused, id))
+                return consumer;
+        }
+
+        /*
+         * An entry only records that its compositor has shown the current frame. Once the
+         * stream has moved past that it says no more than a missing entry would, so it is
+         * free for reuse: a compositor that has gone away gives up its entry within a frame.
+         */
+        auto const latched = current.load();
+        for (auto& consumer : consumers)
+        {
+            if (consumer.consumed.load() < latched && take_over(consumer, consumer.id.load(), id))
+                return consumer;
+        }
+
+        // More compositors than we track, all up to date: take over from the one furthest behind
+        auto& stalest = *std::min_element(
+            consumers.begin(),
+            consumers.end(),
+            [](Consumer const& lhs, Consumer const& rhs) { return lhs.consumed.load() < rhs.consumed.load(); });
+
+        if (take_over(stalest, stalest.id.load(), id))
+            return stalest;
+    }
+}
+
+bool mc::BufferMailbox::take_over(Consumer& consumer, CompositorID owner, CompositorID id)
+{
+    // Only one compositor can win the entry; the loser looks again
+    if (!consumer.id.compare_exchange_strong(owner, id))
+        return false;
+
+    consumer.consumed.store(no_frame);
+    return true;
+}
+
+auto mc::BufferMailbox::consumed_by(CompositorID id) const -> Frame
+{
+    for (auto const& consumer : consumers)
+    {
+        if (consumer.id.load() == id)
+            return consumer.consumed.load();
+    }
+
+    return no_frame;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_BUFFER_MAILBOX_H_
+#define MIR_COMPOSITOR_BUFFER_MAILBOX_H_
+
+#include "mir/compositor/compositor_id.h"
+#include "buffer_acquisition.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace graphics { class Buffer; }
+namespace compositor
+{
+/**
+ * Hands the buffers a client submits over to the compositors showing them.
+ *
+ * Submitted buffers are published into a fixed ring of frames. In queueing
+ * mode every frame is shown in turn (the ring bounds the queue); in dropping
+ * mode only the newest frame is kept. Each compositor latches the current
+ * frame without taking a lock: the first compositor to come back for another
+ * frame advances the stream, and the others pick up that same frame.
+ *
+ * submit(), set_dropping() and drop_old_buffers() may be called from any
+ * thread, but are serialized against each other; compositor_acquire(),
+ * snapshot_acquire() and buffer_ready_for() never wait for them.
+ */
+class BufferMailbox : public BufferAcquisition
+{
+public:
+    BufferMailbox();
+    ~BufferMailbox();
+
+    std::shared_ptr<graphics::Buffer> compositor_acquire(CompositorID id) override;
+    std::shared_ptr<graphics::Buffer> snapshot_acquire() override;
+    bool buffer_ready_for(CompositorID id) const;
+
+    /// Queues the buffer, moving it to the back of the queue if it is already queued
+    void submit(std::shared_ptr<graphics::Buffer> const& buffer);
+    /// Switching to dropping discards all queued frames but the newest
+    void set_dropping(bool dropping);
+    bool dropping() const;
+    /// Makes the newest frame current, discarding everything queued before it
+    void drop_old_buffers();
+
+private:
+    using Frame = std::uint64_t;
+
+    struct Slot
+    {
+        std::atomic<Frame> frame{0};
+        std::atomic<int> readers{0};
+        std::shared_ptr<graphics::Buffer> buffer;
+    };
+
+    struct Consumer
+    {
+        std::atomic<CompositorID> id{nullptr};
+        std::atomic<Frame> consumed{0};
+    };
+
+    static std::size_t const capacity = 16;
+    static std::size_t const max_consumers = 16;
+
+    Slot& slot_for(Frame frame);
+    std::shared_ptr<graphics::Buffer> read(Frame frame) const;
+    void clear(Frame frame);
+    bool advance_from(Frame frame);
+    void discard_queued_frames();
+    Consumer& consumer_for(CompositorID id);
+    static bool take_over(Consumer& consumer, CompositorID owner, CompositorID id);
+    Frame consumed_by(CompositorID id) const;
+
+    std::array<Slot, capacity> mutable slots;
+    std::array<Consumer, max_consumers> consumers;
+    std::atomic<Frame> published{0};
+    std::atomic<Frame> current{0};
+    std::atomic<bool> dropping_{false};
+
+    std::mutex producer_mutex;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_BUFFER_MAILBOX_H_ */
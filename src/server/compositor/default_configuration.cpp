@@ -22,17 +22,61 @@
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
+#include "presentation_observer_multiplexer.h"
 #include "gl/renderer_factory.h"
+#include "software/renderer_factory.h"
+#include "mir/renderer/renderer.h"
+#include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/display_buffer.h"
 #include "mir/main_loop.h"
+#include "mir/log.h"
 
 #include "mir/options/configuration.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <thread>
+
 namespace mc = mir::compositor;
 namespace ms = mir::scene;
 namespace mf = mir::frontend;
 
+namespace
+{
+/// Creates GL or software renderers according to what each display buffer supports
+class SelectingRendererFactory : public mir::renderer::RendererFactory
+{
+public:
+    SelectingRendererFactory(bool prefer_software, unsigned worker_threads)
+        : prefer_software{prefer_software},
+          software{worker_threads}
+    {
+    }
+
+    std::unique_ptr<mir::renderer::Renderer> create_renderer_for(
+        mir::graphics::DisplayBuffer& display_buffer) override
+    {
+        auto const native = display_buffer.native_display_buffer();
+        bool const supports_gl = dynamic_cast<mir::renderer::gl::RenderTarget*>(native);
+        bool const supports_software = dynamic_cast<mir::renderer::software::RenderTarget*>(native);
+
+        if (supports_software && (prefer_software || !supports_gl))
+            return software.create_renderer_for(display_buffer);
+
+        if (prefer_software)
+            mir::log_warning("Display buffer does not support software rendering; using GL");
+
+        return gl.create_renderer_for(display_buffer);
+    }
+
+private:
+    bool const prefer_software;
+    mir::renderer::gl::RendererFactory gl;
+    mir::renderer::software::RendererFactory software;
+};
+}
+
 std::shared_ptr<ms::BufferStreamFactory>
 mir::DefaultServerConfiguration::the_buffer_stream_factory()
 {
@@ -77,15 +121,44 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_shell(),
                 the_compositor_report(),
                 composite_delay,
-                true);
+                true,
+                the_presentation_observer());
+        });
+}
+
+std::shared_ptr<mc::PresentationObserver> mir::DefaultServerConfiguration::the_presentation_observer()
+{
+    return presentation_observer_multiplexer(
+        [default_executor = the_main_loop()]()
+        {
+            return std::make_shared<mc::PresentationObserverMultiplexer>(default_executor);
+        });
+}
+
+std::shared_ptr<mir::ObserverRegistrar<mc::PresentationObserver>>
+mir::DefaultServerConfiguration::the_presentation_observer_registrar()
+{
+    return presentation_observer_multiplexer(
+        [default_executor = the_main_loop()]()
+        {
+            return std::make_shared<mc::PresentationObserverMultiplexer>(default_executor);
         });
 }
 
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]()
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            auto const renderer = the_options()->get<std::string>(options::renderer_opt);
+            if (renderer != "gl" && renderer != "software")
+                BOOST_THROW_EXCEPTION(std::runtime_error("Unknown renderer: " + renderer));
+
+            // The compositing thread renders too, so by default it needs one helper fewer than there are cores
+            auto const threads = the_options()->get<int>(options::compositor_threads_opt);
+            auto const cores = std::thread::hardware_concurrency();
+            unsigned const worker_threads = threads >= 0 ? threads : (cores > 1 ? cores - 1 : 0);
+
+            return std::make_shared<SelectingRendererFactory>(renderer == "software", worker_threads);
         });
 }
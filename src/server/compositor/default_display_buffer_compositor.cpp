@@ -72,7 +72,15 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    composition.buffers.clear();
+    for (auto const& renderable : renderable_list)
+    {
+        if (auto const buffer = renderable->buffer())
+            composition.buffers.push_back(buffer->id());
+    }
+
+    composition.zero_copy = display_buffer.overlay(renderable_list);
+    if (composition.zero_copy)
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
@@ -102,3 +110,8 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
 
     report->finished_frame(this);
 }
+
+auto mc::DefaultDisplayBufferCompositor::last_composition() const -> Composition
+{
+    return composition;
+}
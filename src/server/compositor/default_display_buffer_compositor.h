@@ -47,11 +47,13 @@ public:
         std::shared_ptr<CompositorReport> const& report);
 
     void composite(SceneElementSequence&& scene_sequence) override;
+    Composition last_composition() const override;
 
 private:
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    Composition composition;
 };
 
 }
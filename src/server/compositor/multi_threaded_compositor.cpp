@@ -24,6 +24,7 @@
 #include "mir/compositor/display_listener.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/compositor/presentation_observer.h"
 #include "mir/scene/legacy_scene_change_notification.h"
 #include "mir/scene/surface_observer.h"
 #include "mir/scene/surface.h"
@@ -32,6 +33,7 @@
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
@@ -48,6 +50,27 @@ namespace mir
 namespace compositor
 {
 
+/// Derives the refresh interval of a group from the frames it has been presented in
+class PresentationTiming
+{
+public:
+    std::chrono::nanoseconds refresh_after(mg::Frame const& frame)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        if (frame.msc > last.msc && frame.ust.clock_id == last.ust.clock_id && last.msc != 0)
+            refresh = (frame.ust - last.ust) / (frame.msc - last.msc);
+        last = frame;
+
+        return refresh;
+    }
+
+private:
+    std::mutex mutex;
+    mg::Frame last;
+    std::chrono::nanoseconds refresh{0};
+};
+
 class CompositingFunctor
 {
 public:
@@ -57,7 +80,8 @@ public:
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
-        std::shared_ptr<CompositorReport> const& report) :
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<PresentationObserver> const& presentation_observer) :
         compositor_factory{db_compositor_factory},
         group(group),
         scene(scene),
@@ -66,6 +90,8 @@ public:
         force_sleep{fixed_composite_delay},
         display_listener{display_listener},
         report{report},
+        presentation_observer{presentation_observer},
+        timing{std::make_shared<PresentationTiming>()},
         started_future{started.get_future()}
     {
     }
@@ -75,7 +101,7 @@ public:
     {
         mir::set_thread_name("Mir/Comp");
 
-        std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
+        Compositors compositors;
         group.for_each_display_buffer(
         [this, &compositors](mg::DisplayBuffer& buffer)
         {
@@ -140,7 +166,11 @@ public:
                         auto& compositor = std::get<1>(tuple);
                         compositor->composite(scene->scene_elements_for(compositor.get()));
                     }
+
+                    auto const report_presentation_now = request_presentation_feedback(compositors);
                     group.post();
+                    if (report_presentation_now)
+                        report_presentation_now();
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
@@ -222,6 +252,11 @@ public:
         run_cv.notify_one();
     }
 
+    bool composites(mg::DisplaySyncGroup const& other) const
+    {
+        return &group == &other;
+    }
+
     void wait_until_started()
     {
         if (started_future.wait_for(10s) != std::future_status::ready)
@@ -231,6 +266,54 @@ public:
     }
 
 private:
+    using Compositors =
+        std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>>;
+
+    /*
+     * Asks the group to report when what we're about to post() reaches the screen.
+     * If the platform can't do that the returned function reports "now" instead,
+     * and should be called once post() returns.
+     */
+    std::function<void()> request_presentation_feedback(Compositors const& compositors)
+    {
+        if (!presentation_observer)
+            return {};
+
+        std::vector<mg::BufferID> buffers;
+        bool zero_copy = true;
+        for (auto const& tuple : compositors)
+        {
+            auto composition = std::get<1>(tuple)->last_composition();
+            buffers.insert(buffers.end(), composition.buffers.begin(), composition.buffers.end());
+            zero_copy = zero_copy && composition.zero_copy;
+        }
+
+        if (buffers.empty())
+            return {};
+
+        uint32_t const copy_flags = zero_copy ? PresentationObserver::zero_copy : 0;
+
+        auto const presented =
+            [observer = presentation_observer, timing = timing, buffers, copy_flags](mg::Frame const& frame)
+            {
+                uint32_t flags = copy_flags;
+                std::chrono::nanoseconds refresh{0};
+                if (frame.msc != 0)
+                {
+                    flags |= PresentationObserver::vsync |
+                             PresentationObserver::hw_clock |
+                             PresentationObserver::hw_completion;
+                    refresh = timing->refresh_after(frame);
+                }
+                observer->frame_presented(buffers, frame, refresh, flags);
+            };
+
+        if (group.notify_next_presentation(presented))
+            return {};
+
+        return [presented] { presented(mg::Frame{0, mg::Frame::Timestamp::now(CLOCK_MONOTONIC)}); };
+    }
+
     std::shared_ptr<mc::DisplayBufferCompositorFactory> const compositor_factory;
     mg::DisplaySyncGroup& group;
     std::shared_ptr<mc::Scene> const scene;
@@ -241,6 +324,8 @@ private:
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<PresentationObserver> const presentation_observer;
+    std::shared_ptr<PresentationTiming> const timing;
     std::promise<void> started;
     std::future<void> started_future;
     bool not_posted_yet = true;
@@ -249,6 +334,20 @@ private:
 }
 }
 
+namespace
+{
+void stop_and_wait(
+    std::vector<std::unique_ptr<mc::CompositingFunctor>> const& functors,
+    std::vector<std::future<void>> const& futures)
+{
+    for (auto& f : functors)
+        f->stop();
+
+    for (auto& f : futures)
+        f.wait();
+}
+}
+
 mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<mg::Display> const& display,
     std::shared_ptr<mc::Scene> const& scene,
@@ -257,11 +356,27 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<CompositorReport> const& compositor_report,
     std::chrono::milliseconds fixed_composite_delay,
     bool compose_on_start)
+    : MultiThreadedCompositor(
+          display, scene, db_compositor_factory, display_listener, compositor_report,
+          fixed_composite_delay, compose_on_start, nullptr)
+{
+}
+
+mc::MultiThreadedCompositor::MultiThreadedCompositor(
+    std::shared_ptr<mg::Display> const& display,
+    std::shared_ptr<mc::Scene> const& scene,
+    std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
+    std::shared_ptr<DisplayListener> const& display_listener,
+    std::shared_ptr<CompositorReport> const& compositor_report,
+    std::chrono::milliseconds fixed_composite_delay,
+    bool compose_on_start,
+    std::shared_ptr<PresentationObserver> const& presentation_observer)
     : display{display},
       scene{scene},
       display_buffer_compositor_factory{db_compositor_factory},
       display_listener{display_listener},
       report{compositor_report},
+      presentation_observer{presentation_observer},
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
       compose_on_start{compose_on_start},
@@ -286,6 +401,7 @@ mc::MultiThreadedCompositor::~MultiThreadedCompositor()
 void mc::MultiThreadedCompositor::schedule_compositing(int num)
 {
     report->scheduled();
+    std::lock_guard<std::mutex> lock{functors_mutex};
     for (auto& f : thread_functors)
         f->schedule_compositing(num);
 }
@@ -293,6 +409,7 @@ void mc::MultiThreadedCompositor::schedule_compositing(int num)
 void mc::MultiThreadedCompositor::schedule_compositing(int num, geometry::Rectangle const& damage) const
 {
     report->scheduled();
+    std::lock_guard<std::mutex> lock{functors_mutex};
     for (auto& f : thread_functors)
         f->schedule_compositing(num, damage);
 }
@@ -361,33 +478,89 @@ void mc::MultiThreadedCompositor::stop()
     state = CompositorState::stopped;
 }
 
-void mc::MultiThreadedCompositor::create_compositing_threads()
+void mc::MultiThreadedCompositor::stop_compositing(std::vector<mg::DisplaySyncGroup*> const& groups)
 {
-    /* Start the display buffer compositing threads */
-    display->for_each_display_sync_group([this](mg::DisplaySyncGroup& group)
+    std::vector<std::unique_ptr<CompositingFunctor>> stopping_functors;
+    std::vector<std::future<void>> stopping_futures;
+
     {
+        std::lock_guard<std::mutex> lock{functors_mutex};
+
+        for (size_t i = 0; i != thread_functors.size();)
+        {
+            auto const& functor = thread_functors[i];
+            if (std::any_of(groups.begin(), groups.end(),
+                            [&functor](mg::DisplaySyncGroup* group) { return functor->composites(*group); }))
+            {
+                stopping_functors.push_back(std::move(thread_functors[i]));
+                stopping_futures.push_back(std::move(futures[i]));
+                thread_functors.erase(thread_functors.begin() + i);
+                futures.erase(futures.begin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    /* The scene observer can no longer reach these, so stop them without holding the lock */
+    stop_and_wait(stopping_functors, stopping_futures);
+}
+
+void mc::MultiThreadedCompositor::start_compositing_new_groups()
+{
+    if (state != CompositorState::started)
+        return;
+
+    /* Nothing has been posted to the new groups yet, so always compose a first frame */
+    for (auto const functor : create_compositing_threads())
+        functor->schedule_compositing(1);
+}
+
+auto mc::MultiThreadedCompositor::create_compositing_threads() -> std::vector<CompositingFunctor*>
+{
+    std::vector<CompositingFunctor*> created;
+
+    /* Start the compositing threads for display sync groups we are not already compositing */
+    display->for_each_display_sync_group([this, &created](mg::DisplaySyncGroup& group)
+    {
+        for (auto const& functor : thread_functors)
+        {
+            if (functor->composites(group))
+                return;
+        }
+
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
             display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            fixed_composite_delay, report, presentation_observer);
+
+        auto future = thread_pool.run(std::ref(*thread_functor), &group);
 
-        futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
+        std::lock_guard<std::mutex> lock{functors_mutex};
+        created.push_back(thread_functor.get());
+        futures.push_back(std::move(future));
         thread_functors.push_back(std::move(thread_functor));
     });
 
     thread_pool.shrink();
 
-    for (auto& functor : thread_functors)
+    for (auto const functor : created)
         functor->wait_until_started();
+
+    return created;
 }
 
 void mc::MultiThreadedCompositor::destroy_compositing_threads()
 {
-    for (auto& f : thread_functors)
-        f->stop();
+    std::vector<std::unique_ptr<CompositingFunctor>> stopping_functors;
+    std::vector<std::future<void>> stopping_futures;
 
-    for (auto& f : futures)
-        f.wait();
+    {
+        std::lock_guard<std::mutex> lock{functors_mutex};
+        stopping_functors.swap(thread_functors);
+        stopping_futures.swap(futures);
+    }
 
-    thread_functors.clear();
-    futures.clear();
+    stop_and_wait(stopping_functors, stopping_futures);
 }
@@ -35,6 +35,7 @@ namespace geometry { struct Rectangle; }
 namespace graphics
 {
 class Display;
+class DisplaySyncGroup;
 }
 namespace scene
 {
@@ -49,6 +50,7 @@ class DisplayListener;
 class CompositingFunctor;
 class Scene;
 class CompositorReport;
+class PresentationObserver;
 
 enum class CompositorState
 {
@@ -69,13 +71,25 @@ public:
         std::shared_ptr<CompositorReport> const& compositor_report,
         std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
         bool compose_on_start);
+    MultiThreadedCompositor(
+        std::shared_ptr<graphics::Display> const& display,
+        std::shared_ptr<Scene> const& scene,
+        std::shared_ptr<DisplayBufferCompositorFactory> const& db_compositor_factory,
+        std::shared_ptr<DisplayListener> const& display_listener,
+        std::shared_ptr<CompositorReport> const& compositor_report,
+        std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
+        bool compose_on_start,
+        std::shared_ptr<PresentationObserver> const& presentation_observer);  // may be null
     ~MultiThreadedCompositor();
 
     void start();
     void stop();
 
+    void stop_compositing(std::vector<graphics::DisplaySyncGroup*> const& groups);
+    void start_compositing_new_groups();
+
 private:
-    void create_compositing_threads();
+    std::vector<CompositingFunctor*> create_compositing_threads();
     void destroy_compositing_threads();
 
     std::shared_ptr<graphics::Display> const display;
@@ -83,7 +97,12 @@ private:
     std::shared_ptr<DisplayBufferCompositorFactory> const display_buffer_compositor_factory;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<PresentationObserver> const presentation_observer;
 
+    /// Guards thread_functors and futures against the scene observer while
+    /// individual groups are stopped or started; only the thread calling
+    /// start()/stop()/stop_compositing()/start_compositing_new_groups() modifies them.
+    mutable std::mutex functors_mutex;
     std::vector<std::unique_ptr<CompositingFunctor>> thread_functors;
     std::vector<std::future<void>> futures;
 
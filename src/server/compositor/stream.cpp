@@ -18,8 +18,6 @@
  */
 
 #include "stream.h"
-#include "queueing_schedule.h"
-#include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
 #include <boost/throw_exception.hpp>
 
@@ -29,16 +27,8 @@ namespace mg = mir::graphics;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
-enum class mc::Stream::ScheduleMode {
-    Queueing,
-    Dropping
-};
-
 mc::Stream::Stream(
     geom::Size size, MirPixelFormat pf) :
-    schedule_mode(ScheduleMode::Queueing),
-    schedule(std::make_shared<mc::QueueingSchedule>()),
-    arbiter(std::make_shared<mc::MultiMonitorArbiter>(schedule)),
     latest_buffer_size(size),
     pf(pf),
     first_frame_posted(false),
@@ -58,8 +48,8 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
         first_frame_posted = true;
         pf = buffer->pixel_format();
         latest_buffer_size = buffer->size();
-        schedule->schedule(buffer);
     }
+    mailbox.submit(buffer);
     {
         std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
         frame_callback(buffer->size());
@@ -68,8 +58,7 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
 
 void mc::Stream::with_most_recent_buffer_do(std::function<void(mg::Buffer&)> const& fn)
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    fn(*arbiter->snapshot_acquire());
+    fn(*mailbox.snapshot_acquire());
 }
 
 MirPixelFormat mc::Stream::pixel_format() const
@@ -87,7 +76,7 @@ void mc::Stream::set_frame_posted_callback(
 
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
-    return arbiter->compositor_acquire(id);
+    return mailbox.compositor_acquire(id);
 }
 
 geom::Size mc::Stream::stream_size()
@@ -100,58 +89,24 @@ geom::Size mc::Stream::stream_size()
 
 void mc::Stream::allow_framedropping(bool dropping)
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    if (dropping && schedule_mode == ScheduleMode::Queueing)
-    {
-        transition_schedule(std::make_shared<mc::DroppingSchedule>(), lk);
-        schedule_mode = ScheduleMode::Dropping;
-    }
-    else if (!dropping && schedule_mode == ScheduleMode::Dropping)
-    {
-        transition_schedule(std::make_shared<mc::QueueingSchedule>(), lk);
-        schedule_mode = ScheduleMode::Queueing;
-    }
+    mailbox.set_dropping(dropping);
 }
 
 bool mc::Stream::framedropping() const
 {
-    return schedule_mode == ScheduleMode::Dropping;
-}
-
-void mc::Stream::transition_schedule(
-    std::shared_ptr<mc::Schedule>&& new_schedule, std::lock_guard<std::mutex> const&)
-{
-    std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
-    while(schedule->num_scheduled())
-        transferred_buffers.emplace_back(schedule->next_buffer());
-    for(auto& buffer : transferred_buffers)
-        new_schedule->schedule(buffer);
-    schedule = new_schedule;
-    arbiter->set_schedule(schedule);
+    return mailbox.dropping();
 }
 
 int mc::Stream::buffers_ready_for_compositor(void const* id) const
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    if (arbiter->buffer_ready_for(id))
+    if (mailbox.buffer_ready_for(id))
         return 1;
     return 0;
 }
 
 void mc::Stream::drop_old_buffers()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
-    while(schedule->num_scheduled())
-        transferred_buffers.emplace_back(schedule->next_buffer());
-
-    if (!transferred_buffers.empty())
-    {
-        schedule->schedule(transferred_buffers.back());
-        transferred_buffers.pop_back();
-    }
-
-    arbiter->advance_schedule();
+    mailbox.drop_old_buffers();
 }
 
 bool mc::Stream::has_submitted_buffer() const
@@ -25,7 +25,7 @@
 #include "mir/frontend/buffer_stream_id.h"
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
-#include "multi_monitor_arbiter.h"
+#include "buffer_mailbox.h"
 #include <mutex>
 #include <memory>
 #include <set>
@@ -35,7 +35,6 @@ namespace mir
 namespace frontend { class ClientBuffers; }
 namespace compositor
 {
-class Schedule;
 class Stream : public BufferStream
 {
 public:
@@ -58,13 +57,9 @@ public:
     void set_scale(float scale) override;
 
 private:
-    enum class ScheduleMode;
-    void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    BufferMailbox mailbox;
 
     std::mutex mutable mutex;
-    ScheduleMode schedule_mode;
-    std::shared_ptr<Schedule> schedule;
-    std::shared_ptr<MultiMonitorArbiter> const arbiter;
     geometry::Size latest_buffer_size;
     float scale_{1.0f};
     MirPixelFormat pf;
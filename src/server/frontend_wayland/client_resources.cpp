@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_resources.h"
+
+#include "wayland_frontend.tp.h"
+
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <limits>
+#include <stdexcept>
+
+namespace mf = mir::frontend;
+
+namespace
+{
+auto parse_quota_value(std::string const& spec, std::string const& value, uint64_t unit) -> uint64_t
+{
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{
+            "Invalid resource quota \"" + spec + "\": expected SOFT[:HARD]"}));
+    }
+
+    auto const result = std::stoull(value);
+    if (result > std::numeric_limits<uint64_t>::max() / unit)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Resource quota \"" + spec + "\" is too large"}));
+    }
+
+    return result * unit;
+}
+
+char const* const limit_names[] = {
+    "surfaces",
+    "bytes of buffer memory",
+    "frame callbacks",
+};
+}
+
+auto mf::parse_resource_quota(std::string const& spec, uint64_t unit) -> ResourceQuota
+{
+    auto const separator = spec.find(':');
+    ResourceQuota const quota{
+        parse_quota_value(spec, spec.substr(0, separator), unit),
+        separator == std::string::npos ? 0 : parse_quota_value(spec, spec.substr(separator + 1), unit)};
+
+    if (quota.hard && quota.soft > quota.hard)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{
+            "Invalid resource quota \"" + spec + "\": soft limit is above hard limit"}));
+    }
+
+    return quota;
+}
+
+mf::ClientResources::ClientResources(wl_client* client, pid_t pid, ResourceQuotas const& quotas)
+    : client{client},
+      pid{pid},
+      quotas(quotas)
+{
+}
+
+auto mf::ClientResources::charge(Resource resource, uint64_t amount) -> bool
+{
+    return replace_charge(resource, 0, resource, amount);
+}
+
+auto mf::ClientResources::replace_charge(
+    Resource old_resource, uint64_t old_amount, Resource resource, uint64_t amount) -> bool
+{
+    auto const old_limit = limit_for(old_resource);
+    auto const limit = limit_for(resource);
+    auto const& limit_quota = quota(limit);
+    auto& old_used = usage_[static_cast<int>(old_resource)];
+    auto const released = std::min(old_used, old_amount);
+    auto const new_usage = limited_usage(limit) - (old_limit == limit ? released : 0) + amount;
+
+    if (limit_quota.hard && new_usage > limit_quota.hard)
+    {
+        log_warning(
+            "Client with pid %d exceeded its hard quota of %" PRIu64 " %s",
+            pid, limit_quota.hard, limit_names[static_cast<int>(limit)]);
+        return false;
+    }
+
+    old_used -= released;
+    usage_[static_cast<int>(resource)] += amount;
+
+    update_soft_quota(old_limit);
+    update_soft_quota(limit);
+
+    report();
+    return true;
+}
+
+void mf::ClientResources::release(Resource resource, uint64_t amount)
+{
+    auto& used = usage_[static_cast<int>(resource)];
+    used -= std::min(used, amount);
+
+    update_soft_quota(limit_for(resource));
+
+    report();
+}
+
+auto mf::ClientResources::usage(Resource resource) const -> uint64_t
+{
+    return usage_[static_cast<int>(resource)];
+}
+
+auto mf::ClientResources::limit_for(Resource resource) const -> Limit
+{
+    switch (resource)
+    {
+    case Resource::surfaces:
+        return Limit::surfaces;
+
+    case Resource::shm_buffer_memory:
+    case Resource::hardware_buffer_memory:
+        return Limit::buffer_memory;
+
+    case Resource::frame_callbacks:
+        return Limit::frame_callbacks;
+    }
+
+    BOOST_THROW_EXCEPTION((std::logic_error{"Invalid client resource"}));
+}
+
+auto mf::ClientResources::limited_usage(Limit limit) const -> uint64_t
+{
+    switch (limit)
+    {
+    case Limit::surfaces:
+        return usage(Resource::surfaces);
+
+    case Limit::buffer_memory:
+        return usage(Resource::shm_buffer_memory) + usage(Resource::hardware_buffer_memory);
+
+    case Limit::frame_callbacks:
+        return usage(Resource::frame_callbacks);
+    }
+
+    BOOST_THROW_EXCEPTION((std::logic_error{"Invalid client resource limit"}));
+}
+
+auto mf::ClientResources::quota(Limit limit) const -> ResourceQuota const&
+{
+    switch (limit)
+    {
+    case Limit::surfaces:
+        return quotas.surfaces;
+
+    case Limit::buffer_memory:
+        return quotas.buffer_memory;
+
+    case Limit::frame_callbacks:
+        return quotas.frame_callbacks;
+    }
+
+    BOOST_THROW_EXCEPTION((std::logic_error{"Invalid client resource limit"}));
+}
+
+void mf::ClientResources::update_soft_quota(Limit limit)
+{
+    auto const& limit_quota = quota(limit);
+    auto& warned = over_soft_quota[static_cast<int>(limit)];
+
+    if (!limit_quota.soft || limited_usage(limit) <= limit_quota.soft)
+    {
+        warned = false;
+    }
+    else if (!warned)
+    {
+        warned = true;
+        log_warning(
+            "Client with pid %d exceeded its soft quota of %" PRIu64 " %s",
+            pid, limit_quota.soft, limit_names[static_cast<int>(limit)]);
+    }
+}
+
+void mf::ClientResources::report()
+{
+    tracepoint(
+        mir_server_wayland,
+        client_resources_changed,
+        client,
+        usage(Resource::surfaces),
+        usage(Resource::shm_buffer_memory),
+        usage(Resource::hardware_buffer_memory),
+        usage(Resource::frame_callbacks));
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_RESOURCES_H_
+#define MIR_FRONTEND_CLIENT_RESOURCES_H_
+
+#include <sys/types.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct wl_client;
+
+namespace mir
+{
+namespace frontend
+{
+/// Limits on how much of one resource a client may hold. Zero means unlimited.
+struct ResourceQuota
+{
+    /// Exceeding this is logged
+    uint64_t soft;
+    /// Exceeding this disconnects the client with a no_memory error
+    uint64_t hard;
+};
+
+/**
+ * Parses a quota of the form "SOFT[:HARD]"
+ *
+ * \param spec  The quota, as given on the command line
+ * \param unit  The number of accounted units in each unit of \a spec
+ * \throws std::runtime_error if \a spec is malformed
+ */
+auto parse_resource_quota(std::string const& spec, uint64_t unit = 1) -> ResourceQuota;
+
+struct ResourceQuotas
+{
+    ResourceQuota surfaces;
+    /// In bytes, of shm and hardware buffers together
+    ResourceQuota buffer_memory;
+    ResourceQuota frame_callbacks;
+};
+
+/**
+ * Accounts for the surfaces, buffers and frame callbacks a Wayland client holds
+ *
+ * There is one for each client, shared by everything charged to it so that it outlives them
+ * whatever order they are destroyed in. Buffer memory is that of the buffer most recently
+ * committed to each surface. All charges are made and released on the Wayland thread.
+ */
+class ClientResources
+{
+public:
+    enum class Resource
+    {
+        surfaces,
+        shm_buffer_memory,
+        hardware_buffer_memory,
+        frame_callbacks,
+    };
+
+    /**
+     * \param client    The client being accounted for. Only used to identify it in traces.
+     * \param pid       The client's pid. Only used to identify it in logs.
+     * \param quotas    The limits to enforce
+     */
+    ClientResources(wl_client* client, pid_t pid, ResourceQuotas const& quotas);
+
+    ClientResources(ClientResources const&) = delete;
+    ClientResources& operator=(ClientResources const&) = delete;
+
+    /**
+     * Charges \a amount of \a resource to the client
+     *
+     * \return  false, without charging anything, if that would take the client over its hard quota.
+     *          The caller should then fail the request with wl_client_post_no_memory().
+     */
+    auto charge(Resource resource, uint64_t amount) -> bool;
+
+    /**
+     * Replaces a charge of \a old_amount of \a old_resource with \a amount of \a resource
+     *
+     * Unlike a release() followed by a charge(), a client that stays over its soft quota
+     * is not warned again.
+     *
+     * \return  false, leaving the old charge in place, if that would take the client over
+     *          its hard quota
+     */
+    auto replace_charge(Resource old_resource, uint64_t old_amount, Resource resource, uint64_t amount) -> bool;
+
+    /// Releases \a amount of \a resource previously charged
+    void release(Resource resource, uint64_t amount);
+
+    auto usage(Resource resource) const -> uint64_t;
+
+private:
+    enum class Limit
+    {
+        surfaces,
+        buffer_memory,
+        frame_callbacks,
+    };
+
+    auto limit_for(Resource resource) const -> Limit;
+    auto limited_usage(Limit limit) const -> uint64_t;
+    auto quota(Limit limit) const -> ResourceQuota const&;
+    /// Warns once when \a limit's soft quota is first exceeded, and rearms once usage is within it
+    void update_soft_quota(Limit limit);
+    void report();
+
+    wl_client* const client;
+    pid_t const pid;
+    ResourceQuotas const quotas;
+    std::array<uint64_t, 4> usage_{};
+    /// Whether each limit's soft quota has been exceeded since usage was last within it
+    std::array<bool, 3> over_soft_quota{};
+};
+
+/// Utility function to recover the resource accounting for a wl_client
+auto get_client_resources(wl_client* client) -> std::shared_ptr<ClientResources>;
+}
+}
+
+#endif // MIR_FRONTEND_CLIENT_RESOURCES_H_
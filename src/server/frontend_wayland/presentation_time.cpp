@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_time.h"
+
+#include "wl_surface.h"
+#include "presentation_tracker.h"
+#include "deleted_for_resource.h"
+
+#include "mir/observer_registrar.h"
+#include "mir/executor.h"
+
+#include <limits>
+#include <time.h>
+
+namespace mf = mir::frontend;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class WpPresentation : public wayland::Presentation::Global
+{
+public:
+    WpPresentation(wl_display* display, std::shared_ptr<PresentationTracker> const& tracker);
+
+private:
+    class Instance : public wayland::Presentation
+    {
+    public:
+        Instance(wl_resource* new_resource, std::shared_ptr<PresentationTracker> const& tracker);
+
+    private:
+        void destroy() override;
+        void feedback(wl_resource* surface, wl_resource* callback) override;
+
+        std::shared_ptr<PresentationTracker> const tracker;
+    };
+
+    void bind(wl_resource* new_resource) override;
+
+    std::shared_ptr<PresentationTracker> const tracker;
+};
+}
+}
+
+auto mf::create_wp_presentation(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<ObserverRegistrar<mc::PresentationObserver>> const& registrar)
+    -> std::shared_ptr<WpPresentation>
+{
+    auto const tracker = std::make_shared<PresentationTracker>();
+    registrar->register_interest(tracker, *wayland_executor);
+    return std::make_shared<WpPresentation>(display, tracker);
+}
+
+mf::WpPresentationFeedback::WpPresentationFeedback(
+    wl_resource* new_resource,
+    std::shared_ptr<PresentationTracker> const& tracker)
+    : PresentationFeedback{new_resource, Version<1>()},
+      tracker{tracker},
+      destroyed{deleted_flag_for_resource(resource)}
+{
+}
+
+void mf::WpPresentationFeedback::committed(WlSurface* surface, mg::BufferID buffer)
+{
+    if (*destroyed)
+        return;
+
+    tracker->track(surface, buffer, shared_from_this());
+}
+
+void mf::WpPresentationFeedback::discard()
+{
+    if (*destroyed)
+        return;
+
+    send_discarded_event();
+    destroy_wayland_object();
+}
+
+void mf::WpPresentationFeedback::presented(
+    mg::Frame const& frame,
+    std::chrono::nanoseconds refresh,
+    uint32_t flags)
+{
+    if (*destroyed)
+        return;
+
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(frame.ust.nanoseconds);
+    auto const nanoseconds = frame.ust.nanoseconds - seconds;
+    auto const sec = static_cast<uint64_t>(seconds.count());
+    auto const msc = static_cast<uint64_t>(frame.msc);
+    auto const refresh_ns = std::min<int64_t>(refresh.count(), std::numeric_limits<uint32_t>::max());
+
+    send_presented_event(
+        sec >> 32, sec & 0xffffffff,
+        nanoseconds.count(),
+        refresh_ns,
+        msc >> 32, msc & 0xffffffff,
+        flags);
+    destroy_wayland_object();
+}
+
+mf::WpPresentation::WpPresentation(wl_display* display, std::shared_ptr<PresentationTracker> const& tracker)
+    : Global{display, Version<1>()},
+      tracker{tracker}
+{
+}
+
+void mf::WpPresentation::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource, tracker};
+}
+
+mf::WpPresentation::Instance::Instance(wl_resource* new_resource, std::shared_ptr<PresentationTracker> const& tracker)
+    : Presentation{new_resource, Version<1>()},
+      tracker{tracker}
+{
+    // Frame timestamps come from the kernel's page-flip events, which use CLOCK_MONOTONIC
+    send_clock_id_event(CLOCK_MONOTONIC);
+}
+
+void mf::WpPresentation::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::WpPresentation::Instance::feedback(wl_resource* surface, wl_resource* callback)
+{
+    WlSurface::from(surface)->add_presentation_feedback(
+        std::make_shared<WpPresentationFeedback>(callback, tracker));
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_PRESENTATION_TIME_H
+#define MIR_FRONTEND_PRESENTATION_TIME_H
+
+#include "presentation-time_wrapper.h"
+#include "presentation_tracker.h"
+
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+#include <memory>
+
+struct wl_display;
+
+namespace mir
+{
+class Executor;
+template<class Observer>
+class ObserverRegistrar;
+
+namespace frontend
+{
+class WlSurface;
+class WpPresentation;
+
+/// A wp_presentation_feedback, waiting on the content update it was requested for
+class WpPresentationFeedback : public wayland::PresentationFeedback,
+                               public PresentationTracker::Feedback,
+                               public std::enable_shared_from_this<WpPresentationFeedback>
+{
+public:
+    WpPresentationFeedback(wl_resource* new_resource, std::shared_ptr<PresentationTracker> const& tracker);
+
+    /// The surface committed \p buffer as the content update this feedback is for
+    void committed(WlSurface* surface, graphics::BufferID buffer);
+    void discard() override;
+    void presented(graphics::Frame const& frame, std::chrono::nanoseconds refresh, uint32_t flags) override;
+
+private:
+    std::shared_ptr<PresentationTracker> const tracker;
+    std::shared_ptr<bool> const destroyed;
+};
+
+auto create_wp_presentation(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> const& registrar)
+    -> std::shared_ptr<WpPresentation>;
+}
+}
+
+#endif // MIR_FRONTEND_PRESENTATION_TIME_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_tracker.h"
+
+#include <algorithm>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+
+mf::PresentationTracker::~PresentationTracker()
+{
+    for (auto const& surface : pending)
+        surface.first->remove_destroy_listener(this);
+}
+
+void mf::PresentationTracker::track(
+    Surface* surface,
+    mg::BufferID buffer,
+    std::shared_ptr<Feedback> const& feedback)
+{
+    auto& queue = pending[surface];
+    if (queue.empty())
+        surface->add_destroy_listener(this, [this, surface]() { surface_destroyed(surface); });
+
+    queue.push_back({buffer, feedback});
+
+    if (queue.size() > max_pending_per_surface)
+    {
+        queue.front().feedback->discard();
+        queue.pop_front();
+    }
+}
+
+void mf::PresentationTracker::frame_presented(
+    std::vector<mg::BufferID> const& buffers,
+    mg::Frame const& frame,
+    std::chrono::nanoseconds refresh,
+    uint32_t flags)
+{
+    auto const was_presented = [&buffers](Pending const& p)
+        { return std::find(buffers.begin(), buffers.end(), p.buffer) != buffers.end(); };
+
+    for (auto surface = pending.begin(); surface != pending.end();)
+    {
+        auto& queue = surface->second;
+
+        // Anything committed before the newest buffer shown was superseded without being seen
+        auto const newest = std::find_if(queue.rbegin(), queue.rend(), was_presented);
+        if (newest != queue.rend())
+        {
+            auto const end = newest.base();
+            for (auto p = queue.begin(); p != end; ++p)
+            {
+                if (was_presented(*p))
+                    p->feedback->presented(frame, refresh, flags);
+                else
+                    p->feedback->discard();
+            }
+            queue.erase(queue.begin(), end);
+        }
+
+        if (queue.empty())
+        {
+            surface->first->remove_destroy_listener(this);
+            surface = pending.erase(surface);
+        }
+        else
+        {
+            ++surface;
+        }
+    }
+}
+
+void mf::PresentationTracker::surface_destroyed(Surface* surface)
+{
+    auto const queue = pending.find(surface);
+    if (queue == pending.end())
+        return;
+
+    for (auto const& p : queue->second)
+        p.feedback->discard();
+
+    pending.erase(queue);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_PRESENTATION_TRACKER_H
+#define MIR_FRONTEND_PRESENTATION_TRACKER_H
+
+#include "mir/compositor/presentation_observer.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace mir
+{
+namespace frontend
+{
+/// Matches the buffers the compositor presents to the feedbacks waiting on them
+class PresentationTracker : public compositor::PresentationObserver
+{
+public:
+    /// A surface content updates are committed to
+    class Surface
+    {
+    public:
+        virtual ~Surface() = default;
+
+        virtual void add_destroy_listener(void const* key, std::function<void()> listener) = 0;
+        virtual void remove_destroy_listener(void const* key) = 0;
+    };
+
+    /// Told, exactly once, what became of the content update it is waiting on
+    class Feedback
+    {
+    public:
+        virtual ~Feedback() = default;
+
+        /// The content update will never be shown
+        virtual void discard() = 0;
+        virtual void presented(graphics::Frame const& frame, std::chrono::nanoseconds refresh, uint32_t flags) = 0;
+    };
+
+    /// A client that never gets shown shouldn't be able to grow the queue without limit
+    static size_t const max_pending_per_surface = 32;
+
+    PresentationTracker() = default;
+    ~PresentationTracker();
+
+    void track(Surface* surface, graphics::BufferID buffer, std::shared_ptr<Feedback> const& feedback);
+
+    void frame_presented(
+        std::vector<graphics::BufferID> const& buffers,
+        graphics::Frame const& frame,
+        std::chrono::nanoseconds refresh,
+        uint32_t flags) override;
+
+private:
+    struct Pending
+    {
+        graphics::BufferID buffer;
+        std::shared_ptr<Feedback> feedback;
+    };
+
+    void surface_destroyed(Surface* surface);
+
+    // Only accessed on the Wayland thread
+    std::unordered_map<Surface*, std::deque<Pending>> pending;
+};
+}
+}
+
+#endif // MIR_FRONTEND_PRESENTATION_TRACKER_H
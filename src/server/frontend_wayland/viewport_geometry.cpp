@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "viewport_geometry.h"
+
+#include "viewporter_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cmath>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+auto mf::viewport_geometry(
+    wl_resource* viewport,
+    geom::Size buffer_size,
+    int scale,
+    std::experimental::optional<ViewportSource> const& source,
+    std::experimental::optional<geom::Size> const& destination) -> ViewportGeometry
+{
+    ViewportGeometry result{buffer_size, std::experimental::nullopt};
+
+    if (source)
+    {
+        auto const& src = source.value();
+
+        if (src.x + src.width > buffer_size.width.as_int() ||
+            src.y + src.height > buffer_size.height.as_int())
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                viewport,
+                mw::Viewport::Error::out_of_buffer,
+                "Source rectangle %gx%g+%g+%g extends outside the %dx%d buffer",
+                src.width, src.height, src.x, src.y,
+                buffer_size.width.as_int(), buffer_size.height.as_int()));
+        }
+
+        // Renderables only sample whole buffer pixels, so sub-pixel source rectangles are rounded outwards
+        int const left = std::floor(src.x * scale);
+        int const top = std::floor(src.y * scale);
+        int const right = std::ceil((src.x + src.width) * scale);
+        int const bottom = std::ceil((src.y + src.height) * scale);
+        result.buffer_source = geom::Rectangle{{left, top}, {right - left, bottom - top}};
+
+        if (!destination)
+        {
+            if (src.width != std::floor(src.width) || src.height != std::floor(src.height))
+            {
+                BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                    viewport,
+                    mw::Viewport::Error::bad_size,
+                    "Source size %gx%g is not integral and no destination size is set",
+                    src.width, src.height));
+            }
+            result.size = geom::Size{static_cast<int>(src.width), static_cast<int>(src.height)};
+        }
+    }
+
+    if (destination)
+        result.size = destination.value();
+
+    return result;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_VIEWPORT_GEOMETRY_H
+#define MIR_FRONTEND_VIEWPORT_GEOMETRY_H
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/rectangle.h"
+
+#include <experimental/optional>
+
+struct wl_resource;
+
+namespace mir
+{
+namespace frontend
+{
+/// A wp_viewport source rectangle, in surface coordinates before scaling
+struct ViewportSource
+{
+    double x, y, width, height;
+};
+
+/// What a committed wp_viewport state makes of a surface's buffer
+struct ViewportGeometry
+{
+    /// The size of the surface
+    geometry::Size size;
+    /// The part of the buffer shown, in buffer pixels, if the viewport crops it
+    std::experimental::optional<geometry::Rectangle> buffer_source;
+};
+
+/**
+ * Applies \a source and \a destination to a buffer of \a buffer_size (in surface coordinates) and \a scale
+ *
+ * \throws wayland::ProtocolError  out_of_buffer on \a viewport if \a source extends outside the buffer, or
+ *                                 bad_size if \a source has a fractional size and there is no \a destination
+ */
+auto viewport_geometry(
+    wl_resource* viewport,
+    geometry::Size buffer_size,
+    int scale,
+    std::experimental::optional<ViewportSource> const& source,
+    std::experimental::optional<geometry::Size> const& destination) -> ViewportGeometry;
+}
+}
+
+#endif // MIR_FRONTEND_VIEWPORT_GEOMETRY_H
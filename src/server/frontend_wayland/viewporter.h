@@ -1,5 +1,5 @@
 /*
- * Copyright © 2015 Canonical Ltd.
+ * Copyright © 2019 Canonical Ltd.
  *
  * This program is free software: you can redistribute it and/or modify it
  * under the terms of the GNU General Public License version 2 or 3,
@@ -12,33 +12,24 @@
  *
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- *
  */
 
-#ifndef MIR_COMPOSITOR_SCHEDULE_H_
-#define MIR_COMPOSITOR_SCHEDULE_H_
+
+#ifndef MIR_FRONTEND_VIEWPORTER_H
+#define MIR_FRONTEND_VIEWPORTER_H
 
 #include <memory>
 
+struct wl_display;
+
 namespace mir
 {
-namespace graphics { class Buffer; }
-namespace compositor
+namespace frontend
 {
+class WpViewporter;
 
-class Schedule
-{
-public:
-    virtual void schedule(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
-    virtual unsigned int num_scheduled() = 0;
-    virtual std::shared_ptr<graphics::Buffer> next_buffer() = 0;
-
-    virtual ~Schedule() = default;
-    Schedule() = default;
-    Schedule(Schedule const&) = delete;
-    Schedule& operator=(Schedule const&) = delete;
-};
-
+auto create_wp_viewporter(wl_display* display) -> std::shared_ptr<WpViewporter>;
 }
 }
-#endif /* MIR_COMPOSITOR_SCHEDULE_H_ */
+
+#endif // MIR_FRONTEND_VIEWPORTER_H
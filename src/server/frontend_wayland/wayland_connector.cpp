@@ -26,6 +26,7 @@
 #include "wl_surface.h"
 #include "wl_seat.h"
 #include "wl_region.h"
+#include "client_resources.h"
 
 #include "null_event_sink.h"
 #include "output_manager.h"
@@ -106,9 +107,13 @@ namespace
 {
 struct ClientPrivate
 {
-    ClientPrivate(std::shared_ptr<ms::Session> const& session, msh::Shell* shell)
+    ClientPrivate(
+        std::shared_ptr<ms::Session> const& session,
+        msh::Shell* shell,
+        std::shared_ptr<mf::ClientResources> const& resources)
         : session{session},
-          shell{shell}
+          shell{shell},
+          resources{resources}
     {
     }
 
@@ -129,6 +134,7 @@ struct ClientPrivate
      * This shell is owned by the ClientSessionConstructor, which outlives all clients.
      */
     msh::Shell* const shell;
+    std::shared_ptr<mf::ClientResources> const resources;
 };
 
 static_assert(
@@ -150,10 +156,12 @@ struct ClientSessionConstructor
 {
     ClientSessionConstructor(std::shared_ptr<msh::Shell> const& shell,
                              std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
-                             std::unordered_map<int, std::function<void(std::shared_ptr<scene::Session> const& session)>>* connect_handlers)
+                             std::unordered_map<int, std::function<void(std::shared_ptr<scene::Session> const& session)>>* connect_handlers,
+                             mf::ResourceQuotas const& client_quotas)
         : shell{shell},
           session_authorizer{session_authorizer},
-          connect_handlers{connect_handlers}
+          connect_handlers{connect_handlers},
+          client_quotas(client_quotas)
     {
     }
 
@@ -162,7 +170,7 @@ struct ClientSessionConstructor
     std::shared_ptr<msh::Shell> const shell;
     std::shared_ptr<mf::SessionAuthorizer> const session_authorizer;
     std::unordered_map<int, std::function<void(std::shared_ptr<scene::Session> const& session)>>* connect_handlers;
-
+    mf::ResourceQuotas const client_quotas;
 };
 
 static_assert(
@@ -202,7 +210,10 @@ void create_client_session(wl_listener* listener, void* data)
         "",
         std::make_shared<NullEventSink>());
 
-    auto client_context = new ClientPrivate{session, construction_context->shell.get()};
+    auto client_context = new ClientPrivate{
+        session,
+        construction_context->shell.get(),
+        std::make_shared<mf::ClientResources>(client, client_pid, construction_context->client_quotas)};
     client_context->destroy_listener.notify = &cleanup_private;
     wl_client_add_destroy_listener(client, &client_context->destroy_listener);
 
@@ -219,9 +230,10 @@ void cleanup_client_handler(wl_listener* listener, void*)
 
 void setup_new_client_handler(wl_display* display, std::shared_ptr<msh::Shell> const& shell,
                               std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
-                              std::unordered_map<int, std::function<void(std::shared_ptr<scene::Session> const& session)>>* connect_handlers)
+                              std::unordered_map<int, std::function<void(std::shared_ptr<scene::Session> const& session)>>* connect_handlers,
+                              mf::ResourceQuotas const& client_quotas)
 {
-    auto context = new ClientSessionConstructor{shell, session_authorizer, connect_handlers};
+    auto context = new ClientSessionConstructor{shell, session_authorizer, connect_handlers, client_quotas};
     context->construction_listener.notify = &create_client_session;
 
     wl_display_add_client_created_listener(display, &context->construction_listener);
@@ -288,6 +300,13 @@ void WlCompositor::on_surface_created(wl_client* client, uint32_t id, std::funct
 
 void WlCompositor::Instance::create_surface(wl_resource* new_surface)
 {
+    // The surface releases this when it is destroyed
+    if (!get_client_resources(client)->charge(ClientResources::Resource::surfaces, 1))
+    {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
     auto const surface = new WlSurface{new_surface, compositor->executor, compositor->allocator};
     auto const key = std::make_pair(wl_resource_get_client(new_surface), wl_resource_get_id(new_surface));
     auto const callbacks = compositor->surface_callbacks.find(key);
@@ -614,9 +633,11 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
     std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
     std::shared_ptr<SurfaceStack> const& surface_stack,
+    std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> const& presentation_observer_registrar,
     bool arw_socket,
     std::unique_ptr<WaylandExtensions> extensions_,
-    WaylandProtocolExtensionFilter const& extension_filter)
+    WaylandProtocolExtensionFilter const& extension_filter,
+    ResourceQuotas const& client_quotas)
     : display{wl_display_create(), &cleanup_display},
       pause_signal{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE)},
       executor{std::make_shared<WaylandExecutor>(wl_display_get_event_loop(display.get()))},
@@ -679,7 +700,8 @@ mf::WaylandConnector::WaylandConnector(
         shell,
         seat_global.get(),
         output_manager.get(),
-        surface_stack});
+        surface_stack,
+        presentation_observer_registrar});
 
     wl_display_init_shm(display.get());
 
@@ -713,7 +735,7 @@ mf::WaylandConnector::WaylandConnector(
 
     auto wayland_loop = wl_display_get_event_loop(display.get());
 
-    setup_new_client_handler(display.get(), shell, session_authorizer, &connect_handlers);
+    setup_new_client_handler(display.get(), shell, session_authorizer, &connect_handlers, client_quotas);
 
     pause_source = wl_event_loop_add_fd(wayland_loop, pause_signal, WL_EVENT_READABLE, &halt_eventloop, display.get());
 }
@@ -881,6 +903,19 @@ auto mir::frontend::get_session(wl_client* client) -> std::shared_ptr<scene::Ses
     return {};
 }
 
+auto mf::get_client_resources(wl_client* client) -> std::shared_ptr<ClientResources>
+{
+    auto listener = wl_client_get_destroy_listener(client, &cleanup_private);
+
+    if (listener)
+    {
+        auto client_private = private_from_listener(listener);
+        return client_private->resources;
+    }
+
+    return {};
+}
+
 auto mf::get_session(wl_resource* surface) -> std::shared_ptr<ms::Session>
 {
     return get_session(wl_resource_get_client(surface));
@@ -32,6 +32,8 @@
 namespace mir
 {
 class Executor;
+template<class Observer>
+class ObserverRegistrar;
 
 namespace input
 {
@@ -54,6 +56,10 @@ namespace scene
 {
 class Surface;
 }
+namespace compositor
+{
+class PresentationObserver;
+}
 namespace frontend
 {
 class WlCompositor;
@@ -66,6 +72,7 @@ class SessionAuthorizer;
 class DataDeviceManager;
 class WlSurface;
 class SurfaceStack;
+struct ResourceQuotas;
 
 class WaylandExtensions
 {
@@ -79,6 +86,7 @@ public:
         WlSeat* seat;
         OutputManager* output_manager;
         std::shared_ptr<SurfaceStack> surface_stack;
+        std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> presentation_observer_registrar;
     };
 
     WaylandExtensions() = default;
@@ -114,9 +122,11 @@ public:
         std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
         std::shared_ptr<SurfaceStack> const& surface_stack,
+        std::shared_ptr<ObserverRegistrar<compositor::PresentationObserver>> const& presentation_observer_registrar,
         bool arw_socket,
         std::unique_ptr<WaylandExtensions> extensions,
-        WaylandProtocolExtensionFilter const& extension_filter);
+        WaylandProtocolExtensionFilter const& extension_filter,
+        ResourceQuotas const& client_quotas);
 
     ~WaylandConnector() override;
 
@@ -30,6 +30,10 @@
 #include "xdg-output-unstable-v1_wrapper.h"
 #include "foreign_toplevel_manager_v1.h"
 #include "wlr-foreign-toplevel-management-unstable-v1_wrapper.h"
+#include "presentation_time.h"
+#include "viewporter.h"
+#include "viewporter_wrapper.h"
+#include "client_resources.h"
 
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
@@ -83,6 +87,19 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
                     ctx.surface_stack);
             }
     },
+    {
+        mw::Presentation::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            {
+                return mf::create_wp_presentation(
+                    ctx.display,
+                    ctx.wayland_executor,
+                    ctx.presentation_observer_registrar);
+            }
+    },
+    {
+        mw::Viewporter::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_wp_viewporter(ctx.display); }
+    },
 };
 
 ExtensionBuilder const xwayland_builder {
@@ -169,7 +186,9 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
     return std::vector<std::string>{
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
-        mw::XdgShellV6::interface_name};
+        mw::XdgShellV6::interface_name,
+        mw::Presentation::interface_name,
+        mw::Viewporter::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -191,6 +210,17 @@ std::shared_ptr<mf::Connector>
             auto options = the_options();
             bool const arw_socket = options->is_set(options::arw_server_socket_opt);
 
+            auto const quota = [&options](char const* option, uint64_t unit)
+                {
+                    return options->is_set(option) ?
+                        mf::parse_resource_quota(options->get<std::string>(option), unit) :
+                        mf::ResourceQuota{0, 0};
+                };
+            mf::ResourceQuotas const client_quotas{
+                quota(mo::client_surface_quota_opt, 1),
+                quota(mo::client_buffer_memory_quota_opt, 1024 * 1024),
+                quota(mo::client_frame_callback_quota_opt, 1)};
+
             auto wayland_extensions = std::set<std::string>{
                 enabled_wayland_extensions.begin(),
                 enabled_wayland_extensions.end()};
@@ -207,12 +237,14 @@ std::shared_ptr<mf::Connector>
                 the_buffer_allocator(),
                 the_session_authorizer(),
                 the_frontend_surface_stack(),
+                the_presentation_observer_registrar(),
                 arw_socket,
                 configure_wayland_extensions(
                     wayland_extensions,
                     options->is_set(mo::x11_display_opt),
                     wayland_extension_hooks),
-                wayland_extension_filter);
+                wayland_extension_filter,
+                client_quotas);
         });
 }
 
@@ -20,6 +20,7 @@
 
 #include "wl_subcompositor.h"
 #include "wl_surface.h"
+#include "presentation_time.h"
 
 #include "mir/geometry/rectangle.h"
 
@@ -90,6 +91,13 @@ mf::WlSubsurface::~WlSubsurface()
     }
     surface->clear_role();
     refresh_surface_data_now();
+
+    if (cached_state)
+    {
+        // The cached content will never be applied, so will never be presented
+        for (auto const& feedback : cached_state.value().presentation_feedbacks)
+            feedback->discard();
+    }
 }
 
 void mf::WlSubsurface::populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
@@ -23,8 +23,10 @@
 #include "wl_subcompositor.h"
 #include "wl_region.h"
 #include "deleted_for_resource.h"
+#include "presentation_time.h"
 
 #include "wayland_wrapper.h"
+#include "viewporter_wrapper.h"
 
 #include "wayland_frontend.tp.h"
 
@@ -46,12 +48,18 @@ namespace geom = mir::geometry;
 namespace mw = mir::wayland;
 namespace msh = mir::shell;
 
-mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
+mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource, std::shared_ptr<ClientResources> const& resources)
     : mw::Callback{new_resource, Version<1>()},
-      destroyed{deleted_flag_for_resource(resource)}
+      destroyed{deleted_flag_for_resource(resource)},
+      resources{resources}
 {
 }
 
+mf::WlSurfaceState::Callback::~Callback()
+{
+    resources->release(ClientResources::Resource::frame_callbacks, 1);
+}
+
 void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
 {
     if (source.buffer)
@@ -66,10 +74,20 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.viewport_source)
+        viewport_source = source.viewport_source;
+
+    if (source.viewport_destination)
+        viewport_destination = source.viewport_destination;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_feedbacks.insert(end(presentation_feedbacks),
+                                  begin(source.presentation_feedbacks),
+                                  end(source.presentation_feedbacks));
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -78,6 +96,8 @@ bool mf::WlSurfaceState::surface_data_needs_refresh() const
 {
     return offset ||
            input_shape ||
+           viewport_source ||
+           viewport_destination ||
            surface_data_invalidated;
 }
 
@@ -85,11 +105,12 @@ mf::WlSurface::WlSurface(
     wl_resource* new_resource,
     std::shared_ptr<Executor> const& executor,
     std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator)
-    : Surface(new_resource, Version<4>()),
+    : wayland::Surface(new_resource, Version<4>()),
         session{get_session(client)},
         stream{session->create_buffer_stream({{}, mir_pixel_format_invalid, graphics::BufferUsage::undefined})},
         allocator{allocator},
         executor{executor},
+        resources{get_client_resources(client)},
         null_role{this},
         role{&null_role}
 {
@@ -107,8 +128,15 @@ mf::WlSurface::~WlSurface()
         listener.second();
     }
 
+    // Content that was never committed will never be presented
+    for (auto const& feedback : pending.presentation_feedbacks)
+        feedback->discard();
+
     role->destroy();
     session->destroy_buffer_stream(stream);
+
+    resources->release(buffer_charge_type, buffer_charge);
+    resources->release(ClientResources::Resource::surfaces, 1);
 }
 
 bool mf::WlSurface::synchronized() const
@@ -193,7 +221,14 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
 {
     geometry::Displacement offset = parent_offset + offset_;
 
-    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}});
+    msh::StreamSpecification stream_spec{stream, offset, {}};
+    if (buffer_size_ && (viewport_source || viewport_destination))
+    {
+        stream_spec.size = buffer_size_.value();
+        if (buffer_source)
+            stream_spec.source = buffer_source.value();
+    }
+    buffer_streams.push_back(stream_spec);
     geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
     if (input_shape)
     {
@@ -254,6 +289,16 @@ void mf::WlSurface::send_frame_callbacks()
     frame_callbacks.clear();
 }
 
+auto mf::WlSurface::charge_buffer(ClientResources::Resource type, uint64_t bytes) -> bool
+{
+    if (!resources->replace_charge(buffer_charge_type, buffer_charge, type, bytes))
+        return false;
+
+    buffer_charge_type = type;
+    buffer_charge = bytes;
+    return true;
+}
+
 void mf::WlSurface::destroy()
 {
     destroy_wayland_object();
@@ -289,7 +334,33 @@ void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t h
 
 void mf::WlSurface::frame(wl_resource* new_callback)
 {
-    pending.frame_callbacks.push_back(std::make_shared<WlSurfaceState::Callback>(new_callback));
+    if (!resources->charge(ClientResources::Resource::frame_callbacks, 1))
+    {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    pending.frame_callbacks.push_back(std::make_shared<WlSurfaceState::Callback>(new_callback, resources));
+}
+
+void mf::WlSurface::add_presentation_feedback(std::shared_ptr<WpPresentationFeedback> const& feedback)
+{
+    pending.presentation_feedbacks.push_back(feedback);
+}
+
+void mf::WlSurface::set_viewport(wayland::Viewport* viewport)
+{
+    viewport_ = viewport;
+}
+
+void mf::WlSurface::set_pending_viewport_source(std::experimental::optional<WlSurfaceState::ViewportSource> const& source)
+{
+    pending.viewport_source = source;
+}
+
+void mf::WlSurface::set_pending_viewport_destination(std::experimental::optional<geom::Size> const& destination)
+{
+    pending.viewport_destination = destination;
 }
 
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
@@ -357,7 +428,16 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         input_shape = state.input_shape.value();
 
     if (state.scale)
-        stream->set_scale(state.scale.value());
+    {
+        scale = state.scale.value();
+        stream->set_scale(scale);
+    }
+
+    if (state.viewport_source)
+        viewport_source = state.viewport_source.value();
+
+    if (state.viewport_destination)
+        viewport_destination = state.viewport_destination.value();
 
     if (state.buffer)
     {
@@ -367,7 +447,11 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         {
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
+            buffer_pixel_size = std::experimental::nullopt;
+            charge_buffer(buffer_charge_type, 0);
             send_frame_callbacks();
+            for (auto const& feedback : state.presentation_feedbacks)
+                feedback->discard();
         }
         else
         {
@@ -383,6 +467,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                 };
 
             std::shared_ptr<graphics::Buffer> mir_buffer;
+            ClientResources::Resource charge_type;
+            uint64_t charge;
 
             if (auto const shm_buffer = wl_shm_buffer_get(buffer))
             {
@@ -404,6 +490,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     buffer,
                     executor,
                     std::move(executor_send_frame_callbacks));
+                charge_type = ClientResources::Resource::shm_buffer_memory;
+                charge = static_cast<uint64_t>(stride) * wl_shm_buffer_get_height(shm_buffer);
                 tracepoint(
                     mir_server_wayland,
                     sw_buffer_committed,
@@ -425,6 +513,12 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     buffer,
                     std::move(executor_send_frame_callbacks),
                     std::move(release_buffer));
+                // The real layout is private to the driver, so estimate from the size and format
+                auto const size = mir_buffer->size();
+                auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(mir_buffer->pixel_format());
+                charge_type = ClientResources::Resource::hardware_buffer_memory;
+                charge = static_cast<uint64_t>(size.width.as_uint32_t()) * size.height.as_uint32_t() *
+                    (bytes_per_pixel ? bytes_per_pixel : 4);
                 tracepoint(
                     mir_server_wayland,
                     hw_buffer_committed,
@@ -432,28 +526,65 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     mir_buffer->id().as_value());
             }
 
-            stream->submit_buffer(mir_buffer);
-            auto const new_buffer_size = stream->stream_size();
-
-            if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
+            if (!charge_buffer(charge_type, charge))
             {
-                state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
+                wl_client_post_no_memory(client);
+                return;
             }
 
-            buffer_size_ = new_buffer_size;
+            for (auto const& feedback : state.presentation_feedbacks)
+                feedback->committed(this, mir_buffer->id());
+
+            stream->submit_buffer(mir_buffer);
+            buffer_pixel_size = mir_buffer->size();
         }
     }
     else
     {
         send_frame_callbacks();
+
+        // Without new content there is nothing to present
+        for (auto const& feedback : state.presentation_feedbacks)
+            feedback->discard();
     }
 
+    apply_viewport(state);
+
     for (WlSubsurface* child: children)
     {
         child->parent_has_committed();
     }
 }
 
+void mf::WlSurface::apply_viewport(WlSurfaceState const& state)
+{
+    if (!viewport_)
+    {
+        // Destroying the wp_viewport removes its state; drop any a cached subsurface commit carried past that
+        viewport_source = std::experimental::nullopt;
+        viewport_destination = std::experimental::nullopt;
+    }
+
+    if (!buffer_pixel_size)
+    {
+        // No buffer: nothing to check the viewport against, and the surface is unmapped anyway
+        return;
+    }
+
+    auto const geometry = viewport_ ?
+        viewport_geometry(viewport_->resource, stream->stream_size(), scale, viewport_source, viewport_destination) :
+        ViewportGeometry{stream->stream_size(), std::experimental::nullopt};
+
+    buffer_source = geometry.buffer_source;
+
+    if (!input_shape && std::experimental::make_optional(geometry.size) != buffer_size_)
+    {
+        state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
+    }
+
+    buffer_size_ = geometry.size;
+}
+
 void mf::WlSurface::commit()
 {
     if (pending.offset && *pending.offset == offset_)
@@ -22,10 +22,14 @@
 #include "wayland_wrapper.h"
 
 #include "wl_surface_role.h"
+#include "client_resources.h"
+#include "presentation_tracker.h"
+#include "viewport_geometry.h"
 
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
+#include "mir/geometry/rectangle.h"
 
 #include <vector>
 #include <map>
@@ -34,6 +38,11 @@ namespace mir
 {
 class Executor;
 
+namespace wayland
+{
+class Viewport;
+}
+
 namespace graphics
 {
 class GraphicBufferAllocator;
@@ -58,16 +67,26 @@ namespace frontend
 {
 class WlSurface;
 class WlSubsurface;
+class WpPresentationFeedback;
 
 struct WlSurfaceState
 {
     class Callback : public wayland::Callback
     {
     public:
-        Callback(wl_resource* new_resource);
+        /// The callback must already have been charged to \a resources, and is released when it is destroyed
+        Callback(wl_resource* new_resource, std::shared_ptr<ClientResources> const& resources);
+        ~Callback();
+
         std::shared_ptr<bool> destroyed;
+
+    private:
+        std::shared_ptr<ClientResources> const resources;
     };
 
+    /// A wp_viewport source rectangle, in surface coordinates before the viewport is applied
+    using ViewportSource = frontend::ViewportSource;
+
     // if you add variables, don't forget to update this
     void update_from(WlSurfaceState const& source);
 
@@ -83,7 +102,11 @@ struct WlSurfaceState
     std::experimental::optional<int> scale;
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    // As with input_shape, the outer optional is whether it changed and the inner whether it is set
+    std::experimental::optional<std::experimental::optional<ViewportSource>> viewport_source;
+    std::experimental::optional<std::experimental::optional<geometry::Size>> viewport_destination;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
+    std::vector<std::shared_ptr<WpPresentationFeedback>> presentation_feedbacks;
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -106,7 +129,7 @@ private:
     WlSurface* const surface;
 };
 
-class WlSurface : public wayland::Surface
+class WlSurface : public wayland::Surface, public PresentationTracker::Surface
 {
 public:
     WlSurface(wl_resource* new_resource,
@@ -130,12 +153,18 @@ public:
     void remove_subsurface(WlSubsurface* child);
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
+    void add_presentation_feedback(std::shared_ptr<WpPresentationFeedback> const& feedback);
+    /// The wp_viewport attached to this surface, if any
+    auto viewport() const -> wayland::Viewport* { return viewport_; }
+    void set_viewport(wayland::Viewport* viewport);
+    void set_pending_viewport_source(std::experimental::optional<WlSurfaceState::ViewportSource> const& source);
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& destination);
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
     void commit(WlSurfaceState const& state);
-    void add_destroy_listener(void const* key, std::function<void()> listener);
-    void remove_destroy_listener(void const* key);
+    void add_destroy_listener(void const* key, std::function<void()> listener) override;
+    void remove_destroy_listener(void const* key) override;
 
     std::shared_ptr<scene::Session> const session;
     std::shared_ptr<compositor::BufferStream> const stream;
@@ -145,6 +174,10 @@ public:
 private:
     std::shared_ptr<mir::graphics::GraphicBufferAllocator> const allocator;
     std::shared_ptr<mir::Executor> const executor;
+    std::shared_ptr<ClientResources> const resources;
+    /// What the most recently committed buffer is charged to the client as
+    ClientResources::Resource buffer_charge_type{ClientResources::Resource::shm_buffer_memory};
+    uint64_t buffer_charge{0};
 
     NullWlSurfaceRole null_role;
     WlSurfaceRole* role;
@@ -153,11 +186,20 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    int scale{1};
+    std::experimental::optional<geometry::Size> buffer_pixel_size;
+    wayland::Viewport* viewport_{nullptr};
+    std::experimental::optional<WlSurfaceState::ViewportSource> viewport_source;
+    std::experimental::optional<geometry::Size> viewport_destination;
+    /// The part of the buffer shown, in buffer pixels, when a viewport source is set
+    std::experimental::optional<geometry::Rectangle> buffer_source;
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
     std::map<void const*, std::function<void()>> destroy_listeners;
 
     void send_frame_callbacks();
+    auto charge_buffer(ClientResources::Resource type, uint64_t bytes) -> bool;
+    void apply_viewport(WlSurfaceState const& state);
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
@@ -19,11 +19,16 @@
 
 #include "mir/glib_main_loop_sources.h"
 #include "mir/lockable_callback.h"
+#include "mir/time/timer_wheel.h"
 #include "mir/raii.h"
 #include <mir/log.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <deque>
+#include <limits>
+#include <unordered_set>
 #include <system_error>
 #include <sstream>
 
@@ -180,192 +185,438 @@ void md::add_idle_gsource(
     g_source_attach(gsource, main_context);
 }
 
-void md::add_server_action_gsource(
-    GMainContext* main_context,
-    void const* owner,
-    std::function<void()> const& action,
-    std::function<bool(void const*)> const& should_dispatch)
+/**********************
+ * ServerActionSource *
+ **********************/
+
+struct md::ServerActionSource::ActionGSource
 {
-    struct ServerActionContext
+    struct Action
     {
-        void const* const owner;
-        std::function<void(void)> const action;
-        std::function<bool(void const*)> const should_dispatch;
-
-        // If we come to finalize() before dispatch() we have already
-        // torn down most of Mir and even unloaded some shared libraries.
-        // That means the action could refer to  stuff that is no longer
-        // in the address space.
-        // We will just leak any resources instead of crashing.
-        bool mutable dispatched{false};
+        void const* owner;
+        ServerActionPriority priority;
+        std::function<void()> action;
     };
 
-    struct ServerActionGSource
+    struct Context
     {
-        GSource gsource;
-        ServerActionContext ctx;
-        bool ctx_constructed;
+        std::mutex mutex;
+        // Indexed by ServerActionPriority
+        std::array<std::deque<Action>, 3> pending;
+        std::unordered_set<void const*> paused;
+        std::unordered_map<void const*, std::deque<Action>> parked;
 
-        static gboolean prepare(GSource* source, gint *timeout)
+        size_t pending_count() const
         {
-            *timeout = -1;
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            return ctx.should_dispatch(ctx.owner);
+            size_t count{0};
+            for (auto const& queue : pending)
+                count += queue.size();
+            return count;
         }
 
-        static gboolean check(GSource* source)
+        // Pops the highest priority action. Paused owners' actions are all
+        // parked, so everything pending is runnable.
+        bool pop_runnable(std::function<void()>& action)
         {
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            return ctx.should_dispatch(ctx.owner);
+            for (auto& queue : pending)
+            {
+                if (!queue.empty())
+                {
+                    action = std::move(queue.front().action);
+                    queue.pop_front();
+                    return true;
+                }
+            }
+
+            return false;
         }
 
-        static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+        // Moves the owner's pending actions to the back of its parked actions,
+        // keeping their order, so parked holds its complete backlog.
+        void park_pending_for(void const* owner)
         {
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            ctx.action();
-            ctx.dispatched = true;
-            return FALSE;
+            auto& owner_parked = parked[owner];
+            for (auto& queue : pending)
+            {
+                std::deque<Action> others;
+                for (auto& action : queue)
+                {
+                    if (action.owner == owner)
+                        owner_parked.push_back(std::move(action));
+                    else
+                        others.push_back(std::move(action));
+                }
+                queue.swap(others);
+            }
+
+            if (owner_parked.empty())
+                parked.erase(owner);
+        }
+    };
+
+    GSource gsource;
+    Context ctx;
+    bool ctx_constructed;
+
+    static ActionGSource* create()
+    {
+        static GSourceFuncs gsource_funcs{
+            nullptr,
+            nullptr,
+            ActionGSource::dispatch,
+            ActionGSource::finalize,
+            nullptr,
+            nullptr
+        };
+
+        auto const source = reinterpret_cast<ActionGSource*>(
+            g_source_new(&gsource_funcs, sizeof(ActionGSource)));
+
+        source->ctx_constructed = false;
+        new (&source->ctx) Context;
+        source->ctx_constructed = true;
+
+        return source;
+    }
+
+    static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    {
+        auto& ctx = reinterpret_cast<ActionGSource*>(source)->ctx;
+
+        // Anything enqueued from here on makes us ready again
+        g_source_set_ready_time(source, -1);
+
+        size_t budget;
+        {
+            std::lock_guard<std::mutex> lock{ctx.mutex};
+            budget = ctx.pending_count();
         }
 
-        static void finalize(GSource* source)
+        for (; budget > 0; --budget)
         {
-            auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(source);
-            if (sa_gsource->ctx_constructed && sa_gsource->ctx.dispatched)
-                sa_gsource->ctx.~ServerActionContext();
+            std::function<void()> action;
+            {
+                std::lock_guard<std::mutex> lock{ctx.mutex};
+                if (!ctx.pop_runnable(action))
+                    break;
+            }
+            action();
         }
-    };
 
-    static GSourceFuncs gsource_funcs{
-        ServerActionGSource::prepare,
-        ServerActionGSource::check,
-        ServerActionGSource::dispatch,
-        ServerActionGSource::finalize,
-        nullptr,
-        nullptr
-    };
+        bool more_pending;
+        {
+            std::lock_guard<std::mutex> lock{ctx.mutex};
+            more_pending = ctx.pending_count() > 0;
+        }
 
-    GSourceRef gsource{g_source_new(&gsource_funcs, sizeof(ServerActionGSource))};
-    auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(static_cast<GSource*>(gsource));
+        if (more_pending)
+            g_source_set_ready_time(source, 0);
 
-    sa_gsource->ctx_constructed = false;
-    new (&sa_gsource->ctx) decltype(sa_gsource->ctx){owner, action, should_dispatch};
-    sa_gsource->ctx_constructed = true;
+        return G_SOURCE_CONTINUE;
+    }
 
-    g_source_attach(gsource, main_context);
+    static void finalize(GSource* source)
+    {
+        auto const action_gsource = reinterpret_cast<ActionGSource*>(source);
+        if (!action_gsource->ctx_constructed)
+            return;
+
+        auto& ctx = action_gsource->ctx;
+
+        // If we come to finalize() with actions still queued we have already
+        // torn down most of Mir and even unloaded some shared libraries.
+        // That means the actions could refer to stuff that is no longer
+        // in the address space.
+        // We will just leak any resources instead of crashing.
+        if (ctx.pending_count() == 0 && ctx.parked.empty())
+            ctx.~Context();
+    }
+};
+
+md::ServerActionSource::ServerActionSource(GMainContext* main_context)
+    : gsource{ActionGSource::create()}
+{
+    g_source_attach(&gsource->gsource, main_context);
 }
 
-md::GSourceHandle md::add_timer_gsource(
-    GMainContext* main_context,
-    std::shared_ptr<time::Clock> const& clock,
-    std::shared_ptr<LockableCallback> const& handler,
-    std::function<void()> const& exception_handler,
-    time::Timestamp target_time)
+md::ServerActionSource::~ServerActionSource()
+{
+    g_source_destroy(&gsource->gsource);
+    g_source_unref(&gsource->gsource);
+}
+
+void md::ServerActionSource::enqueue(
+    void const* owner, ServerActionPriority priority, std::function<void()>&& action)
 {
-    struct TimerContext
+    auto& ctx = gsource->ctx;
     {
-        TimerContext(std::shared_ptr<time::Clock> const& clock,
-                     std::shared_ptr<LockableCallback> const& handler,
-                     std::function<void()> const& exception_handler,
-                     time::Timestamp target_time)
-            : clock{clock}, handler{handler}, exception_handler{exception_handler},
-              target_time{target_time}, enabled{true}
+        std::lock_guard<std::mutex> lock{ctx.mutex};
+
+        if (ctx.paused.find(owner) != ctx.paused.end())
         {
+            ctx.parked[owner].push_back({owner, priority, std::move(action)});
+            return;
         }
-        std::shared_ptr<time::Clock> clock;
-        std::shared_ptr<LockableCallback> handler;
-        std::function<void()> exception_handler;
-        time::Timestamp target_time;
-        std::recursive_mutex mutex;
-        bool enabled;
-    };
 
-    struct TimerGSource
-    {
-        GSource gsource;
-        TimerContext ctx;
-        bool ctx_constructed;
+        ctx.pending[static_cast<size_t>(priority)].push_back({owner, priority, std::move(action)});
+    }
 
-        static gboolean prepare(GSource* source, gint *timeout)
-        {
-            auto const& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
+    g_source_set_ready_time(&gsource->gsource, 0);
+}
 
-            auto const now = ctx.clock->now();
-            bool const ready = (now >= ctx.target_time);
-            if (ready)
-                *timeout = -1;
-            else
-                *timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    ctx.clock->min_wait_until(ctx.target_time)).count();
+void md::ServerActionSource::pause_processing_for(void const* owner)
+{
+    auto& ctx = gsource->ctx;
+    std::lock_guard<std::mutex> lock{ctx.mutex};
 
-            return ready;
-        }
+    if (ctx.paused.insert(owner).second)
+        ctx.park_pending_for(owner);
+}
+
+void md::ServerActionSource::resume_processing_for(void const* owner)
+{
+    auto& ctx = gsource->ctx;
+    {
+        std::lock_guard<std::mutex> lock{ctx.mutex};
+
+        ctx.paused.erase(owner);
 
-        static gboolean check(GSource* source)
+        auto const parked = ctx.parked.find(owner);
+        if (parked != ctx.parked.end())
         {
-            auto const& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
+            // Parked actions have been waiting longest, so they go back
+            // to the front of their queues (in order).
+            for (auto action = parked->second.rbegin(); action != parked->second.rend(); ++action)
+                ctx.pending[static_cast<size_t>(action->priority)].push_front(std::move(*action));
 
-            auto const now = ctx.clock->now();
-            bool const ready = (now >= ctx.target_time);
-            return ready;
+            ctx.parked.erase(parked);
         }
+    }
+
+    g_source_set_ready_time(&gsource->gsource, 0);
+}
+
+/***************
+ * AlarmSource *
+ ***************/
+
+struct md::AlarmSource::Wheel
+{
+    Wheel(GMainContext* main_context, std::shared_ptr<time::Clock> const& clock)
+        : main_context{g_main_context_ref(main_context)},
+          clock{clock},
+          timers{clock->now(), std::chrono::milliseconds{1}}
+    {
+    }
+
+    ~Wheel()
+    {
+        g_main_context_unref(main_context);
+    }
+
+    GMainContext* const main_context;
+    std::shared_ptr<time::Clock> const clock;
+    std::mutex mutex;
+    time::TimerWheel timers;
+};
 
-        static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+class md::AlarmSource::WheelAlarm :
+    public md::AlarmSource::Alarm,
+    public mir::time::TimerWheel::Timer,
+    public std::enable_shared_from_this<WheelAlarm>
+{
+public:
+    WheelAlarm(
+        std::shared_ptr<Wheel> const& wheel,
+        std::shared_ptr<LockableCallback> const& handler,
+        std::function<void()> const& exception_handler)
+        : wheel{wheel},
+          handler{handler},
+          exception_handler{exception_handler}
+    {
+    }
+
+    ~WheelAlarm()
+    {
+        std::lock_guard<std::mutex> lock{wheel->mutex};
+        wheel->timers.cancel(*this);
+    }
+
+    void schedule(time::Timestamp target_time) override
+    {
+        bool earlier_than_before;
         {
-            auto& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
-            try
-            {
-                // Attempt to preserve locking order during callback dispatching
-                // so we acquire the caller's lock before our own.
-                auto& handler = *ctx.handler;
-                std::lock_guard<LockableCallback> handler_lock{handler};
-                std::lock_guard<decltype(ctx.mutex)> lock{ctx.mutex};
-                if (ctx.enabled)
-                    handler();
-            }
-            catch(...)
-            {
-                ctx.exception_handler();
-            }
+            std::lock_guard<std::mutex> lock{wheel->mutex};
+            ++generation;
 
-            return FALSE;
+            auto& timers = wheel->timers;
+
+            // An idle wheel may have fallen behind; catch up before inserting
+            // so the new deadline lands on the innermost wheel it can.
+            if (timers.empty())
+                timers.advance(wheel->clock->now(), [](auto&){});
+
+            auto const previous_event =
+                timers.empty() ? time::Timestamp::max() : timers.next_event();
+
+            timers.schedule(*this, target_time);
+            earlier_than_before = timers.next_event() < previous_event;
         }
 
-        static void finalize(GSource* source)
+        // The main loop may be waiting for a later event
+        if (earlier_than_before)
+            g_main_context_wakeup(wheel->main_context);
+    }
+
+    void cancel() override
+    {
+        // Wait for any in-progress dispatch (which holds dispatch_mutex)
+        std::lock_guard<decltype(dispatch_mutex)> dispatch_lock{dispatch_mutex};
+        ++generation;
+
+        std::lock_guard<std::mutex> lock{wheel->mutex};
+        wheel->timers.cancel(*this);
+    }
+
+    uint64_t current_generation() const
+    {
+        return generation;
+    }
+
+    void dispatch(uint64_t scheduled_generation)
+    {
+        try
         {
-            auto const timer_gsource = reinterpret_cast<TimerGSource*>(source);
-            if (timer_gsource->ctx_constructed)
-                timer_gsource->ctx.~TimerContext();
+            // Attempt to preserve locking order during callback dispatching
+            // so we acquire the caller's lock before our own.
+            auto& handler_ref = *handler;
+            std::lock_guard<LockableCallback> handler_lock{handler_ref};
+            std::lock_guard<decltype(dispatch_mutex)> lock{dispatch_mutex};
+
+            // Skip expiries that have since been rescheduled or cancelled
+            if (generation == scheduled_generation)
+                handler_ref();
         }
+        catch(...)
+        {
+            exception_handler();
+        }
+    }
 
-        static void disable(GSource* source)
+private:
+    std::shared_ptr<Wheel> const wheel;
+    std::shared_ptr<LockableCallback> const handler;
+    std::function<void()> const exception_handler;
+    std::recursive_mutex dispatch_mutex;
+    std::atomic<uint64_t> generation{0};
+};
+
+struct md::AlarmSource::AlarmGSource
+{
+    GSource gsource;
+    std::shared_ptr<Wheel> wheel;
+    bool wheel_constructed;
+
+    static AlarmGSource* create(std::shared_ptr<Wheel> const& wheel)
+    {
+        static GSourceFuncs gsource_funcs{
+            AlarmGSource::prepare,
+            AlarmGSource::check,
+            AlarmGSource::dispatch,
+            AlarmGSource::finalize,
+            nullptr,
+            nullptr
+        };
+
+        auto const source = reinterpret_cast<AlarmGSource*>(
+            g_source_new(&gsource_funcs, sizeof(AlarmGSource)));
+
+        source->wheel_constructed = false;
+        new (&source->wheel) std::shared_ptr<Wheel>{wheel};
+        source->wheel_constructed = true;
+
+        return source;
+    }
+
+    static gboolean prepare(GSource* source, gint *timeout)
+    {
+        auto& wheel = *reinterpret_cast<AlarmGSource*>(source)->wheel;
+        std::lock_guard<std::mutex> lock{wheel.mutex};
+
+        *timeout = -1;
+
+        if (wheel.timers.empty())
+            return FALSE;
+
+        auto const next_event = wheel.timers.next_event();
+        if (wheel.clock->now() >= next_event)
+            return TRUE;
+
+        auto const wait = std::chrono::ceil<std::chrono::milliseconds>(
+            wheel.clock->min_wait_until(next_event)).count();
+
+        *timeout = static_cast<gint>(std::min<decltype(wait)>(wait, std::numeric_limits<gint>::max()));
+
+        return FALSE;
+    }
+
+    static gboolean check(GSource* source)
+    {
+        auto& wheel = *reinterpret_cast<AlarmGSource*>(source)->wheel;
+        std::lock_guard<std::mutex> lock{wheel.mutex};
+
+        return !wheel.timers.empty() && wheel.clock->now() >= wheel.timers.next_event();
+    }
+
+    static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    {
+        auto& wheel = *reinterpret_cast<AlarmGSource*>(source)->wheel;
+
+        std::vector<std::pair<std::shared_ptr<WheelAlarm>, uint64_t>> expired;
         {
-            auto& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
-            std::lock_guard<decltype(ctx.mutex)> lock{ctx.mutex};
-            ctx.enabled = false;
+            std::lock_guard<std::mutex> lock{wheel.mutex};
+            wheel.timers.advance(
+                wheel.clock->now(),
+                [&expired](time::TimerWheel::Timer& timer)
+                {
+                    auto& alarm = static_cast<WheelAlarm&>(timer);
+                    if (auto const live_alarm = alarm.weak_from_this().lock())
+                        expired.emplace_back(live_alarm, alarm.current_generation());
+                });
         }
-    };
 
-    static GSourceFuncs gsource_funcs{
-        TimerGSource::prepare,
-        TimerGSource::check,
-        TimerGSource::dispatch,
-        TimerGSource::finalize,
-        nullptr,
-        nullptr
-    };
+        for (auto const& alarm : expired)
+            alarm.first->dispatch(alarm.second);
 
-    GSourceHandle gsource{
-        g_source_new(&gsource_funcs, sizeof(TimerGSource)),
-        [](GSource* gsource) { TimerGSource::disable(gsource); }};
-    auto const timer_gsource = reinterpret_cast<TimerGSource*>(static_cast<GSource*>(gsource));
+        return G_SOURCE_CONTINUE;
+    }
 
-    timer_gsource->ctx_constructed = false;
-    new (&timer_gsource->ctx) TimerContext{clock, handler, exception_handler, target_time};
-    timer_gsource->ctx_constructed = true;
+    static void finalize(GSource* source)
+    {
+        auto const alarm_gsource = reinterpret_cast<AlarmGSource*>(source);
+        if (alarm_gsource->wheel_constructed)
+            alarm_gsource->wheel.~shared_ptr();
+    }
+};
 
-    g_source_attach(gsource, main_context);
+md::AlarmSource::AlarmSource(GMainContext* main_context, std::shared_ptr<time::Clock> const& clock)
+    : wheel{std::make_shared<Wheel>(main_context, clock)},
+      gsource{AlarmGSource::create(wheel)}
+{
+    g_source_attach(&gsource->gsource, main_context);
+}
 
-    return gsource;
+md::AlarmSource::~AlarmSource()
+{
+    g_source_destroy(&gsource->gsource);
+    g_source_unref(&gsource->gsource);
+}
+
+auto md::AlarmSource::create_alarm(
+    std::shared_ptr<LockableCallback> const& handler,
+    std::function<void()> const& exception_handler) -> std::shared_ptr<Alarm>
+{
+    return std::make_shared<WheelAlarm>(wheel, handler, exception_handler);
 }
 
 /*************
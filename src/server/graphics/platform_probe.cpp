@@ -17,11 +17,61 @@
  */
 
 #include "mir/log.h"
+#include "mir/console_services.h"
 #include "mir/graphics/platform.h"
 #include "platform_probe.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <future>
+#include <mutex>
+
+namespace
+{
+/// Modules are probed concurrently, but ConsoleServices implementations expect one caller at a time
+class SerialisedConsoleServices : public mir::ConsoleServices
+{
+public:
+    explicit SerialisedConsoleServices(std::shared_ptr<mir::ConsoleServices> const& wrapped) :
+        wrapped{wrapped}
+    {
+    }
+
+    void register_switch_handlers(
+        mir::graphics::EventHandlerRegister& handlers,
+        std::function<bool()> const& switch_away,
+        std::function<bool()> const& switch_back) override
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        wrapped->register_switch_handlers(handlers, switch_away, switch_back);
+    }
+
+    void restore() override
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        wrapped->restore();
+    }
+
+    std::unique_ptr<mir::VTSwitcher> create_vt_switcher() override
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        return wrapped->create_vt_switcher();
+    }
+
+    std::future<std::unique_ptr<mir::Device>> acquire_device(
+        int major, int minor,
+        std::unique_ptr<mir::Device::Observer> observer) override
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        return wrapped->acquire_device(major, minor, std::move(observer));
+    }
+
+private:
+    std::shared_ptr<mir::ConsoleServices> const wrapped;
+    std::mutex mutex;
+};
+}
+
 auto mir::graphics::probe_module(
     mir::SharedLibrary& module,
     mir::options::ProgramOption const& options,
@@ -54,17 +104,34 @@ mir::graphics::module_for_device(
     mir::options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console)
 {
+    std::shared_ptr<ConsoleServices> const serialised_console =
+        console ? std::make_shared<SerialisedConsoleServices>(console) : nullptr;
+
+    // Probing opens devices and initialises drivers, which is slow, and the modules don't depend
+    // on each other, so probe them all at once
+    std::vector<std::future<mir::graphics::PlatformPriority>> module_priorities;
+    for (auto& module : modules)
+    {
+        module_priorities.push_back(std::async(
+            std::launch::async,
+            [&module, &options, &serialised_console]
+            {
+                return probe_module(*module, options, serialised_console);
+            }));
+    }
+
+    // ...but keep choosing as if they'd been probed in order: the first of equal priority wins
     mir::graphics::PlatformPriority best_priority_so_far = mir::graphics::unsupported;
     std::shared_ptr<mir::SharedLibrary> best_module_so_far;
-    for (auto& module : modules)
+    for (size_t i = 0; i != modules.size(); ++i)
     {
         try
         {
-            auto module_priority = probe_module(*module, options, console);
+            auto module_priority = module_priorities[i].get();
             if (module_priority > best_priority_so_far)
             {
                 best_priority_so_far = module_priority;
-                best_module_so_far = module;
+                best_module_so_far = modules[i];
             }
         }
         catch (std::runtime_error const&)
@@ -19,6 +19,8 @@
 #include "mir/default_server_configuration.h"
 
 #include "key_repeat_dispatcher.h"
+#include "queued_input_dispatcher.h"
+#include "resampling_input_dispatcher.h"
 #include "event_filter_chain_dispatcher.h"
 #include "config_changer.h"
 #include "cursor_controller.h"
@@ -42,6 +44,11 @@
 #include "mir/options/option.h"
 #include "mir/dispatch/multiplexing_dispatchable.h"
 #include "mir/compositor/scene.h"
+#include "mir/graphics/display.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/graphics/display_configuration_observer.h"
+#include "mir/observer_registrar.h"
+#include "mir/optional_value.h"
 #include "mir/emergency_cleanup.h"
 #include "mir/main_loop.h"
 #include "mir/abnormal_exit.h"
@@ -62,6 +69,57 @@ namespace mgn = mg::nested;
 namespace msh = mir::shell;
 namespace md = mir::dispatch;
 
+namespace
+{
+/// Tracks the output resampled motion is paced to: the first one in use
+class PacingOutput : public mg::DisplayConfigurationObserver
+{
+public:
+    auto id() const -> mir::optional_value<unsigned>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return output_id;
+    }
+
+    void initial_configuration(std::shared_ptr<mg::DisplayConfiguration const> const& config) override
+    {
+        update(*config);
+    }
+
+    void configuration_applied(std::shared_ptr<mg::DisplayConfiguration const> const& config) override
+    {
+        update(*config);
+    }
+
+    void base_configuration_updated(std::shared_ptr<mg::DisplayConfiguration const> const&) override {}
+    void session_configuration_applied(
+        std::shared_ptr<ms::Session> const&, std::shared_ptr<mg::DisplayConfiguration> const&) override {}
+    void session_configuration_removed(std::shared_ptr<ms::Session> const&) override {}
+    void configuration_failed(std::shared_ptr<mg::DisplayConfiguration const> const&, std::exception const&) override {}
+    void catastrophic_configuration_error(
+        std::shared_ptr<mg::DisplayConfiguration const> const&, std::exception const&) override {}
+    void configuration_updated_for_session(
+        std::shared_ptr<ms::Session> const&, std::shared_ptr<mg::DisplayConfiguration const> const&) override {}
+
+private:
+    void update(mg::DisplayConfiguration const& config)
+    {
+        mir::optional_value<unsigned> first_used;
+        config.for_each_output([&](mg::DisplayConfigurationOutput const& output)
+            {
+                if (!first_used.is_set() && output.used && output.connected)
+                    first_used = output.id.as_value();
+            });
+
+        std::lock_guard<std::mutex> lock{mutex};
+        output_id = first_used;
+    }
+
+    std::mutex mutable mutex;
+    mir::optional_value<unsigned> output_id;
+};
+}
+
 std::shared_ptr<mi::CompositeEventFilter>
 mir::DefaultServerConfiguration::the_composite_event_filter()
 {
@@ -140,8 +198,31 @@ mir::DefaultServerConfiguration::the_input_dispatcher()
             // lp:1675357: Disable generation of key repeat events on nested servers
             auto enable_repeat = options->get<bool>(options::enable_key_repeat_opt);
 
+            std::shared_ptr<mi::InputDispatcher> dispatcher = the_event_filter_chain_dispatcher();
+
+            if (options->get<bool>(options::resample_input_opt))
+            {
+                std::weak_ptr<mg::Display> const weak_display = the_display();
+                auto const pacing_output = std::make_shared<PacingOutput>();
+                the_display_configuration_observer_registrar()->register_interest(pacing_output);
+
+                auto const last_frame = [weak_display, pacing_output]
+                    {
+                        auto const output_id = pacing_output->id();
+                        if (auto const display = weak_display.lock())
+                        {
+                            if (output_id)
+                                return display->last_frame_on(output_id.value());
+                        }
+                        return mg::Frame{};
+                    };
+
+                dispatcher = std::make_shared<mi::ResamplingInputDispatcher>(
+                    dispatcher, the_main_loop(), the_input_delivery_multiplexer(), the_clock(), last_frame);
+            }
+
             return std::make_shared<mi::KeyRepeatDispatcher>(
-                the_event_filter_chain_dispatcher(), the_main_loop(), the_cookie_authority(),
+                dispatcher, the_main_loop(), the_cookie_authority(),
                 enable_repeat, key_repeat_timeout, key_repeat_delay, false);
         });
 }
@@ -266,13 +347,24 @@ mir::DefaultServerConfiguration::the_input_reading_multiplexer()
     );
 }
 
+std::shared_ptr<mir::dispatch::MultiplexingDispatchable>
+mir::DefaultServerConfiguration::the_input_delivery_multiplexer()
+{
+    return input_delivery_multiplexer(
+        []() -> std::shared_ptr<mir::dispatch::MultiplexingDispatchable>
+        {
+            return std::make_shared<mir::dispatch::MultiplexingDispatchable>();
+        }
+    );
+}
+
 std::shared_ptr<mi::Seat> mir::DefaultServerConfiguration::the_seat()
 {
     return seat(
         [this]()
         {
             return std::make_shared<mi::BasicSeat>(
-                    the_input_dispatcher(),
+                    std::make_shared<mi::QueuedInputDispatcher>(the_input_dispatcher(), the_input_delivery_multiplexer()),
                     the_touch_visualizer(),
                     the_cursor_listener(),
                     the_display_configuration_observer_registrar(),
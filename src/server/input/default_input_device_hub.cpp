@@ -72,8 +72,9 @@ mi::ExternalInputDeviceHub::~ExternalInputDeviceHub()
 
 void mi::ExternalInputDeviceHub::add_observer(std::shared_ptr<InputDeviceObserver> const& observer)
 {
-    data->observer_queue->enqueue(
+    data->observer_queue->enqueue_with_priority(
         data.get(),
+        ServerActionPriority::high,
         [observer, data = this->data]
         {
             for (auto const& item : data->handles)
@@ -144,8 +145,9 @@ void mi::ExternalInputDeviceHub::Internal::changes_complete()
     std::swap(devices_removed, removed);
 
     if (!(added.empty() && changed.empty() && removed.empty()))
-        observer_queue->enqueue(
+        observer_queue->enqueue_with_priority(
             this,
+            ServerActionPriority::high,
             [this, added, changed, removed]
             {
                 observers.for_each([&](std::shared_ptr<InputDeviceObserver> const& observer)
@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "queued_input_dispatcher.h"
+
+#include "mir/dispatch/dispatchable.h"
+#include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/dispatch/threaded_dispatcher.h"
+#include "mir/spsc_ring_buffer.h"
+#include "mir/terminate_with_current_exception.h"
+#include "mir/fd.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace mi = mir::input;
+namespace md = mir::dispatch;
+
+namespace
+{
+// Comfortably more than a burst from a high-rate pointer over a few frames
+size_t const ring_capacity{1024};
+}
+
+class mi::QueuedInputDispatcher::Queue : public md::Dispatchable
+{
+public:
+    Queue(std::shared_ptr<InputDispatcher> const& next_dispatcher)
+        : next_dispatcher{next_dispatcher},
+          ring{ring_capacity},
+          event_fd{eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK)}
+    {
+        if (event_fd < 0)
+            BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                     std::system_category(),
+                                                     "Failed to create event fd for input queue"}));
+    }
+
+    // Called on the producer (input reader) thread only
+    void push(std::shared_ptr<MirEvent const> const& event)
+    {
+        auto copy = event;
+
+        // Once we've spilled into the overflow list everything goes there
+        // until the consumer has caught up, otherwise events would be
+        // delivered out of order.
+        if (overflowing || !ring.try_push(std::move(copy)))
+        {
+            std::lock_guard<std::mutex> lock{overflow_mutex};
+            overflow.push_back(event);
+            overflowing = true;
+        }
+
+        if (!wakeup_pending.exchange(true))
+            wake();
+    }
+
+    mir::Fd watch_fd() const override
+    {
+        return event_fd;
+    }
+
+    bool dispatch(md::FdEvents events) override
+    {
+        if (events & md::FdEvent::error)
+            return false;
+
+        if (!consume())
+            return true;
+
+        // Clear the flag *before* draining: anything pushed after this point
+        // will either be seen by the drain below or will raise a new wakeup.
+        wakeup_pending.exchange(false);
+
+        deliver_pending();
+        return true;
+    }
+
+    md::FdEvents relevant_events() const override
+    {
+        return md::FdEvent::readable;
+    }
+
+private:
+    void deliver_pending()
+    {
+        for (;;)
+        {
+            std::shared_ptr<MirEvent const> event;
+            while (ring.try_pop(event))
+                next_dispatcher->dispatch(event);
+
+            std::deque<std::shared_ptr<MirEvent const>> spilled;
+            {
+                std::lock_guard<std::mutex> lock{overflow_mutex};
+                spilled.swap(overflow);
+                overflowing = false;
+            }
+
+            if (spilled.empty())
+                return;
+
+            for (auto const& spilled_event : spilled)
+                next_dispatcher->dispatch(spilled_event);
+        }
+    }
+
+    bool consume()
+    {
+        uint64_t count;
+        if (read(event_fd, &count, sizeof count) != sizeof count)
+        {
+            if (errno == EAGAIN)
+                return false;
+
+            BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                     std::system_category(),
+                                                     "Failed to consume input queue notification"}));
+        }
+        return true;
+    }
+
+    void wake()
+    {
+        uint64_t one{1};
+        if (write(event_fd, &one, sizeof one) != sizeof one)
+            BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                     std::system_category(),
+                                                     "Failed to wake input queue"}));
+    }
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    SpscRingBuffer<std::shared_ptr<MirEvent const>> ring;
+
+    std::mutex overflow_mutex;
+    std::deque<std::shared_ptr<MirEvent const>> overflow;
+    std::atomic<bool> overflowing{false};
+
+    std::atomic<bool> wakeup_pending{false};
+    mir::Fd const event_fd;
+};
+
+mi::QueuedInputDispatcher::QueuedInputDispatcher(
+    std::shared_ptr<InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<md::MultiplexingDispatchable> const& delivery)
+    : next_dispatcher{next_dispatcher},
+      delivery{delivery},
+      queue{std::make_shared<Queue>(next_dispatcher)}
+{
+    delivery->add_watch(queue);
+    delivery_thread = std::make_unique<md::ThreadedDispatcher>(
+        "Mir/Input Deliver",
+        delivery,
+        []() { mir::terminate_with_current_exception(); });
+}
+
+mi::QueuedInputDispatcher::~QueuedInputDispatcher() noexcept
+{
+    delivery_thread.reset();
+    delivery->remove_watch(queue);
+}
+
+bool mi::QueuedInputDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    queue->push(event);
+    return true;
+}
+
+void mi::QueuedInputDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::QueuedInputDispatcher::stop()
+{
+    next_dispatcher->stop();
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_QUEUED_INPUT_DISPATCHER_H_
+#define MIR_INPUT_QUEUED_INPUT_DISPATCHER_H_
+
+#include "mir/input/input_dispatcher.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace dispatch
+{
+class MultiplexingDispatchable;
+class ThreadedDispatcher;
+}
+namespace input
+{
+/**
+ * Decouples reading input from delivering it.
+ *
+ * dispatch() only hands the event over to a dedicated delivery thread, which
+ * passes it on to next_dispatcher. The input reader thread therefore never
+ * waits on event filters, window management or client sockets, and keeps
+ * draining the kernel's event queues while delivery is busy.
+ *
+ * The delivery thread serves everything watched by \a delivery, so other
+ * work that must be serialised with delivery (such as timed motion from a
+ * ResamplingInputDispatcher further down the chain) can be added to it.
+ *
+ * dispatch() must only be called from a single thread at a time (the input
+ * reader). Event order is preserved.
+ */
+class QueuedInputDispatcher : public InputDispatcher
+{
+public:
+    QueuedInputDispatcher(
+        std::shared_ptr<InputDispatcher> const& next_dispatcher,
+        std::shared_ptr<dispatch::MultiplexingDispatchable> const& delivery);
+    ~QueuedInputDispatcher() noexcept;
+
+    // InputDispatcher
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override;
+    void start() override;
+    void stop() override;
+
+private:
+    class Queue;
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    std::shared_ptr<dispatch::MultiplexingDispatchable> const delivery;
+    std::shared_ptr<Queue> const queue;
+    std::unique_ptr<dispatch::ThreadedDispatcher> delivery_thread;
+};
+
+}
+}
+
+#endif // MIR_INPUT_QUEUED_INPUT_DISPATCHER_H_
@@ -0,0 +1,301 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resampling_input_dispatcher.h"
+
+#include "mir/dispatch/action_queue.h"
+#include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/events/event_private.h"
+#include "mir/events/event_builders.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+#include "mir/time/clock.h"
+
+#include <algorithm>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+using namespace std::chrono_literals;
+
+namespace
+{
+// Resample this far before the frame, so there is usually a real sample on
+// either side to interpolate between rather than having to guess
+auto const resample_latency = 5ms;
+
+// Samples closer together than this are too noisy to extrapolate from, and
+// ones further apart too stale
+auto const min_sample_delta = 2ms;
+auto const max_sample_delta = 20ms;
+
+// Never predict further past the newest sample than this
+auto const max_prediction = 8ms;
+
+// Used until we have seen two frames from the display
+auto const default_frame_period = std::chrono::nanoseconds{1000000000/60};
+
+size_t const max_history{4};
+
+bool is_plain_motion(MirEvent const& event)
+{
+    if (event.type() != mir_event_type_input)
+        return false;
+
+    auto const input = event.to_input();
+    switch (input->input_type())
+    {
+    case mir_input_event_type_pointer:
+    {
+        auto const pointer = input->to_pointer();
+        return pointer->action() == mir_pointer_action_motion &&
+               pointer->vscroll() == 0.0f &&
+               pointer->hscroll() == 0.0f;
+    }
+
+    case mir_input_event_type_touch:
+    {
+        auto const touch = input->to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            if (touch->action(i) != mir_touch_action_change)
+                return false;
+        }
+        return touch->pointer_count() > 0;
+    }
+
+    default:
+        return false;
+    }
+}
+
+float lerp(float a, float b, float alpha)
+{
+    return a + alpha * (b - a);
+}
+}
+
+mi::ResamplingInputDispatcher::ResamplingInputDispatcher(
+    std::shared_ptr<InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+    std::shared_ptr<dispatch::MultiplexingDispatchable> const& delivery,
+    std::shared_ptr<time::Clock> const& clock,
+    std::function<graphics::Frame()> const& last_frame) :
+    next_dispatcher{next_dispatcher},
+    delivery{delivery},
+    frames{std::make_shared<dispatch::ActionQueue>()},
+    clock{clock},
+    last_frame{last_frame},
+    frame_period{default_frame_period},
+    // The alarm fires wherever the alarm factory runs; hand the frame over to the delivery thread
+    frame_alarm{alarm_factory->create_alarm([this] { frames->enqueue([this] { deliver_frame(); }); })}
+{
+    delivery->add_watch(frames);
+}
+
+mi::ResamplingInputDispatcher::~ResamplingInputDispatcher() noexcept
+{
+    delivery->remove_watch(frames);
+}
+
+bool mi::ResamplingInputDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+
+    if (!is_plain_motion(*event))
+    {
+        if (event->type() == mir_event_type_input)
+        {
+            auto const device = devices.find(event->to_input()->device_id());
+            if (device != devices.end())
+            {
+                // Motion held back for this device happened before this
+                // event; deliver it as it was rather than resampled into
+                // the future.
+                if (device->second.pending)
+                    flush(device->second, device->second.history.back().time);
+                device->second.history.clear();
+            }
+        }
+        return next_dispatcher->dispatch(event);
+    }
+
+    auto const input = event->to_input();
+    auto& state = devices[input->device_id()];
+
+    Sample sample{input->event_time(), {}, {}, {}};
+    if (input->input_type() == mir_input_event_type_pointer)
+    {
+        auto const pointer = input->to_pointer();
+        sample.ids.push_back(0);
+        sample.xs.push_back(pointer->x());
+        sample.ys.push_back(pointer->y());
+        state.pending_dx += pointer->dx();
+        state.pending_dy += pointer->dy();
+    }
+    else
+    {
+        auto const touch = input->to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            sample.ids.push_back(touch->id(i));
+            sample.xs.push_back(touch->x(i));
+            sample.ys.push_back(touch->y(i));
+        }
+    }
+
+    if (!state.history.empty() && state.history.back().time > sample.time)
+        state.history.clear();
+
+    state.history.push_back(std::move(sample));
+    if (state.history.size() > max_history)
+        state.history.pop_front();
+
+    state.pending = event;
+
+    if (!frame_scheduled)
+    {
+        scheduled_frame = predict_next_frame();
+        frame_scheduled = true;
+
+        // The alarm may fire immediately if we're already late
+        auto const frame = scheduled_frame;
+        lock.unlock();
+        frame_alarm->reschedule_for(time::Timestamp{frame});
+    }
+
+    return true;
+}
+
+void mi::ResamplingInputDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::ResamplingInputDispatcher::stop()
+{
+    next_dispatcher->stop();
+}
+
+void mi::ResamplingInputDispatcher::deliver_frame()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    frame_scheduled = false;
+
+    for (auto& device : devices)
+    {
+        if (device.second.pending)
+            flush(device.second, scheduled_frame - resample_latency);
+    }
+}
+
+void mi::ResamplingInputDispatcher::flush(DeviceState& state, std::chrono::nanoseconds sample_time)
+{
+    auto const& history = state.history;
+    auto const& newest = history.back();
+
+    // Find the pair of samples to interpolate (or extrapolate) between
+    Sample const* before = nullptr;
+    Sample const* after = nullptr;
+    if (newest.time <= sample_time)
+    {
+        if (history.size() >= 2)
+        {
+            auto const delta = newest.time - history[history.size() - 2].time;
+            if (min_sample_delta <= delta && delta <= max_sample_delta)
+            {
+                before = &history[history.size() - 2];
+                after = &newest;
+                sample_time = std::min(sample_time, newest.time + std::min(delta/2, std::chrono::nanoseconds{max_prediction}));
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = history.size() - 1; i != 0; --i)
+        {
+            if (history[i - 1].time <= sample_time)
+            {
+                before = &history[i - 1];
+                after = &history[i];
+                break;
+            }
+        }
+    }
+
+    auto resampled = mev::clone_event(*state.pending);
+    auto const input = resampled->to_input();
+
+    if (before && after && before->ids == after->ids)
+    {
+        auto const alpha = float((sample_time - before->time).count()) / (after->time - before->time).count();
+
+        if (input->input_type() == mir_input_event_type_pointer)
+        {
+            auto const pointer = input->to_pointer();
+            pointer->set_x(lerp(before->xs[0], after->xs[0], alpha));
+            pointer->set_y(lerp(before->ys[0], after->ys[0], alpha));
+        }
+        else
+        {
+            auto const touch = input->to_touch();
+            for (size_t i = 0; i != touch->pointer_count(); ++i)
+            {
+                touch->set_x(i, lerp(before->xs[i], after->xs[i], alpha));
+                touch->set_y(i, lerp(before->ys[i], after->ys[i], alpha));
+            }
+        }
+        input->set_event_time(sample_time);
+    }
+
+    // Relative motion isn't resampled: whatever was coalesced is delivered
+    if (input->input_type() == mir_input_event_type_pointer)
+    {
+        auto const pointer = input->to_pointer();
+        pointer->set_dx(state.pending_dx);
+        pointer->set_dy(state.pending_dy);
+    }
+
+    state.pending.reset();
+    state.pending_dx = 0;
+    state.pending_dy = 0;
+
+    next_dispatcher->dispatch(std::move(resampled));
+}
+
+std::chrono::nanoseconds mi::ResamplingInputDispatcher::predict_next_frame()
+{
+    auto const now = clock->now().time_since_epoch();
+    auto const frame = last_frame();
+
+    std::chrono::nanoseconds phase{0};
+
+    // Only frames timed in the same clock domain as input events are useful
+    if (frame.msc > 0 && frame.ust.clock_id == CLOCK_MONOTONIC)
+    {
+        if (previous_frame.msc > 0 && frame.msc > previous_frame.msc)
+        {
+            auto const period = (frame.ust - previous_frame.ust) / (frame.msc - previous_frame.msc);
+            if (1ms < period && period < 100ms)
+                frame_period = period;
+        }
+        previous_frame = frame;
+        phase = frame.ust.nanoseconds;
+    }
+
+    auto const elapsed = now - phase;
+    return phase + (elapsed / frame_period + 1) * frame_period;
+}
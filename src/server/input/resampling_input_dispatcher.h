@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_RESAMPLING_INPUT_DISPATCHER_H_
+#define MIR_INPUT_RESAMPLING_INPUT_DISPATCHER_H_
+
+#include "mir/input/input_dispatcher.h"
+#include "mir/graphics/frame.h"
+#include "mir_toolkit/event.h"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace dispatch
+{
+class ActionQueue;
+class MultiplexingDispatchable;
+}
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+class Clock;
+}
+namespace input
+{
+/**
+ * Aligns pointer and touch motion with the display's frames.
+ *
+ * Motion from a device is held back and coalesced until the next predicted
+ * frame, when a single event is delivered with its positions resampled to
+ * a common point shortly before that frame: interpolated between the
+ * samples either side of it, or extrapolated a little way past the newest.
+ * Clients then see one evenly spaced update per frame rather than bursts
+ * at the device's own rate.
+ *
+ * Anything other than plain motion (button or touch down/up, scrolling,
+ * keys...) is delivered immediately, after any motion held back for the
+ * same device.
+ *
+ * Held-back motion is delivered from \a delivery, which should be served by
+ * the thread calling dispatch() (see QueuedInputDispatcher), so the next
+ * dispatcher only ever sees events from the one thread.
+ */
+class ResamplingInputDispatcher : public InputDispatcher
+{
+public:
+    /// \param last_frame   timing of the most recent frame on the output
+    ///                     motion is being presented on
+    ResamplingInputDispatcher(
+        std::shared_ptr<InputDispatcher> const& next_dispatcher,
+        std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+        std::shared_ptr<dispatch::MultiplexingDispatchable> const& delivery,
+        std::shared_ptr<time::Clock> const& clock,
+        std::function<graphics::Frame()> const& last_frame);
+    ~ResamplingInputDispatcher() noexcept;
+
+    // InputDispatcher
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override;
+    void start() override;
+    void stop() override;
+
+private:
+    struct Sample
+    {
+        std::chrono::nanoseconds time;
+        std::vector<int> ids;
+        std::vector<float> xs;
+        std::vector<float> ys;
+    };
+
+    struct DeviceState
+    {
+        std::shared_ptr<MirEvent const> pending;
+        float pending_dx{0};
+        float pending_dy{0};
+        std::deque<Sample> history;
+    };
+
+    void flush(DeviceState& state, std::chrono::nanoseconds sample_time);
+    void deliver_frame();
+    std::chrono::nanoseconds predict_next_frame();
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    std::shared_ptr<dispatch::MultiplexingDispatchable> const delivery;
+    std::shared_ptr<dispatch::ActionQueue> const frames;
+    std::shared_ptr<time::Clock> const clock;
+    std::function<graphics::Frame()> const last_frame;
+
+    std::mutex mutex;
+    std::unordered_map<MirInputDeviceId, DeviceState> devices;
+    bool frame_scheduled{false};
+    std::chrono::nanoseconds scheduled_frame{0};
+    graphics::Frame previous_frame;
+    std::chrono::nanoseconds frame_period;
+    std::unique_ptr<time::Alarm> const frame_alarm;
+};
+
+}
+}
+
+#endif // MIR_INPUT_RESAMPLING_INPUT_DISPATCHER_H_
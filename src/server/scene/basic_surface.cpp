@@ -808,11 +808,13 @@ public:
         std::experimental::optional<geom::Rectangle> const& clip_area,
         glm::mat4 const& transform,
         float alpha,
-        mg::Renderable::ID id)
+        mg::Renderable::ID id,
+        std::experimental::optional<geom::Rectangle> const& source_rect)
     : underlying_buffer_stream{stream},
       compositor_id{compositor_id},
       alpha_{alpha},
       screen_position_(position),
+      source_rect_(source_rect),
       clip_area_(clip_area),
       transformation_(transform),
       id_(id)
@@ -838,6 +840,9 @@ public:
     geom::Rectangle screen_position() const override
     { return screen_position_; }
 
+    std::experimental::optional<geom::Rectangle> source_rect() const override
+    { return source_rect_; }
+
     std::experimental::optional<geom::Rectangle> clip_area() const override
     { return clip_area_; }
 
@@ -858,6 +863,7 @@ private:
     void const*const compositor_id;
     float const alpha_;
     geom::Rectangle const screen_position_;
+    std::experimental::optional<geom::Rectangle> const source_rect_;
     std::experimental::optional<geom::Rectangle> const clip_area_;
     glm::mat4 const transformation_;
     mg::Renderable::ID const id_;
@@ -938,14 +944,20 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             geom::Size size;
             if (info.size.is_set())
                 size = info.size.value();
+            else if (info.source.is_set())
+                size = info.source.value().size;
             else
                 size = info.stream->stream_size();
 
+            std::experimental::optional<geom::Rectangle> source;
+            if (info.source.is_set())
+                source = info.source.value();
+
             list.emplace_back(std::make_shared<SurfaceSnapshot>(
                 info.stream, id,
                 geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
                 clip_area_,
-                transformation_matrix, surface_alpha, info.stream.get()));
+                transformation_matrix, surface_alpha, info.stream.get(), source));
         }
     }
     return list;
@@ -132,8 +132,9 @@ struct ms::MediatingDisplayChanger::SessionObserver : ms::SessionEventSink
     void handle_focus_change(std::shared_ptr<mir::scene::Session> const& session) override
     {
         auto const weak_session = std::weak_ptr<ms::Session>(session);
-        self->server_action_queue->enqueue(
+        self->server_action_queue->enqueue_with_priority(
             self,
+            ServerActionPriority::high,
             [self=self,weak_session]
                 {
                     if (auto const session = weak_session.lock())
@@ -143,16 +144,18 @@ struct ms::MediatingDisplayChanger::SessionObserver : ms::SessionEventSink
 
     void handle_no_focus() override
     {
-        self->server_action_queue->enqueue(
+        self->server_action_queue->enqueue_with_priority(
             self,
+            ServerActionPriority::high,
             [self=self] { self->no_focus_handler(); });
     }
 
     void handle_session_stopping(std::shared_ptr<mir::scene::Session> const& session) override
     {
         auto const weak_session = std::weak_ptr<ms::Session>(session);
-        self->server_action_queue->enqueue(
+        self->server_action_queue->enqueue_with_priority(
             self,
+            ServerActionPriority::high,
             [self=self,weak_session]
             {
                 if (auto const session = weak_session.lock())
@@ -214,8 +217,9 @@ void ms::MediatingDisplayChanger::configure(
 
     std::weak_ptr<ms::Session> const weak_session{session};
 
-    server_action_queue->enqueue(
+    server_action_queue->enqueue_with_priority(
         this,
+        ServerActionPriority::high,
         [this, weak_session, conf]
         {
             if (auto const session = weak_session.lock())
@@ -255,8 +259,9 @@ void ms::MediatingDisplayChanger::remove_session_configuration(
 
     std::weak_ptr<ms::Session> const weak_session{session};
 
-    server_action_queue->enqueue(
+    server_action_queue->enqueue_with_priority(
         this,
+        ServerActionPriority::high,
         [this, weak_session]
         {
             if (auto const session = weak_session.lock())
@@ -308,8 +313,9 @@ ms::MediatingDisplayChanger::preview_base_configuration(
         currently_previewing_session = session;
     }
 
-    server_action_queue->enqueue(
+    server_action_queue->enqueue_with_priority(
         this,
+        ServerActionPriority::high,
         [this, conf, session]()
         {
             if (auto live_session = session.lock())
@@ -368,8 +374,9 @@ ms::MediatingDisplayChanger::cancel_base_configuration_preview(
         // We cancelled the alarm, which means it had not already been triggered.
         // Therefore we need to queue up a switch back to the base display configuration and
         // send a notification.
-        server_action_queue->enqueue(
+        server_action_queue->enqueue_with_priority(
             this,
+            ServerActionPriority::high,
             [this, weak_session = std::weak_ptr<ms::Session>(session)]()
             {
                 if (auto live_session = weak_session.lock())
@@ -392,8 +399,9 @@ ms::MediatingDisplayChanger::base_configuration()
 void ms::MediatingDisplayChanger::configure_for_hardware_change(
     std::shared_ptr<graphics::DisplayConfiguration> const& conf)
 {
-    server_action_queue->enqueue(
+    server_action_queue->enqueue_with_priority(
         this,
+        ServerActionPriority::high,
         [this, conf]
         {
             std::lock_guard<std::mutex> lg{configuration_mutex};
@@ -474,10 +482,28 @@ void ms::MediatingDisplayChanger::apply_config(
         if (configuration_has_new_outputs_enabled(*display->configuration(), *conf) ||
             !display->apply_if_configuration_preserves_display_buffers(*conf))
         {
-            ApplyNowAndRevertOnScopeExit comp{
-                [this] { compositor->stop(); },
-                [this] { compositor->start(); }};
-            display->configure(*conf);
+            /*
+             * Where the platform supports it only the outputs affected by the
+             * change stop compositing (e.g. while a monitor is hotplugged)...
+             */
+            auto const released_groups =
+                [this](std::vector<mg::DisplaySyncGroup*> const& groups)
+                {
+                    compositor->stop_compositing(groups);
+                };
+
+            if (display->configure_incrementally(*conf, released_groups))
+            {
+                compositor->start_compositing_new_groups();
+            }
+            else
+            {
+                /* ...otherwise every output is torn down and rebuilt */
+                ApplyNowAndRevertOnScopeExit comp{
+                    [this] { compositor->stop(); },
+                    [this] { compositor->start(); }};
+                display->configure(*conf);
+            }
         }
 
         observer->configuration_applied(conf);
@@ -582,8 +608,9 @@ void ms::MediatingDisplayChanger::set_base_configuration(std::shared_ptr<mg::Dis
         BOOST_THROW_EXCEPTION(std::runtime_error(bad_display_config));
     }
 
-    server_action_queue->enqueue(
+    server_action_queue->enqueue_with_priority(
         this,
+        ServerActionPriority::high,
         [this, conf]
         {
             std::lock_guard<std::mutex> lg{configuration_mutex};
@@ -299,6 +299,59 @@ void msd::BasicDecoration::update(
     ObjUpdated<WindowState> window_updated{previous_window_state.value_or(nullptr), window_state.get()};
     ObjUpdated<InputState> input_updated{previous_input_state.value_or(nullptr), input_state.get()};
 
+    // Render before touching the scene so the new geometry and buffers go out back to back
+    if (window_updated({
+            &WindowState::focused_state,
+            &WindowState::window_name,
+            &WindowState::titlebar_rect,
+            &WindowState::left_border_rect,
+            &WindowState::right_border_rect,
+            &WindowState::bottom_border_rect}) ||
+        input_updated({
+            &InputState::buttons}))
+    {
+        renderer->update_state(*window_state, *input_state);
+    }
+
+    std::vector<std::pair<
+        std::shared_ptr<mc::BufferStream>,
+        std::experimental::optional<std::shared_ptr<mg::Buffer>>>> new_buffers;
+
+    if (window_updated({
+            &WindowState::focused_state,
+            &WindowState::side_border_width,
+            &WindowState::side_border_height}))
+    {
+        new_buffers.emplace_back(
+            buffer_streams->left_border,
+            renderer->render_left_border());
+        new_buffers.emplace_back(
+            buffer_streams->right_border,
+            renderer->render_right_border());
+    }
+
+    if (window_updated({
+            &WindowState::focused_state,
+            &WindowState::bottom_border_width,
+            &WindowState::bottom_border_height}))
+    {
+        new_buffers.emplace_back(
+            buffer_streams->bottom_border,
+            renderer->render_bottom_border());
+    }
+
+    if (window_updated({
+            &WindowState::focused_state,
+            &WindowState::window_name,
+            &WindowState::titlebar_rect}) ||
+        input_updated({
+            &InputState::buttons}))
+    {
+        new_buffers.emplace_back(
+            buffer_streams->titlebar,
+            renderer->render_titlebar());
+    }
+
     if (window_updated({
             &WindowState::titlebar_height,
             &WindowState::side_border_width,
@@ -361,58 +414,6 @@ void msd::BasicDecoration::update(
         shell->modify_surface(session, decoration_surface, spec);
     }
 
-    if (window_updated({
-            &WindowState::focused_state,
-            &WindowState::window_name,
-            &WindowState::titlebar_rect,
-            &WindowState::left_border_rect,
-            &WindowState::right_border_rect,
-            &WindowState::bottom_border_rect}) ||
-        input_updated({
-            &InputState::buttons}))
-    {
-        renderer->update_state(*window_state, *input_state);
-    }
-
-    std::vector<std::pair<
-        std::shared_ptr<mc::BufferStream>,
-        std::experimental::optional<std::shared_ptr<mg::Buffer>>>> new_buffers;
-
-    if (window_updated({
-            &WindowState::focused_state,
-            &WindowState::side_border_width,
-            &WindowState::side_border_height}))
-    {
-        new_buffers.emplace_back(
-            buffer_streams->left_border,
-            renderer->render_left_border());
-        new_buffers.emplace_back(
-            buffer_streams->right_border,
-            renderer->render_right_border());
-    }
-
-    if (window_updated({
-            &WindowState::focused_state,
-            &WindowState::bottom_border_width,
-            &WindowState::bottom_border_height}))
-    {
-        new_buffers.emplace_back(
-            buffer_streams->bottom_border,
-            renderer->render_bottom_border());
-    }
-
-    if (window_updated({
-            &WindowState::focused_state,
-            &WindowState::window_name,
-            &WindowState::titlebar_rect}) ||
-        input_updated({
-            &InputState::buttons}))
-    {
-        new_buffers.emplace_back(
-            buffer_streams->titlebar,
-            renderer->render_titlebar());
-    }
-
     for (auto const& pair : new_buffers)
     {
         if (pair.second)
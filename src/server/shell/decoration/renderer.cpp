@@ -23,6 +23,7 @@
 
 #include "mir/graphics/graphic_buffer_allocator.h"
 #include "mir/renderer/sw/pixel_source.h"
+#include "mir/renderer/sw/pixel_ops.h"
 #include "mir/geometry/displacement.h"
 #include "mir/log.h"
 
@@ -106,10 +107,10 @@ inline void render_row(
         return;
     geom::X const right = std::min(left.x + as_delta(length), as_x(buf_size.width));
     left.x = std::max(left.x, geom::X{});
+    if (right <= left.x)
+        return;
     uint32_t* const start = data + (left.y.as_int() * buf_size.width.as_int()) + left.x.as_int();
-    uint32_t* const end = start + right.as_int() - left.x.as_int();
-    for (uint32_t* i = start; i < end; i++)
-        *i = color;
+    mrs::fill_pixels(start, right.as_int() - left.x.as_int(), color);
 }
 
 inline void render_close_icon(
@@ -22,6 +22,8 @@
 #include "mir/executor.h"
 #include "mir/fatal.h"
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <experimental/optional>
@@ -59,11 +61,18 @@ public:
 
     void spawn(std::function<void(T*)>&& work)
     {
-        executor->spawn([self = this->shared_from_this(), work]()
+        {
+            std::lock_guard<std::mutex> lock{queue_mutex};
+            pending.push_back(std::move(work));
+            if (draining)
+                return;
+            draining = true;
+        }
+
+        // Only one drain is queued at a time, so work runs in order even on a multi-threaded executor
+        executor->spawn([self = this->shared_from_this()]()
             {
-                std::lock_guard<std::mutex> lock{self->mutex};
-                if (self->target)
-                    work(self->target.value());
+                self->drain();
             });
     }
 
@@ -74,9 +83,31 @@ public:
     }
 
 private:
+    void drain()
+    {
+        std::unique_lock<std::mutex> queue_lock{queue_mutex};
+        while (!pending.empty())
+        {
+            auto const work = std::move(pending.front());
+            pending.pop_front();
+            queue_lock.unlock();
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (target)
+                    work(target.value());
+            }
+            queue_lock.lock();
+        }
+        draining = false;
+    }
+
     std::mutex mutex;
     std::experimental::optional<T*> target;
     std::shared_ptr<Executor> executor;
+
+    std::mutex queue_mutex;
+    std::deque<std::function<void(T*)>> pending;
+    bool draining{false};
 };
 }
 }
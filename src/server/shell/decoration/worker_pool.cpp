@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worker_pool.h"
+
+#include "mir/signal_blocker.h"
+#include "mir/terminate_with_current_exception.h"
+#include "mir/thread_name.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+namespace msd = mir::shell::decoration;
+
+msd::WorkerPool::WorkerPool(unsigned int threads)
+    : threads{threads},
+      state{std::make_shared<State>()}
+{
+    if (threads == 0)
+        BOOST_THROW_EXCEPTION(std::logic_error("decoration worker pool needs at least one thread"));
+}
+
+msd::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+        state->stopping = true;
+    }
+    state->work_available.notify_all();
+
+    for (auto& worker : workers)
+    {
+        // The last reference to the pool may be dropped by work running on it
+        if (worker.get_id() == std::this_thread::get_id())
+            worker.detach();
+        else
+            worker.join();
+    }
+}
+
+void msd::WorkerPool::spawn(std::function<void()>&& work)
+{
+    {
+        std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+        state->work_queue.push_back(std::move(work));
+
+        if (workers.empty())
+        {
+            // Workers inherit our signal mask, so block all signals before creating them
+            mir::SignalBlocker blocker;
+            for (auto i = 0u; i < threads; i++)
+                workers.emplace_back([state = state] { run(state); });
+        }
+    }
+    state->work_available.notify_one();
+}
+
+void msd::WorkerPool::run(std::shared_ptr<State> const& state) noexcept
+try
+{
+    mir::set_thread_name("Mir/Decorations");
+
+    std::unique_lock<decltype(state->mutex)> lock{state->mutex};
+    for (;;)
+    {
+        state->work_available.wait(lock, [&] { return state->stopping || !state->work_queue.empty(); });
+
+        if (state->stopping)
+            return;
+
+        auto work = std::move(state->work_queue.front());
+        state->work_queue.pop_front();
+
+        lock.unlock();
+        work();
+        // Release anything the work captured before taking the lock again
+        work = nullptr;
+        lock.lock();
+    }
+}
+catch (...)
+{
+    mir::terminate_with_current_exception();
+}
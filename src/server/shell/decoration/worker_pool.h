@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SHELL_DECORATION_WORKER_POOL_H_
+#define MIR_SHELL_DECORATION_WORKER_POOL_H_
+
+#include "mir/executor.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace shell
+{
+namespace decoration
+{
+/// Runs decoration work (layout, rendering and buffer submission) off the main loop
+/// Work is started in the order it is spawned, but may run concurrently; callers
+/// that need ordering (such as ThreadsafeAccess) serialize their own work. The
+/// threads are only started once there is some work.
+class WorkerPool : public Executor
+{
+public:
+    explicit WorkerPool(unsigned int threads);
+    ~WorkerPool();
+
+    void spawn(std::function<void()>&& work) override;
+
+private:
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    /// Shared with the workers so that one can outlive the pool if it drops the last reference to it
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable work_available;
+        std::deque<std::function<void()>> work_queue;
+        bool stopping{false};
+    };
+
+    static void run(std::shared_ptr<State> const& state) noexcept;
+
+    unsigned int const threads;
+    std::shared_ptr<State> const state;
+    std::vector<std::thread> workers;
+};
+}
+}
+}
+
+#endif // MIR_SHELL_DECORATION_WORKER_POOL_H_
@@ -28,12 +28,19 @@
 #include "graphics_display_layout.h"
 #include "decoration/basic_manager.h"
 #include "decoration/basic_decoration.h"
+#include "decoration/worker_pool.h"
 
 namespace ms = mir::scene;
 namespace msh = mir::shell;
 namespace msd = mir::shell::decoration;
 namespace mf = mir::frontend;
 
+namespace
+{
+// Text layout is serialized inside the renderer, so a couple of threads is plenty
+unsigned int const decoration_threads{2};
+}
+
 auto mir::DefaultServerConfiguration::the_shell() -> std::shared_ptr<msh::Shell>
 {
     return shell([this]
@@ -71,7 +78,7 @@ auto mir::DefaultServerConfiguration::the_decoration_manager() -> std::shared_pt
         {
             return std::make_shared<msd::BasicManager>(
                 [buffer_allocator = the_buffer_allocator(),
-                 executor = the_main_loop(),
+                 executor = std::make_shared<msd::WorkerPool>(decoration_threads),
                  cursor_images = the_cursor_images()](
                     std::shared_ptr<shell::Shell> const& shell,
                     std::shared_ptr<scene::Surface> const& surface) -> std::unique_ptr<msd::Decoration>
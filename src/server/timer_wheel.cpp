@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/time/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace mt = mir::time;
+
+namespace
+{
+uint64_t rotate_right(uint64_t bits, int by)
+{
+    by &= 63;
+    return by ? (bits >> by) | (bits << (64 - by)) : bits;
+}
+
+// The index of the first occupied slot, counting from start and wrapping around
+int first_occupied_from(uint64_t occupied, int start)
+{
+    return __builtin_ctzll(rotate_right(occupied, start));
+}
+}
+
+mt::TimerWheel::TimerWheel(Timestamp origin, Duration granularity)
+    : origin{origin},
+      granularity{granularity},
+      due{nullptr, -1, 0}
+{
+    for (int level = 0; level != levels; ++level)
+    {
+        wheel[level].occupied = 0;
+        for (int index = 0; index != slots_per_level; ++index)
+            wheel[level].slots[index] = Slot{nullptr, level, index};
+    }
+}
+
+mt::TimerWheel::~TimerWheel()
+{
+    // Leave any remaining timers in a consistent (unscheduled) state
+    auto const clear = [](Slot& slot)
+        {
+            while (auto const timer = slot.head)
+            {
+                slot.head = timer->next;
+                timer->slot = nullptr;
+                timer->prev = timer->next = nullptr;
+            }
+        };
+
+    for (auto& level : wheel)
+        for (auto& slot : level.slots)
+            clear(slot);
+
+    clear(due);
+}
+
+void mt::TimerWheel::schedule(Timer& timer, Timestamp deadline)
+{
+    cancel(timer);
+
+    timer.deadline_ = deadline;
+    timer.tick = tick_for(deadline, true);
+    insert(timer);
+}
+
+void mt::TimerWheel::cancel(Timer& timer)
+{
+    if (timer.scheduled())
+        unlink(timer);
+}
+
+auto mt::TimerWheel::next_event() const -> Timestamp
+{
+    return origin + granularity * next_event_tick();
+}
+
+void mt::TimerWheel::advance(Timestamp now, std::function<void(Timer&)> const& expired)
+{
+    auto const target = tick_for(now, false);
+
+    while (count > 0)
+    {
+        auto const next = next_event_tick();
+        if (next > target)
+            break;
+
+        current = std::max(current, next);
+        process_tick(expired);
+    }
+
+    current = std::max(current, target);
+}
+
+uint64_t mt::TimerWheel::tick_for(Timestamp t, bool round_up) const
+{
+    if (t <= origin)
+        return 0;
+
+    auto const since_origin = t - origin;
+    uint64_t ticks = since_origin / granularity;
+
+    if (round_up && since_origin % granularity != Duration::zero())
+        ++ticks;
+
+    return ticks;
+}
+
+uint64_t mt::TimerWheel::next_event_tick() const
+{
+    if (due.head)
+        return current;
+
+    auto result = std::numeric_limits<uint64_t>::max();
+
+    for (int level = 0; level != levels; ++level)
+    {
+        auto const occupied = wheel[level].occupied;
+        if (!occupied)
+            continue;
+
+        // Slots are visited (expired or cascaded) when the tick count
+        // reaches the start of their span at this level
+        int const shift = level * bits_per_level;
+        auto const next_span = (current >> shift) + 1;
+        auto const offset = first_occupied_from(occupied, next_span % slots_per_level);
+
+        result = std::min(result, (next_span + offset) << shift);
+    }
+
+    return result;
+}
+
+void mt::TimerWheel::insert(Timer& timer)
+{
+    Slot* slot;
+
+    if (timer.tick <= current)
+    {
+        slot = &due;
+    }
+    else
+    {
+        auto const delta = timer.tick - current;
+
+        int level = 0;
+        while (level < levels - 1 && delta >> ((level + 1) * bits_per_level))
+            ++level;
+
+        int const shift = level * bits_per_level;
+
+        // Timers beyond the outermost wheel wait in its last slot and are
+        // re-inserted when that is cascaded.
+        auto const span = (delta >> ((level + 1) * bits_per_level)) ?
+            (current >> shift) + slots_per_level - 1 :
+            timer.tick >> shift;
+
+        int const index = span % slots_per_level;
+        slot = &wheel[level].slots[index];
+        wheel[level].occupied |= uint64_t{1} << index;
+    }
+
+    timer.slot = slot;
+    timer.prev = nullptr;
+    timer.next = slot->head;
+    if (slot->head)
+        slot->head->prev = &timer;
+    slot->head = &timer;
+
+    ++count;
+}
+
+void mt::TimerWheel::unlink(Timer& timer)
+{
+    auto const slot = timer.slot;
+
+    if (timer.prev)
+        timer.prev->next = timer.next;
+    else
+        slot->head = timer.next;
+
+    if (timer.next)
+        timer.next->prev = timer.prev;
+
+    if (!slot->head && slot->level >= 0)
+        wheel[slot->level].occupied &= ~(uint64_t{1} << slot->index);
+
+    timer.slot = nullptr;
+    timer.prev = timer.next = nullptr;
+
+    --count;
+}
+
+void mt::TimerWheel::process_tick(std::function<void(Timer&)> const& expired)
+{
+    if (!due.head)
+    {
+        // Cascade outer wheels whose span starts at this tick, outermost first
+        for (int level = levels - 1; level > 0; --level)
+        {
+            int const shift = level * bits_per_level;
+            if (current & ((uint64_t{1} << shift) - 1))
+                continue;
+
+            auto& slot = wheel[level].slots[(current >> shift) % slots_per_level];
+            while (auto const timer = slot.head)
+            {
+                unlink(*timer);
+                insert(*timer);
+            }
+        }
+
+        auto& slot = wheel[0].slots[current % slots_per_level];
+        while (auto const timer = slot.head)
+        {
+            unlink(*timer);
+            insert(*timer);
+        }
+    }
+
+    while (auto const timer = due.head)
+    {
+        unlink(*timer);
+        expired(*timer);
+    }
+}
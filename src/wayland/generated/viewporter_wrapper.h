@@ -0,0 +1,103 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from viewporter.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_VIEWPORTER_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_VIEWPORTER_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class Viewporter;
+class Viewport;
+
+class Viewporter : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_viewporter";
+
+    static Viewporter* from(struct wl_resource*);
+
+    Viewporter(struct wl_resource* resource, Version<1>);
+    virtual ~Viewporter();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const viewport_exists = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_viewporter) = 0;
+        friend Viewporter::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void get_viewport(struct wl_resource* id, struct wl_resource* surface) = 0;
+};
+
+class Viewport : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_viewport";
+
+    static Viewport* from(struct wl_resource*);
+
+    Viewport(struct wl_resource* resource, Version<1>);
+    virtual ~Viewport();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const bad_value = 0;
+        static uint32_t const bad_size = 1;
+        static uint32_t const out_of_buffer = 2;
+        static uint32_t const no_surface = 3;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void destroy() = 0;
+    virtual void set_source(double x, double y, double width, double height) = 0;
+    virtual void set_destination(int32_t width, int32_t height) = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_VIEWPORTER_XML_WRAPPER
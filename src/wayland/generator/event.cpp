@@ -44,7 +44,7 @@ Emitter Event::prototype() const
 }
 
 // TODO: Decide whether to resolve wl_resource* to wrapped types (ie: Region, Surface, etc).
-Emitter Event::impl() const
+Emitter Event::impl(bool instrumented) const
 {
     return Lines{
         (min_version > 0 ? Lines{
@@ -58,6 +58,9 @@ Emitter Event::impl() const
         Block{
             mir2wl_converters(),
             {"wl_resource_post_event(", wl_call_args(), ");"},
+            (instrumented ?
+                Emitter{"Thunks::statistics.record_event(Opcode::", sanitize_name(name), ");"} :
+                Emitter{nullptr}),
         }
     };
 }
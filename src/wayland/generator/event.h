@@ -28,7 +28,8 @@ public:
 
     Emitter opcode_declare() const;
     Emitter prototype() const;
-    Emitter impl() const;
+    // If instrumented, sending the event also records it
+    Emitter impl(bool instrumented) const;
 
 protected:
     // converts wl input types to mir types
@@ -64,7 +64,8 @@ auto matching_keys_to_vector(
 Interface::Interface(xmlpp::Element const& node,
                      std::function<std::string(std::string)> const& name_transform,
                      std::unordered_set<std::string> const& constructable_interfaces,
-                     std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces)
+                     std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces,
+                     bool instrumented)
     : wl_name{node.get_attribute_value("name")},
       version{std::stoi(node.get_attribute_value("version"))},
       generated_name{name_transform(wl_name)},
@@ -78,7 +79,8 @@ Interface::Interface(xmlpp::Element const& node,
       events{get_events(node, generated_name)},
       enums{get_enums(node)},
       parent_interfaces{matching_keys_to_vector(event_constructable_interfaces, name_transform, wl_name)},
-      has_vtable{!requests.empty()}
+      has_vtable{!requests.empty()},
+      instrumented{instrumented}
 {
 }
 
@@ -297,7 +299,7 @@ Emitter Interface::event_impls() const
     std::vector<Emitter> impls;
     for (auto const& event : events)
     {
-        impls.push_back(event.impl());
+        impls.push_back(event.impl(instrumented));
     }
     return EmptyLineList{impls};
 }
@@ -373,6 +375,12 @@ Emitter Interface::thunks_impl() const
             }, ";"},
             empty_line,
             {"int const ", nmspace, "Thunks::supported_version = ", std::to_string(version), ";"},
+            (instrumented ?
+                Lines{
+                    empty_line,
+                    {"mw::InterfaceStatistics ", nmspace, "Thunks::statistics{&mw::", wl_name, "_interface_data, ",
+                        std::to_string(requests.size()), ", ", std::to_string(events.size()), "};"}} :
+                Emitter{nullptr}),
         };
     }
     else
@@ -387,8 +395,11 @@ Emitter Interface::thunks_impl_contents() const
     impls.push_back(
         {"static int const supported_version;"});
 
+    if (instrumented)
+        impls.push_back({"static InterfaceStatistics statistics;"});
+
     for (auto const& request : requests)
-        impls.push_back(request.thunk_impl());
+        impls.push_back(request.thunk_impl(instrumented));
 
     if (has_vtable)
         impls.push_back(resource_destroyed_thunk());
@@ -474,10 +485,12 @@ Emitter Interface::types_init() const
 std::vector<Request> Interface::get_requests(xmlpp::Element const& node, std::string generated_name)
 {
     std::vector<Request> requests;
+    int opcode = 0;
     for (auto method_node : node.get_children("request"))
     {
         auto elem = dynamic_cast<xmlpp::Element*>(method_node);
-        requests.emplace_back(Request{std::ref(*elem), generated_name});
+        requests.emplace_back(Request{std::ref(*elem), generated_name, opcode});
+        opcode++;
     }
     return requests;
 }
@@ -43,7 +43,8 @@ public:
     Interface(xmlpp::Element const& node,
               std::function<std::string(std::string)> const& name_transform,
               std::unordered_set<std::string> const& constructible_interfaces,
-              std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces);
+              std::unordered_multimap<std::string, std::string> const& event_constructable_interfaces,
+              bool instrumented);
 
     std::string class_name() const;
     Emitter declaration() const;
@@ -88,6 +89,7 @@ private:
     std::vector<Enum> const enums;
     std::vector<std::string> const parent_interfaces;
     bool const has_vtable;
+    bool const instrumented;
 };
 
 #endif // MIR_WAYLAND_GENERATOR_INTERFACE_H
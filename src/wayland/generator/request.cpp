@@ -18,8 +18,9 @@
 
 #include "request.h"
 
-Request::Request(xmlpp::Element const& node, std::string const& class_name)
-    : Method{node, class_name, false}
+Request::Request(xmlpp::Element const& node, std::string const& class_name, int opcode)
+    : Method{node, class_name, false},
+      opcode{opcode}
 {
 }
 
@@ -30,10 +31,11 @@ Emitter Request::virtual_mir_prototype() const
 }
 
 // TODO: Decide whether to resolve wl_resource* to wrapped types (ie: Region, Surface, etc).
-Emitter Request::thunk_impl() const
+Emitter Request::thunk_impl(bool instrumented) const
 {
     return {"static void ", name, "_thunk(", wl_args(), ")",
         Block{
+            (instrumented ? "auto const start = std::chrono::steady_clock::now();" : Emitter{nullptr}),
             {"auto me = static_cast<", class_name, "*>(wl_resource_get_user_data(resource));"},
             wl2mir_converters(),
             "try",
@@ -47,7 +49,10 @@ Emitter Request::thunk_impl() const
             "catch(...)",
             Block{
                 {"internal_error_processing_request(client, \"", class_name, "::", name, "()\");"},
-            }
+            },
+            (instrumented ?
+                Emitter{"statistics.record_request(", std::to_string(opcode), ", std::chrono::steady_clock::now() - start);"} :
+                Emitter{nullptr})
         }
     };
 }
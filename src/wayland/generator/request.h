@@ -24,14 +24,15 @@
 class Request : public Method
 {
 public:
-    Request(xmlpp::Element const& node, std::string const& class_name);
+    Request(xmlpp::Element const& node, std::string const& class_name, int opcode);
 
     // prototype of virtual function that is overridden in Mir
     Emitter virtual_mir_prototype() const;
 
     // the thunk is the static function that libwayland calls
     // It does some type conversion and calls the virtual method, which should be overridden somewhere in Mir
-    Emitter thunk_impl() const;
+    // If instrumented, it also records the request and the time the virtual method took
+    Emitter thunk_impl(bool instrumented) const;
 
     // the bit of this objects vtable that holds this method
     Emitter vtable_initialiser() const;
@@ -48,6 +49,8 @@ protected:
 
     // arguments to call the virtual mir function call (just names, no types)
     Emitter mir_call_args() const;
+
+    int const opcode;
 };
 
 #endif // MIR_WAYLAND_GENERATOR_REQUEST_H
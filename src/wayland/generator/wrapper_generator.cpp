@@ -55,7 +55,7 @@ Emitter header_includes()
     };
 }
 
-Emitter impl_includes(std::string const& protocol_name)
+Emitter impl_includes(std::string const& protocol_name, bool instrumented)
 {
     return Lines{
         {"#include \"", protocol_name, "_wrapper.h\""},
@@ -66,6 +66,12 @@ Emitter impl_includes(std::string const& protocol_name)
         "#include <wayland-server-core.h>",
         empty_line,
         "#include \"mir/log.h\"",
+        (instrumented ?
+            Lines{
+                "#include \"mir/wayland/protocol_statistics.h\"",
+                empty_line,
+                "#include <chrono>"} :
+            Emitter{nullptr}),
     };
 }
 
@@ -119,7 +125,7 @@ Emitter header_file(std::string input_file_path, std::vector<Interface> const& i
     };
 }
 
-Emitter source_file(std::string input_file_path, std::vector<Interface> const& interfaces)
+Emitter source_file(std::string input_file_path, std::vector<Interface> const& interfaces, bool instrumented)
 {
     std::vector<Emitter> interface_emitters, wl_interface_init_emitters;
     std::set<std::string> fwd_declare_interfaces;
@@ -143,7 +149,7 @@ Emitter source_file(std::string input_file_path, std::vector<Interface> const& i
     return Lines{
         comment_header(input_file_path),
         empty_line,
-        impl_includes(protocol_name),
+        impl_includes(protocol_name, instrumented),
         empty_line,
         "namespace mir",
         "{",
@@ -180,18 +186,20 @@ int main(int argc, char** argv)
     Emitter usage_emitter = Lines{
         empty_line,
         "/*",
-        {"Usage: ./", file_name_from_path(argv[0]), " <prefix> <input> <mode>"},
+        {"Usage: ./", file_name_from_path(argv[0]), " <prefix> <input> <mode> [instrumented]"},
         Block{
             "prefix: the name prefix which will be removed, such as wl_",
             "        to not use a prefix, use _ or anything that won't match the start of a name",
             "input: the input xml file path",
             "mode: 'header' or 'source'",
+            "instrumented: generate a source that records request, event and handler time statistics",
+            "              (see mir/wayland/protocol_statistics.h)",
         },
         "*/",
         empty_line,
     };
 
-    if (argc != 4)
+    if (argc != 4 && !(argc == 5 && std::string{argv[4]} == "instrumented"))
     {
         usage_emitter.emit({std::cerr});
         usage_emitter.emit({std::cout});
@@ -201,6 +209,7 @@ int main(int argc, char** argv)
     std::string const prefix{argv[1]};
     std::string const input_file_path{argv[2]};
     bool header_mode{true};
+    bool const instrumented{argc == 5};
     std::string mode_str = argv[3];
     if (mode_str == "header")
     {
@@ -274,14 +283,15 @@ int main(int argc, char** argv)
             *interface,
             name_transform,
             client_constructable_interfaces,
-            server_constructable_interfaces);
+            server_constructable_interfaces,
+            instrumented);
     }
 
     Emitter emitter{nullptr};
     if (header_mode)
         emitter = header_file(input_file_path, interfaces);
     else
-        emitter = source_file(input_file_path, interfaces);
+        emitter = source_file(input_file_path, interfaces, instrumented);
 
     emitter.emit({std::cout});
 }
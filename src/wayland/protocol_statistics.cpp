@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/wayland/protocol_statistics.h"
+
+#include <wayland-server-core.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace mw = mir::wayland;
+
+namespace
+{
+/* Registration only happens as libraries containing instrumented wrappers are
+ * loaded and unloaded, so a lock here costs nothing on the request path.
+ */
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<mw::InterfaceStatistics const*> interfaces;
+};
+
+auto registry() -> Registry&
+{
+    static Registry instance;
+    return instance;
+}
+}
+
+mw::InterfaceStatistics::InterfaceStatistics(wl_interface const* interface, int request_count, int event_count)
+    : interface{interface},
+      request_count{request_count},
+      event_count{event_count},
+      requests{std::make_unique<Counter[]>(request_count)},
+      events{std::make_unique<Counter[]>(event_count)}
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    reg.interfaces.push_back(this);
+}
+
+mw::InterfaceStatistics::~InterfaceStatistics()
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    reg.interfaces.erase(std::remove(reg.interfaces.begin(), reg.interfaces.end(), this), reg.interfaces.end());
+}
+
+void mw::InterfaceStatistics::record_request(uint32_t opcode, std::chrono::steady_clock::duration handler_time)
+{
+    auto& counter = requests[opcode];
+    counter.count.fetch_add(1, std::memory_order_relaxed);
+    counter.nanoseconds.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(handler_time).count(),
+        std::memory_order_relaxed);
+}
+
+void mw::InterfaceStatistics::record_event(uint32_t opcode)
+{
+    events[opcode].count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void mw::InterfaceStatistics::snapshot(std::vector<MessageStatistics>& into) const
+{
+    for (auto i = 0; i != request_count; ++i)
+    {
+        if (auto const count = requests[i].count.load(std::memory_order_relaxed))
+        {
+            into.push_back(MessageStatistics{
+                interface->name,
+                interface->methods[i].name,
+                true,
+                count,
+                std::chrono::nanoseconds{requests[i].nanoseconds.load(std::memory_order_relaxed)}});
+        }
+    }
+
+    for (auto i = 0; i != event_count; ++i)
+    {
+        if (auto const count = events[i].count.load(std::memory_order_relaxed))
+        {
+            into.push_back(MessageStatistics{
+                interface->name,
+                interface->events[i].name,
+                false,
+                count,
+                std::chrono::nanoseconds{0}});
+        }
+    }
+}
+
+auto mw::protocol_statistics() -> std::vector<MessageStatistics>
+{
+    std::vector<MessageStatistics> result;
+
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    for (auto const interface : reg.interfaces)
+    {
+        interface->snapshot(result);
+    }
+
+    return result;
+}
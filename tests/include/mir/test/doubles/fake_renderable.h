@@ -94,7 +94,17 @@ public:
     {
         return rect;
     }
-    
+
+    void set_source_rect(geometry::Rectangle const& source)
+    {
+        source_ = source;
+    }
+
+    std::experimental::optional<geometry::Rectangle> source_rect() const override
+    {
+        return source_;
+    }
+
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
@@ -108,6 +118,7 @@ public:
 private:
     std::shared_ptr<graphics::Buffer> buf;
     mir::geometry::Rectangle rect;
+    std::experimental::optional<geometry::Rectangle> source_;
     float opacity;
     bool rectangular;
 };
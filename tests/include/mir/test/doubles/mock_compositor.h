@@ -35,6 +35,8 @@ class MockCompositor : public compositor::Compositor
 public:
     MOCK_METHOD0(start, void());
     MOCK_METHOD0(stop, void());
+    MOCK_METHOD1(stop_compositing, void(std::vector<graphics::DisplaySyncGroup*> const&));
+    MOCK_METHOD0(start_compositing_new_groups, void());
 };
 
 }
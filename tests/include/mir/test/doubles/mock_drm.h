@@ -99,6 +99,7 @@ public:
 
     MOCK_METHOD1(drmModeGetResources, drmModeResPtr(int fd));
     MOCK_METHOD2(drmModeGetConnector, drmModeConnectorPtr(int fd, uint32_t connectorId));
+    MOCK_METHOD2(drmModeGetConnectorCurrent, drmModeConnectorPtr(int fd, uint32_t connectorId));
     MOCK_METHOD2(drmModeGetEncoder, drmModeEncoderPtr(int fd, uint32_t encoder_id));
     MOCK_METHOD1(drmModeGetPlaneResources, drmModePlaneResPtr(int fd));
     MOCK_METHOD2(drmModeGetPlane, drmModePlanePtr(int fd, uint32_t plane_id));
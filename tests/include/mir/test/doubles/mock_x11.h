@@ -23,6 +23,7 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
 
 namespace mir
 {
@@ -41,6 +42,8 @@ public:
     Window window;
     Screen screen;
     XVisualInfo visual_info;
+    Visual visual;
+    XWindowAttributes window_attributes;
     XEvent keypress_event_return = { 0 };
     XEvent key_release_event_return = { 0 };
     XEvent button_release_event_return = { 0 };
@@ -95,6 +98,22 @@ public:
     MOCK_METHOD9(XGetGeometry, Status(Display*, Drawable, Window*, int*, int*, unsigned int*, unsigned int*, unsigned int*, unsigned int*));
     MOCK_METHOD2(XFixesHideCursor, void(Display *dpy, Window win));
     MOCK_METHOD2(XFixesShowCursor, void(Display *dpy, Window win));
+    MOCK_METHOD3(XGetWindowAttributes, Status(Display*, Window, XWindowAttributes*));
+    MOCK_METHOD5(XQueryExtension, Bool(Display*, const char*, int*, int*, int*));
+    MOCK_METHOD2(XSync, int(Display*, Bool));
+    MOCK_METHOD1(XFlush, int(Display*));
+    MOCK_METHOD4(XCreateGC, GC(Display*, Drawable, unsigned long, XGCValues*));
+    MOCK_METHOD2(XFreeGC, int(Display*, GC));
+    MOCK_METHOD10(XCreateImage, XImage*(Display*, Visual*, unsigned int, int, int, char*, unsigned int, unsigned int, int, int));
+    MOCK_METHOD10(XPutImage, int(Display*, Drawable, GC, XImage*, int, int, int, int, unsigned int, unsigned int));
+    MOCK_METHOD1(XShmQueryExtension, Bool(Display*));
+    MOCK_METHOD8(XShmCreateImage, XImage*(Display*, Visual*, unsigned int, int, char*, XShmSegmentInfo*, unsigned int, unsigned int));
+    MOCK_METHOD2(XShmAttach, Bool(Display*, XShmSegmentInfo*));
+    MOCK_METHOD2(XShmDetach, Bool(Display*, XShmSegmentInfo*));
+    /* Too long to mock, use wrapper instead.
+    MOCK_METHOD11(XShmPutImage, Bool(Display*, Drawable, GC, XImage*, int, int, int, int, unsigned int, unsigned int, Bool));
+    */
+    MOCK_METHOD10(XShmPutImage_wrapper, Bool(Display*, Drawable, GC, XImage*, int, int, int, int, unsigned int, unsigned int));
 
     FakeX11Resources fake_x11;
 };
@@ -107,6 +107,14 @@ public:
         scene->remove_observer(observer);
     }
 
+    void stop_compositing(std::vector<mg::DisplaySyncGroup*> const&)
+    {
+    }
+
+    void start_compositing_new_groups()
+    {
+    }
+
 private:
     std::shared_ptr<mg::Display> const display;
     std::shared_ptr<mc::DisplayListener> const display_listener;
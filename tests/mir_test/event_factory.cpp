@@ -166,6 +166,12 @@ mis::TouchParameters& mis::TouchParameters::with_event_time(std::chrono::nanosec
     return *this;
 }
 
+mis::TouchParameters& mis::TouchParameters::with_additional_contact(geom::Point abs_pos)
+{
+    additional_contacts.push_back(abs_pos);
+    return *this;
+}
+
 mis::TouchParameters mis::a_touch_event()
 {
     return mis::TouchParameters();
@@ -304,6 +304,14 @@ mtd::MockDRM::MockDRM()
                     return fd_to_drm.at(fd).find_connector(connector_id);
                 }));
 
+    ON_CALL(*this, drmModeGetConnectorCurrent(_, _))
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t connector_id)
+                {
+                    return fd_to_drm.at(fd).find_connector(connector_id);
+                }));
+
     ON_CALL(*this, drmModeObjectGetProperties(_, _, _))
         .WillByDefault(Return(&empty_object_props));
 
@@ -510,6 +518,11 @@ drmModeConnectorPtr drmModeGetConnector(int fd, uint32_t connectorId)
     return global_mock->drmModeGetConnector(fd, connectorId);
 }
 
+drmModeConnectorPtr drmModeGetConnectorCurrent(int fd, uint32_t connectorId)
+{
+    return global_mock->drmModeGetConnectorCurrent(fd, connectorId);
+}
+
 drmModeEncoderPtr drmModeGetEncoder(int fd, uint32_t encoder_id)
 {
     return global_mock->drmModeGetEncoder(fd, encoder_id);
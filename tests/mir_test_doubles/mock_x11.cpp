@@ -44,6 +44,8 @@ mtd::FakeX11Resources::FakeX11Resources()
     std::memset(&enter_notify_event_return, 0, sizeof(XEvent));
     std::memset(&leave_notify_event_return, 0, sizeof(XEvent));
     std::memset(&visual_info, 0, sizeof(XVisualInfo));
+    std::memset(&visual, 0, sizeof visual);
+    std::memset(&window_attributes, 0, sizeof window_attributes);
     std::memset(&screen, 0, sizeof screen);
     visual_info.red_mask = 0xFF0000;
     keypress_event_return.type = KeyPress;
@@ -63,6 +65,11 @@ mtd::FakeX11Resources::FakeX11Resources()
     screen.height = 1800;
     screen.mwidth = 338;
     screen.mwidth = 270;
+    visual.red_mask = 0xFF0000;
+    window_attributes.width = 1280;
+    window_attributes.height = 1024;
+    window_attributes.depth = 24;
+    window_attributes.visual = &visual;
 }
 
 mtd::MockX11::MockX11()
@@ -104,6 +111,16 @@ mtd::MockX11::MockX11()
     .WillByDefault(DoAll(SetArgPointee<5>(fake_x11.screen.width),
                          SetArgPointee<6>(fake_x11.screen.height),
                          Return(1)));
+
+    ON_CALL(*this, XGetWindowAttributes(fake_x11.display,_,_))
+    .WillByDefault(DoAll(Invoke([this](Display*, Window, XWindowAttributes* attributes)
+                                {
+                                    *attributes = fake_x11.window_attributes;
+                                }),
+                         Return(1)));
+
+    ON_CALL(*this, XCreateGC(fake_x11.display,_,_,_))
+    .WillByDefault(Return(reinterpret_cast<GC>(0x9abc)));
 }
 
 mtd::MockX11::~MockX11()
@@ -282,3 +299,68 @@ extern "C" void XFixesShowCursor(Display *dpy, Window win)
 {
     global_mock->XFixesShowCursor(dpy, win);
 }
+
+Status XGetWindowAttributes(Display* display, Window w, XWindowAttributes* window_attributes_return)
+{
+    return global_mock->XGetWindowAttributes(display, w, window_attributes_return);
+}
+
+Bool XQueryExtension(Display* display, const char* name, int* major_opcode_return, int* first_event_return, int* first_error_return)
+{
+    return global_mock->XQueryExtension(display, name, major_opcode_return, first_event_return, first_error_return);
+}
+
+int XSync(Display* display, Bool discard)
+{
+    return global_mock->XSync(display, discard);
+}
+
+int XFlush(Display* display)
+{
+    return global_mock->XFlush(display);
+}
+
+GC XCreateGC(Display* display, Drawable d, unsigned long valuemask, XGCValues* values)
+{
+    return global_mock->XCreateGC(display, d, valuemask, values);
+}
+
+int XFreeGC(Display* display, GC gc)
+{
+    return global_mock->XFreeGC(display, gc);
+}
+
+XImage* XCreateImage(Display* display, Visual* visual, unsigned int depth, int format, int offset, char* data, unsigned int width, unsigned int height, int bitmap_pad, int bytes_per_line)
+{
+    return global_mock->XCreateImage(display, visual, depth, format, offset, data, width, height, bitmap_pad, bytes_per_line);
+}
+
+int XPutImage(Display* display, Drawable d, GC gc, XImage* image, int src_x, int src_y, int dest_x, int dest_y, unsigned int width, unsigned int height)
+{
+    return global_mock->XPutImage(display, d, gc, image, src_x, src_y, dest_x, dest_y, width, height);
+}
+
+Bool XShmQueryExtension(Display* display)
+{
+    return global_mock->XShmQueryExtension(display);
+}
+
+XImage* XShmCreateImage(Display* display, Visual* visual, unsigned int depth, int format, char* data, XShmSegmentInfo* shminfo, unsigned int width, unsigned int height)
+{
+    return global_mock->XShmCreateImage(display, visual, depth, format, data, shminfo, width, height);
+}
+
+Bool XShmAttach(Display* display, XShmSegmentInfo* shminfo)
+{
+    return global_mock->XShmAttach(display, shminfo);
+}
+
+Bool XShmDetach(Display* display, XShmSegmentInfo* shminfo)
+{
+    return global_mock->XShmDetach(display, shminfo);
+}
+
+Bool XShmPutImage(Display* display, Drawable d, GC gc, XImage* image, int src_x, int src_y, int dst_x, int dst_y, unsigned int src_width, unsigned int src_height, Bool /*send_event*/)
+{
+    return global_mock->XShmPutImage_wrapper(display, d, gc, image, src_x, src_y, dst_x, dst_y, src_width, src_height);
+}
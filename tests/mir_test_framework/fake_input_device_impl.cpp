@@ -238,11 +238,23 @@ void mtf::FakeInputDeviceImpl::InputDevice::synthesize_events(synthesis::TouchPa
     float abs_y = touch.abs_y;
     map_touch_coordinates(abs_x, abs_y);
 
+    std::vector<mir::events::ContactState> contacts{
+        {MirTouchId{1}, touch_action, mir_touch_tooltype_finger, abs_x, abs_y, 1.0f, 8.0f, 5.0f, 0.0f}};
+
+    for (auto const& position : touch.additional_contacts)
+    {
+        float x = position.x.as_int();
+        float y = position.y.as_int();
+        map_touch_coordinates(x, y);
+
+        contacts.push_back(
+            {MirTouchId{static_cast<int>(contacts.size()) + 1}, touch_action, mir_touch_tooltype_finger,
+             x, y, 1.0f, 8.0f, 5.0f, 0.0f});
+    }
+
     if (is_output_active())
     {
-        auto touch_event = builder->touch_event(
-            event_time,
-            {{MirTouchId{1}, touch_action, mir_touch_tooltype_finger, abs_x, abs_y, 1.0f, 8.0f, 5.0f, 0.0f}});
+        auto touch_event = builder->touch_event(event_time, contacts);
 
         sink->handle_input(std::move(touch_event));
     }
@@ -0,0 +1,783 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/doubles/stub_buffer.h"
+#include "src/server/compositor/buffer_mailbox.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace testing;
+namespace mtd = mir::test::doubles;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+namespace
+{
+struct BufferMailbox : Test
+{
+    BufferMailbox()
+    {
+        for(auto i = 0u; i < num_buffers; i++)
+            buffers.emplace_back(std::make_shared<mtd::StubBuffer>());
+    }
+
+    void submit(std::vector<std::shared_ptr<mg::Buffer>> const& submissions)
+    {
+        for (auto const& buffer : submissions)
+            mailbox.submit(buffer);
+    }
+
+    std::vector<std::shared_ptr<mg::Buffer>> drain(mc::CompositorID id)
+    {
+        std::vector<std::shared_ptr<mg::Buffer>> acquired;
+        while (mailbox.buffer_ready_for(id))
+            acquired.emplace_back(mailbox.compositor_acquire(id));
+        return acquired;
+    }
+
+    unsigned int const num_buffers{6u};
+    std::vector<std::shared_ptr<mg::Buffer>> buffers;
+    mc::BufferMailbox mailbox;
+};
+
+MATCHER_P(IsSameBufferAs, buffer, "")
+{
+    return buffer->id() == arg->id();
+}
+
+std::shared_ptr<mg::Buffer> wrap_with_destruction_notifier(
+    std::shared_ptr<mg::Buffer> const& buffer,
+    std::shared_ptr<bool> const& destroyed)
+{
+    class DestructionNotifyingBuffer : public mg::Buffer
+    {
+    public:
+        DestructionNotifyingBuffer(
+            std::shared_ptr<mg::Buffer> const& buffer,
+            std::shared_ptr<bool> const& destroyed)
+            : wrapped{buffer},
+              destroyed{destroyed}
+        {
+        }
+
+        ~DestructionNotifyingBuffer()
+        {
+            *destroyed = true;
+        }
+
+        std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+        {
+            return wrapped->native_buffer_handle();
+        }
+
+        mg::BufferID id() const override
+        {
+            return wrapped->id();
+        }
+
+        mir::geometry::Size size() const override
+        {
+            return wrapped->size();
+        }
+
+        MirPixelFormat pixel_format() const override
+        {
+            return wrapped->pixel_format();
+        }
+
+        mg::NativeBufferBase *native_buffer_base() override
+        {
+            return wrapped->native_buffer_base();
+        }
+
+    private:
+        std::shared_ptr<mg::Buffer> const wrapped;
+        std::shared_ptr<bool> const destroyed;
+    };
+
+    return std::make_shared<DestructionNotifyingBuffer>(buffer, destroyed);
+}
+}
+
+
+TEST_F(BufferMailbox, compositor_access_before_any_submission_throws)
+{
+    EXPECT_THROW({
+        mailbox.compositor_acquire(this);
+    }, std::logic_error);
+
+    submit({buffers[0]});
+
+    mailbox.compositor_acquire(this);
+}
+
+TEST_F(BufferMailbox, compositor_access)
+{
+    submit({buffers[0]});
+    auto cbuffer = mailbox.compositor_acquire(this);
+    EXPECT_THAT(cbuffer, IsSameBufferAs(buffers[0]));
+}
+
+TEST_F(BufferMailbox, compositor_release_sends_buffer_back)
+{
+    auto buffer_released = std::make_shared<bool>(false);
+    submit({wrap_with_destruction_notifier(buffers[0], buffer_released)});
+
+    auto cbuffer = mailbox.compositor_acquire(this);
+    submit({buffers[1]});
+    cbuffer.reset();
+    // We need to acquire a new buffer - the current one is on-screen, so can't be sent back.
+    mailbox.compositor_acquire(this);
+    EXPECT_TRUE(*buffer_released);
+}
+
+TEST_F(BufferMailbox, compositor_can_acquire_different_buffers)
+{
+    submit({buffers[0]});
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    submit({buffers[1]});
+    auto cbuffer2 = mailbox.compositor_acquire(this);
+    EXPECT_THAT(cbuffer1, Not(IsSameBufferAs(cbuffer2)));
+}
+
+TEST_F(BufferMailbox, compositor_buffer_syncs_to_fastest_compositor)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+
+    submit({buffers[0]});
+    auto cbuffer1 = mailbox.compositor_acquire(&comp_id1);
+    auto cbuffer2 = mailbox.compositor_acquire(&comp_id2);
+
+    submit({buffers[1]});
+    auto cbuffer3 = mailbox.compositor_acquire(&comp_id1);
+
+    submit({buffers[0]});
+    auto cbuffer4 = mailbox.compositor_acquire(&comp_id1);
+    auto cbuffer5 = mailbox.compositor_acquire(&comp_id2);
+
+    submit({buffers[1]});
+    auto cbuffer6 = mailbox.compositor_acquire(&comp_id2);
+    auto cbuffer7 = mailbox.compositor_acquire(&comp_id2);
+
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer2, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer3, IsSameBufferAs(buffers[1]));
+    EXPECT_THAT(cbuffer4, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer5, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer6, IsSameBufferAs(buffers[1]));
+    EXPECT_THAT(cbuffer7, IsSameBufferAs(buffers[1]));
+}
+
+TEST_F(BufferMailbox, compositor_consumes_all_buffers_in_order_when_queueing)
+{
+    submit({buffers[0], buffers[1], buffers[2], buffers[3], buffers[4]});
+
+    EXPECT_THAT(drain(this), ElementsAre(buffers[0], buffers[1], buffers[2], buffers[3], buffers[4]));
+}
+
+TEST_F(BufferMailbox, compositor_consumes_all_buffers_when_operating_as_a_bypassed_buffer_would)
+{
+    submit({buffers[0], buffers[1], buffers[2], buffers[3], buffers[4]});
+
+    // A bypassed buffer stays on screen until the next one is acquired
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    auto cbuffer2 = mailbox.compositor_acquire(this);
+    auto id1 = cbuffer1->id();
+    cbuffer1.reset();
+
+    auto cbuffer3 = mailbox.compositor_acquire(this);
+    auto id2 = cbuffer2->id();
+    cbuffer2.reset();
+
+    auto cbuffer4 = mailbox.compositor_acquire(this);
+    auto id3 = cbuffer3->id();
+    cbuffer3.reset();
+
+    auto cbuffer5 = mailbox.compositor_acquire(this);
+    auto id4 = cbuffer4->id();
+    cbuffer4.reset();
+    auto id5 = cbuffer5->id();
+    cbuffer5.reset();
+
+    EXPECT_THAT(id1, Eq(buffers[0]->id()));
+    EXPECT_THAT(id2, Eq(buffers[1]->id()));
+    EXPECT_THAT(id3, Eq(buffers[2]->id()));
+    EXPECT_THAT(id4, Eq(buffers[3]->id()));
+    EXPECT_THAT(id5, Eq(buffers[4]->id()));
+}
+
+TEST_F(BufferMailbox, multimonitor_compositor_buffer_syncs_to_fastest_with_more_queueing)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+
+    submit({buffers[0], buffers[1], buffers[2], buffers[3], buffers[4]});
+
+    auto cbuffer1 = mailbox.compositor_acquire(&comp_id1); //buffer[0]
+    auto cbuffer2 = mailbox.compositor_acquire(&comp_id2); //buffer[0]
+
+    auto cbuffer3 = mailbox.compositor_acquire(&comp_id1); //buffer[1]
+
+    auto cbuffer4 = mailbox.compositor_acquire(&comp_id1); //buffer[2]
+    auto cbuffer5 = mailbox.compositor_acquire(&comp_id2); //buffer[2]
+
+    auto cbuffer6 = mailbox.compositor_acquire(&comp_id2); //buffer[3]
+
+    auto cbuffer7 = mailbox.compositor_acquire(&comp_id2); //buffer[4]
+    auto cbuffer8 = mailbox.compositor_acquire(&comp_id1); //buffer[4]
+
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer2, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer3, IsSameBufferAs(buffers[1]));
+    EXPECT_THAT(cbuffer4, IsSameBufferAs(buffers[2]));
+    EXPECT_THAT(cbuffer5, IsSameBufferAs(buffers[2]));
+    EXPECT_THAT(cbuffer6, IsSameBufferAs(buffers[3]));
+    EXPECT_THAT(cbuffer7, IsSameBufferAs(buffers[4]));
+    EXPECT_THAT(cbuffer8, IsSameBufferAs(buffers[4]));
+}
+
+TEST_F(BufferMailbox, resubmitting_a_queued_buffer_moves_it_to_the_back_of_the_queue)
+{
+    submit({buffers[0], buffers[1], buffers[2], buffers[3], buffers[4], buffers[0]});
+
+    EXPECT_THAT(drain(this), ElementsAre(buffers[1], buffers[2], buffers[3], buffers[4], buffers[0]));
+}
+
+TEST_F(BufferMailbox, resubmitting_the_current_buffer_queues_it_again)
+{
+    submit({buffers[0]});
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    submit({buffers[1], buffers[0]});
+
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(drain(this), ElementsAre(buffers[1], buffers[0]));
+}
+
+TEST_F(BufferMailbox, drops_all_but_the_newest_buffer_when_dropping)
+{
+    mailbox.set_dropping(true);
+    submit({buffers[0], buffers[1], buffers[2], buffers[3], buffers[4]});
+
+    auto acquired = drain(this);
+    ASSERT_THAT(acquired, SizeIs(1));
+    EXPECT_THAT(acquired[0], IsSameBufferAs(buffers[4]));
+    acquired.clear();
+
+    for (int i = 0; i < 4 ; ++i)
+    {
+        EXPECT_TRUE(buffers[i].unique());
+    }
+}
+
+TEST_F(BufferMailbox, dropping_keeps_the_current_buffer_for_slower_compositors)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+    mailbox.set_dropping(true);
+
+    submit({buffers[0]});
+    auto cbuffer1 = mailbox.compositor_acquire(&comp_id1);
+    submit({buffers[1], buffers[2]});
+    auto cbuffer2 = mailbox.compositor_acquire(&comp_id2);
+    auto cbuffer3 = mailbox.compositor_acquire(&comp_id1);
+
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer2, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(cbuffer3, IsSameBufferAs(buffers[2]));
+    EXPECT_TRUE(buffers[1].unique());
+}
+
+TEST_F(BufferMailbox, submitting_the_same_buffer_many_times_when_dropping_doesnt_drop_it)
+{
+    mailbox.set_dropping(true);
+    submit({buffers[2], buffers[2], buffers[2]});
+
+    auto acquired = drain(this);
+    ASSERT_THAT(acquired, SizeIs(1));
+    EXPECT_THAT(acquired[0], IsSameBufferAs(buffers[2]));
+}
+
+TEST_F(BufferMailbox, switching_to_dropping_discards_queued_buffers_but_the_newest)
+{
+    submit({buffers[0], buffers[1], buffers[2]});
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+
+    mailbox.set_dropping(true);
+
+    EXPECT_TRUE(mailbox.dropping());
+    EXPECT_TRUE(buffers[1].unique());
+    EXPECT_THAT(drain(this), ElementsAre(buffers[2]));
+}
+
+TEST_F(BufferMailbox, queue_is_bounded_when_compositors_fall_behind)
+{
+    auto const submissions = 100u;
+    for (auto i = 0u; i < submissions; i++)
+        submit({std::make_shared<mtd::StubBuffer>()});
+    auto const newest = std::make_shared<mtd::StubBuffer>();
+    submit({newest});
+
+    auto const acquired = drain(this);
+    EXPECT_THAT(acquired.size(), Lt(submissions));
+    ASSERT_THAT(acquired, Not(IsEmpty()));
+    EXPECT_THAT(acquired.back(), IsSameBufferAs(newest));
+}
+
+TEST_F(BufferMailbox, queueing_holds_sixteen_frames_and_drops_the_oldest)
+{
+    std::vector<std::shared_ptr<mg::Buffer>> submitted;
+    for (auto i = 0; i < 20; i++)
+        submitted.emplace_back(std::make_shared<mtd::StubBuffer>());
+    submit(submitted);
+
+    auto const acquired = drain(this);
+
+    ASSERT_THAT(acquired, SizeIs(16));
+    EXPECT_THAT(acquired, ElementsAreArray(submitted.end() - 16, submitted.end()));
+    for (auto i = 0; i < 4; i++)
+        EXPECT_TRUE(submitted[i].unique());
+}
+
+TEST_F(BufferMailbox, basic_snapshot_equals_compositor_buffer)
+{
+    submit({buffers[3], buffers[4]});
+
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    auto sbuffer1 = mailbox.snapshot_acquire();
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(sbuffer1));
+}
+
+TEST_F(BufferMailbox, basic_snapshot_equals_latest_compositor_buffer)
+{
+    submit({buffers[3], buffers[4]});
+    int that = 4;
+
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    auto cbuffer2 = mailbox.compositor_acquire(&that);
+    auto sbuffer1 = mailbox.snapshot_acquire();
+    cbuffer2.reset();
+    cbuffer2 = mailbox.compositor_acquire(&that);
+
+    auto sbuffer2 = mailbox.snapshot_acquire();
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(sbuffer1));
+    EXPECT_THAT(cbuffer2, IsSameBufferAs(sbuffer2));
+}
+
+TEST_F(BufferMailbox, snapshot_cycling_doesnt_advance_buffer_for_compositors)
+{
+    submit({buffers[3], buffers[4]});
+    auto that = 4;
+    auto a_few_times = 5u;
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    std::vector<mg::BufferID> snapshot_buffers(a_few_times);
+    for(auto i = 0u; i < a_few_times; i++)
+    {
+        snapshot_buffers[i] = mailbox.snapshot_acquire()->id();
+    }
+    auto cbuffer2 = mailbox.compositor_acquire(&that);
+
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(cbuffer2));
+    EXPECT_THAT(snapshot_buffers, Each(Eq(cbuffer1->id())));
+}
+
+TEST_F(BufferMailbox, no_buffers_available_throws_on_snapshot)
+{
+    EXPECT_THROW({
+        mailbox.snapshot_acquire();
+    }, std::logic_error);
+}
+
+TEST_F(BufferMailbox, snapshotting_will_release_buffer_if_it_was_the_last_owner)
+{
+    auto buffer_released = std::make_shared<bool>(false);
+    submit({wrap_with_destruction_notifier(buffers[3], buffer_released), buffers[4]});
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    auto sbuffer1 = mailbox.snapshot_acquire();
+    cbuffer1.reset();
+
+    // Acquire a new buffer so first one is no longer onscreen.
+    mailbox.compositor_acquire(this);
+
+    EXPECT_FALSE(*buffer_released);
+    sbuffer1.reset();
+    EXPECT_TRUE(*buffer_released);
+}
+
+TEST_F(BufferMailbox, compositor_can_acquire_a_few_times_and_only_sends_on_the_last_release)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+
+    auto buffer_released = std::make_shared<bool>(false);
+    submit({wrap_with_destruction_notifier(buffers[0], buffer_released), buffers[1]});
+    auto cbuffer1 = mailbox.compositor_acquire(&comp_id1);
+    auto cbuffer2 = mailbox.compositor_acquire(&comp_id2);
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(cbuffer2));
+
+    auto cbuffer3 = mailbox.compositor_acquire(&comp_id1);
+    EXPECT_FALSE(*buffer_released);
+    cbuffer1.reset();
+    cbuffer2.reset();
+    EXPECT_TRUE(*buffer_released);
+}
+
+TEST_F(BufferMailbox, advance_on_fastest_has_same_buffer)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+    submit({buffers[0], buffers[1]});
+
+    auto id1 = mailbox.compositor_acquire(&comp_id1)->id(); //buffer[0]
+    auto id2 = mailbox.compositor_acquire(&comp_id2)->id(); //buffer[0]
+
+    auto cbuffer3 = mailbox.compositor_acquire(&comp_id1); //buffer[1]
+
+    EXPECT_THAT(id1, Eq(id2));
+    EXPECT_THAT(id1, Eq(buffers[0]->id()));
+    EXPECT_THAT(cbuffer3, IsSameBufferAs(buffers[1]));
+}
+
+TEST_F(BufferMailbox, buffers_are_sent_back)
+{
+    std::array<std::shared_ptr<bool>, 3> buffer_released = {
+        {
+            std::make_shared<bool>(false),
+            std::make_shared<bool>(false),
+            std::make_shared<bool>(false)
+        }};
+    int comp_id1{0};
+    int comp_id2{0};
+
+    submit(
+        {
+            wrap_with_destruction_notifier(buffers[0], buffer_released[0]),
+            wrap_with_destruction_notifier(buffers[1], buffer_released[1]),
+            wrap_with_destruction_notifier(buffers[2], buffer_released[2]),
+            buffers[3]
+        });
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+    b1.reset();
+    auto b2 = mailbox.compositor_acquire(&comp_id1);
+    b2.reset();
+    auto b3 = mailbox.compositor_acquire(&comp_id1);
+    auto b5 = mailbox.compositor_acquire(&comp_id2);
+    b3.reset();
+    auto b4 = mailbox.compositor_acquire(&comp_id1);
+    b5.reset();
+    b4.reset();
+    auto b6 = mailbox.compositor_acquire(&comp_id1);
+    b6.reset();
+
+    EXPECT_THAT(buffer_released, Each(Pointee(true)));
+}
+
+TEST_F(BufferMailbox, can_check_if_buffers_are_ready)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+    submit({buffers[3]});
+
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id2));
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id2));
+    b1.reset();
+
+    auto b2 = mailbox.compositor_acquire(&comp_id2);
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id2));
+}
+
+TEST_F(BufferMailbox, other_compositor_ready_status_advances_with_fastest_compositor)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+    submit({buffers[0], buffers[1], buffers[2]});
+
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id2));
+
+    mailbox.compositor_acquire(&comp_id1);
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id2));
+
+    mailbox.compositor_acquire(&comp_id1);
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id2));
+
+    mailbox.compositor_acquire(&comp_id1);
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_TRUE(mailbox.buffer_ready_for(&comp_id2));
+
+    mailbox.compositor_acquire(&comp_id2);
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id1));
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id2));
+}
+
+TEST_F(BufferMailbox, will_release_buffer_in_nbuffers_2_overlay_scenario)
+{
+    int comp_id1{0};
+    auto buffer_released = std::make_shared<bool>(false);
+    auto notifying_buffer = wrap_with_destruction_notifier(buffers[0], buffer_released);
+    submit({notifying_buffer, buffers[1]});
+    notifying_buffer.reset();
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+    auto b2 = mailbox.compositor_acquire(&comp_id1);
+    EXPECT_THAT(b1, IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(b2, IsSameBufferAs(buffers[1]));
+    b1.reset();
+    b2.reset();
+
+    EXPECT_TRUE(*buffer_released);
+}
+
+TEST_F(BufferMailbox, will_release_buffer_in_nbuffers_2_starvation_scenario)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+
+    // With two buffers a client can only submit one again once the compositors let go of it
+    submit({buffers[0], buffers[1]});
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+    auto id1 = b1->id();
+    auto b2 = mailbox.compositor_acquire(&comp_id1);
+    auto id2 = b2->id();
+
+    b1.reset();
+    submit({buffers[0]});
+
+    auto b3 = mailbox.compositor_acquire(&comp_id2);
+    auto id3 = b3->id();
+    auto b4 = mailbox.compositor_acquire(&comp_id2);
+    auto id4 = b4->id();
+
+    b3.reset();
+
+    b2.reset();
+    b4.reset();
+
+    EXPECT_THAT(id1, Eq(buffers[0]->id()));
+    EXPECT_THAT(id2, Eq(buffers[1]->id()));
+    EXPECT_THAT(id3, Eq(buffers[1]->id()));
+    EXPECT_THAT(id4, Eq(buffers[0]->id()));
+}
+
+TEST_F(BufferMailbox, will_ensure_smooth_monitor_production)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+
+    submit({buffers[0], buffers[1], buffers[2]});
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+    auto id1 = b1->id();
+    auto b2 = mailbox.compositor_acquire(&comp_id2);
+    auto id2 = b2->id();
+    b1.reset();
+
+    auto b3 = mailbox.compositor_acquire(&comp_id1);
+    auto id3 = b3->id();
+    b3.reset();
+
+    auto b4 = mailbox.compositor_acquire(&comp_id2);
+    auto id4 = b4->id();
+    b2.reset();
+
+    auto b5 = mailbox.compositor_acquire(&comp_id1);
+
+    EXPECT_THAT(id1, Eq(buffers[0]->id()));
+    EXPECT_THAT(id2, Eq(buffers[0]->id()));
+    EXPECT_THAT(id3, Eq(buffers[1]->id()));
+    EXPECT_THAT(id4, Eq(buffers[1]->id()));
+    EXPECT_THAT(b5, IsSameBufferAs(buffers[2]));
+}
+
+TEST_F(BufferMailbox, can_drop_old_buffers)
+{
+    int comp_id1{0};
+    int comp_id2{0};
+    submit({buffers[0], buffers[1], buffers[2]});
+
+    mailbox.drop_old_buffers();
+
+    EXPECT_TRUE(buffers[0].unique());
+    EXPECT_TRUE(buffers[1].unique());
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+    auto b2 = mailbox.compositor_acquire(&comp_id2);
+    EXPECT_THAT(b1, IsSameBufferAs(buffers[2]));
+    EXPECT_THAT(b2, IsSameBufferAs(buffers[2]));
+    EXPECT_FALSE(mailbox.buffer_ready_for(&comp_id1));
+}
+
+TEST_F(BufferMailbox, checks_if_buffer_is_valid_after_dropping_old_buffers)
+{
+    int comp_id1{0};
+
+    submit({buffers[0], buffers[1], buffers[2], buffers[3]});
+
+    mailbox.drop_old_buffers();
+
+    auto b1 = mailbox.compositor_acquire(&comp_id1);
+
+    EXPECT_THAT(b1->id(), Eq(buffers[3]->id()));
+    EXPECT_THAT(b1->size(), Eq(buffers[3]->size()));
+}
+
+TEST_F(BufferMailbox, releases_buffer_on_destruction)
+{
+    auto buffer_released = std::make_shared<bool>(false);
+
+    {
+        mc::BufferMailbox mailbox;
+        mailbox.submit(wrap_with_destruction_notifier(buffers[0], buffer_released));
+        mailbox.compositor_acquire(this);
+    }
+    EXPECT_TRUE(*buffer_released);
+}
+
+TEST_F(BufferMailbox, acquires_buffer_after_queue_runs_out_and_is_refilled)
+{
+    submit({buffers[0]});
+    auto cbuffer1 = mailbox.compositor_acquire(this);
+    auto cbuffer2 = mailbox.compositor_acquire(this);
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(cbuffer2));
+    submit({buffers[1]});
+    auto cbuffer3 = mailbox.compositor_acquire(this);
+    EXPECT_THAT(cbuffer2, Not(IsSameBufferAs(cbuffer3)));
+}
+
+TEST_F(BufferMailbox, second_compositor_advances_after_both_acquire_first_buffer)
+{
+    int comp_id1{0};
+    int comp_id2{1};
+
+    submit({buffers[0]});
+    auto cbuffer1 = mailbox.compositor_acquire(&comp_id1);
+    auto cbuffer2 = mailbox.compositor_acquire(&comp_id2);
+    auto cbuffer3 = mailbox.compositor_acquire(&comp_id1);
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(cbuffer2));
+    EXPECT_THAT(cbuffer1, IsSameBufferAs(cbuffer3));
+    submit({buffers[1]});
+    auto cbuffer4 = mailbox.compositor_acquire(&comp_id2);
+    EXPECT_THAT(cbuffer1, Not(IsSameBufferAs(cbuffer4)));
+}
+
+TEST_F(BufferMailbox, handles_more_compositors_than_it_tracks)
+{
+    std::vector<int> compositors(40);
+    submit({buffers[0]});
+
+    for (auto& id : compositors)
+        EXPECT_THAT(mailbox.compositor_acquire(&id), IsSameBufferAs(buffers[0]));
+
+    // A compositor the mailbox has forgotten may be shown the current buffer again, but no more than that
+    submit({buffers[1]});
+    for (auto& id : compositors)
+    {
+        mailbox.compositor_acquire(&id);
+        EXPECT_THAT(mailbox.compositor_acquire(&id), IsSameBufferAs(buffers[1]));
+    }
+}
+
+TEST_F(BufferMailbox, compositors_that_went_away_give_up_their_entries)
+{
+    int steady_id{0};
+    std::vector<int> transient_ids(16);
+
+    for (auto frame = 0u; frame != transient_ids.size(); ++frame)
+    {
+        submit({buffers[frame % num_buffers]});
+
+        ASSERT_THAT(mailbox.compositor_acquire(&steady_id), IsSameBufferAs(buffers[frame % num_buffers]));
+
+        // Each compositor shows one frame and goes away, filling another entry
+        EXPECT_THAT(mailbox.compositor_acquire(&transient_ids[frame]), IsSameBufferAs(buffers[frame % num_buffers]));
+
+        // The compositor that stays is never mistaken for one that hasn't seen the frame
+        EXPECT_FALSE(mailbox.buffer_ready_for(&steady_id)) << "frame " << frame;
+        EXPECT_FALSE(mailbox.buffer_ready_for(&transient_ids[frame])) << "frame " << frame;
+    }
+}
+
+TEST_F(BufferMailbox, concurrent_compositors_each_get_their_own_entry)
+{
+    submit({buffers[0]});
+
+    std::vector<int> ids(16);
+    std::vector<std::thread> compositors;
+    for (auto& id : ids)
+        compositors.emplace_back([&] { mailbox.compositor_acquire(&id); });
+
+    for (auto& compositor : compositors)
+        compositor.join();
+
+    for (auto& id : ids)
+        EXPECT_FALSE(mailbox.buffer_ready_for(&id));
+}
+
+TEST_F(BufferMailbox, concurrent_submissions_and_acquisitions_only_see_submitted_buffers)
+{
+    auto const iterations = 20000;
+    std::atomic<bool> done{false};
+    std::atomic<int> unexpected{0};
+
+    submit({buffers[0]});
+
+    auto const compositor = [&](int)
+        {
+            int id{0};
+            while (!done)
+            {
+                auto const buffer = mailbox.compositor_acquire(&id);
+                if (std::find(buffers.begin(), buffers.end(), buffer) == buffers.end())
+                    ++unexpected;
+                mailbox.buffer_ready_for(&id);
+                mailbox.snapshot_acquire();
+            }
+        };
+
+    std::thread compositor1{compositor, 1};
+    std::thread compositor2{compositor, 2};
+
+    for (auto i = 0; i < iterations; i++)
+    {
+        mailbox.submit(buffers[i % num_buffers]);
+        if (i % 1000 == 0)
+            mailbox.set_dropping(!mailbox.dropping());
+        if (i % 777 == 0)
+            mailbox.drop_old_buffers();
+    }
+
+    done = true;
+    compositor1.join();
+    compositor2.join();
+
+    EXPECT_THAT(unexpected, Eq(0));
+    mailbox.drop_old_buffers();
+    EXPECT_THAT(mailbox.compositor_acquire(this), IsSameBufferAs(buffers[(iterations - 1) % num_buffers]));
+}
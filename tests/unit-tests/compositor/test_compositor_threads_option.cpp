@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/options/default_configuration.h"
+#include "mir/abnormal_exit.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+namespace mo = mir::options;
+
+using namespace testing;
+
+namespace
+{
+auto compositor_threads_from(std::vector<char const*> args) -> int
+{
+    args.insert(args.begin(), "mir_unit_tests");
+    std::shared_ptr<mo::Configuration> const config =
+        std::make_shared<mo::DefaultConfiguration>(static_cast<int>(args.size()), args.data());
+    return config->the_options()->get<int>(mo::compositor_threads_opt);
+}
+}
+
+TEST(CompositorThreadsOption, defaults_to_automatic)
+{
+    EXPECT_THAT(compositor_threads_from({}), Eq(-1));
+}
+
+TEST(CompositorThreadsOption, takes_an_explicit_count)
+{
+    EXPECT_THAT(compositor_threads_from({"--compositor-threads", "3"}), Eq(3));
+    EXPECT_THAT(compositor_threads_from({"--compositor-threads=16"}), Eq(16));
+}
+
+TEST(CompositorThreadsOption, takes_zero_for_no_additional_threads)
+{
+    EXPECT_THAT(compositor_threads_from({"--compositor-threads", "0"}), Eq(0));
+}
+
+// Any negative value means automatic, not only the default
+TEST(CompositorThreadsOption, accepts_other_negative_values)
+{
+    EXPECT_THAT(compositor_threads_from({"--compositor-threads=-4"}), Eq(-4));
+}
+
+TEST(CompositorThreadsOption, rejects_values_that_are_not_integers)
+{
+    EXPECT_THROW(compositor_threads_from({"--compositor-threads", "many"}), mir::AbnormalExit);
+    EXPECT_THROW(compositor_threads_from({"--compositor-threads", "1.5"}), mir::AbnormalExit);
+    EXPECT_THROW(compositor_threads_from({"--compositor-threads", ""}), mir::AbnormalExit);
+}
+
+TEST(CompositorThreadsOption, rejects_a_missing_value)
+{
+    EXPECT_THROW(compositor_threads_from({"--compositor-threads"}), mir::AbnormalExit);
+}
@@ -23,6 +23,7 @@
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/compositor/presentation_observer.h"
 #include "mir/scene/observer.h"
 #include "mir/raii.h"
 
@@ -38,10 +39,12 @@
 
 #include <boost/throw_exception.hpp>
 
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 
 #include <gmock/gmock.h>
@@ -75,6 +78,16 @@ public:
             f(db.buffer);
     }
 
+    mg::DisplaySyncGroup* group(unsigned int index)
+    {
+        return &buffers[index];
+    }
+
+    void add_group()
+    {
+        buffers.emplace_back();
+    }
+
 private:
     struct StubDisplaySyncGroup : mg::DisplaySyncGroup
     {
@@ -90,7 +103,7 @@ private:
         testing::NiceMock<mtd::MockDisplayBuffer> buffer; 
     };
 
-    std::vector<StubDisplaySyncGroup> buffers;
+    std::deque<StubDisplaySyncGroup> buffers;
 };
 
 class StubScene : public mtd::StubScene
@@ -871,6 +884,81 @@ TEST(MultiThreadedCompositor, registers_and_unregisters_with_scene)
     compositor.stop();
 }
 
+TEST(MultiThreadedCompositor, stopping_compositing_of_some_groups_leaves_the_others_running)
+{
+    using namespace testing;
+    unsigned int const nbuffers{3};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+    auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
+
+    mc::MultiThreadedCompositor compositor{
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+
+    compositor.start();
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_))
+        .Times(1);
+
+    compositor.stop_compositing({display->group(1)});
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_))
+        .Times(nbuffers - 1);
+
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, starts_compositing_only_groups_not_already_composited)
+{
+    using namespace testing;
+    unsigned int const nbuffers{2};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+    auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
+
+    mc::MultiThreadedCompositor compositor{
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+
+    EXPECT_CALL(*mock_scene, register_compositor(_))
+        .Times(nbuffers);
+
+    compositor.start();
+    compositor.start_compositing_new_groups();
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, register_compositor(_))
+        .Times(1);
+
+    display->add_group();
+    compositor.start_compositing_new_groups();
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_))
+        .Times(nbuffers + 1);
+
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, does_not_start_new_groups_while_stopped)
+{
+    using namespace testing;
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(1);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+    auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
+
+    mc::MultiThreadedCompositor compositor{
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+
+    EXPECT_CALL(*mock_scene, register_compositor(_))
+        .Times(0);
+
+    compositor.start_compositing_new_groups();
+}
+
 TEST(MultiThreadedCompositor, notifies_about_display_additions_and_removals)
 {
     using namespace testing;
@@ -948,3 +1036,164 @@ TEST(MultiThreadedCompositor, can_schedule_from_display_observer_when_removing_d
         display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
     compositor.start();
 }
+
+namespace
+{
+class PresentingDisplay : public mtd::NullDisplay
+{
+public:
+    PresentingDisplay(bool timed) : group{timed} {}
+
+    void for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f) override
+    {
+        f(group);
+    }
+
+private:
+    struct TimedDisplaySyncGroup : mg::DisplaySyncGroup
+    {
+        TimedDisplaySyncGroup(bool timed) : timed{timed} {}
+
+        void for_each_display_buffer(std::function<void(mg::DisplayBuffer&)> const& f) override
+        {
+            f(buffer);
+        }
+        void post() override
+        {
+            ++msc;
+            if (auto const presented = std::move(handler))
+                presented(mg::Frame{msc, mg::Frame::Timestamp{CLOCK_MONOTONIC, msc * 16ms}});
+            handler = nullptr;
+        }
+        std::chrono::milliseconds recommended_sleep() const override
+        {
+            return std::chrono::milliseconds::zero();
+        }
+        bool notify_next_presentation(mg::PresentationHandler const& handler) override
+        {
+            if (timed)
+                this->handler = handler;
+            return timed;
+        }
+
+        bool const timed;
+        int64_t msc{0};
+        mg::PresentationHandler handler;
+        testing::NiceMock<mtd::MockDisplayBuffer> buffer;
+    };
+
+    TimedDisplaySyncGroup group;
+};
+
+struct ComposingDisplayBufferCompositor : mc::DisplayBufferCompositor
+{
+    void composite(mc::SceneElementSequence&&) override {}
+
+    Composition last_composition() const override
+    {
+        return {{mg::BufferID{7}}, false};
+    }
+};
+
+struct ComposingDisplayBufferCompositorFactory : mc::DisplayBufferCompositorFactory
+{
+    std::unique_ptr<mc::DisplayBufferCompositor> create_compositor_for(mg::DisplayBuffer&) override
+    {
+        return std::make_unique<ComposingDisplayBufferCompositor>();
+    }
+};
+
+struct Presentation
+{
+    std::vector<mg::BufferID> buffers;
+    mg::Frame frame;
+    std::chrono::nanoseconds refresh;
+    uint32_t flags;
+};
+
+class RecordingPresentationObserver : public mc::PresentationObserver
+{
+public:
+    void frame_presented(
+        std::vector<mg::BufferID> const& buffers,
+        mg::Frame const& frame,
+        std::chrono::nanoseconds refresh,
+        uint32_t flags) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        presentations.push_back({buffers, frame, refresh, flags});
+        cv.notify_all();
+    }
+
+    auto wait_for(size_t count, std::chrono::milliseconds timeout = 10s) -> std::vector<Presentation>
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait_for(lock, timeout, [&]{ return presentations.size() >= count; });
+        return presentations;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Presentation> presentations;
+};
+}
+
+TEST(MultiThreadedCompositor, reports_hardware_timed_presentation_of_composited_buffers)
+{
+    using namespace testing;
+    auto scene = std::make_shared<StubScene>();
+    auto observer = std::make_shared<RecordingPresentationObserver>();
+
+    mc::MultiThreadedCompositor compositor{
+        std::make_shared<PresentingDisplay>(true),
+        scene,
+        std::make_shared<ComposingDisplayBufferCompositorFactory>(),
+        null_display_listener,
+        null_report,
+        default_delay,
+        true,
+        observer};
+    compositor.start();
+
+    std::vector<Presentation> presentations;
+    while ((presentations = observer->wait_for(2, 10ms)).size() < 2)
+        scene->emit_change_event();
+    compositor.stop();
+
+    ASSERT_THAT(presentations.size(), Ge(2u));
+    uint32_t const hardware_timed =
+        mc::PresentationObserver::vsync | mc::PresentationObserver::hw_clock | mc::PresentationObserver::hw_completion;
+    EXPECT_THAT(presentations[0].buffers, ElementsAre(mg::BufferID{7}));
+    EXPECT_THAT(presentations[0].frame.msc, Eq(1));
+    EXPECT_THAT(presentations[0].flags, Eq(hardware_timed));
+    EXPECT_THAT(presentations[1].frame.msc, Eq(2));
+    EXPECT_THAT(presentations[1].refresh, Eq(16ms));
+}
+
+TEST(MultiThreadedCompositor, reports_untimed_presentation_after_post_when_platform_cannot_time_it)
+{
+    using namespace testing;
+    auto scene = std::make_shared<StubScene>();
+    auto observer = std::make_shared<RecordingPresentationObserver>();
+
+    mc::MultiThreadedCompositor compositor{
+        std::make_shared<PresentingDisplay>(false),
+        scene,
+        std::make_shared<ComposingDisplayBufferCompositorFactory>(),
+        null_display_listener,
+        null_report,
+        default_delay,
+        true,
+        observer};
+    compositor.start();
+
+    auto const presentations = observer->wait_for(1);
+    compositor.stop();
+
+    ASSERT_THAT(presentations.size(), Ge(1u));
+    EXPECT_THAT(presentations[0].buffers, ElementsAre(mg::BufferID{7}));
+    EXPECT_THAT(presentations[0].frame.msc, Eq(0));
+    EXPECT_THAT(presentations[0].refresh, Eq(0ns));
+    EXPECT_THAT(presentations[0].flags, Eq(0u));
+}
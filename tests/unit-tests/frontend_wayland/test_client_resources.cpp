@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/client_resources.h"
+#include "mir/logging/logger.h"
+#include "mir/logging/dumb_console_logger.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <stdexcept>
+
+namespace mf = mir::frontend;
+namespace ml = mir::logging;
+
+using namespace testing;
+using Resource = mf::ClientResources::Resource;
+
+namespace
+{
+struct MockLogger : ml::Logger
+{
+    MOCK_METHOD3(log, void (ml::Severity severity, const std::string& message, const std::string& component));
+};
+
+struct ClientResourcesWarnings : Test
+{
+    std::shared_ptr<MockLogger> const mock_logger{std::make_shared<NiceMock<MockLogger>>()};
+
+    void SetUp() override
+    {
+        ml::set_logger(mock_logger);
+    }
+
+    void TearDown() override
+    {
+        ml::set_logger(std::make_shared<ml::DumbConsoleLogger>());
+    }
+};
+}
+
+TEST(ResourceQuota, parses_soft_limit_alone)
+{
+    auto const quota = mf::parse_resource_quota("10");
+
+    EXPECT_THAT(quota.soft, Eq(10u));
+    EXPECT_THAT(quota.hard, Eq(0u));
+}
+
+TEST(ResourceQuota, parses_soft_and_hard_limits_in_units)
+{
+    auto const quota = mf::parse_resource_quota("10:20", 1024);
+
+    EXPECT_THAT(quota.soft, Eq(10u * 1024));
+    EXPECT_THAT(quota.hard, Eq(20u * 1024));
+}
+
+TEST(ResourceQuota, rejects_malformed_quotas)
+{
+    EXPECT_THROW(mf::parse_resource_quota(""), std::runtime_error);
+    EXPECT_THROW(mf::parse_resource_quota("ten"), std::runtime_error);
+    EXPECT_THROW(mf::parse_resource_quota("10:"), std::runtime_error);
+    EXPECT_THROW(mf::parse_resource_quota("-1"), std::runtime_error);
+    EXPECT_THROW(mf::parse_resource_quota("20:10"), std::runtime_error);
+}
+
+TEST(ClientResources, zero_quotas_are_unlimited)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {0, 0}, {0, 0}}};
+
+    EXPECT_TRUE(resources.charge(Resource::surfaces, 1000000));
+    EXPECT_THAT(resources.usage(Resource::surfaces), Eq(1000000u));
+}
+
+TEST(ClientResources, exceeding_soft_quota_still_charges)
+{
+    mf::ClientResources resources{nullptr, 0, {{1, 0}, {0, 0}, {0, 0}}};
+
+    EXPECT_TRUE(resources.charge(Resource::surfaces, 2));
+    EXPECT_THAT(resources.usage(Resource::surfaces), Eq(2u));
+}
+
+TEST(ClientResources, charge_over_hard_quota_fails_without_charging)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {0, 0}, {0, 3}}};
+
+    EXPECT_TRUE(resources.charge(Resource::frame_callbacks, 3));
+    EXPECT_FALSE(resources.charge(Resource::frame_callbacks, 1));
+    EXPECT_THAT(resources.usage(Resource::frame_callbacks), Eq(3u));
+}
+
+TEST(ClientResources, released_resources_can_be_charged_again)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 2}, {0, 0}, {0, 0}}};
+
+    ASSERT_TRUE(resources.charge(Resource::surfaces, 2));
+    resources.release(Resource::surfaces, 1);
+
+    EXPECT_TRUE(resources.charge(Resource::surfaces, 1));
+}
+
+TEST(ClientResources, shm_and_hardware_buffers_share_memory_quota)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {0, 100}, {0, 0}}};
+
+    ASSERT_TRUE(resources.charge(Resource::shm_buffer_memory, 60));
+
+    EXPECT_FALSE(resources.charge(Resource::hardware_buffer_memory, 60));
+    EXPECT_TRUE(resources.charge(Resource::hardware_buffer_memory, 40));
+    EXPECT_THAT(resources.usage(Resource::shm_buffer_memory), Eq(60u));
+    EXPECT_THAT(resources.usage(Resource::hardware_buffer_memory), Eq(40u));
+}
+
+TEST(ClientResources, releasing_more_than_charged_leaves_no_usage)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {0, 0}, {0, 0}}};
+
+    resources.charge(Resource::shm_buffer_memory, 10);
+    resources.release(Resource::shm_buffer_memory, 20);
+
+    EXPECT_THAT(resources.usage(Resource::shm_buffer_memory), Eq(0u));
+}
+
+TEST(ClientResources, failed_replace_charge_keeps_old_charge)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {0, 100}, {0, 0}}};
+
+    ASSERT_TRUE(resources.charge(Resource::shm_buffer_memory, 60));
+
+    EXPECT_FALSE(resources.replace_charge(Resource::shm_buffer_memory, 60, Resource::hardware_buffer_memory, 120));
+    EXPECT_THAT(resources.usage(Resource::shm_buffer_memory), Eq(60u));
+    EXPECT_THAT(resources.usage(Resource::hardware_buffer_memory), Eq(0u));
+}
+
+TEST_F(ClientResourcesWarnings, recharging_same_amount_over_soft_quota_warns_once)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {100, 0}, {0, 0}}};
+
+    EXPECT_CALL(*mock_logger, log(ml::Severity::warning, HasSubstr("soft quota"), _))
+        .Times(1);
+
+    ASSERT_TRUE(resources.charge(Resource::shm_buffer_memory, 120));
+    for (auto i = 0; i != 3; ++i)
+    {
+        ASSERT_TRUE(resources.replace_charge(Resource::shm_buffer_memory, 120, Resource::shm_buffer_memory, 120));
+    }
+}
+
+TEST_F(ClientResourcesWarnings, dropping_within_soft_quota_rearms_warning)
+{
+    mf::ClientResources resources{nullptr, 0, {{0, 0}, {100, 0}, {0, 0}}};
+
+    EXPECT_CALL(*mock_logger, log(ml::Severity::warning, HasSubstr("soft quota"), _))
+        .Times(2);
+
+    ASSERT_TRUE(resources.charge(Resource::shm_buffer_memory, 120));
+    ASSERT_TRUE(resources.replace_charge(Resource::shm_buffer_memory, 120, Resource::shm_buffer_memory, 80));
+    ASSERT_TRUE(resources.replace_charge(Resource::shm_buffer_memory, 80, Resource::shm_buffer_memory, 120));
+}
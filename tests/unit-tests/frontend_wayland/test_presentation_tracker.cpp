@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/presentation_tracker.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <map>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct FakeSurface : mf::PresentationTracker::Surface
+{
+    ~FakeSurface()
+    {
+        auto const to_notify = std::move(listeners);
+        for (auto const& listener : to_notify)
+            listener.second();
+    }
+
+    void add_destroy_listener(void const* key, std::function<void()> listener) override
+    {
+        listeners[key] = std::move(listener);
+    }
+
+    void remove_destroy_listener(void const* key) override
+    {
+        listeners.erase(key);
+    }
+
+    std::map<void const*, std::function<void()>> listeners;
+};
+
+struct MockFeedback : mf::PresentationTracker::Feedback
+{
+    MOCK_METHOD0(discard, void());
+    MOCK_METHOD3(presented, void(mg::Frame const&, std::chrono::nanoseconds, uint32_t));
+};
+
+struct PresentationTracker : Test
+{
+    auto feedback() -> std::shared_ptr<MockFeedback>
+    {
+        return std::make_shared<StrictMock<MockFeedback>>();
+    }
+
+    void present(std::vector<mg::BufferID> const& buffers)
+    {
+        tracker.frame_presented(buffers, frame, refresh, flags);
+    }
+
+    // Outlives the tracker, so updates still queued at the end of a test aren't discarded
+    std::unique_ptr<FakeSurface> surface{std::make_unique<FakeSurface>()};
+    mf::PresentationTracker tracker;
+    mg::Frame const frame{7, mg::Frame::Timestamp{CLOCK_MONOTONIC, 16ms}};
+    std::chrono::nanoseconds const refresh{16666666};
+    uint32_t const flags{mir::compositor::PresentationObserver::vsync};
+};
+}
+
+TEST_F(PresentationTracker, reports_presentation_of_the_committed_buffer)
+{
+    auto const shown = feedback();
+    tracker.track(surface.get(), mg::BufferID{1}, shown);
+
+    EXPECT_CALL(*shown, presented(Field(&mg::Frame::msc, Eq(frame.msc)), refresh, flags));
+
+    present({mg::BufferID{1}});
+}
+
+TEST_F(PresentationTracker, waits_while_other_buffers_are_presented)
+{
+    auto const waiting = feedback();
+    tracker.track(surface.get(), mg::BufferID{2}, waiting);
+
+    present({mg::BufferID{1}});
+    Mock::VerifyAndClearExpectations(waiting.get());
+
+    EXPECT_CALL(*waiting, presented(_, _, _));
+    present({mg::BufferID{2}});
+}
+
+TEST_F(PresentationTracker, discards_superseded_updates_before_reporting_the_presented_one)
+{
+    auto const superseded = feedback();
+    auto const shown = feedback();
+    auto const later = feedback();
+    tracker.track(surface.get(), mg::BufferID{1}, superseded);
+    tracker.track(surface.get(), mg::BufferID{2}, shown);
+    tracker.track(surface.get(), mg::BufferID{3}, later);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*superseded, discard());
+        EXPECT_CALL(*shown, presented(_, _, _));
+    }
+
+    present({mg::BufferID{2}});
+}
+
+TEST_F(PresentationTracker, discards_the_oldest_update_beyond_the_per_surface_cap)
+{
+    std::vector<std::shared_ptr<MockFeedback>> feedbacks;
+    for (auto i = 0u; i != mf::PresentationTracker::max_pending_per_surface; ++i)
+    {
+        feedbacks.push_back(feedback());
+        tracker.track(surface.get(), mg::BufferID{i + 1}, feedbacks.back());
+    }
+
+    EXPECT_CALL(*feedbacks.front(), discard());
+
+    tracker.track(surface.get(), mg::BufferID{1000}, feedback());
+}
+
+TEST_F(PresentationTracker, discards_queued_updates_when_the_surface_is_destroyed)
+{
+    auto const first = feedback();
+    auto const second = feedback();
+    tracker.track(surface.get(), mg::BufferID{1}, first);
+    tracker.track(surface.get(), mg::BufferID{2}, second);
+
+    EXPECT_CALL(*first, discard());
+    EXPECT_CALL(*second, discard());
+
+    surface.reset();
+
+    // Buffers presented after the surface went away are not reported
+    present({mg::BufferID{1}, mg::BufferID{2}});
+}
+
+TEST_F(PresentationTracker, stops_listening_to_a_surface_with_nothing_queued)
+{
+    auto const shown = feedback();
+    tracker.track(surface.get(), mg::BufferID{1}, shown);
+    ASSERT_THAT(surface->listeners.size(), Eq(1u));
+
+    EXPECT_CALL(*shown, presented(_, _, _));
+    present({mg::BufferID{1}});
+
+    EXPECT_THAT(surface->listeners, IsEmpty());
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/viewport_geometry.h"
+
+#include "viewporter_wrapper.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+geom::Size const buffer_size{640, 480};
+
+auto error_from(std::function<void()> const& apply) -> uint32_t
+{
+    try
+    {
+        apply();
+    }
+    catch (mw::ProtocolError const& error)
+    {
+        return error.code();
+    }
+    ADD_FAILURE() << "No protocol error was raised";
+    return ~0u;
+}
+}
+
+TEST(ViewportGeometry, without_source_or_destination_is_the_whole_buffer)
+{
+    auto const geometry = mf::viewport_geometry(nullptr, buffer_size, 1, {}, {});
+
+    EXPECT_THAT(geometry.size, Eq(buffer_size));
+    EXPECT_FALSE(geometry.buffer_source);
+}
+
+TEST(ViewportGeometry, destination_sets_the_surface_size)
+{
+    auto const geometry = mf::viewport_geometry(nullptr, buffer_size, 1, {}, geom::Size{320, 200});
+
+    EXPECT_THAT(geometry.size, Eq(geom::Size{320, 200}));
+    EXPECT_FALSE(geometry.buffer_source);
+}
+
+TEST(ViewportGeometry, integral_source_without_destination_sets_the_surface_size)
+{
+    auto const geometry = mf::viewport_geometry(nullptr, buffer_size, 1, mf::ViewportSource{10, 20, 100, 50}, {});
+
+    EXPECT_THAT(geometry.size, Eq(geom::Size{100, 50}));
+    EXPECT_THAT(geometry.buffer_source, Eq(geom::Rectangle{{10, 20}, {100, 50}}));
+}
+
+TEST(ViewportGeometry, source_is_scaled_to_buffer_pixels)
+{
+    auto const geometry = mf::viewport_geometry(
+        nullptr, buffer_size, 2, mf::ViewportSource{10, 20, 100, 50}, geom::Size{200, 100});
+
+    EXPECT_THAT(geometry.size, Eq(geom::Size{200, 100}));
+    EXPECT_THAT(geometry.buffer_source, Eq(geom::Rectangle{{20, 40}, {200, 100}}));
+}
+
+TEST(ViewportGeometry, fractional_source_is_rounded_outwards_to_whole_buffer_pixels)
+{
+    auto const geometry = mf::viewport_geometry(
+        nullptr, buffer_size, 1, mf::ViewportSource{10.5, 20.25, 100.25, 50.5}, geom::Size{100, 50});
+
+    // Left and top round down, right (110.75) and bottom (70.75) round up
+    EXPECT_THAT(geometry.buffer_source, Eq(geom::Rectangle{{10, 20}, {101, 51}}));
+}
+
+TEST(ViewportGeometry, fractional_source_is_rounded_after_scaling)
+{
+    auto const geometry = mf::viewport_geometry(
+        nullptr, buffer_size, 2, mf::ViewportSource{10.25, 20.5, 100.5, 50.25}, geom::Size{100, 50});
+
+    // The left (20.5) rounds down, the top (41) is already whole, the right (221.5) and bottom (141.5) round up
+    EXPECT_THAT(geometry.buffer_source, Eq(geom::Rectangle{{20, 41}, {202, 101}}));
+}
+
+TEST(ViewportGeometry, source_outside_the_buffer_is_an_out_of_buffer_error)
+{
+    EXPECT_THAT(
+        error_from([]{ mf::viewport_geometry(nullptr, buffer_size, 1, mf::ViewportSource{600, 0, 41, 10}, {}); }),
+        Eq(mw::Viewport::Error::out_of_buffer));
+    EXPECT_THAT(
+        error_from([]{ mf::viewport_geometry(nullptr, buffer_size, 1, mf::ViewportSource{0, 470, 10, 10.5}, {}); }),
+        Eq(mw::Viewport::Error::out_of_buffer));
+}
+
+TEST(ViewportGeometry, source_reaching_the_buffer_edge_is_accepted)
+{
+    auto const geometry = mf::viewport_geometry(nullptr, buffer_size, 1, mf::ViewportSource{600, 440, 40, 40}, {});
+
+    EXPECT_THAT(geometry.buffer_source, Eq(geom::Rectangle{{600, 440}, {40, 40}}));
+}
+
+TEST(ViewportGeometry, fractional_source_without_destination_is_a_bad_size_error)
+{
+    EXPECT_THAT(
+        error_from([]{ mf::viewport_geometry(nullptr, buffer_size, 1, mf::ViewportSource{0, 0, 100.5, 50}, {}); }),
+        Eq(mw::Viewport::Error::bad_size));
+}
+
+TEST(ViewportGeometry, fractional_source_position_without_destination_is_accepted)
+{
+    auto const geometry = mf::viewport_geometry(nullptr, buffer_size, 1, mf::ViewportSource{0.5, 0.5, 100, 50}, {});
+
+    EXPECT_THAT(geometry.size, Eq(geom::Size{100, 50}));
+    EXPECT_THAT(geometry.buffer_source, Eq(geom::Rectangle{{0, 0}, {101, 51}}));
+}
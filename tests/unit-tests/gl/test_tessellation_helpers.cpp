@@ -147,3 +147,19 @@ TEST_F(Tessellation, tex_coords_0_or_1_when_transformed)
     mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {x, y});
     expect_tex_coords_1_or_0(primitive);
 }
+
+TEST_F(Tessellation, tex_coords_span_source_rect)
+{
+    ON_CALL(renderable, buffer())
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(geom::Size{20, 40})));
+    ON_CALL(renderable, source_rect())
+        .WillByDefault(Return(geom::Rectangle{{5, 10}, {10, 20}}));
+
+    mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    for (int i = 0; i < primitive.nvertices; i++)
+    {
+        EXPECT_THAT(primitive.vertices[i].texcoord[0], AnyOf(Eq(0.25f), Eq(0.75f))) << "for i = " << i;
+        EXPECT_THAT(primitive.vertices[i].texcoord[1], AnyOf(Eq(0.25f), Eq(0.75f))) << "for i = " << i;
+    }
+}
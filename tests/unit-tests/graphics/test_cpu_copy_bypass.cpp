@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/cpu_copy_bypass.h"
+
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_renderable.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct ReadableBuffer : mtd::StubBuffer, mrs::ReadMappableBuffer
+{
+    ReadableBuffer(geom::Size size, MirPixelFormat format) :
+        StubBuffer{mg::BufferProperties{size, format, mg::BufferUsage::software}}
+    {
+    }
+
+    auto map_readable() -> std::unique_ptr<mrs::Mapping<unsigned char const>> override
+    {
+        return nullptr;
+    }
+};
+
+struct CpuCopyBypass : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {1920, 1080}};
+    glm::mat2 const identity{1};
+
+    auto renderable_of(std::shared_ptr<mg::Buffer> const& buffer) -> mg::RenderableList
+    {
+        return {std::make_shared<mtd::StubRenderable>(buffer, view_area)};
+    }
+};
+}
+
+TEST_F(CpuCopyBypass, bypasses_fullscreen_xrgb_buffer_the_cpu_can_read)
+{
+    auto const buffer = std::make_shared<ReadableBuffer>(view_area.size, mir_pixel_format_xrgb_8888);
+
+    EXPECT_THAT(mgc::cpu_copy_bypass_candidate(renderable_of(buffer), view_area, identity, view_area.size), Eq(buffer));
+}
+
+TEST_F(CpuCopyBypass, does_not_bypass_other_pixel_formats)
+{
+    for (auto const format : {mir_pixel_format_argb_8888, mir_pixel_format_abgr_8888, mir_pixel_format_rgb_565})
+    {
+        auto const buffer = std::make_shared<ReadableBuffer>(view_area.size, format);
+
+        EXPECT_THAT(mgc::cpu_copy_bypass_candidate(renderable_of(buffer), view_area, identity, view_area.size), IsNull())
+            << "format " << format;
+    }
+}
+
+TEST_F(CpuCopyBypass, does_not_bypass_buffers_the_cpu_cant_read)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{view_area.size, mir_pixel_format_xrgb_8888, mg::BufferUsage::hardware});
+
+    EXPECT_THAT(mgc::cpu_copy_bypass_candidate(renderable_of(buffer), view_area, identity, view_area.size), IsNull());
+}
+
+TEST_F(CpuCopyBypass, does_not_bypass_buffers_that_dont_fill_the_output)
+{
+    auto const buffer = std::make_shared<ReadableBuffer>(geom::Size{1280, 720}, mir_pixel_format_xrgb_8888);
+
+    EXPECT_THAT(mgc::cpu_copy_bypass_candidate(renderable_of(buffer), view_area, identity, view_area.size), IsNull());
+}
+
+TEST_F(CpuCopyBypass, does_not_bypass_on_a_transformed_output)
+{
+    glm::mat2 const rotated{0, 1, -1, 0};
+    auto const buffer = std::make_shared<ReadableBuffer>(view_area.size, mir_pixel_format_xrgb_8888);
+
+    EXPECT_THAT(mgc::cpu_copy_bypass_candidate(renderable_of(buffer), view_area, rotated, view_area.size), IsNull());
+}
+
+TEST_F(CpuCopyBypass, only_considers_the_topmost_renderable)
+{
+    auto const bottom = std::make_shared<ReadableBuffer>(view_area.size, mir_pixel_format_xrgb_8888);
+    auto const top = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{view_area.size, mir_pixel_format_xrgb_8888, mg::BufferUsage::hardware});
+
+    mg::RenderableList const renderables{
+        std::make_shared<mtd::StubRenderable>(bottom, view_area),
+        std::make_shared<mtd::StubRenderable>(top, view_area)};
+
+    EXPECT_THAT(mgc::cpu_copy_bypass_candidate(renderables, view_area, identity, view_area.size), IsNull());
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/egl_context_executor.h"
+#include "mir/renderer/gl/context.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+
+namespace mgc = mir::graphics::common;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+thread_local int current_context{0};
+
+class TaggedContext : public mir::renderer::gl::Context
+{
+public:
+    explicit TaggedContext(int tag) : tag{tag} {}
+
+    void make_current() const override { current_context = tag; }
+    void release_current() const override { current_context = 0; }
+
+private:
+    int const tag;
+};
+
+/// Blocks the thread it runs on until released
+struct Gate
+{
+    std::promise<void> opened;
+    std::shared_future<void> const open{opened.get_future().share()};
+
+    auto blocker() -> std::function<void()>
+    {
+        return [open = open] { open.wait(); };
+    }
+};
+}
+
+TEST(EGLContextExecutor, runs_work_with_context_current)
+{
+    std::promise<int> context;
+
+    {
+        mgc::EGLContextExecutor executor{std::make_unique<TaggedContext>(42)};
+        executor.spawn([&] { context.set_value(current_context); });
+    }
+
+    EXPECT_THAT(context.get_future().get(), Eq(42));
+}
+
+TEST(EGLContextExecutor, spawn_does_not_wait_for_running_work)
+{
+    Gate gate;
+    mgc::EGLContextExecutor executor{std::make_unique<TaggedContext>(1)};
+
+    std::promise<void> started;
+    executor.spawn([&, block = gate.blocker()] { started.set_value(); block(); });
+    started.get_future().wait();
+
+    auto spawned = std::async(std::launch::async, [&] { executor.spawn([]{}); });
+
+    EXPECT_THAT(spawned.wait_for(10s), Eq(std::future_status::ready));
+
+    gate.opened.set_value();
+}
+
+TEST(EGLContextExecutor, work_on_one_context_runs_in_order)
+{
+    std::vector<int> order;
+
+    {
+        mgc::EGLContextExecutor executor{std::make_unique<TaggedContext>(1)};
+        for (int i = 0; i != 100; ++i)
+            executor.spawn([&order, i] { order.push_back(i); });
+    }
+
+    ASSERT_THAT(order.size(), Eq(100u));
+    for (int i = 0; i != 100; ++i)
+        EXPECT_THAT(order[i], Eq(i));
+}
+
+TEST(EGLContextExecutor, destruction_drains_queued_work)
+{
+    Gate gate;
+    std::atomic<int> runs{0};
+
+    {
+        mgc::EGLContextExecutor executor{std::make_unique<TaggedContext>(1)};
+        executor.spawn(gate.blocker());
+        for (int i = 0; i != 10; ++i)
+            executor.spawn([&] { ++runs; });
+
+        gate.opened.set_value();
+    }
+
+    EXPECT_THAT(runs, Eq(10));
+}
+
+TEST(EGLContextExecutor, reports_queue_depth_and_latency)
+{
+    Gate gate;
+    mgc::EGLContextExecutor executor{std::make_unique<TaggedContext>(1)};
+
+    executor.spawn(gate.blocker());
+    for (int i = 0; i != 3; ++i)
+        executor.spawn([]{});
+
+    EXPECT_THAT(executor.statistics().queue_depth, Eq(4u));
+
+    std::this_thread::sleep_for(10ms);
+    gate.opened.set_value();
+
+    std::promise<void> done;
+    executor.spawn([&] { done.set_value(); });
+    done.get_future().wait();
+
+    // The last functor counts as complete only after it returns
+    while (executor.statistics().completed != 5)
+        std::this_thread::yield();
+
+    auto const statistics = executor.statistics();
+    EXPECT_THAT(statistics.queue_depth, Eq(0u));
+    EXPECT_THAT(statistics.max_queue_depth, Ge(4u));
+    EXPECT_THAT(statistics.max_latency, Ge(10ms));
+    EXPECT_THAT(statistics.mean_latency, Le(statistics.max_latency));
+}
@@ -0,0 +1,271 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/renderer/sw/pixel_ops.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace testing;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+// Odd lengths exercise both the vector loops and their scalar tails
+std::vector<size_t> const lengths{0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 64, 100, 257};
+
+auto random_pixels(size_t count) -> std::vector<uint32_t>
+{
+    static std::mt19937 generator{1234};
+    std::vector<uint32_t> pixels(count);
+    for (auto& pixel : pixels)
+        pixel = generator();
+    return pixels;
+}
+
+auto reference_swizzle(uint32_t pixel) -> uint32_t
+{
+    auto const a = pixel >> 24, r = (pixel >> 16) & 0xff, g = (pixel >> 8) & 0xff, b = pixel & 0xff;
+    return (a << 24) | (b << 16) | (g << 8) | r;
+}
+
+auto reference_premultiply(uint32_t pixel) -> uint32_t
+{
+    auto const a = pixel >> 24;
+    auto const scale = [a](uint32_t c) { return static_cast<uint32_t>(c * a / 255.0 + 0.5); };
+    return (a << 24) | (scale((pixel >> 16) & 0xff) << 16) | (scale((pixel >> 8) & 0xff) << 8) | scale(pixel & 0xff);
+}
+}
+
+TEST(PixelOps, reports_an_implementation)
+{
+    EXPECT_THAT(mrs::pixel_ops_implementation(), AnyOf(StrEq("avx2"), StrEq("sse2"), StrEq("neon"), StrEq("generic")));
+}
+
+TEST(PixelOps, swap_red_blue_matches_reference)
+{
+    for (auto const length : lengths)
+    {
+        auto const src = random_pixels(length);
+        std::vector<uint32_t> dst(length);
+
+        mrs::swap_red_blue(src.data(), dst.data(), length);
+
+        for (size_t i = 0; i != length; ++i)
+            ASSERT_THAT(dst[i], Eq(reference_swizzle(src[i]))) << "length " << length << ", pixel " << i;
+    }
+}
+
+TEST(PixelOps, swap_red_blue_works_in_place_and_unaligned)
+{
+    auto pixels = random_pixels(101);
+    auto const original = pixels;
+
+    mrs::swap_red_blue(pixels.data() + 1, pixels.data() + 1, 99);
+
+    EXPECT_THAT(pixels.front(), Eq(original.front()));
+    EXPECT_THAT(pixels.back(), Eq(original.back()));
+    for (size_t i = 1; i != 100; ++i)
+        ASSERT_THAT(pixels[i], Eq(reference_swizzle(original[i])));
+}
+
+TEST(PixelOps, premultiply_alpha_matches_reference)
+{
+    for (auto const length : lengths)
+    {
+        auto const src = random_pixels(length);
+        std::vector<uint32_t> dst(length);
+
+        mrs::premultiply_alpha(src.data(), dst.data(), length);
+
+        for (size_t i = 0; i != length; ++i)
+            ASSERT_THAT(dst[i], Eq(reference_premultiply(src[i]))) << "length " << length << ", pixel " << i;
+    }
+}
+
+TEST(PixelOps, premultiply_alpha_is_exact_for_every_channel_and_alpha)
+{
+    std::vector<uint32_t> pixels;
+    for (uint32_t a = 0; a != 256; ++a)
+        for (uint32_t c = 0; c != 256; ++c)
+            pixels.push_back((a << 24) | (c << 16) | ((255 - c) << 8) | c);
+
+    std::vector<uint32_t> premultiplied(pixels.size());
+    mrs::premultiply_alpha(pixels.data(), premultiplied.data(), pixels.size());
+
+    for (size_t i = 0; i != pixels.size(); ++i)
+        ASSERT_THAT(premultiplied[i], Eq(reference_premultiply(pixels[i])));
+}
+
+TEST(PixelOps, fill_pixels_sets_exactly_the_requested_pixels)
+{
+    for (auto const length : lengths)
+    {
+        std::vector<uint32_t> pixels(length + 2, 0);
+
+        mrs::fill_pixels(pixels.data() + 1, length, 0xdeadbeef);
+
+        EXPECT_THAT(pixels.front(), Eq(0u));
+        EXPECT_THAT(pixels.back(), Eq(0u));
+        EXPECT_THAT(std::count(pixels.begin() + 1, pixels.end() - 1, 0xdeadbeef), Eq(static_cast<long>(length)));
+    }
+}
+
+TEST(PixelOps, copy_rows_handles_differing_strides)
+{
+    size_t const width = 13, height = 7;
+    geom::Stride const src_stride{width * 4 + 12}, dst_stride{width * 4 + 4};
+
+    std::vector<unsigned char> src(src_stride.as_uint32_t() * height);
+    std::iota(src.begin(), src.end(), 0);
+    std::vector<unsigned char> dst(dst_stride.as_uint32_t() * height, 0);
+
+    mrs::copy_rows(src.data(), src_stride, dst.data(), dst_stride, width * 4, height);
+
+    for (size_t y = 0; y != height; ++y)
+    {
+        auto const src_row = src.begin() + y * src_stride.as_uint32_t();
+        auto const dst_row = dst.begin() + y * dst_stride.as_uint32_t();
+        EXPECT_TRUE(std::equal(src_row, src_row + width * 4, dst_row));
+        EXPECT_THAT(dst_row[width * 4], Eq(0));
+    }
+}
+
+TEST(PixelOps, flip_rows_reverses_row_order)
+{
+    for (size_t const height : {0u, 1u, 2u, 5u, 8u})
+    {
+        size_t const width = 19;
+        geom::Stride const stride{(width + 3) * 4};
+        auto const stride_pixels = stride.as_uint32_t() / 4;
+
+        auto pixels = random_pixels(stride_pixels * height);
+        auto const original = pixels;
+
+        mrs::flip_rows(reinterpret_cast<unsigned char*>(pixels.data()), stride, width, height, false);
+
+        for (size_t y = 0; y != height; ++y)
+            for (size_t x = 0; x != width; ++x)
+                ASSERT_THAT(pixels[y * stride_pixels + x], Eq(original[(height - 1 - y) * stride_pixels + x]));
+    }
+}
+
+TEST(PixelOps, flip_rows_can_swap_red_and_blue)
+{
+    for (size_t const height : {1u, 4u, 7u})
+    {
+        size_t const width = 37;
+        geom::Stride const stride{width * 4};
+
+        auto pixels = random_pixels(width * height);
+        auto const original = pixels;
+
+        mrs::flip_rows(reinterpret_cast<unsigned char*>(pixels.data()), stride, width, height, true);
+
+        for (size_t y = 0; y != height; ++y)
+            for (size_t x = 0; x != width; ++x)
+                ASSERT_THAT(pixels[y * width + x], Eq(reference_swizzle(original[(height - 1 - y) * width + x])));
+    }
+}
+
+TEST(PixelOps, scale_pixels_by_integer_factor_replicates_pixels)
+{
+    std::vector<uint32_t> const src{1, 2, 3, 4, 5, 6};
+    std::vector<uint32_t> dst(6 * 4);
+
+    mrs::scale_pixels(
+        src.data(), geom::Size{3, 2}, geom::Stride{3 * 4},
+        dst.data(), geom::Size{6, 4}, geom::Stride{6 * 4});
+
+    EXPECT_THAT(dst, ElementsAre(
+        1, 1, 2, 2, 3, 3,
+        1, 1, 2, 2, 3, 3,
+        4, 4, 5, 5, 6, 6,
+        4, 4, 5, 5, 6, 6));
+}
+
+TEST(PixelOps, scale_pixels_down_samples_pixel_centres)
+{
+    std::vector<uint32_t> src(4 * 4);
+    std::iota(src.begin(), src.end(), 0);
+    std::vector<uint32_t> dst(2 * 2);
+
+    mrs::scale_pixels(
+        src.data(), geom::Size{4, 4}, geom::Stride{4 * 4},
+        dst.data(), geom::Size{2, 2}, geom::Stride{2 * 4});
+
+    EXPECT_THAT(dst, ElementsAre(5, 7, 13, 15));
+}
+
+TEST(PixelOps, blend_over_matches_reference)
+{
+    auto const reference = [](uint32_t source, uint32_t destination, uint32_t opacity, bool opaque)
+        {
+            if (opaque)
+                source |= 0xff000000;
+            auto const source_alpha = std::lround((source >> 24) * opacity / 255.0);
+            uint32_t result = 0;
+            for (int shift = 0; shift != 32; shift += 8)
+            {
+                auto const channel =
+                    std::lround(((source >> shift) & 0xff) * opacity / 255.0) +
+                    std::lround(((destination >> shift) & 0xff) * (255 - source_alpha) / 255.0);
+                result |= std::min<uint32_t>(channel, 255) << shift;
+            }
+            return result;
+        };
+
+    for (auto const opacity : {0, 1, 128, 254, 255})
+    {
+        for (auto const opaque : {false, true})
+        {
+            for (auto const length : lengths)
+            {
+                std::vector<uint32_t> src;
+                for (auto const pixel : random_pixels(length))
+                    src.push_back(reference_premultiply(pixel));
+                auto const original_dst = random_pixels(length);
+                auto dst = original_dst;
+
+                mrs::blend_over(src.data(), dst.data(), length, opacity, opaque);
+
+                for (size_t i = 0; i != length; ++i)
+                {
+                    ASSERT_THAT(dst[i], Eq(reference(src[i], original_dst[i], opacity, opaque)))
+                        << "opacity " << opacity << ", opaque " << opaque << ", pixel " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(PixelOps, blend_over_of_opaque_source_replaces_destination)
+{
+    auto const src = random_pixels(37);
+    std::vector<uint32_t> dst(37, 0x12345678);
+
+    mrs::blend_over(src.data(), dst.data(), src.size(), 255, true);
+
+    for (size_t i = 0; i != src.size(); ++i)
+        ASSERT_THAT(dst[i], Eq(src[i] | 0xff000000));
+}
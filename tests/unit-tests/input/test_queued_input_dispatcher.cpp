@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/input/queued_input_dispatcher.h"
+
+#include "mir/events/event_builders.h"
+#include "mir_toolkit/events/input/input_event.h"
+#include "mir_toolkit/events/input/keyboard_event.h"
+
+#include "mir/dispatch/action_queue.h"
+#include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/test/signal.h"
+#include "mir/test/doubles/mock_input_dispatcher.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace mi = mir::input;
+namespace md = mir::dispatch;
+namespace mev = mir::events;
+namespace mt = mir::test;
+namespace mtd = mt::doubles;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+std::shared_ptr<MirEvent const> key_event(int scan_code)
+{
+    return mev::make_event(
+        MirInputDeviceId{0}, std::chrono::nanoseconds{scan_code}, std::vector<uint8_t>{},
+        mir_keyboard_action_down, 0, scan_code, mir_input_event_modifier_none);
+}
+
+int scan_code_of(MirEvent const& event)
+{
+    return mir_keyboard_event_scan_code(mir_input_event_get_keyboard_event(mir_event_get_input_event(&event)));
+}
+
+struct RecordingDispatcher : mi::InputDispatcher
+{
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] { return !blocked; });
+
+        scan_codes.push_back(scan_code_of(*event));
+        thread_ids.insert(std::this_thread::get_id());
+        cv.notify_all();
+        return true;
+    }
+
+    void start() override {}
+    void stop() override {}
+
+    void unblock()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        blocked = false;
+        cv.notify_all();
+    }
+
+    bool wait_for_count(size_t count)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        return cv.wait_for(lock, 30s, [&] { return scan_codes.size() >= count; });
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool blocked{false};
+    std::vector<int> scan_codes;
+    std::set<std::thread::id> thread_ids;
+};
+}
+
+TEST(QueuedInputDispatcher, delivers_events_on_a_separate_thread)
+{
+    auto const next = std::make_shared<RecordingDispatcher>();
+    mi::QueuedInputDispatcher dispatcher{next, std::make_shared<md::MultiplexingDispatchable>()};
+
+    dispatcher.dispatch(key_event(1));
+
+    ASSERT_TRUE(next->wait_for_count(1));
+    std::lock_guard<std::mutex> lock{next->mutex};
+    EXPECT_THAT(next->thread_ids, Not(Contains(std::this_thread::get_id())));
+}
+
+TEST(QueuedInputDispatcher, dispatch_does_not_wait_for_delivery)
+{
+    auto const next = std::make_shared<RecordingDispatcher>();
+    next->blocked = true;
+    mi::QueuedInputDispatcher dispatcher{next, std::make_shared<md::MultiplexingDispatchable>()};
+
+    // If dispatch() waited on the (blocked) next dispatcher this would hang
+    EXPECT_TRUE(dispatcher.dispatch(key_event(1)));
+    EXPECT_TRUE(dispatcher.dispatch(key_event(2)));
+
+    next->unblock();
+    EXPECT_TRUE(next->wait_for_count(2));
+}
+
+TEST(QueuedInputDispatcher, preserves_event_order_when_delivery_falls_behind)
+{
+    // Enough events to overflow the handoff buffer while delivery is stalled
+    int const event_count{5000};
+
+    auto const next = std::make_shared<RecordingDispatcher>();
+    next->blocked = true;
+    mi::QueuedInputDispatcher dispatcher{next, std::make_shared<md::MultiplexingDispatchable>()};
+
+    std::vector<int> expected;
+    for (int i = 0; i != event_count; ++i)
+    {
+        dispatcher.dispatch(key_event(i));
+        expected.push_back(i);
+
+        if (i == event_count/2)
+            next->unblock();
+    }
+
+    ASSERT_TRUE(next->wait_for_count(event_count));
+    std::lock_guard<std::mutex> lock{next->mutex};
+    EXPECT_THAT(next->scan_codes, ContainerEq(expected));
+}
+
+TEST(QueuedInputDispatcher, serves_other_delivery_work_on_the_delivery_thread)
+{
+    auto const next = std::make_shared<RecordingDispatcher>();
+    auto const delivery = std::make_shared<md::MultiplexingDispatchable>();
+    auto const work = std::make_shared<md::ActionQueue>();
+    delivery->add_watch(work);
+    mi::QueuedInputDispatcher dispatcher{next, delivery};
+
+    dispatcher.dispatch(key_event(1));
+    ASSERT_TRUE(next->wait_for_count(1));
+
+    mt::Signal done;
+    std::thread::id work_thread;
+    work->enqueue([&] { work_thread = std::this_thread::get_id(); done.raise(); });
+
+    ASSERT_TRUE(done.wait_for(30s));
+    std::lock_guard<std::mutex> lock{next->mutex};
+    EXPECT_THAT(next->thread_ids, ElementsAre(work_thread));
+
+    delivery->remove_watch(work);
+}
+
+TEST(QueuedInputDispatcher, forwards_start_and_stop)
+{
+    auto const next = std::make_shared<NiceMock<mtd::MockInputDispatcher>>();
+    mi::QueuedInputDispatcher dispatcher{next, std::make_shared<md::MultiplexingDispatchable>()};
+
+    InSequence seq;
+    EXPECT_CALL(*next, start());
+    EXPECT_CALL(*next, stop());
+
+    dispatcher.start();
+    dispatcher.stop();
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright © 2016 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/input/resampling_input_dispatcher.h"
+
+#include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/events/event_builders.h"
+#include "mir_toolkit/events/input/input_event.h"
+#include "mir_toolkit/events/input/pointer_event.h"
+#include "mir_toolkit/events/input/touch_event.h"
+#include "mir_toolkit/events/input/keyboard_event.h"
+
+#include "mir/test/doubles/mock_input_dispatcher.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <poll.h>
+
+namespace mi = mir::input;
+namespace md = mir::dispatch;
+namespace mg = mir::graphics;
+namespace mev = mir::events;
+namespace mtd = mir::test::doubles;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+MirInputDeviceId const device_id{7};
+
+struct ResamplingInputDispatcher : Test
+{
+    ResamplingInputDispatcher()
+    {
+        ON_CALL(*next, dispatch(_)).WillByDefault(Invoke(
+            [this](std::shared_ptr<MirEvent const> const& event)
+            {
+                delivered.push_back(event);
+                return true;
+            }));
+
+        // A frame was presented "now", which both the clock and the alarms
+        // agree on to within the test's tolerances
+        frame.msc = 1;
+        frame.ust = mir::time::PosixTimestamp{CLOCK_MONOTONIC, clock->now().time_since_epoch()};
+    }
+
+    std::chrono::nanoseconds frame_start() const
+    {
+        return frame.ust.nanoseconds;
+    }
+
+    std::shared_ptr<MirEvent const> motion(std::chrono::nanoseconds time, float x, float y, float dx = 0, float dy = 0)
+    {
+        return mev::make_event(device_id, time, {}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, 0, x, y, 0, 0, dx, dy);
+    }
+
+    std::shared_ptr<MirEvent const> button_down(std::chrono::nanoseconds time, float x, float y)
+    {
+        return mev::make_event(device_id, time, {}, mir_input_event_modifier_none,
+            mir_pointer_action_button_down, mir_pointer_button_primary, x, y, 0, 0, 0, 0);
+    }
+
+    struct TouchPoint
+    {
+        MirTouchId id;
+        float x;
+        float y;
+    };
+
+    std::shared_ptr<MirEvent const> touch(
+        std::chrono::nanoseconds time, MirTouchAction action, std::vector<TouchPoint> const& points)
+    {
+        auto event = mev::make_event(device_id, time, {}, mir_input_event_modifier_none);
+        for (auto const& point : points)
+            mev::add_touch(*event, point.id, action, mir_touch_tooltype_finger, point.x, point.y, 1, 0, 0, 0);
+        return std::move(event);
+    }
+
+    static MirTouchEvent const* touch_of(std::shared_ptr<MirEvent const> const& event)
+    {
+        return mir_input_event_get_touch_event(mir_event_get_input_event(event.get()));
+    }
+
+    static float touch_x(std::shared_ptr<MirEvent const> const& event, size_t index)
+    {
+        return mir_touch_event_axis_value(touch_of(event), index, mir_touch_axis_x);
+    }
+
+    static MirPointerEvent const* pointer(std::shared_ptr<MirEvent const> const& event)
+    {
+        return mir_input_event_get_pointer_event(mir_event_get_input_event(event.get()));
+    }
+
+    static float x_of(std::shared_ptr<MirEvent const> const& event)
+    {
+        return mir_pointer_event_axis_value(pointer(event), mir_pointer_axis_x);
+    }
+
+    void advance_to_next_frame()
+    {
+        alarm_factory->advance_by(1000ms/60 + 1ms);
+        clock->advance_by(1000ms/60 + 1ms);
+        run_delivery();
+    }
+
+    // Does the delivery thread's work on this one
+    void run_delivery()
+    {
+        pollfd fd{delivery->watch_fd(), POLLIN, 0};
+        while (poll(&fd, 1, 0) == 1)
+            delivery->dispatch(md::FdEvent::readable);
+    }
+
+    std::shared_ptr<NiceMock<mtd::MockInputDispatcher>> const next{std::make_shared<NiceMock<mtd::MockInputDispatcher>>()};
+    std::shared_ptr<mtd::FakeAlarmFactory> const alarm_factory{std::make_shared<mtd::FakeAlarmFactory>()};
+    std::shared_ptr<md::MultiplexingDispatchable> const delivery{std::make_shared<md::MultiplexingDispatchable>()};
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    mg::Frame frame;
+    std::vector<std::shared_ptr<MirEvent const>> delivered;
+
+    mi::ResamplingInputDispatcher dispatcher{next, alarm_factory, delivery, clock, [this] { return frame; }};
+};
+}
+
+TEST_F(ResamplingInputDispatcher, forwards_non_motion_events_immediately)
+{
+    auto const press = button_down(frame_start(), 0, 0);
+
+    dispatcher.dispatch(press);
+
+    EXPECT_THAT(delivered, ElementsAre(press));
+}
+
+TEST_F(ResamplingInputDispatcher, holds_motion_until_the_next_frame)
+{
+    dispatcher.dispatch(motion(frame_start() + 1ms, 1, 1));
+
+    EXPECT_THAT(delivered, IsEmpty());
+
+    advance_to_next_frame();
+
+    EXPECT_THAT(delivered, SizeIs(1));
+}
+
+TEST_F(ResamplingInputDispatcher, coalesces_motion_within_a_frame_and_sums_relative_motion)
+{
+    dispatcher.dispatch(motion(frame_start() + 1ms, 1, 1, 1, 2));
+    dispatcher.dispatch(motion(frame_start() + 2ms, 2, 3, 1, 2));
+    dispatcher.dispatch(motion(frame_start() + 3ms, 3, 5, 1, 2));
+
+    advance_to_next_frame();
+
+    ASSERT_THAT(delivered, SizeIs(1));
+    EXPECT_THAT(mir_pointer_event_axis_value(pointer(delivered[0]), mir_pointer_axis_relative_x), FloatEq(3));
+    EXPECT_THAT(mir_pointer_event_axis_value(pointer(delivered[0]), mir_pointer_axis_relative_y), FloatEq(6));
+}
+
+TEST_F(ResamplingInputDispatcher, interpolates_position_to_just_before_the_frame)
+{
+    // The next frame is ~16.7ms away and we resample 5ms before it, at ~11.7ms
+    dispatcher.dispatch(motion(frame_start() + 6ms, 10, 0));
+    dispatcher.dispatch(motion(frame_start() + 14ms, 50, 0));
+
+    advance_to_next_frame();
+
+    ASSERT_THAT(delivered, SizeIs(1));
+    EXPECT_THAT(x_of(delivered[0]), FloatNear(10 + 40*(1000.0f/60 - 5 - 6)/8, 0.5f));
+}
+
+TEST_F(ResamplingInputDispatcher, extrapolates_a_limited_distance_past_the_newest_sample)
+{
+    dispatcher.dispatch(motion(frame_start() + 2ms, 10, 0));
+    dispatcher.dispatch(motion(frame_start() + 6ms, 30, 0));
+
+    advance_to_next_frame();
+
+    // Prediction is capped at half the sample interval (2ms) past the newest sample
+    ASSERT_THAT(delivered, SizeIs(1));
+    EXPECT_THAT(x_of(delivered[0]), FloatNear(40, 0.5f));
+}
+
+TEST_F(ResamplingInputDispatcher, delivers_pending_motion_before_a_button_press)
+{
+    auto const move = motion(frame_start() + 1ms, 5, 5);
+    auto const press = button_down(frame_start() + 2ms, 5, 5);
+
+    dispatcher.dispatch(move);
+    dispatcher.dispatch(press);
+
+    ASSERT_THAT(delivered, SizeIs(2));
+    EXPECT_THAT(mir_pointer_event_action(pointer(delivered[0])), Eq(mir_pointer_action_motion));
+    EXPECT_THAT(x_of(delivered[0]), FloatEq(5));
+    EXPECT_THAT(delivered[1], Eq(press));
+
+    advance_to_next_frame();
+    EXPECT_THAT(delivered, SizeIs(2));
+}
+
+TEST_F(ResamplingInputDispatcher, delivers_held_motion_from_the_delivery_dispatchable)
+{
+    dispatcher.dispatch(motion(frame_start() + 1ms, 1, 1));
+
+    alarm_factory->advance_by(1000ms/60 + 1ms);
+    clock->advance_by(1000ms/60 + 1ms);
+
+    EXPECT_THAT(delivered, IsEmpty());
+
+    run_delivery();
+
+    EXPECT_THAT(delivered, SizeIs(1));
+}
+
+TEST_F(ResamplingInputDispatcher, interpolates_each_touch_point)
+{
+    dispatcher.dispatch(touch(frame_start() + 6ms, mir_touch_action_change, {{0, 10, 0}, {1, 100, 0}}));
+    dispatcher.dispatch(touch(frame_start() + 14ms, mir_touch_action_change, {{0, 50, 0}, {1, 20, 0}}));
+
+    advance_to_next_frame();
+
+    auto const alpha = (1000.0f/60 - 5 - 6)/8;
+    ASSERT_THAT(delivered, SizeIs(1));
+    ASSERT_THAT(mir_touch_event_point_count(touch_of(delivered[0])), Eq(2u));
+    EXPECT_THAT(touch_x(delivered[0], 0), FloatNear(10 + 40*alpha, 0.5f));
+    EXPECT_THAT(touch_x(delivered[0], 1), FloatNear(100 - 80*alpha, 0.5f));
+}
+
+TEST_F(ResamplingInputDispatcher, does_not_resample_between_touches_with_different_points)
+{
+    dispatcher.dispatch(touch(frame_start() + 6ms, mir_touch_action_change, {{0, 10, 0}}));
+    dispatcher.dispatch(touch(frame_start() + 14ms, mir_touch_action_change, {{0, 50, 0}, {1, 20, 0}}));
+
+    advance_to_next_frame();
+
+    ASSERT_THAT(delivered, SizeIs(1));
+    EXPECT_THAT(touch_x(delivered[0], 0), FloatEq(50));
+    EXPECT_THAT(touch_x(delivered[0], 1), FloatEq(20));
+}
+
+TEST_F(ResamplingInputDispatcher, forwards_touch_down_immediately)
+{
+    auto const down = touch(frame_start() + 1ms, mir_touch_action_down, {{0, 10, 0}});
+
+    dispatcher.dispatch(down);
+
+    EXPECT_THAT(delivered, ElementsAre(down));
+}
+
+TEST_F(ResamplingInputDispatcher, delivers_pending_touch_motion_before_touch_up)
+{
+    auto const up = touch(frame_start() + 4ms, mir_touch_action_up, {{0, 30, 0}});
+
+    dispatcher.dispatch(touch(frame_start() + 1ms, mir_touch_action_change, {{0, 10, 0}}));
+    dispatcher.dispatch(touch(frame_start() + 3ms, mir_touch_action_change, {{0, 30, 0}}));
+    dispatcher.dispatch(up);
+
+    ASSERT_THAT(delivered, SizeIs(2));
+    EXPECT_THAT(mir_touch_event_action(touch_of(delivered[0]), 0), Eq(mir_touch_action_change));
+    EXPECT_THAT(touch_x(delivered[0], 0), FloatEq(30));
+    EXPECT_THAT(delivered[1], Eq(up));
+
+    advance_to_next_frame();
+    EXPECT_THAT(delivered, SizeIs(2));
+}
+
+TEST_F(ResamplingInputDispatcher, forwards_start_and_stop)
+{
+    InSequence seq;
+    EXPECT_CALL(*next, start());
+    EXPECT_CALL(*next, stop());
+
+    dispatcher.start();
+    dispatcher.stop();
+}
@@ -268,3 +268,18 @@ TEST_F(BypassMatchTest, multimonitor_oversized_no_bypass)
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), primary_matcher));
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), secondary_matcher));
 }
+
+TEST_F(BypassMatchTest, cropped_buffer_not_bypassable)
+{
+    mgg::BypassMatch matcher(primary_monitor);
+
+    auto const cropped = std::make_shared<mtd::FakeRenderable>(primary_monitor);
+    cropped->set_buffer(std::make_shared<mtd::StubBuffer>(geom::Size{3840, 2400}));
+    cropped->set_source_rect({{0, 0}, {1920, 1200}});
+    mg::RenderableList list{cropped};
+
+    EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
+
+    cropped->set_source_rect({{0, 0}, {3840, 2400}});
+    EXPECT_NE(list.rend(), std::find_if(list.rbegin(), list.rend(), mgg::BypassMatch{primary_monitor}));
+}
@@ -472,6 +472,20 @@ TEST_F(MesaCursorTest, pads_missing_data_when_buffer_size_differs)
     cursor_tmp.show(SinglePixelCursorImage());
 }
 
+TEST_F(MesaCursorTest, showing_a_recently_shown_image_does_not_rewrite_buffers)
+{
+    using namespace testing;
+
+    SinglePixelCursorImage const other_image;
+    cursor.show(stub_image);
+    cursor.show(other_image);
+
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(0);
+    EXPECT_CALL(*output_container.outputs[0], set_cursor(_));
+
+    cursor.show(stub_image);
+}
+
 TEST_F(MesaCursorTest, does_not_throw_when_images_are_too_large)
 {
     using namespace testing;
@@ -37,6 +37,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <gbm.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 using namespace testing;
 using namespace mir;
@@ -114,11 +116,11 @@ public:
     }
 
 protected:
-    GBMOutputSurface make_output_surface()
+    GBMOutputSurface make_output_surface(int drm_fd = mir::Fd{})
     {
         helpers::EGLHelper egl{gl_config};
         return GBMOutputSurface{
-            mir::Fd{} ,
+            drm_fd,
             GBMSurfaceUPtr{nullptr},
             static_cast<uint32_t>(width),
             static_cast<uint32_t>(height),
@@ -445,6 +447,61 @@ TEST_F(MesaDisplayBufferTest, clone_mode_waits_for_page_flip_on_second_flip)
     db.post();
 }
 
+TEST_F(MesaDisplayBufferTest, clone_mode_reports_presentation_once_every_output_has_flipped)
+{
+    Frame const flipped{42, Frame::Timestamp{CLOCK_MONOTONIC, std::chrono::nanoseconds{1234}}};
+    ON_CALL(*mock_kms_output, last_frame())
+        .WillByDefault(Return(flipped));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    std::vector<Frame> presented;
+    ASSERT_TRUE(db.notify_next_presentation([&](Frame const& frame) { presented.push_back(frame); }));
+
+    EXPECT_CALL(*mock_kms_output, wait_for_page_flip())
+        .Times(2);
+
+    db.swap_buffers();
+    db.post();
+
+    ASSERT_THAT(presented.size(), Eq(1u));
+    EXPECT_THAT(presented.front().msc, Eq(flipped.msc));
+    EXPECT_THAT(presented.front().ust, Eq(flipped.ust));
+}
+
+TEST_F(MesaDisplayBufferTest, presentation_is_reported_once_per_frame)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    int first{0}, second{0};
+
+    db.notify_next_presentation([&](Frame const&) { ++first; });
+    db.swap_buffers();
+    db.post();
+
+    db.notify_next_presentation([&](Frame const&) { ++second; });
+    db.swap_buffers();
+    db.post();
+
+    db.swap_buffers();
+    db.post();
+
+    EXPECT_THAT(first, Eq(1));
+    EXPECT_THAT(second, Eq(1));
+}
+
 TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_list)
 {
     graphics::RenderableList list{
@@ -503,3 +560,83 @@ TEST_F(MesaDisplayBufferTest, buffer_requiring_migration_is_ineligable_for_bypas
 
     EXPECT_FALSE(db.overlay(bypassable_list));
 }
+
+namespace
+{
+/// A memfd stands in for the DRM device, so that dumb buffers can be mapped
+struct FakeDumbBufferDevice
+{
+    FakeDumbBufferDevice(MockDRM& mock_drm, int width, int height)
+        : fd{memfd_create("fake DRM device", 0)},
+          pitch{static_cast<uint32_t>(width) * 4}
+    {
+        if (fd < 0 || ftruncate(fd, pitch * height) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create fake DRM device"};
+
+        ON_CALL(mock_drm, drmIoctl(int{fd}, DRM_IOCTL_MODE_CREATE_DUMB, _))
+            .WillByDefault(Invoke(
+                [this, height](int, unsigned long, void* arg)
+                {
+                    auto const create = static_cast<drm_mode_create_dumb*>(arg);
+                    create->handle = 1;
+                    create->pitch = pitch;
+                    create->size = pitch * height;
+                    return 0;
+                }));
+    }
+
+    mir::Fd const fd;
+    uint32_t const pitch;
+};
+}
+
+TEST_F(MesaDisplayBufferTest, software_frames_are_scanned_out_from_dumb_buffers)
+{
+    FakeDumbBufferDevice device{mock_drm, width, height};
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(device.fd),
+        display_area,
+        identity);
+
+    FBHandle const* scanned_out{nullptr};
+    EXPECT_CALL(mock_gbm, gbm_surface_lock_front_buffer(_)).Times(0);
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(DoAll(SaveArg<0>(&scanned_out), Return(true)));
+
+    {
+        auto const mapping = db.map_framebuffer();
+        EXPECT_THAT(mapping->size(), Eq(geometry::Size{width, height}));
+        EXPECT_THAT(mapping->stride(), Eq(geometry::Stride{device.pitch}));
+        std::fill(mapping->data(), mapping->data() + mapping->len(), 0xff);
+    }
+    db.present({display_area});
+    db.post();
+
+    EXPECT_THAT(scanned_out, NotNull());
+    EXPECT_THAT(scanned_out, Ne(reinterpret_cast<FBHandle*>(0x12ad)));
+}
+
+TEST_F(MesaDisplayBufferTest, dumb_buffer_age_counts_frames_since_it_was_drawn)
+{
+    FakeDumbBufferDevice device{mock_drm, width, height};
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(device.fd),
+        display_area,
+        identity);
+
+    for (auto const expected_age : {0u, 0u, 2u, 2u})
+    {
+        db.map_framebuffer();
+        EXPECT_THAT(db.framebuffer_age(), Eq(expected_age));
+        db.present({display_area});
+        db.post();
+    }
+}
@@ -988,3 +988,66 @@ TEST_F(MesaDisplayConfigurationTest, does_not_query_drm_unnecesarily)
     EXPECT_CALL(mock_drm, drmModeGetConnector(_,_)).Times(AtLeast(1));
     display->configuration();
 }
+
+TEST_F(MesaDisplayConfigurationTest, only_probes_the_connector_named_by_a_hotplug_event)
+{
+    using namespace ::testing;
+    using namespace std::chrono_literals;
+
+    uint32_t const crtc_id{10};
+    uint32_t const encoder_id{20};
+    uint32_t const connector_ids[]{30, 31};
+    geom::Size const connector_physical_sizes_mm{480, 270};
+    std::vector<uint32_t> possible_encoder_ids_empty;
+
+    uint32_t const possible_crtcs_mask_empty{0};
+    mock_drm.reset(drm_device);
+    mock_drm.add_crtc(
+        drm_device,
+        crtc_id,
+        modes0[1]);
+    mock_drm.add_encoder(
+        drm_device,
+        encoder_id,
+        crtc_id,
+        possible_crtcs_mask_empty);
+    for (auto const connector_id : connector_ids)
+    {
+        mock_drm.add_connector(
+            drm_device,
+            connector_id,
+            DRM_MODE_CONNECTOR_Composite,
+            DRM_MODE_CONNECTED,
+            encoder_id,
+            modes0,
+            possible_encoder_ids_empty,
+            connector_physical_sizes_mm);
+    }
+    mock_drm.prepare(drm_device);
+
+    auto const syspath = fake_devices.add_device(
+        "drm",
+        "card2",
+        NULL,
+        {},
+        {
+            "DEVTYPE", "drm_minor",
+            "DEVNAME", "/dev/dri/card2",
+            "MAJOR", "226",
+            "MINOR", "2",
+            "HOTPLUG", "1",
+            "CONNECTOR", "31"
+        });
+
+    auto display = create_display(create_platform());
+
+    MainLoop ml;
+    mt::Signal handler_signal;
+    display->register_configuration_change_handler(ml.ml, [&handler_signal]{handler_signal.raise();});
+    fake_devices.emit_device_changed(syspath);
+    ASSERT_TRUE(handler_signal.wait_for(10s));
+
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, connector_ids[0])).Times(0);
+    EXPECT_CALL(mock_drm, drmModeGetConnector(_, connector_ids[1])).Times(AtLeast(1));
+    display->configuration();
+}
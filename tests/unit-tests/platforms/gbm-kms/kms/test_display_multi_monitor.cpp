@@ -40,6 +40,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
 #include <unordered_set>
 #include <fcntl.h>
 
@@ -541,6 +542,109 @@ TEST_F(MesaDisplayMultiMonitorTest, configure_clears_unused_connected_outputs)
     }
 }
 
+TEST_F(MesaDisplayMultiMonitorTest, configure_incrementally_only_releases_affected_groups)
+{
+    using namespace testing;
+
+    int const num_connected_outputs{3};
+    int const num_disconnected_outputs{2};
+
+    setup_outputs(num_connected_outputs, num_disconnected_outputs);
+
+    auto display = create_display_side_by_side(create_platform());
+
+    std::vector<mg::DisplaySyncGroup*> groups_before;
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { groups_before.push_back(&group); });
+    ASSERT_THAT(groups_before.size(), Eq(static_cast<size_t>(num_connected_outputs)));
+
+    /* Disable the rightmost output, leaving the others exactly as they are */
+    auto conf = display->configuration();
+    mg::DisplayConfigurationOutputId rightmost;
+    int rightmost_x{-1};
+
+    conf->for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (output.used && output.top_left.x.as_int() > rightmost_x)
+            {
+                rightmost = output.id;
+                rightmost_x = output.top_left.x.as_int();
+            }
+        });
+    conf->for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (output.id == rightmost)
+                output.used = false;
+        });
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    /* The surviving outputs keep their scanout buffers */
+    EXPECT_CALL(mock_drm, drmModeAddFB2(_, _, _, _, _, _, _, _, _))
+        .Times(0);
+
+    std::vector<mg::DisplaySyncGroup*> released;
+    EXPECT_TRUE(display->configure_incrementally(
+        *conf,
+        [&](std::vector<mg::DisplaySyncGroup*> const& groups) { released = groups; }));
+
+    ASSERT_THAT(released.size(), Eq(1u));
+
+    std::vector<mg::DisplaySyncGroup*> groups_after;
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { groups_after.push_back(&group); });
+
+    std::vector<mg::DisplaySyncGroup*> expected_survivors;
+    std::copy_if(
+        groups_before.begin(), groups_before.end(), std::back_inserter(expected_survivors),
+        [&](mg::DisplaySyncGroup* group) { return group != released.front(); });
+
+    EXPECT_THAT(groups_after, UnorderedElementsAreArray(expected_survivors));
+}
+
+TEST_F(MesaDisplayMultiMonitorTest, failed_incremental_configure_leaves_display_buffers_intact)
+{
+    using namespace testing;
+
+    int const num_connected_outputs{3};
+    int const num_disconnected_outputs{2};
+
+    setup_outputs(num_connected_outputs, num_disconnected_outputs);
+
+    auto display = create_display_side_by_side(create_platform());
+
+    std::vector<mg::DisplaySyncGroup*> groups_before;
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { groups_before.push_back(&group); });
+    ASSERT_THAT(groups_before.size(), Eq(static_cast<size_t>(num_connected_outputs)));
+
+    /* Change the mode of all but the leftmost output, so two groups are rebuilt */
+    auto conf = display->configuration();
+    conf->for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (output.used && output.top_left.x.as_int() > 0)
+                output.current_mode_index = (output.current_mode_index + 1) % output.modes.size();
+        });
+
+    /* Building the first new DisplayBuffer succeeds, but not the second */
+    EXPECT_CALL(mock_gbm, gbm_surface_create(_,_,_,_,_))
+        .WillOnce(Return(mock_gbm.fake_gbm.surface))
+        .WillRepeatedly(Return(nullptr));
+
+    EXPECT_THROW(
+        display->configure_incrementally(*conf, [](std::vector<mg::DisplaySyncGroup*> const&) {}),
+        std::runtime_error);
+
+    std::vector<mg::DisplaySyncGroup*> groups_after;
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { groups_after.push_back(&group); });
+
+    EXPECT_THAT(groups_after, ElementsAreArray(groups_before));
+}
+
 TEST_F(MesaDisplayMultiMonitorTest, resume_clears_unused_connected_outputs)
 {
     using namespace testing;
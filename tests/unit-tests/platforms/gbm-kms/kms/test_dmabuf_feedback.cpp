@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/dmabuf_feedback.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <drm_fourcc.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sysmacros.h>
+
+namespace mgg = mir::graphics::gbm;
+
+using namespace testing;
+using Entry = mgg::DmaBufFeedbackParameters::FormatTableEntry;
+
+namespace
+{
+struct MockFormatSink : mgg::DmaBufFeedbackParameters::FormatSink
+{
+    MOCK_METHOD1(format, void(uint32_t));
+    MOCK_METHOD2(modifier, void(uint32_t, uint64_t));
+};
+
+struct MockFeedbackSink : mgg::DmaBufFeedbackParameters::FeedbackSink
+{
+    MOCK_METHOD2(format_table, void(mir::Fd const&, uint32_t));
+    MOCK_METHOD1(main_device, void(dev_t));
+    MOCK_METHOD3(tranche, void(dev_t, uint32_t, std::vector<uint16_t> const&));
+    MOCK_METHOD0(done, void());
+};
+
+MATCHER_P2(IsEntry, format, modifier, "")
+{
+    return arg.format == static_cast<uint32_t>(format) && arg.padding == 0 && arg.modifier == modifier;
+}
+
+struct DmaBufFeedback : Test
+{
+    auto table_entries() -> std::vector<Entry>
+    {
+        mir::Fd table;
+        uint32_t size{0};
+        NiceMock<MockFeedbackSink> sink;
+        EXPECT_CALL(sink, format_table(_, _)).WillOnce(DoAll(SaveArg<0>(&table), SaveArg<1>(&size)));
+
+        parameters.send_feedback(sink);
+
+        std::vector<Entry> entries(size / sizeof(Entry));
+        EXPECT_THAT(size % sizeof(Entry), Eq(0u));
+        EXPECT_THAT(pread(table, entries.data(), size, 0), Eq(static_cast<ssize_t>(size)));
+        return entries;
+    }
+
+    dev_t const device{makedev(226, 128)};
+    mgg::DmaBufFeedbackParameters const parameters{
+        {
+            {DRM_FORMAT_XRGB8888, {DRM_FORMAT_MOD_LINEAR, I915_FORMAT_MOD_X_TILED}},
+            {DRM_FORMAT_ARGB8888, {DRM_FORMAT_MOD_INVALID}},
+            {DRM_FORMAT_XBGR8888, {}}
+        },
+        device};
+};
+}
+
+TEST_F(DmaBufFeedback, format_table_lists_every_importable_modifier_in_order)
+{
+    EXPECT_THAT(table_entries(), ElementsAre(
+        IsEntry(DRM_FORMAT_XRGB8888, DRM_FORMAT_MOD_LINEAR),
+        IsEntry(DRM_FORMAT_XRGB8888, I915_FORMAT_MOD_X_TILED),
+        IsEntry(DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_INVALID)));
+}
+
+TEST_F(DmaBufFeedback, format_table_is_read_only_and_sealed)
+{
+    mir::Fd table;
+    NiceMock<MockFeedbackSink> sink;
+    EXPECT_CALL(sink, format_table(_, _)).WillOnce(SaveArg<0>(&table));
+
+    parameters.send_feedback(sink);
+
+    Entry const entry{};
+    EXPECT_THAT(pwrite(table, &entry, sizeof entry, 0), Eq(-1));
+    EXPECT_THAT(ftruncate(table, 0), Eq(-1));
+
+    auto const seals = fcntl(table, F_GET_SEALS);
+    EXPECT_THAT(seals & (F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL),
+                Eq(F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL));
+}
+
+TEST_F(DmaBufFeedback, sends_a_single_tranche_of_the_whole_table_on_the_main_device)
+{
+    StrictMock<MockFeedbackSink> sink;
+
+    {
+        InSequence seq;
+        EXPECT_CALL(sink, format_table(_, 3 * sizeof(Entry)));
+        EXPECT_CALL(sink, main_device(device));
+        EXPECT_CALL(sink, tranche(device, 0u, ElementsAre(0, 1, 2)));
+        EXPECT_CALL(sink, done());
+    }
+
+    parameters.send_feedback(sink);
+}
+
+TEST_F(DmaBufFeedback, version_4_sends_no_format_events)
+{
+    StrictMock<MockFormatSink> sink;
+
+    parameters.send_formats(sink, 4);
+}
+
+TEST_F(DmaBufFeedback, version_3_sends_formats_and_modifiers)
+{
+    StrictMock<MockFormatSink> sink;
+
+    {
+        InSequence seq;
+        EXPECT_CALL(sink, format(DRM_FORMAT_XRGB8888));
+        EXPECT_CALL(sink, modifier(DRM_FORMAT_XRGB8888, DRM_FORMAT_MOD_LINEAR));
+        EXPECT_CALL(sink, modifier(DRM_FORMAT_XRGB8888, I915_FORMAT_MOD_X_TILED));
+        EXPECT_CALL(sink, format(DRM_FORMAT_ARGB8888));
+        EXPECT_CALL(sink, modifier(DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_INVALID));
+        EXPECT_CALL(sink, format(DRM_FORMAT_XBGR8888));
+    }
+
+    parameters.send_formats(sink, 3);
+}
+
+TEST_F(DmaBufFeedback, earlier_versions_send_formats_only)
+{
+    StrictMock<MockFormatSink> sink;
+
+    EXPECT_CALL(sink, format(DRM_FORMAT_XRGB8888));
+    EXPECT_CALL(sink, format(DRM_FORMAT_ARGB8888));
+    EXPECT_CALL(sink, format(DRM_FORMAT_XBGR8888));
+
+    parameters.send_formats(sink, 2);
+}
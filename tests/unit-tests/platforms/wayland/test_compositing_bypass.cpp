@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/wayland/compositing_bypass.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mgw = mir::graphics::wayland;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct HostBufferPool : Test
+{
+    mgw::HostBufferPool pool{[this](geom::Size size)
+        {
+            ++buffers_created;
+            return std::make_unique<mgw::HostBuffer>(size);
+        }};
+
+    int buffers_created{0};
+    geom::Size const size{1920, 1080};
+};
+}
+
+TEST_F(HostBufferPool, reuses_a_buffer_once_the_host_releases_it)
+{
+    auto& first = pool.acquire(size);
+    first.busy = false;
+
+    EXPECT_THAT(&pool.acquire(size), Eq(&first));
+    EXPECT_THAT(buffers_created, Eq(1));
+}
+
+TEST_F(HostBufferPool, creates_another_buffer_while_the_host_holds_one)
+{
+    auto& first = pool.acquire(size);
+    auto& second = pool.acquire(size);
+
+    EXPECT_THAT(&second, Ne(&first));
+    EXPECT_TRUE(first.busy);
+    EXPECT_TRUE(second.busy);
+    EXPECT_THAT(buffers_created, Eq(2));
+}
+
+TEST_F(HostBufferPool, replaces_idle_buffers_of_a_different_size)
+{
+    pool.acquire(size).busy = false;
+
+    auto& resized = pool.acquire(geom::Size{1280, 720});
+    resized.busy = false;
+
+    EXPECT_THAT(resized.size, Eq(geom::Size{1280, 720}));
+    EXPECT_THAT(&pool.acquire(geom::Size{1280, 720}), Eq(&resized));
+    EXPECT_THAT(buffers_created, Eq(2));
+}
@@ -24,6 +24,7 @@
 #include "src/server/report/null/display_report.h"
 
 #include "mir/graphics/display_configuration.h"
+#include "mir/graphics/display_buffer.h"
 
 #include "mir/test/doubles/null_display_configuration_policy.h"
 #include "mir/test/doubles/mock_egl.h"
@@ -365,3 +366,44 @@ TEST_F(X11DisplayTest, updates_scale_property_correctly)
 
     EXPECT_THAT(new_scale, Eq(scale));
 }
+
+TEST_F(X11DisplayTest, incremental_configuration_only_touches_changed_outputs_once_released)
+{
+    auto const window_sizes = std::vector<mgx::X11OutputConfig>{{{1280, 1024}}, {{600, 500}}};
+    setup_x11_screen(geom::Size{2880, 1800}, geom::Size{677, 290}, window_sizes);
+
+    auto display = create_display();
+
+    std::vector<mg::DisplaySyncGroup*> groups;
+    std::vector<mg::DisplayBuffer*> buffers;
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group)
+        {
+            groups.push_back(&group);
+            group.for_each_display_buffer([&](mg::DisplayBuffer& buffer) { buffers.push_back(&buffer); });
+        });
+    ASSERT_THAT(buffers.size(), Eq(2u));
+    auto const unchanged_area = buffers[0]->view_area();
+    auto const old_area = buffers[1]->view_area();
+
+    auto config = display->configuration();
+    geom::Point const moved_to{2000, 0};
+    config->for_each_output([&](mg::UserDisplayConfigurationOutput& conf_output)
+        {
+            if (conf_output.top_left == old_area.top_left)
+                conf_output.top_left = moved_to;
+        });
+
+    std::vector<mg::DisplaySyncGroup*> released;
+    geom::Rectangle area_when_released;
+    EXPECT_TRUE(display->configure_incrementally(*config, [&](std::vector<mg::DisplaySyncGroup*> const& groups)
+        {
+            released = groups;
+            area_when_released = buffers[1]->view_area();
+        }));
+
+    ASSERT_THAT(released.size(), Eq(1u));
+    EXPECT_THAT(released[0], Eq(groups[1]));
+    EXPECT_THAT(area_when_released, Eq(old_area));
+    EXPECT_THAT(buffers[1]->view_area(), Eq(geom::Rectangle{moved_to, old_area.size}));
+    EXPECT_THAT(buffers[0]->view_area(), Eq(unchanged_area));
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "src/platforms/x11/graphics/display_buffer.h"
+#include "src/server/report/null/display_report.h"
+
+#include "mir/graphics/atomic_frame.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/mock_x11.h"
+#include "mir/test/doubles/mock_gl_config.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_renderable.h"
+
+namespace mg=mir::graphics;
+namespace mgx=mg::X;
+namespace mrs=mir::renderer::software;
+namespace mtd=mir::test::doubles;
+namespace geom=mir::geometry;
+using namespace testing;
+
+namespace
+{
+class PixelMapping : public mrs::Mapping<unsigned char const>
+{
+public:
+    PixelMapping(std::vector<uint32_t> const& pixels, geom::Size size) :
+        pixels{pixels},
+        size_{size}
+    {
+    }
+
+    MirPixelFormat format() const override { return mir_pixel_format_xrgb_8888; }
+    geom::Stride stride() const override { return geom::Stride{size_.width.as_uint32_t() * sizeof(uint32_t)}; }
+    geom::Size size() const override { return size_; }
+    unsigned char const* data() override { return reinterpret_cast<unsigned char const*>(pixels.data()); }
+    size_t len() const override { return pixels.size() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t> const& pixels;
+    geom::Size const size_;
+};
+
+struct ClientBuffer : mtd::StubBuffer, mrs::ReadMappableBuffer
+{
+    explicit ClientBuffer(geom::Size size) :
+        StubBuffer{mg::BufferProperties{size, mir_pixel_format_xrgb_8888, mg::BufferUsage::software}},
+        pixels(size.width.as_uint32_t() * size.height.as_uint32_t(), 0xff336699)
+    {
+    }
+
+    auto map_readable() -> std::unique_ptr<mrs::Mapping<unsigned char const>> override
+    {
+        return std::make_unique<PixelMapping>(pixels, size());
+    }
+
+    std::vector<uint32_t> const pixels;
+};
+
+int destroy_image(XImage*)
+{
+    return 1;
+}
+
+class X11DisplayBufferTest : public Test
+{
+public:
+    X11DisplayBufferTest()
+    {
+        mock_x11.fake_x11.window_attributes.width = view_area.size.width.as_int();
+        mock_x11.fake_x11.window_attributes.height = view_area.size.height.as_int();
+
+        ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+            .WillByDefault(Return("other stuff"));
+
+        ON_CALL(mock_egl, eglGetConfigAttrib(mock_egl.fake_egl_display, _, _, _))
+            .WillByDefault(DoAll(SetArgPointee<3>(EGL_WINDOW_BIT), Return(EGL_TRUE)));
+
+        ON_CALL(mock_x11, XShmQueryExtension(_))
+            .WillByDefault(Return(True));
+
+        ON_CALL(mock_x11, XQueryExtension(_, StrEq("MIT-SHM"), _, _, _))
+            .WillByDefault(DoAll(SetArgPointee<2>(shm_opcode), Return(True)));
+
+        ON_CALL(mock_x11, XSetErrorHandler(_))
+            .WillByDefault(Invoke([this](XErrorHandler handler)
+                {
+                    auto const previous = error_handler;
+                    error_handler = handler;
+                    return previous;
+                }));
+
+        // Like the X server, report a failed attach once the client syncs
+        ON_CALL(mock_x11, XSync(_, _))
+            .WillByDefault(Invoke([this](Display* dpy, Bool)
+                {
+                    if (reject_attach && attach_requested && error_handler)
+                    {
+                        XErrorEvent error{};
+                        error.request_code = shm_opcode;
+                        error.minor_code = 1;
+                        error_handler(dpy, &error);
+                    }
+                    attach_requested = false;
+                    return 1;
+                }));
+
+        ON_CALL(mock_x11, XShmAttach(_, _))
+            .WillByDefault(Invoke([this](Display*, XShmSegmentInfo*)
+                {
+                    attach_requested = true;
+                    return True;
+                }));
+
+        ON_CALL(mock_x11, XShmCreateImage(_, _, _, _, _, _, _, _))
+            .WillByDefault(Invoke([this](Display*, Visual*, unsigned, int, char*, XShmSegmentInfo*, unsigned width, unsigned height)
+                {
+                    return fake_image(width, height);
+                }));
+
+        ON_CALL(mock_x11, XCreateImage(_, _, _, _, _, _, _, _, _, _))
+            .WillByDefault(Invoke([this](Display*, Visual*, unsigned, int, int, char* data, unsigned width, unsigned height, int, int)
+                {
+                    auto const image = fake_image(width, height);
+                    image->data = data;
+                    return image;
+                }));
+    }
+
+    auto fake_image(unsigned width, unsigned height) -> XImage*
+    {
+        images.push_back(std::make_unique<XImage>());
+        auto const image = images.back().get();
+        image->width = width;
+        image->height = height;
+        image->bytes_per_line = width * sizeof(uint32_t);
+        image->f.destroy_image = &destroy_image;
+        return image;
+    }
+
+    auto create_display_buffer() -> std::unique_ptr<mgx::DisplayBuffer>
+    {
+        return std::make_unique<mgx::DisplayBuffer>(
+            mock_x11.fake_x11.display,
+            mg::DisplayConfigurationOutputId{1},
+            mock_x11.fake_x11.window,
+            view_area,
+            refresh_rate,
+            EGL_NO_CONTEXT,
+            std::make_shared<mg::AtomicFrame>(),
+            std::make_shared<mir::report::null::DisplayReport>(),
+            mock_gl_config);
+    }
+
+    auto fullscreen(std::shared_ptr<mg::Buffer> const& buffer) -> mg::RenderableList
+    {
+        return {std::make_shared<mtd::StubRenderable>(buffer, view_area)};
+    }
+
+    geom::Rectangle const view_area{{0, 0}, {64, 32}};
+    double const refresh_rate{60.0};
+    int const shm_opcode{130};
+    XErrorHandler error_handler{nullptr};
+    bool reject_attach{false};
+    bool attach_requested{false};
+    std::vector<std::unique_ptr<XImage>> images;
+
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockX11> mock_x11;
+    NiceMock<mtd::MockGLConfig> mock_gl_config;
+};
+}
+
+TEST_F(X11DisplayBufferTest, passes_through_fullscreen_buffer_the_cpu_can_read)
+{
+    auto const display_buffer = create_display_buffer();
+
+    EXPECT_TRUE(display_buffer->overlay(fullscreen(std::make_shared<ClientBuffer>(view_area.size))));
+}
+
+TEST_F(X11DisplayBufferTest, does_not_pass_through_on_a_transformed_output)
+{
+    auto const display_buffer = create_display_buffer();
+    display_buffer->set_transformation(glm::mat2{0, 1, -1, 0});
+
+    EXPECT_FALSE(display_buffer->overlay(fullscreen(std::make_shared<ClientBuffer>(view_area.size))));
+}
+
+TEST_F(X11DisplayBufferTest, passthrough_shows_the_buffer_through_shared_memory)
+{
+    auto const display_buffer = create_display_buffer();
+    auto const buffer = std::make_shared<ClientBuffer>(view_area.size);
+
+    EXPECT_CALL(mock_x11, XShmPutImage_wrapper(
+        mock_x11.fake_x11.display, mock_x11.fake_x11.window, _, _, 0, 0, 0, 0,
+        view_area.size.width.as_uint32_t(), view_area.size.height.as_uint32_t()));
+    EXPECT_CALL(mock_x11, XPutImage(_, _, _, _, _, _, _, _, _, _)).Times(0);
+
+    ASSERT_TRUE(display_buffer->overlay(fullscreen(buffer)));
+    display_buffer->post();
+}
+
+TEST_F(X11DisplayBufferTest, passthrough_reuses_the_shared_memory_image)
+{
+    auto const display_buffer = create_display_buffer();
+    auto const buffer = std::make_shared<ClientBuffer>(view_area.size);
+
+    EXPECT_CALL(mock_x11, XShmCreateImage(_, _, _, _, _, _, _, _)).Times(1);
+    EXPECT_CALL(mock_x11, XShmPutImage_wrapper(_, _, _, _, _, _, _, _, _, _)).Times(2);
+
+    for (auto i = 0; i != 2; ++i)
+    {
+        ASSERT_TRUE(display_buffer->overlay(fullscreen(buffer)));
+        display_buffer->post();
+    }
+}
+
+TEST_F(X11DisplayBufferTest, falls_back_to_put_image_when_the_server_cant_attach_shared_memory)
+{
+    reject_attach = true;
+    auto const display_buffer = create_display_buffer();
+    auto const buffer = std::make_shared<ClientBuffer>(view_area.size);
+
+    EXPECT_CALL(mock_x11, XShmCreateImage(_, _, _, _, _, _, _, _)).Times(1);
+    EXPECT_CALL(mock_x11, XShmPutImage_wrapper(_, _, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_x11, XPutImage(
+        mock_x11.fake_x11.display, mock_x11.fake_x11.window, _, _, 0, 0, 0, 0,
+        view_area.size.width.as_uint32_t(), view_area.size.height.as_uint32_t())).Times(2);
+
+    for (auto i = 0; i != 2; ++i)
+    {
+        ASSERT_TRUE(display_buffer->overlay(fullscreen(buffer)));
+        display_buffer->post();
+    }
+
+    EXPECT_THAT(error_handler, IsNull());
+}
+
+TEST_F(X11DisplayBufferTest, present_puts_each_damaged_rectangle)
+{
+    auto const display_buffer = create_display_buffer();
+    display_buffer->map_framebuffer();
+
+    geom::Rectangle const first{{0, 0}, {16, 8}};
+    geom::Rectangle const second{{20, 10}, {4, 4}};
+
+    EXPECT_CALL(mock_x11, XPutImage(_, _, _, _, 0, 0, 0, 0, 16u, 8u));
+    EXPECT_CALL(mock_x11, XPutImage(_, _, _, _, 20, 10, 20, 10, 4u, 4u));
+
+    display_buffer->present({first, second});
+
+    EXPECT_THAT(display_buffer->framebuffer_age(), Eq(1u));
+}
+
+TEST_F(X11DisplayBufferTest, recommends_sleeping_after_passthrough_until_the_next_frame_is_due)
+{
+    using namespace std::chrono_literals;
+    auto const display_buffer = create_display_buffer();
+
+    ASSERT_TRUE(display_buffer->overlay(fullscreen(std::make_shared<ClientBuffer>(view_area.size))));
+    display_buffer->post();
+
+    // A 16ms frame at 60Hz, less 5ms to copy the next buffer
+    EXPECT_THAT(display_buffer->recommended_sleep(), Eq(11ms));
+}
+
+TEST_F(X11DisplayBufferTest, does_not_recommend_sleeping_after_compositing)
+{
+    using namespace std::chrono_literals;
+    auto const display_buffer = create_display_buffer();
+
+    ASSERT_TRUE(display_buffer->overlay(fullscreen(std::make_shared<ClientBuffer>(view_area.size))));
+    display_buffer->post();
+    display_buffer->post();
+
+    EXPECT_THAT(display_buffer->recommended_sleep(), Eq(0ms));
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/thread/basic_thread_pool.h"
+
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace testing;
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+class FramebufferMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    FramebufferMapping(std::vector<uint32_t>& pixels, geom::Size size)
+        : pixels{pixels},
+          size_{size}
+    {
+    }
+
+    MirPixelFormat format() const override { return mir_pixel_format_xrgb_8888; }
+    geom::Stride stride() const override { return geom::Stride{size_.width.as_int() * 4}; }
+    geom::Size size() const override { return size_; }
+    unsigned char* data() override { return reinterpret_cast<unsigned char*>(pixels.data()); }
+    size_t len() const override { return pixels.size() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t>& pixels;
+    geom::Size const size_;
+};
+
+/// A display buffer with a single framebuffer in memory, recording what is presented
+class SoftwareDisplayBuffer : public mtd::StubDisplayBuffer, public mrs::RenderTarget
+{
+public:
+    SoftwareDisplayBuffer(geom::Rectangle const& area)
+        : StubDisplayBuffer{area},
+          size{area.size},
+          framebuffer(area.size.width.as_int() * area.size.height.as_int(), 0xdeadbeef)
+    {
+    }
+
+    auto map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>> override
+    {
+        return std::make_unique<FramebufferMapping>(framebuffer, size);
+    }
+
+    auto framebuffer_age() const -> unsigned override
+    {
+        return presented ? 1 : 0;
+    }
+
+    void present(std::vector<geom::Rectangle> const& damage) override
+    {
+        presented = true;
+        last_damage = damage;
+    }
+
+    auto pixel(int x, int y) const -> uint32_t
+    {
+        return framebuffer[y * size.width.as_int() + x];
+    }
+
+    geom::Size const size;
+    std::vector<uint32_t> framebuffer;
+    std::vector<geom::Rectangle> last_damage;
+    bool presented{false};
+};
+
+auto buffer_of(geom::Size size, uint32_t pixel, MirPixelFormat format = mir_pixel_format_argb_8888)
+    -> std::shared_ptr<mtd::StubBuffer>
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+    std::vector<uint32_t> pixels(size.width.as_int() * size.height.as_int(), pixel);
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof(uint32_t));
+    return buffer;
+}
+
+auto renderable_of(geom::Rectangle const& position, uint32_t pixel, float alpha = 1.0f)
+    -> std::shared_ptr<mtd::FakeRenderable>
+{
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(position, alpha);
+    renderable->set_buffer(buffer_of(position.size, pixel));
+    return renderable;
+}
+
+auto area_covered(std::vector<geom::Rectangle> const& damage) -> int
+{
+    int area = 0;
+    for (auto const& rect : damage)
+        area += rect.size.width.as_int() * rect.size.height.as_int();
+    return area;
+}
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {200, 150}};
+    SoftwareDisplayBuffer display_buffer{view_area};
+    std::shared_ptr<mir::thread::BasicThreadPool> const thread_pool{
+        std::make_shared<mir::thread::BasicThreadPool>(0)};
+};
+}
+
+TEST_F(SoftwareRenderer, requires_a_software_render_target)
+{
+    mtd::StubDisplayBuffer gl_only_display_buffer{view_area};
+
+    EXPECT_THROW(
+        (mrs::Renderer{gl_only_display_buffer, thread_pool, 0}),
+        std::logic_error);
+}
+
+TEST_F(SoftwareRenderer, draws_renderables_over_a_cleared_framebuffer)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+
+    renderer.render({renderable_of({{10, 20}, {30, 40}}, 0xff112233)});
+
+    EXPECT_THAT(display_buffer.pixel(10, 20), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel(39, 59), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel(9, 20), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel(40, 59), Eq(0u));
+    EXPECT_THAT(display_buffer.pixel(199, 149), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, blends_translucent_renderables_over_those_beneath)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+
+    renderer.render({
+        renderable_of(view_area, 0xff00ff00),
+        renderable_of({{0, 0}, {50, 50}}, 0xffff0000, 0.5f)});
+
+    auto const blended = display_buffer.pixel(25, 25);
+    EXPECT_THAT(blended >> 24, Eq(0xffu));
+    EXPECT_THAT((blended >> 16) & 0xff, AllOf(Ge(0x7fu), Le(0x80u)));
+    EXPECT_THAT((blended >> 8) & 0xff, AllOf(Ge(0x7fu), Le(0x80u)));
+    EXPECT_THAT(display_buffer.pixel(75, 75), Eq(0xff00ff00u));
+}
+
+TEST_F(SoftwareRenderer, converts_abgr_buffers)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(view_area);
+    renderable->set_buffer(buffer_of(view_area.size, 0xff332211, mir_pixel_format_abgr_8888));
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0xff112233u));
+}
+
+TEST_F(SoftwareRenderer, scales_buffers_to_their_screen_position)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {100, 100}});
+    renderable->set_buffer(buffer_of({10, 10}, 0xff445566));
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0xff445566u));
+    EXPECT_THAT(display_buffer.pixel(99, 99), Eq(0xff445566u));
+    EXPECT_THAT(display_buffer.pixel(100, 100), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, draws_only_the_source_rect_of_buffers)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{{20, 10}, mir_pixel_format_argb_8888, mg::BufferUsage::software});
+    // Left half 0xff111111, right half 0xff222222
+    std::vector<uint32_t> pixels(20 * 10, 0xff111111);
+    for (int y = 0; y != 10; ++y)
+        std::fill(pixels.begin() + y * 20 + 10, pixels.begin() + y * 20 + 20, 0xff222222);
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof(uint32_t));
+
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {100, 100}});
+    renderable->set_buffer(buffer);
+    renderable->set_source_rect({{10, 0}, {10, 10}});
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0xff222222u));
+    EXPECT_THAT(display_buffer.pixel(99, 99), Eq(0xff222222u));
+    EXPECT_THAT(display_buffer.pixel(100, 0), Eq(0u));
+
+    renderable->set_source_rect({{0, 0}, {10, 10}});
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.pixel(50, 50), Eq(0xff111111u));
+}
+
+TEST_F(SoftwareRenderer, presents_only_what_changed)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+    auto const still = renderable_of({{0, 0}, {200, 150}}, 0xff000000);
+    auto const moving = renderable_of({{0, 0}, {10, 10}}, 0xffffffff);
+
+    renderer.render({still, moving});
+    EXPECT_THAT(area_covered(display_buffer.last_damage), Eq(200 * 150));
+
+    renderer.render({still, moving});
+    EXPECT_THAT(display_buffer.last_damage, IsEmpty());
+
+    auto const moved = renderable_of({{150, 100}, {10, 10}}, 0xffffffff);
+    renderer.render({still, moved});
+    EXPECT_THAT(area_covered(display_buffer.last_damage), AllOf(Gt(0), Lt(200 * 150)));
+    EXPECT_THAT(display_buffer.pixel(5, 5), Eq(0xff000000u));
+    EXPECT_THAT(display_buffer.pixel(155, 105), Eq(0xffffffffu));
+}
+
+TEST_F(SoftwareRenderer, worker_threads_draw_the_same_frame)
+{
+    SoftwareDisplayBuffer threaded_display_buffer{view_area};
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+    mrs::Renderer threaded_renderer{threaded_display_buffer, thread_pool, 3};
+
+    mg::RenderableList const renderables{
+        renderable_of({{-5, -5}, {150, 100}}, 0xff123456),
+        renderable_of({{30, 40}, {170, 110}}, 0x80402010, 0.75f),
+        renderable_of({{70, 20}, {20, 120}}, 0xffabcdef, 0.25f)};
+
+    renderer.render(renderables);
+    threaded_renderer.render(renderables);
+
+    EXPECT_THAT(threaded_display_buffer.framebuffer, ContainerEq(display_buffer.framebuffer));
+}
+
+TEST_F(SoftwareRenderer, rotates_the_output)
+{
+    mrs::Renderer renderer{display_buffer, thread_pool, 0};
+    renderer.set_output_transform(glm::mat2{-1, 0, 0, -1});
+
+    renderer.render({renderable_of({{0, 0}, {10, 10}}, 0xff112233)});
+
+    EXPECT_THAT(display_buffer.pixel(199, 149), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0u));
+}
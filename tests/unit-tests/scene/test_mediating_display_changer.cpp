@@ -27,6 +27,7 @@
 #include "mir/test/doubles/mock_compositor.h"
 #include "mir/test/doubles/null_display_configuration.h"
 #include "mir/test/doubles/stub_display_configuration.h"
+#include "mir/test/doubles/null_display_sync_group.h"
 #include "mir/test/doubles/mock_scene_session.h"
 #include "mir/test/doubles/stub_session.h"
 #include "mir/test/fake_shared.h"
@@ -323,8 +324,8 @@ TEST_F(MediatingDisplayChangerTest, handles_hardware_change_when_display_buffers
     EXPECT_CALL(mock_conf_policy, apply_to(Ref(*conf)));
 
     /*
-     * Currently we have to tear down and recreate the compositor in order to add
-     * a new output. This is not an inherent limitation, and we might do better later.
+     * Unless the display supports incremental configuration we have to tear
+     * down and recreate the compositor in order to add a new output.
      */
     EXPECT_CALL(mock_compositor, stop()).Times(1);
     EXPECT_CALL(mock_display, configure(Ref(*conf)));
@@ -333,6 +334,54 @@ TEST_F(MediatingDisplayChangerTest, handles_hardware_change_when_display_buffers
     changer->configure_for_hardware_change(conf);
 }
 
+TEST_F(MediatingDisplayChangerTest, handles_hardware_change_incrementally_when_display_supports_it)
+{
+    using namespace testing;
+    mtd::NullDisplayConfiguration conf;
+    mtd::NullDisplaySyncGroup affected_group;
+
+    ON_CALL(mock_display, apply_if_configuration_preserves_display_buffers(_))
+        .WillByDefault(Return(false));
+
+    InSequence s;
+    EXPECT_CALL(mock_conf_policy, apply_to(Ref(conf)));
+    EXPECT_CALL(mock_display, configure_incrementally(Ref(conf), _))
+        .WillOnce(Invoke(
+            [&](mg::DisplayConfiguration const&, mg::DisplaySyncGroupReleaseHandler const& release)
+            {
+                release({&affected_group});
+                return true;
+            }));
+    EXPECT_CALL(mock_compositor, stop_compositing(ElementsAre(&affected_group)));
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
+
+    EXPECT_CALL(mock_compositor, stop()).Times(0);
+    EXPECT_CALL(mock_display, configure(_)).Times(0);
+    EXPECT_CALL(mock_compositor, start()).Times(0);
+
+    changer->configure_for_hardware_change(mt::fake_shared(conf));
+}
+
+TEST_F(MediatingDisplayChangerTest, restarts_whole_compositor_when_incremental_configuration_fails)
+{
+    using namespace testing;
+    mtd::NullDisplayConfiguration conf;
+
+    ON_CALL(mock_display, apply_if_configuration_preserves_display_buffers(_))
+        .WillByDefault(Return(false));
+    EXPECT_CALL(mock_display, configure_incrementally(Ref(conf), _))
+        .WillOnce(InvokeWithoutArgs([]() -> bool { BOOST_THROW_EXCEPTION(std::runtime_error{"Avocado!"}); }));
+
+    auto const previous_base_config = changer->base_configuration();
+
+    InSequence s;
+    EXPECT_CALL(mock_compositor, stop());
+    EXPECT_CALL(mock_display, configure(mt::DisplayConfigMatches(std::cref(*previous_base_config))));
+    EXPECT_CALL(mock_compositor, start());
+
+    changer->configure_for_hardware_change(mt::fake_shared(conf));
+}
+
 TEST_F(MediatingDisplayChangerTest, hardware_change_doesnt_apply_base_config_if_per_session_config_is_active)
 {
     using namespace testing;
@@ -451,8 +500,8 @@ TEST_F(MediatingDisplayChangerTest, focusing_a_session_with_db_preserving_but_ou
     changer->configure(session1, conf);
 
     /*
-     * Currently we have to tear down and recreate the compositor in order to add
-     * a new output. This is not an inherent limitation, and we might do better later.
+     * Unless the display supports incremental configuration we have to tear
+     * down and recreate the compositor in order to add a new output.
      */
     InSequence s;
     EXPECT_CALL(mock_compositor, stop()).Times(1);
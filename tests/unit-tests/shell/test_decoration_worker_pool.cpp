@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/shell/decoration/worker_pool.h"
+#include "src/server/shell/decoration/threadsafe_access.h"
+
+#include "mir/test/signal.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+namespace msd = mir::shell::decoration;
+namespace mt = mir::test;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct Target
+{
+    std::vector<int> seen;
+};
+
+struct DecorationWorkerPool
+    : Test
+{
+    std::shared_ptr<msd::WorkerPool> const pool{std::make_shared<msd::WorkerPool>(4)};
+};
+}
+
+TEST_F(DecorationWorkerPool, runs_spawned_work)
+{
+    auto const done = std::make_shared<mt::Signal>();
+
+    pool->spawn([done] { done->raise(); });
+
+    EXPECT_TRUE(done->wait_for(10s));
+}
+
+TEST_F(DecorationWorkerPool, runs_work_concurrently)
+{
+    auto const entered = std::make_shared<std::atomic<int>>(0);
+    auto const all_entered = std::make_shared<mt::Signal>();
+
+    for (auto i = 0; i < 4; i++)
+    {
+        pool->spawn([entered, all_entered]
+            {
+                if (++*entered == 4)
+                    all_entered->raise();
+                all_entered->wait_for(10s);
+            });
+    }
+
+    EXPECT_TRUE(all_entered->wait_for(10s));
+}
+
+TEST_F(DecorationWorkerPool, threadsafe_access_runs_work_in_order)
+{
+    Target target;
+    auto const access = std::make_shared<msd::ThreadsafeAccess<Target>>(pool);
+    access->initialize(&target);
+
+    auto const items = 1000;
+    auto const done = std::make_shared<mt::Signal>();
+    for (auto i = 0; i < items; i++)
+    {
+        access->spawn([i](Target* target) { target->seen.push_back(i); });
+    }
+    access->spawn([done](Target*) { done->raise(); });
+
+    ASSERT_TRUE(done->wait_for(10s));
+    access->invalidate();
+
+    ASSERT_THAT(target.seen, SizeIs(items));
+    for (auto i = 0; i < items; i++)
+        EXPECT_THAT(target.seen[i], Eq(i));
+}
+
+TEST_F(DecorationWorkerPool, threadsafe_access_drops_work_once_invalidated)
+{
+    Target target;
+    auto const access = std::make_shared<msd::ThreadsafeAccess<Target>>(pool);
+    access->initialize(&target);
+    access->invalidate();
+
+    auto const done = std::make_shared<mt::Signal>();
+    access->spawn([](Target* target) { target->seen.push_back(0); });
+    pool->spawn([done] { done->raise(); });
+
+    ASSERT_TRUE(done->wait_for(10s));
+    EXPECT_THAT(target.seen, IsEmpty());
+}
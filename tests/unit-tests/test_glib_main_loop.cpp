@@ -792,6 +792,110 @@ TEST_F(GLibMainLoopTest, dispatches_actions_resumed_externally)
     EXPECT_THAT(actions, ElementsAre(1, 0));
 }
 
+TEST_F(GLibMainLoopTest, dispatches_pending_actions_in_priority_order)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    int const owner{0};
+
+    ml.enqueue_with_priority(&owner, mir::ServerActionPriority::low, [&] { actions.push_back(4); ml.stop(); });
+    ml.enqueue_with_priority(&owner, mir::ServerActionPriority::normal, [&] { actions.push_back(2); });
+    ml.enqueue_with_priority(&owner, mir::ServerActionPriority::high, [&] { actions.push_back(0); });
+    ml.enqueue(&owner, [&] { actions.push_back(3); });
+    ml.enqueue_with_priority(&owner, mir::ServerActionPriority::high, [&] { actions.push_back(1); });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST_F(GLibMainLoopTest, resumed_actions_keep_their_order_and_priority)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    int const owner1{0};
+    int const owner2{0};
+
+    ml.pause_processing_for(&owner1);
+
+    ml.enqueue_with_priority(&owner1, mir::ServerActionPriority::normal, [&] { actions.push_back(3); });
+    ml.enqueue_with_priority(&owner1, mir::ServerActionPriority::high, [&] { actions.push_back(1); });
+    ml.enqueue_with_priority(&owner1, mir::ServerActionPriority::normal, [&] { actions.push_back(4); });
+    ml.enqueue_with_priority(&owner2, mir::ServerActionPriority::low, [&] { actions.push_back(5); ml.stop(); });
+    ml.enqueue_with_priority(
+        &owner2,
+        mir::ServerActionPriority::high,
+        [&]
+        {
+            actions.push_back(0);
+            ml.resume_processing_for(&owner1);
+            ml.enqueue_with_priority(&owner2, mir::ServerActionPriority::high, [&] { actions.push_back(2); });
+        });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(0, 1, 2, 3, 4, 5));
+}
+
+TEST_F(GLibMainLoopTest, actions_pending_when_paused_run_before_those_enqueued_while_paused)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    int const owner1{0};
+    int const owner2{0};
+
+    ml.enqueue(&owner1, [&] { actions.push_back(1); });
+    ml.pause_processing_for(&owner1);
+    ml.enqueue(&owner1, [&] { actions.push_back(2); });
+    ml.enqueue(&owner1, [&] { actions.push_back(3); ml.stop(); });
+    ml.enqueue(&owner2, [&] { actions.push_back(0); ml.resume_processing_for(&owner1); });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(0, 1, 2, 3));
+}
+
+TEST_F(GLibMainLoopTest, actions_enqueued_from_within_action_do_not_starve_other_sources)
+{
+    using namespace testing;
+
+    mt::Pipe p;
+    char const data_to_write{'a'};
+    int handled_fd{-1};
+    int const owner{0};
+    std::function<void()> requeue;
+
+    requeue =
+        [&]
+        {
+            if (handled_fd < 0)
+                ml.enqueue(&owner, requeue);
+            else
+                ml.stop();
+        };
+
+    ml.register_fd_handler(
+        {p.read_fd()},
+        &owner,
+        [&handled_fd] (int fd)
+        {
+            char c;
+            if (read(fd, &c, 1) == 1)
+                handled_fd = fd;
+        });
+
+    EXPECT_EQ(1, write(p.write_fd(), &data_to_write, 1));
+
+    ml.enqueue(&owner, requeue);
+
+    ml.run();
+
+    EXPECT_THAT(handled_fd, Eq(p.read_fd()));
+}
+
 TEST_F(GLibMainLoopTest, propagates_exception_from_server_action)
 {
     // Execute in forked process to work around
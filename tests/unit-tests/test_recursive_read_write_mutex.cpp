@@ -23,6 +23,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <chrono>
+
 namespace mt = mir::test;
 
 using namespace testing;
@@ -174,3 +177,77 @@ TEST_F(RecursiveReadWriteMutex, read_lock_waits_for_write_locks_on_other_threads
 
     threads.push_back(std::thread{writer_function});
 }
+
+TEST_F(RecursiveReadWriteMutex, can_be_recursively_read_locked_while_a_writer_waits)
+{
+    mt::Barrier writer_started{2};
+
+    auto const writer_function =
+        [&]{
+            writer_started.ready();
+
+            mutex.write_lock();
+            notify_write_locked();
+            mutex.write_unlock();
+        };
+
+    InSequence seq;
+
+    EXPECT_CALL(*this, notify_read_unlocking()).Times(1);
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+
+    mutex.read_lock();
+    threads.push_back(std::thread{writer_function});
+
+    // Give the writer a chance to start waiting (the test passes either way)
+    writer_started.ready();
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+    mutex.read_lock();
+    mutex.read_unlock();
+
+    notify_read_unlocking();
+    mutex.read_unlock();
+}
+
+TEST_F(RecursiveReadWriteMutex, writers_exclude_readers_and_other_writers)
+{
+    int const iterations{2000};
+    unsigned const writer_threads{4};
+    std::pair<int, int> guarded{0, 0};
+    std::atomic<bool> consistent{true};
+
+    for (auto i = 0U; i != reader_threads; ++i)
+    {
+        threads.push_back(std::thread{
+            [&]{
+                for (int j = 0; j != iterations; ++j)
+                {
+                    mutex.read_lock();
+                    if (guarded.first != guarded.second)
+                        consistent = false;
+                    mutex.read_unlock();
+                }
+            }});
+    }
+
+    for (auto i = 0U; i != writer_threads; ++i)
+    {
+        threads.push_back(std::thread{
+            [&]{
+                for (int j = 0; j != iterations; ++j)
+                {
+                    mutex.write_lock();
+                    ++guarded.first;
+                    ++guarded.second;
+                    mutex.write_unlock();
+                }
+            }});
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_THAT(guarded.first, Eq(iterations * int(writer_threads)));
+}
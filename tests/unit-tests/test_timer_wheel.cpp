@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/time/timer_wheel.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mt = mir::time;
+
+namespace
+{
+struct TimerWheelTest : Test
+{
+    mt::Timestamp const origin{std::chrono::seconds{1000}};
+    mt::TimerWheel wheel{origin, 1ms};
+
+    std::vector<mt::TimerWheel::Timer*> advance_to(mt::Timestamp now)
+    {
+        std::vector<mt::TimerWheel::Timer*> expired;
+        wheel.advance(now, [&](mt::TimerWheel::Timer& timer) { expired.push_back(&timer); });
+        return expired;
+    }
+};
+}
+
+TEST_F(TimerWheelTest, is_initially_empty)
+{
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_THAT(advance_to(origin + 1h), IsEmpty());
+}
+
+TEST_F(TimerWheelTest, timer_expires_at_but_not_before_deadline)
+{
+    mt::TimerWheel::Timer timer;
+    wheel.schedule(timer, origin + 120ms);
+
+    EXPECT_TRUE(timer.scheduled());
+    EXPECT_THAT(advance_to(origin + 119ms), IsEmpty());
+    EXPECT_THAT(advance_to(origin + 120ms), ElementsAre(&timer));
+    EXPECT_FALSE(timer.scheduled());
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheelTest, deadline_is_rounded_up_to_granularity)
+{
+    mt::TimerWheel::Timer timer;
+    wheel.schedule(timer, origin + 10ms + 1us);
+
+    EXPECT_THAT(advance_to(origin + 10ms + 1us), IsEmpty());
+    EXPECT_THAT(advance_to(origin + 11ms), ElementsAre(&timer));
+}
+
+TEST_F(TimerWheelTest, timers_within_one_tick_expire_together)
+{
+    mt::TimerWheel::Timer first, second;
+    wheel.schedule(first, origin + 5ms + 100us);
+    wheel.schedule(second, origin + 5ms + 900us);
+
+    EXPECT_THAT(wheel.next_event(), Eq(origin + 6ms));
+    EXPECT_THAT(advance_to(origin + 6ms), UnorderedElementsAre(&first, &second));
+}
+
+TEST_F(TimerWheelTest, cancelled_timer_does_not_expire)
+{
+    mt::TimerWheel::Timer timer;
+    wheel.schedule(timer, origin + 50ms);
+    wheel.cancel(timer);
+
+    EXPECT_FALSE(timer.scheduled());
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_THAT(advance_to(origin + 1s), IsEmpty());
+}
+
+TEST_F(TimerWheelTest, rescheduled_timer_expires_only_at_new_deadline)
+{
+    mt::TimerWheel::Timer timer;
+    wheel.schedule(timer, origin + 50ms);
+    wheel.schedule(timer, origin + 5s);
+
+    EXPECT_THAT(advance_to(origin + 50ms), IsEmpty());
+    EXPECT_THAT(advance_to(origin + 5s), ElementsAre(&timer));
+}
+
+TEST_F(TimerWheelTest, timer_scheduled_in_the_past_expires_on_next_advance)
+{
+    advance_to(origin + 1s);
+
+    mt::TimerWheel::Timer timer;
+    wheel.schedule(timer, origin + 10ms);
+
+    EXPECT_THAT(wheel.next_event(), Le(origin + 1s));
+    EXPECT_THAT(advance_to(origin + 1s), ElementsAre(&timer));
+}
+
+TEST_F(TimerWheelTest, timer_beyond_outermost_wheel_expires_on_time)
+{
+    mt::TimerWheel::Timer timer;
+    wheel.schedule(timer, origin + 30h);
+
+    EXPECT_THAT(advance_to(origin + 30h - 1ms), IsEmpty());
+    EXPECT_THAT(advance_to(origin + 30h), ElementsAre(&timer));
+}
+
+TEST_F(TimerWheelTest, next_event_is_never_after_earliest_deadline)
+{
+    mt::TimerWheel::Timer near, far;
+    wheel.schedule(far, origin + 3h);
+    wheel.schedule(near, origin + 70s);
+
+    EXPECT_THAT(wheel.next_event(), Le(origin + 70s));
+
+    // The timers go out of scope before the wheel
+    wheel.cancel(near);
+    wheel.cancel(far);
+}
+
+TEST_F(TimerWheelTest, expires_many_random_timers_in_deadline_order)
+{
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> delay_ms{0, 5'000'000};
+
+    std::vector<mt::TimerWheel::Timer> timers(1000);
+    for (auto& timer : timers)
+        wheel.schedule(timer, origin + std::chrono::milliseconds{delay_ms(generator)});
+
+    // Cancel a few along the way
+    for (size_t i = 0; i < timers.size(); i += 7)
+        wheel.cancel(timers[i]);
+
+    mt::Timestamp now = origin;
+    mt::Timestamp last_deadline = origin;
+    size_t expired_count{0};
+
+    while (!wheel.empty())
+    {
+        now = std::max(now + 1ms, wheel.next_event());
+        for (auto const timer : advance_to(now))
+        {
+            EXPECT_THAT(timer->deadline(), Le(now));
+            EXPECT_THAT(timer->deadline(), Gt(now - 1ms));
+            EXPECT_THAT(timer->deadline(), Ge(last_deadline));
+            last_deadline = timer->deadline();
+            ++expired_count;
+        }
+    }
+
+    EXPECT_THAT(expired_count, Eq(timers.size() - (timers.size() + 6) / 7));
+}
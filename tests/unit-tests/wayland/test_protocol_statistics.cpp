@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/wayland/protocol_statistics.h"
+
+#include <wayland-server-core.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+
+namespace mw = mir::wayland;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+wl_message const test_requests[] = {
+    {"destroy", "", nullptr},
+    {"frobnicate", "u", nullptr}};
+
+wl_message const test_events[] = {
+    {"frobnicated", "", nullptr}};
+
+wl_interface const test_interface{"test_frobnicator", 1, 2, test_requests, 1, test_events};
+
+auto statistics_for(std::string const& message) -> std::vector<mw::MessageStatistics>
+{
+    auto statistics = mw::protocol_statistics();
+    statistics.erase(
+        std::remove_if(
+            statistics.begin(),
+            statistics.end(),
+            [&](auto const& s) { return s.interface != test_interface.name || s.message != message; }),
+        statistics.end());
+    return statistics;
+}
+}
+
+TEST(ProtocolStatistics, omits_messages_that_have_not_been_seen)
+{
+    mw::InterfaceStatistics statistics{&test_interface, 2, 1};
+
+    EXPECT_THAT(statistics_for("destroy"), IsEmpty());
+    EXPECT_THAT(statistics_for("frobnicated"), IsEmpty());
+}
+
+TEST(ProtocolStatistics, accumulates_request_counts_and_handler_time)
+{
+    mw::InterfaceStatistics statistics{&test_interface, 2, 1};
+
+    statistics.record_request(1, 3ms);
+    statistics.record_request(1, 4ms);
+
+    auto const frobnicate = statistics_for("frobnicate");
+    ASSERT_THAT(frobnicate.size(), Eq(1u));
+    EXPECT_TRUE(frobnicate[0].is_request);
+    EXPECT_THAT(frobnicate[0].count, Eq(2u));
+    EXPECT_THAT(frobnicate[0].handler_time, Eq(7ms));
+}
+
+TEST(ProtocolStatistics, counts_events)
+{
+    mw::InterfaceStatistics statistics{&test_interface, 2, 1};
+
+    statistics.record_event(0);
+
+    auto const frobnicated = statistics_for("frobnicated");
+    ASSERT_THAT(frobnicated.size(), Eq(1u));
+    EXPECT_FALSE(frobnicated[0].is_request);
+    EXPECT_THAT(frobnicated[0].count, Eq(1u));
+}
+
+TEST(ProtocolStatistics, statistics_are_unregistered_on_destruction)
+{
+    {
+        mw::InterfaceStatistics statistics{&test_interface, 2, 1};
+        statistics.record_request(0, 1ms);
+        ASSERT_THAT(statistics_for("destroy"), Not(IsEmpty()));
+    }
+
+    EXPECT_THAT(statistics_for("destroy"), IsEmpty());
+}